@@ -0,0 +1,87 @@
+// Host build: Adafruit_GFX subset drawing into a subclass framebuffer. Text is tracked
+// (cursor, bounds with the built-in 6x8 font) but glyphs are rendered as solid cells.
+#ifndef HAL_NATIVE_ADAFRUIT_GFX_H
+#define HAL_NATIVE_ADAFRUIT_GFX_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "Print.h"
+#include "WString.h"
+
+class Adafruit_GFX : public Print {
+ public:
+  Adafruit_GFX(int16_t w, int16_t h) : width_(w), height_(h) {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t yy = y; yy < y + h; ++yy) {
+      for (int16_t xx = x; xx < x + w; ++xx) {
+        drawPixel(xx, yy, color);
+      }
+    }
+  }
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+    fillRect(x, y + h - 1, w, 1, color);
+    fillRect(x, y, 1, h, color);
+    fillRect(x + w - 1, y, 1, h, color);
+  }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+
+  void setCursor(int16_t x, int16_t y) {
+    cursorX_ = x;
+    cursorY_ = y;
+  }
+  int16_t getCursorX() const { return cursorX_; }
+  int16_t getCursorY() const { return cursorY_; }
+  void setTextSize(uint8_t s) { textSize_ = s > 0 ? s : 1; }
+  void setTextColor(uint16_t c) { textColor_ = c; }
+  void setTextColor(uint16_t c, uint16_t /*bg*/) { textColor_ = c; }
+  void setTextWrap(bool w) { wrap_ = w; }
+
+  void getTextBounds(const char* s, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+    const size_t n = s ? strlen(s) : 0;
+    *x1 = x;
+    *y1 = y;
+    *w = static_cast<uint16_t>(n * 6U * textSize_);
+    *h = static_cast<uint16_t>(n > 0 ? 8U * textSize_ : 0U);
+  }
+  void getTextBounds(const String& s, int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+    getTextBounds(s.c_str(), x, y, x1, y1, w, h);
+  }
+
+  size_t write(uint8_t c) override {
+    if (c == '\n') {
+      cursorX_ = 0;
+      cursorY_ = static_cast<int16_t>(cursorY_ + 8 * textSize_);
+      return 1;
+    }
+    if (c == '\r') {
+      return 1;
+    }
+    if (c != ' ') {
+      fillRect(cursorX_, static_cast<int16_t>(cursorY_ + textSize_), static_cast<int16_t>(5 * textSize_),
+               static_cast<int16_t>(6 * textSize_), textColor_);
+    }
+    cursorX_ = static_cast<int16_t>(cursorX_ + 6 * textSize_);
+    return 1;
+  }
+  using Print::write;
+
+  int16_t width() const { return width_; }
+  int16_t height() const { return height_; }
+
+ protected:
+  int16_t width_;
+  int16_t height_;
+  int16_t cursorX_ = 0;
+  int16_t cursorY_ = 0;
+  uint8_t textSize_ = 1;
+  uint16_t textColor_ = 1;
+  bool wrap_ = true;
+};
+
+#endif
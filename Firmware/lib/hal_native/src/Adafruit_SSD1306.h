@@ -0,0 +1,87 @@
+// Host build: 1 bpp SSD1306 framebuffer; display() pushes it over the simulated I2C bus.
+#ifndef HAL_NATIVE_ADAFRUIT_SSD1306_H
+#define HAL_NATIVE_ADAFRUIT_SSD1306_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_EXTERNALVCC 0x01
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+#define SSD1306_SETCONTRAST 0x81
+
+class Adafruit_SSD1306 : public Adafruit_GFX {
+ public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rstPin = -1, uint32_t clkDuring = 400000UL,
+                   uint32_t clkAfter = 100000UL)
+      : Adafruit_GFX(w, h), wire_(twi) {
+    (void)rstPin;
+    (void)clkDuring;
+    (void)clkAfter;
+  }
+  ~Adafruit_SSD1306() override { delete[] buffer_; }
+
+  bool begin(uint8_t vcs = SSD1306_SWITCHCAPVCC, uint8_t addr = 0, bool reset = true, bool periphBegin = true) {
+    (void)vcs;
+    (void)reset;
+    (void)periphBegin;
+    addr_ = addr;
+    if (buffer_ == nullptr) {
+      buffer_ = new uint8_t[bufferSize()];
+    }
+    clearDisplay();
+    wire_->beginTransmission(addr_);
+    wire_->write(0x00);
+    return wire_->endTransmission() == 0;
+  }
+  void clearDisplay() {
+    if (buffer_) {
+      memset(buffer_, 0, bufferSize());
+    }
+  }
+  void display() {
+    for (size_t off = 0; off < bufferSize(); off += 32) {
+      wire_->beginTransmission(addr_);
+      wire_->write(0x40);
+      wire_->write(buffer_ + off, 32);
+      wire_->endTransmission();
+    }
+  }
+  void ssd1306_command(uint8_t c) {
+    wire_->beginTransmission(addr_);
+    wire_->write(0x00);
+    wire_->write(c);
+    wire_->endTransmission();
+  }
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (!buffer_ || x < 0 || y < 0 || x >= width_ || y >= height_) {
+      return;
+    }
+    uint8_t& byte = buffer_[x + (y / 8) * width_];
+    const uint8_t bit = static_cast<uint8_t>(1U << (y & 7));
+    if (color == SSD1306_WHITE) {
+      byte |= bit;
+    } else if (color == SSD1306_INVERSE) {
+      byte ^= bit;
+    } else {
+      byte &= static_cast<uint8_t>(~bit);
+    }
+  }
+  uint8_t* getBuffer() { return buffer_; }
+
+ private:
+  size_t bufferSize() const { return static_cast<size_t>(width_) * ((height_ + 7) / 8); }
+
+  TwoWire* wire_;
+  uint8_t* buffer_ = nullptr;
+  uint8_t addr_ = 0x3C;
+};
+
+#endif
@@ -0,0 +1,85 @@
+// Host build: 4 bpp SSD1327 framebuffer; display() pushes it over the simulated I2C bus.
+#ifndef HAL_NATIVE_ADAFRUIT_SSD1327_H
+#define HAL_NATIVE_ADAFRUIT_SSD1327_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1327_BLACK 0x0
+#define SSD1327_WHITE 0xF
+#define SSD1327_I2C_ADDRESS 0x3D
+#define SSD1327_DISPLAYOFF 0xAE
+#define SSD1327_DISPLAYON 0xAF
+#define SSD1327_SETCONTRAST 0x81
+
+class Adafruit_SSD1327 : public Adafruit_GFX {
+ public:
+  Adafruit_SSD1327(uint16_t w, uint16_t h, TwoWire* twi = &Wire, int8_t rstPin = -1, uint32_t preclk = 400000,
+                   uint32_t postclk = 100000)
+      : Adafruit_GFX(static_cast<int16_t>(w), static_cast<int16_t>(h)), wire_(twi) {
+    (void)rstPin;
+    (void)preclk;
+    (void)postclk;
+  }
+  ~Adafruit_SSD1327() override { delete[] buffer_; }
+
+  bool begin(uint8_t i2caddr = SSD1327_I2C_ADDRESS, bool reset = true) {
+    (void)reset;
+    addr_ = i2caddr;
+    if (buffer_ == nullptr) {
+      buffer_ = new uint8_t[bufferSize()];
+    }
+    clearDisplay();
+    wire_->beginTransmission(addr_);
+    wire_->write(0x00);
+    return wire_->endTransmission() == 0;
+  }
+  void clearDisplay() {
+    if (buffer_) {
+      memset(buffer_, 0, bufferSize());
+    }
+  }
+  void display() {
+    for (size_t off = 0; off < bufferSize(); off += 32) {
+      wire_->beginTransmission(addr_);
+      wire_->write(0x40);
+      wire_->write(buffer_ + off, 32);
+      wire_->endTransmission();
+    }
+  }
+  void oled_command(uint8_t c) {
+    wire_->beginTransmission(addr_);
+    wire_->write(0x00);
+    wire_->write(c);
+    wire_->endTransmission();
+  }
+  void setContrast(uint8_t level) {
+    oled_command(SSD1327_SETCONTRAST);
+    oled_command(level);
+  }
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (!buffer_ || x < 0 || y < 0 || x >= width_ || y >= height_) {
+      return;
+    }
+    uint8_t& byte = buffer_[(x + y * width_) / 2];
+    const uint8_t c = static_cast<uint8_t>(color & 0x0F);
+    if (x & 1) {
+      byte = static_cast<uint8_t>((byte & 0xF0) | c);
+    } else {
+      byte = static_cast<uint8_t>((byte & 0x0F) | (c << 4));
+    }
+  }
+  uint8_t* getBuffer() { return buffer_; }
+
+ private:
+  size_t bufferSize() const { return static_cast<size_t>(width_) * height_ / 2; }
+
+  TwoWire* wire_;
+  uint8_t* buffer_ = nullptr;
+  uint8_t addr_ = SSD1327_I2C_ADDRESS;
+};
+
+#endif
@@ -0,0 +1,102 @@
+// Host build: Arduino-ESP32 core subset used by the firmware, backed by native_hal.cpp.
+#ifndef HAL_NATIVE_ARDUINO_H
+#define HAL_NATIVE_ARDUINO_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "ESP.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "HardwareSerial.h"
+#include "Print.h"
+#include "WString.h"
+
+#define IRAM_ATTR
+#define PROGMEM
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t*>(addr))
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+#define OPEN_DRAIN 0x10
+#define OUTPUT_OPEN_DRAIN 0x13
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define digitalPinToInterrupt(p) (p)
+
+using std::max;
+using std::min;
+
+template <typename T, typename L, typename H>
+constexpr T constrain(T amt, L low, H high) {
+  return amt < low ? static_cast<T>(low) : (amt > high ? static_cast<T>(high) : amt);
+}
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+void analogSetAttenuation(int attenuation);
+
+// Continuous (DMA) ADC, Arduino-ESP32 3.x API: one averaged result per pin and frame.
+typedef struct {
+  uint8_t pin;
+  uint8_t channel;
+  int avg_read_raw;
+  int avg_read_mvolts;
+} adc_continuous_data_t;
+
+bool analogContinuous(const uint8_t pins[], size_t pins_count, uint32_t conversions_per_pin,
+                      uint32_t sampling_freq_hz, void (*userFunc)(void));
+bool analogContinuousRead(adc_continuous_data_t** buffer, uint32_t timeout_ms);
+bool analogContinuousStart();
+bool analogContinuousStop();
+bool analogContinuousDeinit();
+
+bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t resolution);
+bool ledcWrite(uint8_t pin, uint32_t duty);
+bool ledcDetach(uint8_t pin);
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+void noInterrupts();
+void interrupts();
+
+float temperatureRead();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+void setup();
+void loop();
+
+#endif
@@ -0,0 +1,54 @@
+// Host build: OTA never starts a transfer; callbacks are stored so a test can drive them.
+#ifndef HAL_NATIVE_ARDUINOOTA_H
+#define HAL_NATIVE_ARDUINOOTA_H
+
+#include <functional>
+
+typedef enum {
+  OTA_AUTH_ERROR,
+  OTA_BEGIN_ERROR,
+  OTA_CONNECT_ERROR,
+  OTA_RECEIVE_ERROR,
+  OTA_END_ERROR,
+} ota_error_t;
+
+class ArduinoOTAClass {
+ public:
+  using THandlerFunction = std::function<void()>;
+  using THandlerFunction_Progress = std::function<void(unsigned int, unsigned int)>;
+  using THandlerFunction_Error = std::function<void(ota_error_t)>;
+
+  ArduinoOTAClass& setHostname(const char* /*hostname*/) { return *this; }
+  ArduinoOTAClass& setPassword(const char* /*password*/) { return *this; }
+  ArduinoOTAClass& setRebootOnSuccess(bool /*reboot*/) { return *this; }
+  ArduinoOTAClass& onStart(THandlerFunction fn) {
+    onStart_ = fn;
+    return *this;
+  }
+  ArduinoOTAClass& onEnd(THandlerFunction fn) {
+    onEnd_ = fn;
+    return *this;
+  }
+  ArduinoOTAClass& onProgress(THandlerFunction_Progress fn) {
+    onProgress_ = fn;
+    return *this;
+  }
+  ArduinoOTAClass& onError(THandlerFunction_Error fn) {
+    onError_ = fn;
+    return *this;
+  }
+  void begin() { begun_ = true; }
+  void handle() {}
+  bool hostBegun() const { return begun_; }
+
+ private:
+  THandlerFunction onStart_;
+  THandlerFunction onEnd_;
+  THandlerFunction_Progress onProgress_;
+  THandlerFunction_Error onError_;
+  bool begun_ = false;
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif
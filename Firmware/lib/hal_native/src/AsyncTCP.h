@@ -0,0 +1,6 @@
+#ifndef HAL_NATIVE_ASYNCTCP_H
+#define HAL_NATIVE_ASYNCTCP_H
+
+// Host build: the async TCP layer is folded into the ESPAsyncWebServer shim.
+
+#endif
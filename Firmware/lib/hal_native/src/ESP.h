@@ -0,0 +1,23 @@
+#ifndef HAL_NATIVE_ESP_H
+#define HAL_NATIVE_ESP_H
+
+#include <stdint.h>
+
+#include "Arduino.h"
+
+class EspClass {
+ public:
+  /** Modelled on the S3's internal heap minus what the firmware currently holds via operator new. */
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getHeapSize();
+  /** 240 MHz cycle count derived from the virtual clock. */
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz() { return 240; }
+  /** Records the request; the host runner stops instead of rebooting. */
+  void restart();
+};
+
+extern EspClass ESP;
+
+#endif
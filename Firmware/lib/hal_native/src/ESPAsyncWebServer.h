@@ -0,0 +1,250 @@
+// Host build: ESPAsyncWebServer subset. Requests are issued synchronously from the host with
+// hostRequest(); handlers run exactly as registered and the response is captured. AsyncWebSocket
+// clients are scripted from the host: events fire synchronously, outbound messages wait in a
+// per-client queue that drains in virtual time (or not at all while the client is stalled).
+#ifndef HAL_NATIVE_ESPASYNCWEBSERVER_H
+#define HAL_NATIVE_ESPASYNCWEBSERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FS.h"
+#include "IPAddress.h"
+#include "WString.h"
+
+typedef enum {
+  HTTP_GET = 0b00000001,
+  HTTP_POST = 0b00000010,
+  HTTP_ANY = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebServerResponse {
+ public:
+  AsyncWebServerResponse(int code, const String& contentType, std::string body)
+      : code_(code), contentType_(contentType), body_(std::move(body)) {}
+  void addHeader(const char* name, const char* value) { headers_.emplace_back(name, value); }
+  void addHeader(const String& name, const String& value) { headers_.emplace_back(name.c_str(), value.c_str()); }
+  void setCode(int code) { code_ = code; }
+
+  int code() const { return code_; }
+  const String& contentType() const { return contentType_; }
+  const std::string& body() const { return body_; }
+  const std::vector<std::pair<std::string, std::string>>& headers() const { return headers_; }
+
+ private:
+  int code_;
+  String contentType_;
+  std::string body_;
+  std::vector<std::pair<std::string, std::string>> headers_;
+};
+
+class AsyncWebHeader {
+ public:
+  AsyncWebHeader(const std::string& name, const std::string& value) : name_(name.c_str()), value_(value.c_str()) {}
+  const String& name() const { return name_; }
+  const String& value() const { return value_; }
+
+ private:
+  String name_;
+  String value_;
+};
+
+class AsyncWebServerRequest {
+ public:
+  AsyncWebServerRequest(const std::string& url, std::vector<std::pair<std::string, std::string>> headers)
+      : url_(url.c_str()), headers_(std::move(headers)) {}
+  ~AsyncWebServerRequest() { delete response_; }
+
+  const String& url() const { return url_; }
+  String host() const { return String("192.168.4.2"); }
+  WebRequestMethodComposite method() const { return HTTP_GET; }
+
+  bool hasHeader(const char* name) const;
+  const AsyncWebHeader* getHeader(const char* name) const;
+
+  AsyncWebServerResponse* beginResponse(FS& fs, const String& path, const String& contentType = String(),
+                                        bool download = false);
+  AsyncWebServerResponse* beginResponse(int code, const String& contentType = String(),
+                                        const String& content = String());
+  AsyncWebServerResponse* beginResponse(int code, const String& contentType, const uint8_t* content, size_t len);
+  void send(AsyncWebServerResponse* response);
+  void send(int code, const String& contentType = String(), const String& content = String());
+  void send(FS& fs, const String& path, const String& contentType = String(), bool download = false);
+
+  AsyncWebServerResponse* hostResponse() const { return response_; }
+
+ private:
+  String url_;
+  std::vector<std::pair<std::string, std::string>> headers_;
+  mutable std::vector<AsyncWebHeader> headerViews_;
+  AsyncWebServerResponse* response_ = nullptr;
+};
+
+using ArRequestHandlerFunction = std::function<void(AsyncWebServerRequest* request)>;
+
+class AsyncWebServer;
+
+class AsyncWebHandler {
+ public:
+  virtual ~AsyncWebHandler() = default;
+
+ protected:
+  friend class AsyncWebServer;
+  AsyncWebServer* server_ = nullptr;
+};
+
+class AsyncWebServer {
+ public:
+  explicit AsyncWebServer(uint16_t port) : port_(port) {}
+
+  void begin() { running_ = true; }
+  void end() { running_ = false; }
+  void on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest);
+  void onNotFound(ArRequestHandlerFunction fn) { notFound_ = fn; }
+  AsyncWebHandler& addHandler(AsyncWebHandler* handler) {
+    handler->server_ = this;
+    return *handler;
+  }
+
+  // --- Host-side client ----------------------------------------------------------------------
+  struct HostResponse {
+    int code;
+    std::string contentType;
+    std::vector<std::pair<std::string, std::string>> headers;
+    size_t bodyLength;
+  };
+  /** Issues a GET; code 0 when the server is not running. */
+  HostResponse hostRequest(const char* url, std::vector<std::pair<std::string, std::string>> headers = {});
+  bool hostRunning() const { return running_; }
+
+ private:
+  struct Route {
+    std::string uri;
+    WebRequestMethodComposite method;
+    ArRequestHandlerFunction fn;
+  };
+
+  uint16_t port_;
+  bool running_ = false;
+  std::vector<Route> routes_;
+  ArRequestHandlerFunction notFound_;
+};
+
+// --- AsyncWebSocket -------------------------------------------------------------------------
+
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PING, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+typedef enum { WS_CONTINUATION, WS_TEXT, WS_BINARY, WS_DISCONNECT = 0x08, WS_PING, WS_PONG } AwsFrameType;
+typedef enum { WS_DISCONNECTED, WS_CONNECTED, WS_DISCONNECTING } AwsClientStatus;
+
+typedef struct {
+  uint8_t message_opcode;
+  uint32_t num;
+  uint8_t final;
+  uint8_t masked;
+  uint8_t opcode;
+  uint64_t len;
+  uint8_t mask[4];
+  uint64_t index;
+} AwsFrameInfo;
+
+class AsyncWebSocket;
+
+class AsyncWebSocketClient {
+ public:
+  AsyncWebSocketClient(AsyncWebSocket* server, uint32_t id) : server_(server), id_(id) {}
+
+  uint32_t id() const { return id_; }
+  AwsClientStatus status() const { return status_; }
+  IPAddress remoteIP() const { return IPAddress(192, 168, 4, static_cast<uint8_t>(1 + id_)); }
+  size_t queueLen() const { return queue_.size(); }
+  bool queueIsFull() const;
+  bool canSend() const { return !queueIsFull(); }
+  /** Close frame goes out after the current event handler returns; WS_EVT_DISCONNECT follows. */
+  void close() {
+    if (status_ == WS_CONNECTED) {
+      status_ = WS_DISCONNECTING;
+    }
+  }
+
+  bool text(const char* message, size_t len) { return enqueue(false, reinterpret_cast<const uint8_t*>(message), len); }
+  bool text(const char* message);
+  bool text(const String& message) { return text(message.c_str(), message.length()); }
+  bool binary(const uint8_t* message, size_t len) { return enqueue(true, message, len); }
+
+ private:
+  friend class AsyncWebSocket;
+  struct Frame {
+    bool binary;
+    std::string data;
+  };
+
+  bool enqueue(bool binary, const uint8_t* message, size_t len);
+
+  AsyncWebSocket* server_;
+  uint32_t id_;
+  AwsClientStatus status_ = WS_CONNECTED;
+  bool stalled_ = false;
+  uint64_t frontReadyUs_ = 0;
+  std::deque<Frame> queue_;
+};
+
+class AsyncWebSocket : public AsyncWebHandler {
+ public:
+  using AwsEventHandler = std::function<void(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type,
+                                             void* arg, uint8_t* data, size_t len)>;
+
+  explicit AsyncWebSocket(const char* url);
+  ~AsyncWebSocket() override;
+
+  void onEvent(AwsEventHandler handler) { event_ = handler; }
+  /** Connected client with this id, or nullptr. */
+  AsyncWebSocketClient* client(uint32_t id);
+  size_t count() const;
+  void cleanupClients(uint16_t maxClients = 8);
+
+  // --- Host-side clients -------------------------------------------------------------------
+  struct HostFrame {
+    bool binary;
+    std::string data;
+  };
+  /** Opens a client and fires WS_EVT_CONNECT; returns its id (> 0) or -1 when the server is down. */
+  int hostConnect();
+  void hostDisconnect(uint32_t id);
+  void hostSendText(uint32_t id, const std::string& text);
+  /** Messages the client has received (delivered from its queue). */
+  std::vector<HostFrame>& hostReceived(uint32_t id);
+  /** A stalled client stops reading: its queue keeps growing until the firmware backs off. */
+  void hostSetStalled(uint32_t id, bool stalled);
+  uint64_t hostBytesSent() const { return bytesSent_; }
+  bool hostRunning() const;
+  /** Drains client queues up to nowUs (called from the virtual clock). */
+  static void hostAdvance(uint64_t nowUs);
+
+ private:
+  friend class AsyncWebSocketClient;
+  struct HostClient {
+    std::unique_ptr<AsyncWebSocketClient> client;
+    std::vector<HostFrame> received;
+  };
+
+  HostClient* find(uint32_t id);
+  void dispatch(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+  void finishCloses();
+  void drain(uint64_t nowUs);
+
+  std::string url_;
+  AwsEventHandler event_;
+  std::vector<HostClient> clients_;
+  uint32_t nextId_ = 1;
+  uint64_t bytesSent_ = 0;
+};
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HAL_NATIVE_ESPMDNS_H
+#define HAL_NATIVE_ESPMDNS_H
+
+class MDNSResponder {
+ public:
+  bool begin(const char* /*hostname*/) { return true; }
+  void end() {}
+};
+
+extern MDNSResponder MDNS;
+
+#endif
@@ -0,0 +1,81 @@
+// Host build: filesystem view of a host directory (the LittleFS image source, ./data by default).
+// Writes land in an in-memory overlay on top of it, so runs never modify the directory.
+#ifndef HAL_NATIVE_FS_H
+#define HAL_NATIVE_FS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "WString.h"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FileState {
+  std::string path;
+  std::string data;
+  size_t pos = 0;
+  bool writable = false;
+  bool dirty = false;
+};
+
+/** Handle on a whole-file copy; copies share it, and writes reach the overlay on flush() / close(). */
+class File {
+ public:
+  File() = default;
+  explicit File(std::shared_ptr<FileState> state) : state_(std::move(state)) {}
+
+  explicit operator bool() const { return state_ != nullptr; }
+  size_t size() const { return state_ ? state_->data.size() : 0; }
+  size_t position() const { return state_ ? state_->pos : 0; }
+  int available() const { return state_ ? static_cast<int>(state_->data.size() - state_->pos) : 0; }
+  size_t read(uint8_t* buf, size_t len);
+  size_t write(const uint8_t* buf, size_t len);
+  size_t write(uint8_t b) { return write(&b, 1); }
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  void flush();
+  void close();
+
+ private:
+  std::shared_ptr<FileState> state_;
+};
+
+class FS {
+ public:
+  virtual ~FS() = default;
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  /** "r", "r+" (existing file), "w" (create / truncate) and "a" (create / append). */
+  File open(const char* path, const char* mode = "r");
+  File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+  bool remove(const char* path);
+  /** Whole-file read for host consumers (web server stub); false when missing. */
+  bool readAll(const char* path, std::string& out);
+  /** Host path of a firmware path, e.g. "/index.html" -> "<root>/index.html". */
+  std::string hostPath(const char* path) const;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekSet;
+
+/** Host-side LittleFS counters: write() calls and the bytes they carried, remove() calls. */
+struct NativeFsStats {
+  uint64_t writeOps;
+  uint64_t bytesWritten;
+  uint64_t removes;
+};
+NativeFsStats nativeFsStats();
+/** Drops every overlay write and remove, and zeroes the counters. */
+void nativeFsReset();
+
+#endif
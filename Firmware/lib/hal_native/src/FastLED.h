@@ -0,0 +1,63 @@
+// Host build: FastLED subset. show() charges the WS2812 frame time to the virtual clock.
+#ifndef HAL_NATIVE_FASTLED_H
+#define HAL_NATIVE_FASTLED_H
+
+#include <stdint.h>
+
+enum EOrder { RGB = 0012, GRB = 0102 };
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER>
+class WS2812B {};
+template <uint8_t DATA_PIN, EOrder RGB_ORDER>
+class WS2812 {};
+
+struct CRGB {
+  enum HTMLColorCode : uint32_t {
+    Black = 0x000000,
+    White = 0xFFFFFF,
+    Red = 0xFF0000,
+    Green = 0x008000,
+    Blue = 0x0000FF,
+  };
+
+  uint8_t r = 0;
+  uint8_t g = 0;
+  uint8_t b = 0;
+
+  constexpr CRGB() = default;
+  constexpr CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  constexpr CRGB(HTMLColorCode code)
+      : r(static_cast<uint8_t>((code >> 16) & 0xFF)),
+        g(static_cast<uint8_t>((code >> 8) & 0xFF)),
+        b(static_cast<uint8_t>(code & 0xFF)) {}
+
+  bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+  bool operator!=(const CRGB& o) const { return !(*this == o); }
+};
+
+class CFastLED {
+ public:
+  template <template <uint8_t, EOrder> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+  CFastLED& addLeds(CRGB* data, int count) {
+    leds_ = data;
+    count_ = count;
+    return *this;
+  }
+  void setBrightness(uint8_t scale) { brightness_ = scale; }
+  uint8_t getBrightness() const { return brightness_; }
+  void clear(bool writeData = false);
+  void show();
+
+  uint64_t hostShowCount() const { return showCount_; }
+  const CRGB* hostLeds() const { return leds_; }
+
+ private:
+  CRGB* leds_ = nullptr;
+  int count_ = 0;
+  uint8_t brightness_ = 255;
+  uint64_t showCount_ = 0;
+};
+
+extern CFastLED FastLED;
+
+#endif
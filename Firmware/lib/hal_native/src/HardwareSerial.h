@@ -0,0 +1,53 @@
+// Host build: USB CDC Serial (optionally echoed to stdout) and UART Serial2 (captured, byte-time charged).
+#ifndef HAL_NATIVE_HARDWARESERIAL_H
+#define HAL_NATIVE_HARDWARESERIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "Print.h"
+
+#define SERIAL_8N1 0x800001c
+#define SERIAL_8E1 0x800001e
+
+class HardwareSerial : public Print {
+ public:
+  explicit HardwareSerial(int uartNum) : uartNum_(uartNum) {}
+
+  void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+  void end();
+  size_t setTxBufferSize(size_t size);
+  size_t setRxBufferSize(size_t size);
+
+  int available();
+  int read();
+  void flush();
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  operator bool() const { return true; }
+
+  /** Host-side taps: bytes the firmware wrote, and bytes queued for it to read. */
+  const std::string& hostTxLog() const { return tx_; }
+  void hostClearTxLog() { tx_.clear(); }
+  void hostInject(const uint8_t* data, size_t len) { rx_.append(reinterpret_cast<const char*>(data), len); }
+  uint64_t hostTxBytesTotal() const { return txTotal_; }
+
+ private:
+  int uartNum_;
+  unsigned long baud_ = 115200;
+  bool started_ = false;
+  std::string tx_;
+  std::string rx_;
+  uint64_t txTotal_ = 0;
+  uint64_t pendingTxUs_ = 0;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial2;
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef HAL_NATIVE_IPADDRESS_H
+#define HAL_NATIVE_IPADDRESS_H
+
+#include <stdint.h>
+
+#include "Print.h"
+#include "Printable.h"
+#include "WString.h"
+
+class IPAddress : public Printable {
+ public:
+  IPAddress() = default;
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : octets_{a, b, c, d} {}
+  /** Network byte order as on the ESP32 (first octet in the low byte). */
+  explicit IPAddress(uint32_t address)
+      : octets_{static_cast<uint8_t>(address), static_cast<uint8_t>(address >> 8), static_cast<uint8_t>(address >> 16),
+                static_cast<uint8_t>(address >> 24)} {}
+
+  operator uint32_t() const {
+    return static_cast<uint32_t>(octets_[0]) | (static_cast<uint32_t>(octets_[1]) << 8) |
+           (static_cast<uint32_t>(octets_[2]) << 16) | (static_cast<uint32_t>(octets_[3]) << 24);
+  }
+
+  uint8_t operator[](int i) const { return octets_[i & 3]; }
+  bool operator==(const IPAddress& o) const {
+    return octets_[0] == o.octets_[0] && octets_[1] == o.octets_[1] && octets_[2] == o.octets_[2] &&
+           octets_[3] == o.octets_[3];
+  }
+  bool operator!=(const IPAddress& o) const { return !(*this == o); }
+
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", octets_[0], octets_[1], octets_[2], octets_[3]);
+    return String(buf);
+  }
+  size_t printTo(Print& p) const override { return p.print(toString()); }
+
+ private:
+  uint8_t octets_[4] = {0, 0, 0, 0};
+};
+
+#endif
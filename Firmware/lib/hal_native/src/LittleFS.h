@@ -0,0 +1,19 @@
+#ifndef HAL_NATIVE_LITTLEFS_H
+#define HAL_NATIVE_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+ public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+             const char* partitionLabel = "spiffs");
+  void end() {}
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif
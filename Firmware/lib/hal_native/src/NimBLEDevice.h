@@ -0,0 +1,147 @@
+// Host build: NimBLE-Arduino 2.x peripheral subset with a scripted central.
+// Notifications consume controller buffers that drain once per connection interval, so a
+// sender that outruns the link sees notify() fail exactly as it does on the S3.
+#ifndef HAL_NATIVE_NIMBLEDEVICE_H
+#define HAL_NATIVE_NIMBLEDEVICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#define ESP_PWR_LVL_P9 7
+
+namespace NIMBLE_PROPERTY {
+constexpr uint16_t READ = 0x0002;
+constexpr uint16_t WRITE_NR = 0x0004;
+constexpr uint16_t WRITE = 0x0008;
+constexpr uint16_t NOTIFY = 0x0010;
+constexpr uint16_t INDICATE = 0x0020;
+}  // namespace NIMBLE_PROPERTY
+
+class NimBLEServer;
+class NimBLECharacteristic;
+
+class NimBLEConnInfo {
+ public:
+  explicit NimBLEConnInfo(uint16_t mtu = 23, uint16_t handle = 0) : mtu_(mtu), handle_(handle) {}
+  uint16_t getMTU() const { return mtu_; }
+  uint16_t getConnHandle() const { return handle_; }
+
+ private:
+  uint16_t mtu_;
+  uint16_t handle_;
+};
+
+class NimBLEServerCallbacks {
+ public:
+  virtual ~NimBLEServerCallbacks() = default;
+  virtual void onConnect(NimBLEServer* /*server*/, NimBLEConnInfo& /*connInfo*/) {}
+  virtual void onDisconnect(NimBLEServer* /*server*/, NimBLEConnInfo& /*connInfo*/, int /*reason*/) {}
+  virtual void onMTUChange(uint16_t /*mtu*/, NimBLEConnInfo& /*connInfo*/) {}
+};
+
+class NimBLECharacteristicCallbacks {
+ public:
+  virtual ~NimBLECharacteristicCallbacks() = default;
+  virtual void onWrite(NimBLECharacteristic* /*characteristic*/, NimBLEConnInfo& /*connInfo*/) {}
+  /** 0 once a queued notification has gone out over the air, non-zero if it was dropped. */
+  virtual void onStatus(NimBLECharacteristic* /*characteristic*/, int /*code*/) {}
+  virtual void onSubscribe(NimBLECharacteristic* /*characteristic*/, NimBLEConnInfo& /*connInfo*/,
+                           uint16_t /*subValue*/) {}
+};
+
+class NimBLECharacteristic {
+ public:
+  NimBLECharacteristic(const char* uuid, uint16_t properties) : uuid_(uuid), properties_(properties) {}
+
+  void setCallbacks(NimBLECharacteristicCallbacks* callbacks) { callbacks_ = callbacks; }
+  NimBLECharacteristicCallbacks* getCallbacks() const { return callbacks_; }
+  void setValue(const uint8_t* data, size_t len) { value_.assign(reinterpret_cast<const char*>(data), len); }
+  void setValue(const std::string& value) { value_ = value; }
+  std::string getValue() const { return value_; }
+  const std::string& getUUIDString() const { return uuid_; }
+  /** Queues the current value; false when the controller has no free buffer. */
+  bool notify();
+
+ private:
+  std::string uuid_;
+  uint16_t properties_;
+  std::string value_;
+  NimBLECharacteristicCallbacks* callbacks_ = nullptr;
+};
+
+class NimBLEService {
+ public:
+  explicit NimBLEService(const char* uuid) : uuid_(uuid) {}
+  ~NimBLEService();
+  NimBLECharacteristic* createCharacteristic(const char* uuid, uint16_t properties);
+  NimBLECharacteristic* getCharacteristic(const char* uuid);
+  bool start() { return true; }
+
+ private:
+  std::string uuid_;
+  std::vector<NimBLECharacteristic*> characteristics_;
+};
+
+class NimBLEAdvertising {
+ public:
+  bool addServiceUUID(const char* /*uuid*/) { return true; }
+  bool setName(const char* /*name*/) { return true; }
+  bool start() {
+    advertising_ = true;
+    return true;
+  }
+  bool stop() {
+    advertising_ = false;
+    return true;
+  }
+  bool isAdvertising() const { return advertising_; }
+
+ private:
+  bool advertising_ = false;
+};
+
+class NimBLEServer {
+ public:
+  ~NimBLEServer();
+  void setCallbacks(NimBLEServerCallbacks* callbacks) { callbacks_ = callbacks; }
+  NimBLEService* createService(const char* uuid);
+  bool startAdvertising();
+  size_t getConnectedCount() const;
+
+  NimBLEServerCallbacks* callbacks() const { return callbacks_; }
+  const std::vector<NimBLEService*>& services() const { return services_; }
+
+ private:
+  NimBLEServerCallbacks* callbacks_ = nullptr;
+  std::vector<NimBLEService*> services_;
+};
+
+class NimBLEDevice {
+ public:
+  static bool init(const std::string& deviceName);
+  static bool setPower(int /*dbm*/) { return true; }
+  static bool setMTU(uint16_t mtu);
+  static NimBLEServer* createServer();
+  static NimBLEServer* getServer();
+  static NimBLEAdvertising* getAdvertising();
+
+  // --- Host-side central -------------------------------------------------------------------
+  /** Connects a central; the MTU exchange completes on the next tick when mtu > 23. */
+  static void hostConnect(uint16_t mtu = 247);
+  static void hostDisconnect(int reason = 0x13);
+  static bool hostConnected();
+  /** Writes to the characteristic with the given UUID (e.g. the NUS RX line). */
+  static void hostWrite(const char* uuid, const std::string& data);
+  /** Notifications delivered to the central so far (each entry is one ATT packet). */
+  static std::vector<std::string>& hostNotifications();
+  /** Controller model: free notify buffers and how many drain per connection event. */
+  static void hostSetLinkModel(uint8_t txBuffers, uint8_t packetsPerEvent, uint32_t connIntervalUs);
+  static uint64_t hostNotifyRejected();
+  /** Advances the link model; called by the HAL clock. */
+  static void hostAdvance(uint64_t nowUs);
+};
+
+#endif
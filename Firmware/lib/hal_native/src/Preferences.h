@@ -0,0 +1,58 @@
+// Host build: in-memory NVS. Every put* is counted so wear can be measured off-target.
+#ifndef HAL_NATIVE_PREFERENCES_H
+#define HAL_NATIVE_PREFERENCES_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "WString.h"
+
+class Preferences {
+ public:
+  bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+  void end();
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putUChar(const char* key, uint8_t value);
+  size_t putUShort(const char* key, uint16_t value);
+  size_t putUInt(const char* key, uint32_t value);
+  size_t putInt(const char* key, int32_t value);
+  size_t putFloat(const char* key, float value);
+  size_t putBool(const char* key, bool value);
+  size_t putString(const char* key, const char* value);
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+  size_t putBytes(const char* key, const void* value, size_t len);
+
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+  uint16_t getUShort(const char* key, uint16_t defaultValue = 0);
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+  int32_t getInt(const char* key, int32_t defaultValue = 0);
+  float getFloat(const char* key, float defaultValue = NAN);
+  bool getBool(const char* key, bool defaultValue = false);
+  String getString(const char* key, const String& defaultValue = String());
+  size_t getString(const char* key, char* value, size_t maxLen);
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+ private:
+  size_t put(const char* key, const void* data, size_t len);
+  bool get(const char* key, void* out, size_t len);
+
+  char namespace_[16] = {0};
+  bool open_ = false;
+  bool readOnly_ = false;
+};
+
+/** Host-side NVS counters (all namespaces). A write of an unchanged value still counts, as on flash. */
+struct NativeNvsStats {
+  uint64_t writeOps;
+  uint64_t bytesWritten;
+  uint64_t commits;
+};
+NativeNvsStats nativeNvsStats();
+void nativeNvsReset();
+
+#endif
@@ -0,0 +1,79 @@
+// Host build: Arduino Print base with the subset of overloads the firmware uses.
+#ifndef HAL_NATIVE_PRINT_H
+#define HAL_NATIVE_PRINT_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Printable.h"
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+
+class Print {
+ public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      n += write(*buffer++);
+    }
+    return n;
+  }
+  size_t write(const char* s) { return s ? write(reinterpret_cast<const uint8_t*>(s), strlen(s)) : 0; }
+  size_t write(const char* s, size_t size) { return write(reinterpret_cast<const uint8_t*>(s), size); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    const int len = vsnprintf(small, sizeof(small), format, copy);
+    va_end(copy);
+    if (len < 0) {
+      va_end(args);
+      return 0;
+    }
+    size_t n;
+    if (static_cast<size_t>(len) < sizeof(small)) {
+      n = write(small, static_cast<size_t>(len));
+    } else {
+      char* buf = new char[static_cast<size_t>(len) + 1];
+      vsnprintf(buf, static_cast<size_t>(len) + 1, format, args);
+      n = write(buf, static_cast<size_t>(len));
+      delete[] buf;
+    }
+    va_end(args);
+    return n;
+  }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str(), s.length()); }
+  size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+  size_t print(int v, int base = DEC) { return print(static_cast<long>(v), base); }
+  size_t print(unsigned int v, int base = DEC) { return print(static_cast<unsigned long>(v), base); }
+  size_t print(long v, int base = DEC) { return base == HEX ? printf("%lx", v) : printf("%ld", v); }
+  size_t print(unsigned long v, int base = DEC) { return base == HEX ? printf("%lx", v) : printf("%lu", v); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  size_t print(const Printable& p) { return p.printTo(*this); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T& v) {
+    const size_t n = print(v);
+    return n + println();
+  }
+  template <typename T>
+  size_t println(const T& v, int fmt) {
+    const size_t n = print(v, fmt);
+    return n + println();
+  }
+};
+
+#endif
@@ -0,0 +1,129 @@
+// Host build: minimal Arduino String backed by std::string.
+#ifndef HAL_NATIVE_WSTRING_H
+#define HAL_NATIVE_WSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+class String {
+ public:
+  String() = default;
+  String(const char* s) : s_(s ? s : "") {}
+  String(const char* s, size_t len) : s_(s ? std::string(s, len) : std::string()) {}
+  String(const std::string& s) : s_(s) {}
+  explicit String(char c) : s_(1, c) {}
+  explicit String(int v) { fromFormat("%d", v); }
+  explicit String(unsigned int v) { fromFormat("%u", v); }
+  explicit String(long v) { fromFormat("%ld", v); }
+  explicit String(unsigned long v) { fromFormat("%lu", v); }
+  explicit String(float v, unsigned int decimals = 2) { fromFormat("%.*f", static_cast<int>(decimals), v); }
+  explicit String(double v, unsigned int decimals = 2) { fromFormat("%.*f", static_cast<int>(decimals), v); }
+
+  const char* c_str() const { return s_.c_str(); }
+  unsigned int length() const { return static_cast<unsigned int>(s_.size()); }
+  bool isEmpty() const { return s_.empty(); }
+  bool reserve(unsigned int size) {
+    s_.reserve(size);
+    return true;
+  }
+  void clear() { s_.clear(); }
+
+  bool concat(const char* s) {
+    if (s == nullptr) {
+      return false;
+    }
+    s_ += s;
+    return true;
+  }
+  bool concat(const char* s, unsigned int len) {
+    if (s == nullptr) {
+      return false;
+    }
+    s_.append(s, len);
+    return true;
+  }
+  bool concat(const String& s) {
+    s_ += s.s_;
+    return true;
+  }
+  bool concat(char c) {
+    s_ += c;
+    return true;
+  }
+
+  String& operator=(const char* s) {
+    s_ = s ? s : "";
+    return *this;
+  }
+  String& operator+=(const char* s) {
+    concat(s);
+    return *this;
+  }
+  String& operator+=(const String& s) {
+    s_ += s.s_;
+    return *this;
+  }
+  String& operator+=(char c) {
+    s_ += c;
+    return *this;
+  }
+
+  char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : '\0'; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+
+  bool equals(const char* s) const { return s != nullptr && s_ == s; }
+  bool startsWith(const char* p) const { return p != nullptr && s_.compare(0, strlen(p), p) == 0; }
+  bool endsWith(const char* p) const {
+    if (p == nullptr) {
+      return false;
+    }
+    const size_t n = strlen(p);
+    return s_.size() >= n && s_.compare(s_.size() - n, n, p) == 0;
+  }
+  bool endsWith(const String& p) const { return endsWith(p.c_str()); }
+  int indexOf(char c, unsigned int from = 0) const {
+    const size_t pos = s_.find(c, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+  }
+  String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from >= s_.size() || to <= from) {
+      return String();
+    }
+    return String(s_.substr(from, to - from));
+  }
+  long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(s_.c_str(), nullptr); }
+
+  friend bool operator==(const String& a, const String& b) { return a.s_ == b.s_; }
+  friend bool operator==(const String& a, const char* b) { return b != nullptr && a.s_ == b; }
+  friend bool operator!=(const String& a, const String& b) { return !(a == b); }
+  friend bool operator!=(const String& a, const char* b) { return !(a == b); }
+  friend bool operator<(const String& a, const String& b) { return a.s_ < b.s_; }
+  friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+  friend String operator+(const String& a, const char* b) { return String(a.s_ + (b ? b : "")); }
+  friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.s_); }
+
+  const std::string& str() const { return s_; }
+
+ private:
+  template <typename T>
+  void fromFormat(const char* fmt, T v) {
+    char buf[40];
+    snprintf(buf, sizeof(buf), fmt, v);
+    s_ = buf;
+  }
+  void fromFormat(const char* fmt, int decimals, double v) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), fmt, decimals, v);
+    s_ = buf;
+  }
+
+  std::string s_;
+};
+
+#endif
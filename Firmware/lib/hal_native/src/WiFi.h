@@ -0,0 +1,90 @@
+// Host build: WiFi station/AP model. STA association succeeds after a configurable delay, or never.
+#ifndef HAL_NATIVE_WIFI_H
+#define HAL_NATIVE_WIFI_H
+
+#include <stdint.h>
+
+#include "IPAddress.h"
+#include "WString.h"
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3,
+} wifi_mode_t;
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+// The subset of arduino_event_id_t the firmware listens for.
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_START,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_AP_START,
+  ARDUINO_EVENT_WIFI_AP_STOP,
+  ARDUINO_EVENT_MAX,
+} arduino_event_id_t;
+
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+typedef int wifi_event_id_t;
+
+class WiFiClass {
+ public:
+  bool mode(wifi_mode_t m);
+  wifi_mode_t getMode() const { return mode_; }
+  wl_status_t begin(const char* ssid, const char* password = nullptr);
+  bool disconnect(bool wifiOff = false);
+  wl_status_t status();
+  bool softAP(const char* ssid, const char* password = nullptr);
+  IPAddress localIP();
+  IPAddress softAPIP() const;
+  bool setHostname(const char* name);
+  const char* getHostname() const { return hostname_; }
+  int8_t RSSI() const { return status_ == WL_CONNECTED ? rssi_ : 0; }
+  String SSID() const { return status_ == WL_CONNECTED ? String(ssid_) : String(); }
+  /** Callbacks run on whichever context advances the clock past the event (the event task on hardware). */
+  wifi_event_id_t onEvent(WiFiEventCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+
+  /**
+   * Host-side: how the simulated access point behaves on begin(). connectAfterMs < 0 means the
+   * network never answers (the firmware falls back to its soft AP). Default: connects after 1500 ms.
+   */
+  void hostSetStaBehaviour(int32_t connectAfterMs, int8_t rssi = -55);
+  /** Host-side: completes a due association and fires its events; called as virtual time moves. */
+  void hostAdvance(uint64_t nowUs);
+
+ private:
+  static constexpr uint8_t kMaxEventCallbacks = 4;
+  struct EventCallback {
+    WiFiEventCb cb;
+    arduino_event_id_t event;
+  };
+
+  void completeAssociation(uint64_t nowUs);
+  void fireEvent(arduino_event_id_t event);
+
+  wifi_mode_t mode_ = WIFI_OFF;
+  wl_status_t status_ = WL_DISCONNECTED;
+  bool apUp_ = false;
+  uint64_t beginAtUs_ = 0;
+  bool beginPending_ = false;
+  int32_t connectAfterMs_ = 1500;
+  int8_t rssi_ = -55;
+  char ssid_[33] = {0};
+  char hostname_[33] = {0};
+  EventCallback callbacks_[kMaxEventCallbacks] = {};
+  uint8_t callbackCount_ = 0;
+};
+
+extern WiFiClass WiFi;
+
+#endif
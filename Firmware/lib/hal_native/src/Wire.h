@@ -0,0 +1,37 @@
+// Host build: I2C master. Devices present on the bus ACK; every byte charges 400 kHz wire time to the clock.
+#ifndef HAL_NATIVE_WIRE_H
+#define HAL_NATIVE_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class TwoWire {
+ public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  bool end();
+  void setClock(uint32_t frequency);
+  void setTimeOut(uint16_t timeoutMs) { timeoutMs_ = timeoutMs; }
+
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t data);
+  size_t write(const uint8_t* data, size_t len);
+  uint8_t endTransmission(bool sendStop = true);
+  size_t requestFrom(uint8_t address, size_t len, bool sendStop = true);
+  int available() { return 0; }
+  int read() { return -1; }
+
+  /** Host-side: mark a 7-bit address as populated (0x3C/0x3D are present by default). */
+  void hostSetDevicePresent(uint8_t address, bool present);
+  uint64_t hostBytesTransferred() const { return bytes_; }
+
+ private:
+  uint32_t frequency_ = 400000;
+  uint16_t timeoutMs_ = 50;
+  uint8_t address_ = 0;
+  size_t pending_ = 0;
+  uint64_t bytes_ = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
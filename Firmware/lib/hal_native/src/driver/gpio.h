@@ -0,0 +1,17 @@
+#ifndef HAL_NATIVE_DRIVER_GPIO_H
+#define HAL_NATIVE_DRIVER_GPIO_H
+
+#include "esp_sleep.h"
+
+typedef int gpio_num_t;
+
+typedef enum {
+  GPIO_INTR_DISABLE = 0,
+  GPIO_INTR_LOW_LEVEL = 4,
+  GPIO_INTR_HIGH_LEVEL = 5,
+} gpio_int_type_t;
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t type);
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio);
+
+#endif
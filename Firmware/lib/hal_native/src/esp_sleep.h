@@ -0,0 +1,26 @@
+// Host build: light sleep fast-forwards the virtual clock until a wake GPIO reads LOW.
+#ifndef HAL_NATIVE_ESP_SLEEP_H
+#define HAL_NATIVE_ESP_SLEEP_H
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+  ESP_SLEEP_WAKEUP_TIMER = 4,
+  ESP_SLEEP_WAKEUP_GPIO = 7,
+} esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_enable_gpio_wakeup();
+/** Returns once a wake pin is LOW, or after the host sleep cap (default 10 s) as a timer wakeup. */
+esp_err_t esp_light_sleep_start();
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
+
+/** Host-side: longest light sleep before the runner wakes the firmware anyway. */
+void nativeHalSetSleepCapMs(uint32_t ms);
+uint64_t nativeHalLightSleepCount();
+
+#endif
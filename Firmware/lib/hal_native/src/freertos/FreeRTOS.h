@@ -0,0 +1,25 @@
+// Host build: FreeRTOS base types (ESP-IDF flavour, 1 kHz tick). Implemented in native_rtos.cpp.
+#ifndef HAL_NATIVE_FREERTOS_FREERTOS_H
+#define HAL_NATIVE_FREERTOS_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffffUL
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define configMAX_PRIORITIES 25
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7fffffff
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+
+#endif
@@ -0,0 +1,18 @@
+// Host build: FreeRTOS queue API subset (copying queues; semaphores are zero-size queues).
+#ifndef HAL_NATIVE_FREERTOS_QUEUE_H
+#define HAL_NATIVE_FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+
+struct NativeRtosQueue;
+typedef NativeRtosQueue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait);
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+BaseType_t xQueueReset(QueueHandle_t queue);
+
+#endif
@@ -0,0 +1,15 @@
+// Host build: FreeRTOS semaphore API subset on top of the queue shim.
+#ifndef HAL_NATIVE_FREERTOS_SEMPHR_H
+#define HAL_NATIVE_FREERTOS_SEMPHR_H
+
+#include "queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+#endif
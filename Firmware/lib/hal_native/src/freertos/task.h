@@ -0,0 +1,34 @@
+// Host build: FreeRTOS task API subset. Tasks run on std::thread; see native_rtos.cpp for the
+// virtual-time scheduling model.
+#ifndef HAL_NATIVE_FREERTOS_TASK_H
+#define HAL_NATIVE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+struct NativeRtosTask;
+typedef NativeRtosTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn,
+                                   const char* name,
+                                   uint32_t stackDepth,
+                                   void* arg,
+                                   UBaseType_t priority,
+                                   TaskHandle_t* created,
+                                   BaseType_t coreId);
+BaseType_t xTaskCreate(TaskFunction_t fn,
+                       const char* name,
+                       uint32_t stackDepth,
+                       void* arg,
+                       UBaseType_t priority,
+                       TaskHandle_t* created);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskDelayUntil(TickType_t* previousWake, TickType_t period);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xPortGetCoreID();
+void taskYIELD();
+
+#endif
@@ -0,0 +1,926 @@
+// Host build core: virtual clock, GPIO/ADC/LEDC/interrupt model, heap accounting and the runner.
+#include <Arduino.h>
+#include <ESP.h>
+#include <ESPAsyncWebServer.h>
+#include <FS.h>
+#include <NimBLEDevice.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <driver/mcpwm_cap.h>
+#include <driver/pulse_cnt.h>
+#include <math.h>
+#include <string.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+#include "native_hal.h"
+#include "native_hal_internal.h"
+
+// Opaque handles of the PCNT and MCPWM capture stubs.
+struct pcnt_unit_t {
+  bool enabled;
+  bool running;
+  bool accumulate;
+  int highLimit;
+  int64_t count;
+};
+
+struct pcnt_chan_t {
+  pcnt_unit_t* unit;
+  int pin;
+  pcnt_channel_edge_action_t onRising;
+};
+
+struct mcpwm_cap_timer_t {
+  bool enabled;
+  bool running;
+};
+
+struct mcpwm_cap_channel_t {
+  mcpwm_cap_timer_t* timer;
+  int pin;
+  uint32_t prescale;
+  uint32_t edgesSinceCapture;
+  bool risingEdge;
+  bool enabled;
+  mcpwm_capture_event_cb_t onCapture;
+  void* ctx;
+};
+
+namespace {
+
+constexpr uint8_t kPinCount = 49;  // ESP32-S3 GPIO0..48
+constexpr uint32_t kAdcFullScaleMv = 3100;
+constexpr uint32_t kAdcMaxRaw = 4095;
+constexpr uint32_t kModelledHeapBytes = 320U * 1024U;
+// analogRead() takes ~10 us on the S3 (SAR conversion + driver overhead).
+constexpr uint32_t kAdcReadCostUs = 10;
+constexpr uint32_t kYieldCostUs = 100;
+
+uint64_t nowUs = 0;    // clock of the running context
+uint64_t worldUs = 0;  // furthest any context has got; GPIO pulse trains and the BLE link follow this
+uint32_t loopCostUs = 200;
+uint64_t loopIterations = 0;
+NativeHalTickHook tickHook = nullptr;
+void* tickHookCtx = nullptr;
+
+struct PinState {
+  uint8_t mode = INPUT;
+  int inputLevel = HIGH;
+  int pendingInputLevel = HIGH;
+  uint64_t pendingInputUs = UINT64_MAX;
+  int outputLevel = LOW;
+  uint64_t outputChangedUs = 0;
+  uint32_t analogMv = 0;
+  bool ledcAttached = false;
+  uint32_t ledcDuty = 0;
+  void (*isr)() = nullptr;
+  int isrMode = 0;
+  float pulseHz = 0.0f;
+  double pulsePhase = 0.0;
+  uint64_t pulseUs = 0;  // pulse train generated up to here
+  uint32_t rippleMv = 0;
+  float rippleHz = 0.0f;
+  uint32_t noiseMv = 0;
+};
+
+PinState pins[kPinCount];
+float dieTemperatureC = 40.0f;
+bool restartRequested = false;
+std::mt19937 rng(1);
+
+PinState* pinState(uint8_t pin) {
+  return pin < kPinCount ? &pins[pin] : nullptr;
+}
+
+uint32_t sampleMv(const PinState& p, uint64_t atUs) {
+  if (p.rippleMv == 0 && p.noiseMv == 0) {
+    return p.analogMv;
+  }
+  double mv = static_cast<double>(p.analogMv);
+  if (p.rippleMv > 0) {
+    mv += p.rippleMv * sin(2.0 * M_PI * static_cast<double>(p.rippleHz) * static_cast<double>(atUs) * 1e-6);
+  }
+  if (p.noiseMv > 0) {
+    mv += std::uniform_real_distribution<double>(-1.0, 1.0)(rng) * p.noiseMv;
+  }
+  return mv <= 0.0 ? 0U : mv >= kAdcFullScaleMv ? kAdcFullScaleMv : static_cast<uint32_t>(mv + 0.5);
+}
+
+uint16_t rawFromMv(uint32_t mv) {
+  return static_cast<uint16_t>((mv * kAdcMaxRaw + kAdcFullScaleMv / 2) / kAdcFullScaleMv);
+}
+
+// Continuous ADC: frames of conversionsPerPin samples per pin at the pattern rate, kept in a
+// two-frame pool (as the Arduino driver sizes it). Frames complete as the reading task's clock
+// passes them: other contexts run ahead in long atomic slices, and following the world clock
+// would overflow the pool in a way the S3, with the reader on its own core, never does.
+constexpr size_t kAdcContinuousMaxPins = 10;
+constexpr size_t kAdcContinuousPoolFrames = 2;
+
+struct ContinuousAdc {
+  bool configured = false;
+  bool running = false;
+  uint8_t pins[kAdcContinuousMaxPins] = {};
+  size_t pinCount = 0;
+  uint32_t conversionsPerPin = 0;
+  uint32_t freqHz = 0;
+  void (*onFrame)() = nullptr;
+  uintptr_t reader = 0;  // context of the last analogContinuousRead(), 0 until then
+  uint64_t frameStartUs = 0;
+  adc_continuous_data_t pool[kAdcContinuousPoolFrames][kAdcContinuousMaxPins] = {};
+  size_t pooled = 0;
+  adc_continuous_data_t result[kAdcContinuousMaxPins] = {};
+  uint64_t dropped = 0;
+};
+
+ContinuousAdc adcDma;
+
+uint64_t adcFrameUs() {
+  return static_cast<uint64_t>(adcDma.pinCount) * adcDma.conversionsPerPin * 1000000ULL / adcDma.freqHz;
+}
+
+void runContinuousAdc(uint64_t untilUs) {
+  if (!adcDma.running || (adcDma.reader != 0 && adcDma.reader != nativeRtosCurrentContext())) {
+    return;
+  }
+  const uint64_t frameUs = adcFrameUs();
+  while (adcDma.frameStartUs + frameUs <= untilUs) {
+    adc_continuous_data_t frame[kAdcContinuousMaxPins];
+    for (size_t i = 0; i < adcDma.pinCount; ++i) {
+      const PinState& p = pins[adcDma.pins[i]];
+      uint64_t sumMv = 0;
+      for (uint32_t k = 0; k < adcDma.conversionsPerPin; ++k) {
+        const uint64_t atUs =
+            adcDma.frameStartUs + (static_cast<uint64_t>(k) * adcDma.pinCount + i) * 1000000ULL / adcDma.freqHz;
+        sumMv += sampleMv(p, atUs);
+      }
+      const uint32_t mv = static_cast<uint32_t>(sumMv / adcDma.conversionsPerPin);
+      frame[i] = adc_continuous_data_t{adcDma.pins[i], static_cast<uint8_t>(adcDma.pins[i] - 1),
+                                       static_cast<int>(rawFromMv(mv)), static_cast<int>(mv)};
+    }
+    adcDma.frameStartUs += frameUs;
+    // The conversion-done interrupt fires before the driver tries the pool, so also for dropped frames.
+    if (adcDma.onFrame != nullptr) {
+      adcDma.onFrame();
+    }
+    if (adcDma.pooled == kAdcContinuousPoolFrames) {
+      adcDma.dropped++;
+      continue;
+    }
+    memcpy(adcDma.pool[adcDma.pooled++], frame, sizeof(frame));
+  }
+}
+
+// Pins counted by PCNT follow the clock of the task reading the counter, for the same reason as the
+// continuous ADC above; other pulse trains (GPIO interrupts) follow the world clock.
+uintptr_t pulseReader = 0;
+
+bool followsPulseReader(int pin);
+
+// As many units and channels as the S3 has (4 PCNT units, 2 MCPWM groups of 3 capture channels).
+constexpr size_t kPcntUnits = 4;
+constexpr size_t kCaptureTimers = 2;
+constexpr size_t kCaptureChannels = 6;
+constexpr uint32_t kCaptureResolutionHz = 80000000;  // capture timer on the 80 MHz APB clock
+
+pcnt_unit_t pcntUnits[kPcntUnits];
+pcnt_chan_t pcntChannels[kPcntUnits];
+size_t pcntUnitCount = 0;
+size_t pcntChannelCount = 0;
+mcpwm_cap_timer_t captureTimers[kCaptureTimers];
+mcpwm_cap_channel_t captureChannels[kCaptureChannels];
+size_t captureTimerCount = 0;
+size_t captureChannelCount = 0;
+
+bool followsPulseReader(int pin) {
+  if (pulseReader == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < pcntChannelCount; ++i) {
+    if (pcntChannels[i].pin == pin) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void countPulses(int pin, uint64_t edges) {
+  for (size_t i = 0; i < pcntChannelCount; ++i) {
+    const pcnt_chan_t& c = pcntChannels[i];
+    pcnt_unit_t& u = *c.unit;
+    if (c.pin != pin || !u.running || c.onRising == PCNT_CHANNEL_EDGE_ACTION_HOLD) {
+      continue;
+    }
+    u.count += c.onRising == PCNT_CHANNEL_EDGE_ACTION_INCREASE ? static_cast<int64_t>(edges)
+                                                                : -static_cast<int64_t>(edges);
+    if (!u.accumulate && u.highLimit > 0) {
+      u.count %= u.highLimit;  // the hardware counter restarts at its limit
+    }
+  }
+}
+
+// Edge k (1-based) of this step falls where the phase, startPhase at startUs, reaches k.
+void capturePulses(int pin, uint64_t edges, uint64_t startUs, double startPhase, float hz) {
+  for (size_t i = 0; i < captureChannelCount; ++i) {
+    mcpwm_cap_channel_t& c = captureChannels[i];
+    if (c.pin != pin || !c.enabled || !c.timer->running || !c.risingEdge || c.onCapture == nullptr) {
+      continue;
+    }
+    for (uint64_t k = 1; k <= edges; ++k) {
+      if (++c.edgesSinceCapture < c.prescale) {
+        continue;
+      }
+      c.edgesSinceCapture = 0;
+      const double atUs = static_cast<double>(startUs) + (static_cast<double>(k) - startPhase) / hz * 1e6;
+      const mcpwm_capture_event_data_t event{
+          static_cast<uint32_t>(static_cast<uint64_t>(atUs * (kCaptureResolutionHz / 1000000U))), MCPWM_CAP_EDGE_POS};
+      c.onCapture(&c, &event, c.ctx);
+    }
+  }
+}
+
+void runPulseGenerators(uint64_t untilUs, bool readerClock) {
+  for (uint8_t pin = 0; pin < kPinCount; ++pin) {
+    PinState& p = pins[pin];
+    if (untilUs <= p.pulseUs || followsPulseReader(pin) != readerClock) {
+      continue;
+    }
+    const uint64_t startUs = p.pulseUs;
+    const uint64_t deltaUs = untilUs - startUs;
+    p.pulseUs = untilUs;
+    if (p.pulseHz <= 0.0f) {
+      continue;
+    }
+    const double startPhase = p.pulsePhase;
+    p.pulsePhase += static_cast<double>(p.pulseHz) * static_cast<double>(deltaUs) * 1e-6;
+    const uint64_t edges = static_cast<uint64_t>(p.pulsePhase);
+    p.pulsePhase -= static_cast<double>(edges);
+    if (edges == 0) {
+      continue;
+    }
+    countPulses(pin, edges);
+    capturePulses(pin, edges, startUs, startPhase, p.pulseHz);
+    if (p.isr != nullptr && (p.isrMode == RISING || p.isrMode == CHANGE)) {
+      for (uint64_t i = 0; i < edges; ++i) {
+        p.isr();
+      }
+    }
+  }
+}
+
+// --- heap accounting ------------------------------------------------------------------------
+struct HeapCounters {
+  uint64_t allocCount;
+  uint64_t freeCount;
+  uint64_t bytesAllocated;
+  uint64_t liveBytes;
+  uint64_t peakLiveBytes;
+};
+HeapCounters heap = {0, 0, 0, 0, 0};
+constexpr size_t kHeapHeader = alignof(std::max_align_t);
+
+void* countedAlloc(size_t size) {
+  unsigned char* raw = static_cast<unsigned char*>(std::malloc(size + kHeapHeader));
+  if (raw == nullptr) {
+    return nullptr;
+  }
+  *reinterpret_cast<size_t*>(raw) = size;
+  heap.allocCount++;
+  heap.bytesAllocated += size;
+  heap.liveBytes += size;
+  if (heap.liveBytes > heap.peakLiveBytes) {
+    heap.peakLiveBytes = heap.liveBytes;
+  }
+  return raw + kHeapHeader;
+}
+
+void countedFree(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  unsigned char* raw = static_cast<unsigned char*>(ptr) - kHeapHeader;
+  heap.freeCount++;
+  heap.liveBytes -= *reinterpret_cast<size_t*>(raw);
+  std::free(raw);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+  void* p = countedAlloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return countedAlloc(size);
+}
+void operator delete(void* ptr) noexcept {
+  countedFree(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+  countedFree(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+  countedFree(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept {
+  countedFree(ptr);
+}
+
+// --- native_hal.h ---------------------------------------------------------------------------
+
+uint64_t nativeHalNowUs() {
+  return nowUs;
+}
+
+namespace {
+void advanceWorld() {
+  if (nowUs > worldUs) {
+    runPulseGenerators(nowUs, false);
+    worldUs = nowUs;
+    NimBLEDevice::hostAdvance(worldUs);
+    AsyncWebSocket::hostAdvance(worldUs);
+    WiFi.hostAdvance(worldUs);
+  }
+}
+
+void runReaderClockModels() {
+  runContinuousAdc(nowUs);
+  if (pulseReader != 0 && pulseReader == nativeRtosCurrentContext()) {
+    runPulseGenerators(nowUs, true);
+  }
+}
+}  // namespace
+
+void nativeHalAdvanceUs(uint64_t us) {
+  if (us == 0) {
+    return;
+  }
+  nowUs += us;
+  advanceWorld();
+  runReaderClockModels();
+}
+
+void nativeHalEnterContextClock(uint64_t us) {
+  nowUs = us;
+  advanceWorld();
+  runReaderClockModels();
+}
+
+void nativeHalRunTickHook() {
+  if (tickHook != nullptr) {
+    tickHook(nowUs, tickHookCtx);
+  }
+}
+
+void nativeHalSetLoopCostUs(uint32_t us) {
+  loopCostUs = us;
+}
+
+uint32_t nativeHalLoopCostUs() {
+  return loopCostUs;
+}
+
+uint64_t nativeHalLoopIterations() {
+  return loopIterations;
+}
+
+void nativeHalSetTickHook(NativeHalTickHook hook, void* ctx) {
+  tickHook = hook;
+  tickHookCtx = ctx;
+}
+
+void nativeHalSetDigitalInput(uint8_t pin, int level) {
+  if (PinState* p = pinState(pin)) {
+    p->inputLevel = level;
+    p->pendingInputUs = UINT64_MAX;
+  }
+}
+
+void nativeHalSetDigitalInputAt(uint8_t pin, int level, uint64_t atUs) {
+  if (PinState* p = pinState(pin)) {
+    p->pendingInputLevel = level;
+    p->pendingInputUs = atUs;
+  }
+}
+
+int nativeHalGetDigitalOutput(uint8_t pin) {
+  const PinState* p = pinState(pin);
+  return p ? p->outputLevel : LOW;
+}
+
+uint64_t nativeHalDigitalOutputChangedUs(uint8_t pin) {
+  const PinState* p = pinState(pin);
+  return p ? p->outputChangedUs : 0;
+}
+
+void nativeHalSetAnalogMillivolts(uint8_t pin, uint32_t millivolts) {
+  if (PinState* p = pinState(pin)) {
+    p->analogMv = millivolts > kAdcFullScaleMv ? kAdcFullScaleMv : millivolts;
+  }
+}
+
+uint32_t nativeHalGetAnalogMillivolts(uint8_t pin) {
+  const PinState* p = pinState(pin);
+  return p ? p->analogMv : 0;
+}
+
+void nativeHalSetAnalogWaveform(uint8_t pin, uint32_t rippleMv, float rippleHz, uint32_t noiseMv) {
+  if (PinState* p = pinState(pin)) {
+    p->rippleMv = rippleMv;
+    p->rippleHz = rippleHz;
+    p->noiseMv = noiseMv;
+  }
+}
+
+uint64_t nativeHalAdcFramesDropped() {
+  return adcDma.dropped;
+}
+
+bool nativeHalLedcAttached(uint8_t pin) {
+  const PinState* p = pinState(pin);
+  return p && p->ledcAttached;
+}
+
+uint32_t nativeHalLedcDuty(uint8_t pin) {
+  const PinState* p = pinState(pin);
+  return (p && p->ledcAttached) ? p->ledcDuty : 0;
+}
+
+void nativeHalSetPulseFrequency(uint8_t pin, float hz) {
+  if (PinState* p = pinState(pin)) {
+    p->pulseHz = hz > 0.0f ? hz : 0.0f;
+  }
+}
+
+void nativeHalSetDieTemperatureC(float celsius) {
+  dieTemperatureC = celsius;
+}
+
+NativeHalHeapStats nativeHalHeapStats() {
+  return NativeHalHeapStats{heap.allocCount, heap.freeCount, heap.bytesAllocated, heap.liveBytes,
+                            heap.peakLiveBytes};
+}
+
+void nativeHalResetHeapPeak() {
+  heap.peakLiveBytes = heap.liveBytes;
+}
+
+bool nativeHalRestartRequested() {
+  return restartRequested;
+}
+
+void nativeHalRunFor(uint64_t simulatedUs) {
+  const uint64_t until = nowUs + simulatedUs;
+  if (nativeRtosActive()) {
+    // Firmware runs in its own FreeRTOS tasks; the tick hook fires whenever one resumes.
+    nativeRtosRunUntil(until);
+    return;
+  }
+  while (nowUs < until && !restartRequested) {
+    if (tickHook != nullptr) {
+      tickHook(nowUs, tickHookCtx);
+    }
+    loop();
+    loopIterations++;
+    nativeHalAdvanceUs(loopCostUs);
+  }
+}
+
+__attribute__((weak)) int nativeHalMain(int argc, char** argv) {
+  uint32_t seconds = 60;
+  bool echo = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--seconds=", 10) == 0) {
+      seconds = static_cast<uint32_t>(strtoul(argv[i] + 10, nullptr, 10));
+    } else if (strncmp(argv[i], "--loop-cost-us=", 15) == 0) {
+      nativeHalSetLoopCostUs(static_cast<uint32_t>(strtoul(argv[i] + 15, nullptr, 10)));
+    } else if (strncmp(argv[i], "--fs-root=", 10) == 0) {
+      nativeHalSetFsRoot(argv[i] + 10);
+    } else if (strcmp(argv[i], "--echo") == 0) {
+      echo = true;
+    }
+  }
+  nativeHalSetSerialEcho(echo);
+
+  const auto wallStart = std::chrono::steady_clock::now();
+  setup();
+  const uint64_t setupUs = nowUs;
+  nativeHalRunFor(static_cast<uint64_t>(seconds) * 1000000ULL);
+  const double wallS =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  const double simS = static_cast<double>(nowUs) / 1e6;
+  const NativeHalHeapStats h = nativeHalHeapStats();
+  const NativeNvsStats nvs = nativeNvsStats();
+  printf("[native] simulated %.1f s (setup %.1f ms) in %.3f s wall (%.0fx)\n", simS,
+         static_cast<double>(setupUs) / 1000.0, wallS, wallS > 0.0 ? simS / wallS : 0.0);
+  if (nativeRtosActive()) {
+    nativeRtosPrintSummary(simS);
+  } else {
+    printf("[native] loop iterations: %llu (%.0f/s simulated)\n", static_cast<unsigned long long>(loopIterations),
+           simS > 0.0 ? static_cast<double>(loopIterations) / simS : 0.0);
+  }
+  printf("[native] heap: %llu allocs, %llu frees, %llu bytes total, %llu live, %llu peak\n",
+         static_cast<unsigned long long>(h.allocCount), static_cast<unsigned long long>(h.freeCount),
+         static_cast<unsigned long long>(h.bytesAllocated), static_cast<unsigned long long>(h.liveBytes),
+         static_cast<unsigned long long>(h.peakLiveBytes));
+  printf("[native] nvs: %llu writes, %llu bytes\n", static_cast<unsigned long long>(nvs.writeOps),
+         static_cast<unsigned long long>(nvs.bytesWritten));
+  const NativeFsStats fsWrites = nativeFsStats();
+  printf("[native] littlefs: %llu writes, %llu bytes\n", static_cast<unsigned long long>(fsWrites.writeOps),
+         static_cast<unsigned long long>(fsWrites.bytesWritten));
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  const int rc = nativeHalMain(argc, argv);
+  // Task threads are parked inside the scheduler; leave without unwinding them.
+  fflush(nullptr);
+  _Exit(rc);
+}
+
+// --- Arduino core ---------------------------------------------------------------------------
+
+unsigned long millis() {
+  return static_cast<uint32_t>(nowUs / 1000ULL);
+}
+
+unsigned long micros() {
+  return static_cast<uint32_t>(nowUs);
+}
+
+void delay(uint32_t ms) {
+  nativeHalAdvanceUs(static_cast<uint64_t>(ms) * 1000ULL);
+}
+
+void delayMicroseconds(uint32_t us) {
+  nativeHalAdvanceUs(us);
+}
+
+void yield() {
+  nativeHalAdvanceUs(kYieldCostUs);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (PinState* p = pinState(pin)) {
+    p->mode = mode;
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (PinState* p = pinState(pin)) {
+    const int level = val ? HIGH : LOW;
+    if (level != p->outputLevel) {
+      p->outputLevel = level;
+      p->outputChangedUs = nowUs;
+    }
+  }
+}
+
+int digitalRead(uint8_t pin) {
+  PinState* p = pinState(pin);
+  if (p == nullptr) {
+    return LOW;
+  }
+  if (nowUs >= p->pendingInputUs) {
+    p->inputLevel = p->pendingInputLevel;
+    p->pendingInputUs = UINT64_MAX;
+  }
+  return (p->mode & OUTPUT) == OUTPUT ? p->outputLevel : p->inputLevel;
+}
+
+uint16_t analogRead(uint8_t pin) {
+  nativeHalAdvanceUs(kAdcReadCostUs);
+  const PinState* p = pinState(pin);
+  return p ? rawFromMv(sampleMv(*p, nowUs)) : 0;
+}
+
+uint32_t analogReadMilliVolts(uint8_t pin) {
+  nativeHalAdvanceUs(kAdcReadCostUs);
+  const PinState* p = pinState(pin);
+  return p ? sampleMv(*p, nowUs) : 0;
+}
+
+bool analogContinuous(const uint8_t pinList[], size_t pinCount, uint32_t conversionsPerPin, uint32_t freqHz,
+                      void (*userFunc)(void)) {
+  // S3 limits: 611 Hz .. 83.333 kHz pattern rate; ADC1 only (GPIO1..10).
+  if (adcDma.running || pinList == nullptr || pinCount == 0 || pinCount > kAdcContinuousMaxPins ||
+      conversionsPerPin == 0 || freqHz < 611 || freqHz > 83333) {
+    return false;
+  }
+  for (size_t i = 0; i < pinCount; ++i) {
+    if (pinList[i] < 1 || pinList[i] > 10) {
+      return false;
+    }
+    adcDma.pins[i] = pinList[i];
+  }
+  adcDma.pinCount = pinCount;
+  adcDma.conversionsPerPin = conversionsPerPin;
+  adcDma.freqHz = freqHz;
+  adcDma.onFrame = userFunc;
+  adcDma.configured = true;
+  return true;
+}
+
+bool analogContinuousStart() {
+  if (!adcDma.configured || adcDma.running) {
+    return false;
+  }
+  adcDma.running = true;
+  adcDma.pooled = 0;
+  adcDma.frameStartUs = worldUs;
+  return true;
+}
+
+bool analogContinuousStop() {
+  if (!adcDma.running) {
+    return false;
+  }
+  adcDma.running = false;
+  return true;
+}
+
+bool analogContinuousDeinit() {
+  adcDma.running = false;
+  adcDma.configured = false;
+  adcDma.pooled = 0;
+  adcDma.reader = 0;
+  return true;
+}
+
+bool analogContinuousRead(adc_continuous_data_t** buffer, uint32_t /*timeout_ms*/) {
+  adcDma.reader = nativeRtosCurrentContext();
+  if (buffer == nullptr || adcDma.pooled == 0) {
+    return false;
+  }
+  memcpy(adcDma.result, adcDma.pool[0], sizeof(adcDma.result));
+  for (size_t f = 1; f < adcDma.pooled; ++f) {
+    memcpy(adcDma.pool[f - 1], adcDma.pool[f], sizeof(adcDma.pool[f]));
+  }
+  adcDma.pooled--;
+  *buffer = adcDma.result;
+  return true;
+}
+
+void analogReadResolution(uint8_t /*bits*/) {}
+
+void analogSetAttenuation(int /*attenuation*/) {}
+
+bool ledcAttach(uint8_t pin, uint32_t /*freq*/, uint8_t /*resolution*/) {
+  PinState* p = pinState(pin);
+  if (p == nullptr) {
+    return false;
+  }
+  p->ledcAttached = true;
+  p->ledcDuty = 0;
+  return true;
+}
+
+bool ledcWrite(uint8_t pin, uint32_t duty) {
+  PinState* p = pinState(pin);
+  if (p == nullptr || !p->ledcAttached) {
+    return false;
+  }
+  p->ledcDuty = duty;
+  return true;
+}
+
+bool ledcDetach(uint8_t pin) {
+  PinState* p = pinState(pin);
+  if (p == nullptr) {
+    return false;
+  }
+  p->ledcAttached = false;
+  p->ledcDuty = 0;
+  return true;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+  if (PinState* p = pinState(pin)) {
+    p->isr = isr;
+    p->isrMode = mode;
+  }
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (PinState* p = pinState(pin)) {
+    p->isr = nullptr;
+  }
+}
+
+void noInterrupts() {}
+
+void interrupts() {}
+
+float temperatureRead() {
+  return dieTemperatureC;
+}
+
+long random(long howbig) {
+  if (howbig <= 0) {
+    return 0;
+  }
+  return static_cast<long>(rng() % static_cast<unsigned long>(howbig));
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) {
+    return howsmall;
+  }
+  return howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) {
+  rng.seed(static_cast<std::mt19937::result_type>(seed));
+}
+
+// --- ESP ------------------------------------------------------------------------------------
+
+EspClass ESP;
+
+uint32_t EspClass::getFreeHeap() {
+  return heap.liveBytes >= kModelledHeapBytes ? 0U : static_cast<uint32_t>(kModelledHeapBytes - heap.liveBytes);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return heap.peakLiveBytes >= kModelledHeapBytes ? 0U
+                                                  : static_cast<uint32_t>(kModelledHeapBytes - heap.peakLiveBytes);
+}
+
+uint32_t EspClass::getHeapSize() {
+  return kModelledHeapBytes;
+}
+
+uint32_t EspClass::getCycleCount() {
+  return static_cast<uint32_t>(nowUs * 240ULL);
+}
+
+void EspClass::restart() {
+  restartRequested = true;
+  printf("[native] ESP.restart() requested at %.3f s\n", static_cast<double>(nowUs) / 1e6);
+}
+
+// --- driver/pulse_cnt.h, driver/mcpwm_cap.h -----------------------------------------------------
+
+esp_err_t pcnt_new_unit(const pcnt_unit_config_t* config, pcnt_unit_handle_t* ret_unit) {
+  if (config == nullptr || ret_unit == nullptr || config->low_limit >= 0 || config->high_limit <= 0 ||
+      pcntUnitCount == kPcntUnits) {
+    return ESP_FAIL;
+  }
+  pcnt_unit_t& u = pcntUnits[pcntUnitCount++];
+  u = pcnt_unit_t{false, false, config->flags.accum_count != 0, config->high_limit, 0};
+  *ret_unit = &u;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_set_glitch_filter(pcnt_unit_handle_t unit, const pcnt_glitch_filter_config_t* /*config*/) {
+  return unit != nullptr ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t pcnt_new_channel(pcnt_unit_handle_t unit, const pcnt_chan_config_t* config, pcnt_channel_handle_t* ret_chan) {
+  if (unit == nullptr || config == nullptr || ret_chan == nullptr || pcntChannelCount == kPcntUnits) {
+    return ESP_FAIL;
+  }
+  pcnt_chan_t& c = pcntChannels[pcntChannelCount++];
+  c = pcnt_chan_t{unit, config->edge_gpio_num, PCNT_CHANNEL_EDGE_ACTION_HOLD};
+  *ret_chan = &c;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_channel_set_edge_action(pcnt_channel_handle_t chan,
+                                       pcnt_channel_edge_action_t pos_act,
+                                       pcnt_channel_edge_action_t /*neg_act*/) {
+  if (chan == nullptr) {
+    return ESP_FAIL;
+  }
+  chan->onRising = pos_act;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_add_watch_point(pcnt_unit_handle_t unit, int /*watch_point*/) {
+  return unit != nullptr ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t pcnt_unit_enable(pcnt_unit_handle_t unit) {
+  if (unit == nullptr) {
+    return ESP_FAIL;
+  }
+  unit->enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_clear_count(pcnt_unit_handle_t unit) {
+  if (unit == nullptr) {
+    return ESP_FAIL;
+  }
+  unit->count = 0;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_start(pcnt_unit_handle_t unit) {
+  if (unit == nullptr || !unit->enabled) {
+    return ESP_FAIL;
+  }
+  unit->running = true;
+  return ESP_OK;
+}
+
+esp_err_t pcnt_unit_get_count(pcnt_unit_handle_t unit, int* value) {
+  if (unit == nullptr || value == nullptr) {
+    return ESP_FAIL;
+  }
+  pulseReader = nativeRtosCurrentContext();
+  runPulseGenerators(nowUs, true);
+  *value = static_cast<int>(static_cast<uint32_t>(unit->count));
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_new_capture_timer(const mcpwm_capture_timer_config_t* config, mcpwm_cap_timer_handle_t* ret_cap_timer) {
+  if (config == nullptr || ret_cap_timer == nullptr || captureTimerCount == kCaptureTimers) {
+    return ESP_FAIL;
+  }
+  mcpwm_cap_timer_t& t = captureTimers[captureTimerCount++];
+  t = mcpwm_cap_timer_t{false, false};
+  *ret_cap_timer = &t;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_enable(mcpwm_cap_timer_handle_t cap_timer) {
+  if (cap_timer == nullptr) {
+    return ESP_FAIL;
+  }
+  cap_timer->enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_start(mcpwm_cap_timer_handle_t cap_timer) {
+  if (cap_timer == nullptr || !cap_timer->enabled) {
+    return ESP_FAIL;
+  }
+  cap_timer->running = true;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_get_resolution(mcpwm_cap_timer_handle_t cap_timer, uint32_t* out_resolution) {
+  if (cap_timer == nullptr || out_resolution == nullptr) {
+    return ESP_FAIL;
+  }
+  *out_resolution = kCaptureResolutionHz;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_new_capture_channel(mcpwm_cap_timer_handle_t cap_timer,
+                                    const mcpwm_capture_channel_config_t* config,
+                                    mcpwm_cap_channel_handle_t* ret_cap_channel) {
+  if (cap_timer == nullptr || config == nullptr || ret_cap_channel == nullptr || config->prescale > 256 ||
+      captureChannelCount == kCaptureChannels) {
+    return ESP_FAIL;
+  }
+  mcpwm_cap_channel_t& c = captureChannels[captureChannelCount++];
+  c = mcpwm_cap_channel_t{cap_timer, config->gpio_num, config->prescale > 0 ? config->prescale : 1U, 0,
+                          config->flags.pos_edge != 0, false, nullptr, nullptr};
+  *ret_cap_channel = &c;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_channel_register_event_callbacks(mcpwm_cap_channel_handle_t cap_channel,
+                                                         const mcpwm_capture_event_callbacks_t* cbs,
+                                                         void* user_data) {
+  if (cap_channel == nullptr || cbs == nullptr || cap_channel->enabled) {
+    return ESP_FAIL;
+  }
+  cap_channel->onCapture = cbs->on_cap;
+  cap_channel->ctx = user_data;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_channel_enable(mcpwm_cap_channel_handle_t cap_channel) {
+  if (cap_channel == nullptr || cap_channel->enabled) {
+    return ESP_FAIL;
+  }
+  cap_channel->enabled = true;
+  cap_channel->edgesSinceCapture = 0;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_channel_disable(mcpwm_cap_channel_handle_t cap_channel) {
+  if (cap_channel == nullptr || !cap_channel->enabled) {
+    return ESP_FAIL;
+  }
+  cap_channel->enabled = false;
+  return ESP_OK;
+}
@@ -0,0 +1,85 @@
+// Host build control surface: virtual clock, pin/ADC injection and runtime counters.
+// Only the env:native build links this; firmware modules never include it directly.
+#ifndef HAL_NATIVE_NATIVE_HAL_H
+#define HAL_NATIVE_NATIVE_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Virtual clock in microseconds since boot. Only delay()/yield()/bus transfers and the runner advance it. */
+uint64_t nativeHalNowUs();
+void nativeHalAdvanceUs(uint64_t us);
+
+/** Virtual CPU time charged for every loop() call by the runner (default 200 us). */
+void nativeHalSetLoopCostUs(uint32_t us);
+uint32_t nativeHalLoopCostUs();
+uint64_t nativeHalLoopIterations();
+/** Blocking calls (delay/yield) made by a FreeRTOS task so far, i.e. its loop iterations. */
+uint64_t nativeHalTaskIterations(const char* taskName);
+
+/** Called by the runner once per loop(); the simulator uses it to feed sensor traces. */
+using NativeHalTickHook = void (*)(uint64_t nowUs, void* ctx);
+void nativeHalSetTickHook(NativeHalTickHook hook, void* ctx);
+
+/** Level seen by digitalRead() on an input pin (default: HIGH, i.e. pulled up / button released). */
+void nativeHalSetDigitalInput(uint8_t pin, int level);
+/** Same, taking effect once the reading context's clock reaches atUs (e.g. a button press during setup()). */
+void nativeHalSetDigitalInputAt(uint8_t pin, int level, uint64_t atUs);
+int nativeHalGetDigitalOutput(uint8_t pin);
+/** Virtual time of the last digitalWrite() that changed the pin's level. */
+uint64_t nativeHalDigitalOutputChangedUs(uint8_t pin);
+
+/** ADC input in millivolts at the pin; analogRead() maps 0..3100 mV onto 0..4095. */
+void nativeHalSetAnalogMillivolts(uint8_t pin, uint32_t millivolts);
+uint32_t nativeHalGetAnalogMillivolts(uint8_t pin);
+/**
+ * Synthetic waveform on top of the pin's level: a sine of rippleMv amplitude at rippleHz plus
+ * uniform noise of ±noiseMv, seen by analogRead() and by every continuous-ADC conversion.
+ */
+void nativeHalSetAnalogWaveform(uint8_t pin, uint32_t rippleMv, float rippleHz, uint32_t noiseMv);
+/** Continuous-ADC frames dropped because the two-frame DMA pool was full (reader too slow). */
+uint64_t nativeHalAdcFramesDropped();
+
+/** LEDC output state as last written by the firmware. */
+bool nativeHalLedcAttached(uint8_t pin);
+uint32_t nativeHalLedcDuty(uint8_t pin);
+
+/** Square wave on an interrupt pin; the attached ISR fires once per rising edge as the clock advances. */
+void nativeHalSetPulseFrequency(uint8_t pin, float hz);
+
+void nativeHalSetDieTemperatureC(float celsius);
+
+/** Serial (USB CDC) echo to stdout; off keeps long runs quiet. */
+void nativeHalSetSerialEcho(bool enabled);
+
+/** Heap accounting from the global operator new/delete overrides. */
+struct NativeHalHeapStats {
+  uint64_t allocCount;
+  uint64_t freeCount;
+  uint64_t bytesAllocated;
+  uint64_t liveBytes;
+  uint64_t peakLiveBytes;
+};
+NativeHalHeapStats nativeHalHeapStats();
+void nativeHalResetHeapPeak();
+
+/** Set by ESP.restart(); the runner stops at the next iteration. */
+bool nativeHalRestartRequested();
+
+/** Directory that backs LittleFS on the host (default: ./data). */
+void nativeHalSetFsRoot(const char* path);
+const char* nativeHalFsRoot();
+
+/**
+ * Calls loop() until the virtual clock has advanced by simulatedUs (or a restart is requested).
+ * Once the firmware has started FreeRTOS tasks, runs those instead (see native_rtos.cpp).
+ */
+void nativeHalRunFor(uint64_t simulatedUs);
+
+/**
+ * Program entry for env:native. The default (weak) implementation runs setup() and then
+ * loop() for --seconds=N simulated seconds (default 60) and prints a short summary.
+ */
+int nativeHalMain(int argc, char** argv);
+
+#endif
@@ -0,0 +1,19 @@
+// Hooks between the host HAL translation units; not for firmware or harness code.
+#ifndef HAL_NATIVE_NATIVE_HAL_INTERNAL_H
+#define HAL_NATIVE_NATIVE_HAL_INTERNAL_H
+
+#include <stdint.h>
+
+/** Switches the virtual clock to a context's own time; peripherals only ever move forward. */
+void nativeHalEnterContextClock(uint64_t us);
+void nativeHalRunTickHook();
+
+/** True once the firmware has created a FreeRTOS task; the runner then schedules tasks instead of loop(). */
+bool nativeRtosActive();
+/** Blocks the runner (main context) until its clock reaches untilUs while tasks run. */
+void nativeRtosRunUntil(uint64_t untilUs);
+void nativeRtosPrintSummary(double simulatedSeconds);
+/** Identity of the running context (the runner or a task), for models that follow one task's clock. */
+uintptr_t nativeRtosCurrentContext();
+
+#endif
@@ -0,0 +1,511 @@
+// Host build: BLE peripheral, WebSocket server and HTTP server models with scripted peers.
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <NimBLEDevice.h>
+
+#include <string.h>
+#include <strings.h>
+
+#include "native_hal.h"
+
+// --- NimBLE ---------------------------------------------------------------------------------
+
+namespace {
+
+struct BleLink {
+  NimBLEServer* server = nullptr;
+  NimBLEAdvertising advertising;
+  bool initialized = false;
+  bool connected = false;
+  uint16_t localMtu = 23;
+  uint16_t peerMtu = 23;
+  bool mtuExchangePending = false;
+  uint8_t txBuffers = 12;
+  uint8_t freeBuffers = 12;
+  uint8_t packetsPerEvent = 6;
+  uint32_t connIntervalUs = 15000;
+  uint64_t nextEventUs = 0;
+  uint64_t rejected = 0;
+  // Packets queued in the controller: delivered (and onStatus fired) at the next event.
+  std::vector<std::pair<NimBLECharacteristic*, std::string>> inFlight;
+  std::vector<std::string> delivered;
+};
+
+BleLink& ble() {
+  static BleLink link;
+  return link;
+}
+
+NimBLECharacteristic* findCharacteristic(const char* uuid) {
+  BleLink& l = ble();
+  if (l.server == nullptr || uuid == nullptr) {
+    return nullptr;
+  }
+  for (NimBLEService* s : l.server->services()) {
+    if (NimBLECharacteristic* c = s->getCharacteristic(uuid)) {
+      return c;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+bool NimBLECharacteristic::notify() {
+  BleLink& l = ble();
+  if (!l.connected) {
+    return false;
+  }
+  if (l.freeBuffers == 0) {
+    l.rejected++;
+    return false;
+  }
+  l.freeBuffers--;
+  l.inFlight.emplace_back(this, value_);
+  return true;
+}
+
+NimBLEService::~NimBLEService() {
+  for (NimBLECharacteristic* c : characteristics_) {
+    delete c;
+  }
+}
+
+NimBLECharacteristic* NimBLEService::createCharacteristic(const char* uuid, uint16_t properties) {
+  characteristics_.push_back(new NimBLECharacteristic(uuid, properties));
+  return characteristics_.back();
+}
+
+NimBLECharacteristic* NimBLEService::getCharacteristic(const char* uuid) {
+  for (NimBLECharacteristic* c : characteristics_) {
+    if (strcasecmp(c->getUUIDString().c_str(), uuid) == 0) {
+      return c;
+    }
+  }
+  return nullptr;
+}
+
+NimBLEServer::~NimBLEServer() {
+  for (NimBLEService* s : services_) {
+    delete s;
+  }
+}
+
+NimBLEService* NimBLEServer::createService(const char* uuid) {
+  services_.push_back(new NimBLEService(uuid));
+  return services_.back();
+}
+
+bool NimBLEServer::startAdvertising() {
+  return ble().advertising.start();
+}
+
+size_t NimBLEServer::getConnectedCount() const {
+  return ble().connected ? 1 : 0;
+}
+
+bool NimBLEDevice::init(const std::string& /*deviceName*/) {
+  ble().initialized = true;
+  return true;
+}
+
+bool NimBLEDevice::setMTU(uint16_t mtu) {
+  ble().localMtu = mtu;
+  return true;
+}
+
+NimBLEServer* NimBLEDevice::createServer() {
+  BleLink& l = ble();
+  if (l.server == nullptr) {
+    l.server = new NimBLEServer();
+  }
+  return l.server;
+}
+
+NimBLEServer* NimBLEDevice::getServer() {
+  return ble().server;
+}
+
+NimBLEAdvertising* NimBLEDevice::getAdvertising() {
+  return &ble().advertising;
+}
+
+void NimBLEDevice::hostConnect(uint16_t mtu) {
+  BleLink& l = ble();
+  if (l.server == nullptr || l.connected) {
+    return;
+  }
+  l.connected = true;
+  l.advertising.stop();
+  l.peerMtu = 23;
+  l.freeBuffers = l.txBuffers;
+  l.inFlight.clear();
+  l.nextEventUs = nativeHalNowUs() + l.connIntervalUs;
+  const uint16_t negotiated = mtu < l.localMtu ? mtu : l.localMtu;
+  l.mtuExchangePending = negotiated > 23;
+  NimBLEConnInfo info(23);
+  if (l.server->callbacks()) {
+    l.server->callbacks()->onConnect(l.server, info);
+  }
+  l.peerMtu = negotiated;
+}
+
+void NimBLEDevice::hostDisconnect(int reason) {
+  BleLink& l = ble();
+  if (!l.connected) {
+    return;
+  }
+  l.connected = false;
+  for (auto& p : l.inFlight) {
+    if (p.first->getCallbacks()) {
+      p.first->getCallbacks()->onStatus(p.first, 0x0E);
+    }
+  }
+  l.inFlight.clear();
+  NimBLEConnInfo info(l.peerMtu);
+  if (l.server && l.server->callbacks()) {
+    l.server->callbacks()->onDisconnect(l.server, info, reason);
+  }
+}
+
+bool NimBLEDevice::hostConnected() {
+  return ble().connected;
+}
+
+void NimBLEDevice::hostWrite(const char* uuid, const std::string& data) {
+  BleLink& l = ble();
+  NimBLECharacteristic* c = findCharacteristic(uuid);
+  if (!l.connected || c == nullptr) {
+    return;
+  }
+  c->setValue(data);
+  NimBLEConnInfo info(l.peerMtu);
+  if (c->getCallbacks()) {
+    c->getCallbacks()->onWrite(c, info);
+  }
+}
+
+std::vector<std::string>& NimBLEDevice::hostNotifications() {
+  return ble().delivered;
+}
+
+void NimBLEDevice::hostSetLinkModel(uint8_t txBuffers, uint8_t packetsPerEvent, uint32_t connIntervalUs) {
+  BleLink& l = ble();
+  l.txBuffers = txBuffers > 0 ? txBuffers : 1;
+  l.freeBuffers = l.txBuffers;
+  l.packetsPerEvent = packetsPerEvent > 0 ? packetsPerEvent : 1;
+  l.connIntervalUs = connIntervalUs > 0 ? connIntervalUs : 7500;
+}
+
+uint64_t NimBLEDevice::hostNotifyRejected() {
+  return ble().rejected;
+}
+
+void NimBLEDevice::hostAdvance(uint64_t nowUs) {
+  BleLink& l = ble();
+  if (!l.connected || nowUs < l.nextEventUs) {
+    return;
+  }
+  l.nextEventUs = nowUs + l.connIntervalUs;
+
+  if (l.mtuExchangePending) {
+    l.mtuExchangePending = false;
+    NimBLEConnInfo info(l.peerMtu);
+    if (l.server && l.server->callbacks()) {
+      l.server->callbacks()->onMTUChange(l.peerMtu, info);
+    }
+  }
+
+  size_t n = l.inFlight.size() < l.packetsPerEvent ? l.inFlight.size() : l.packetsPerEvent;
+  std::vector<std::pair<NimBLECharacteristic*, std::string>> sent(l.inFlight.begin(), l.inFlight.begin() + n);
+  l.inFlight.erase(l.inFlight.begin(), l.inFlight.begin() + n);
+  for (auto& p : sent) {
+    l.freeBuffers++;
+    l.delivered.push_back(p.second);
+    if (l.delivered.size() > 4096) {
+      l.delivered.erase(l.delivered.begin(), l.delivered.begin() + 2048);
+    }
+    if (p.first->getCallbacks()) {
+      p.first->getCallbacks()->onStatus(p.first, 0);
+    }
+  }
+}
+
+// --- AsyncWebSocket -------------------------------------------------------------------------
+
+namespace {
+// Queueing a message copies it into the client's buffer on the caller's task; the AsyncTCP task
+// then sends one frame per (TCP/WiFi stack cost + bytes) of virtual time.
+constexpr uint64_t kWsQueueCostUs = 6;
+constexpr uint64_t kWsQueueBytesPerUs = 32;
+constexpr uint64_t kWsFrameCostUs = 40;
+constexpr uint64_t kWsBytesPerUs = 4;
+// Library default (WS_MAX_QUEUED_MESSAGES); a full queue refuses the message.
+constexpr size_t kWsMaxQueuedMessages = 32;
+
+std::vector<AsyncWebSocket*>& webSockets() {
+  static std::vector<AsyncWebSocket*> servers;
+  return servers;
+}
+
+uint64_t wsFrameCostUs(size_t length) {
+  return kWsFrameCostUs + length / kWsBytesPerUs;
+}
+}  // namespace
+
+bool AsyncWebSocketClient::queueIsFull() const {
+  return queue_.size() >= kWsMaxQueuedMessages || status_ != WS_CONNECTED;
+}
+
+bool AsyncWebSocketClient::text(const char* message) {
+  return text(message, message != nullptr ? strlen(message) : 0);
+}
+
+bool AsyncWebSocketClient::enqueue(bool binary, const uint8_t* message, size_t len) {
+  if (message == nullptr || queueIsFull()) {
+    return false;
+  }
+  nativeHalAdvanceUs(kWsQueueCostUs + len / kWsQueueBytesPerUs);
+  if (queue_.empty()) {
+    frontReadyUs_ = nativeHalNowUs() + wsFrameCostUs(len);
+  }
+  queue_.push_back(Frame{binary, std::string(reinterpret_cast<const char*>(message), len)});
+  return true;
+}
+
+AsyncWebSocket::AsyncWebSocket(const char* url) : url_(url != nullptr ? url : "/") {
+  webSockets().push_back(this);
+}
+
+AsyncWebSocket::~AsyncWebSocket() {
+  std::vector<AsyncWebSocket*>& all = webSockets();
+  for (size_t i = 0; i < all.size(); ++i) {
+    if (all[i] == this) {
+      all.erase(all.begin() + static_cast<std::ptrdiff_t>(i));
+      break;
+    }
+  }
+}
+
+AsyncWebSocket::HostClient* AsyncWebSocket::find(uint32_t id) {
+  for (HostClient& c : clients_) {
+    if (c.client->id() == id) {
+      return &c;
+    }
+  }
+  return nullptr;
+}
+
+AsyncWebSocketClient* AsyncWebSocket::client(uint32_t id) {
+  HostClient* c = find(id);
+  return c != nullptr && c->client->status() == WS_CONNECTED ? c->client.get() : nullptr;
+}
+
+size_t AsyncWebSocket::count() const {
+  size_t n = 0;
+  for (const HostClient& c : clients_) {
+    n += c.client->status() == WS_CONNECTED ? 1 : 0;
+  }
+  return n;
+}
+
+void AsyncWebSocket::cleanupClients(uint16_t maxClients) {
+  for (size_t i = 0; i < clients_.size();) {
+    if (clients_[i].client->status() == WS_DISCONNECTED) {
+      clients_.erase(clients_.begin() + static_cast<std::ptrdiff_t>(i));
+    } else {
+      ++i;
+    }
+  }
+  if (count() > maxClients) {
+    clients_.front().client->close();
+    finishCloses();
+  }
+}
+
+void AsyncWebSocket::dispatch(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+  if (event_) {
+    event_(this, client, type, arg, data, len);
+  }
+  finishCloses();
+}
+
+void AsyncWebSocket::finishCloses() {
+  for (HostClient& c : clients_) {
+    if (c.client->status() == WS_DISCONNECTING) {
+      c.client->status_ = WS_DISCONNECTED;
+      c.client->queue_.clear();
+      dispatch(c.client.get(), WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+    }
+  }
+}
+
+void AsyncWebSocket::drain(uint64_t nowUs) {
+  for (HostClient& c : clients_) {
+    AsyncWebSocketClient& client = *c.client;
+    if (client.stalled_) {
+      continue;
+    }
+    while (!client.queue_.empty() && client.frontReadyUs_ <= nowUs) {
+      AsyncWebSocketClient::Frame& f = client.queue_.front();
+      bytesSent_ += f.data.size();
+      c.received.push_back(HostFrame{f.binary, std::move(f.data)});
+      client.queue_.pop_front();
+      if (!client.queue_.empty()) {
+        client.frontReadyUs_ += wsFrameCostUs(client.queue_.front().data.size());
+      }
+    }
+    if (c.received.size() > 4096) {
+      c.received.erase(c.received.begin(), c.received.begin() + 2048);
+    }
+  }
+}
+
+void AsyncWebSocket::hostAdvance(uint64_t nowUs) {
+  for (AsyncWebSocket* ws : webSockets()) {
+    ws->drain(nowUs);
+  }
+}
+
+int AsyncWebSocket::hostConnect() {
+  if (!hostRunning()) {
+    return -1;
+  }
+  clients_.push_back(HostClient{std::unique_ptr<AsyncWebSocketClient>(new AsyncWebSocketClient(this, nextId_++)), {}});
+  AsyncWebSocketClient* c = clients_.back().client.get();
+  dispatch(c, WS_EVT_CONNECT, nullptr, nullptr, 0);
+  return static_cast<int>(c->id());
+}
+
+void AsyncWebSocket::hostDisconnect(uint32_t id) {
+  if (AsyncWebSocketClient* c = client(id)) {
+    c->close();
+    finishCloses();
+  }
+}
+
+void AsyncWebSocket::hostSendText(uint32_t id, const std::string& text) {
+  AsyncWebSocketClient* c = client(id);
+  if (c == nullptr) {
+    return;
+  }
+  AwsFrameInfo info = {};
+  info.message_opcode = WS_TEXT;
+  info.opcode = WS_TEXT;
+  info.final = 1;
+  info.len = text.size();
+  std::string data = text;
+  data.push_back('\0');
+  dispatch(c, WS_EVT_DATA, &info, reinterpret_cast<uint8_t*>(&data[0]), text.size());
+}
+
+std::vector<AsyncWebSocket::HostFrame>& AsyncWebSocket::hostReceived(uint32_t id) {
+  static std::vector<HostFrame> none;
+  HostClient* c = find(id);
+  if (c == nullptr) {
+    none.clear();
+    return none;
+  }
+  return c->received;
+}
+
+void AsyncWebSocket::hostSetStalled(uint32_t id, bool stalled) {
+  if (HostClient* c = find(id)) {
+    c->client->stalled_ = stalled;
+    if (!stalled && !c->client->queue_.empty()) {
+      c->client->frontReadyUs_ = nativeHalNowUs() + wsFrameCostUs(c->client->queue_.front().data.size());
+    }
+  }
+}
+
+bool AsyncWebSocket::hostRunning() const {
+  return server_ != nullptr && server_->hostRunning();
+}
+
+// --- ESPAsyncWebServer ----------------------------------------------------------------------
+
+bool AsyncWebServerRequest::hasHeader(const char* name) const {
+  return getHeader(name) != nullptr;
+}
+
+const AsyncWebHeader* AsyncWebServerRequest::getHeader(const char* name) const {
+  if (headerViews_.empty()) {
+    for (const auto& h : headers_) {
+      headerViews_.emplace_back(h.first, h.second);
+    }
+  }
+  for (const AsyncWebHeader& h : headerViews_) {
+    if (strcasecmp(h.name().c_str(), name) == 0) {
+      return &h;
+    }
+  }
+  return nullptr;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(FS& fs, const String& path, const String& contentType,
+                                                             bool /*download*/) {
+  std::string body;
+  if (!fs.readAll(path.c_str(), body)) {
+    return new AsyncWebServerResponse(404, String("text/plain"), std::string());
+  }
+  return new AsyncWebServerResponse(200, contentType, std::move(body));
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType,
+                                                             const String& content) {
+  return new AsyncWebServerResponse(code, contentType, content.str());
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType,
+                                                             const uint8_t* content, size_t len) {
+  return new AsyncWebServerResponse(code, contentType,
+                                    std::string(reinterpret_cast<const char*>(content), content ? len : 0));
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+  if (response_ != nullptr && response_ != response) {
+    delete response_;
+  }
+  response_ = response;
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
+  send(beginResponse(code, contentType, content));
+}
+
+void AsyncWebServerRequest::send(FS& fs, const String& path, const String& contentType, bool download) {
+  send(beginResponse(fs, path, contentType, download));
+}
+
+void AsyncWebServer::on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest) {
+  routes_.push_back(Route{uri ? uri : "", method, onRequest});
+}
+
+AsyncWebServer::HostResponse AsyncWebServer::hostRequest(const char* url,
+                                                         std::vector<std::pair<std::string, std::string>> headers) {
+  HostResponse out{0, std::string(), {}, 0};
+  if (!running_ || url == nullptr) {
+    return out;
+  }
+  AsyncWebServerRequest request(url, std::move(headers));
+  bool handled = false;
+  for (const Route& r : routes_) {
+    if ((r.method & HTTP_GET) != 0 && r.uri == url) {
+      r.fn(&request);
+      handled = true;
+      break;
+    }
+  }
+  if (!handled && notFound_) {
+    notFound_(&request);
+  }
+  if (AsyncWebServerResponse* resp = request.hostResponse()) {
+    out.code = resp->code();
+    out.contentType = resp->contentType().c_str();
+    out.headers = resp->headers();
+    out.bodyLength = resp->body().size();
+  } else {
+    out.code = 500;
+  }
+  return out;
+}
@@ -0,0 +1,687 @@
+// Host build: Serial, I2C, NVS, WiFi, LittleFS, OTA, FastLED and light-sleep models.
+#include <Arduino.h>
+#include <ArduinoOTA.h>
+#include <ESPmDNS.h>
+#include <FastLED.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <Wire.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "native_hal.h"
+
+namespace {
+bool serialEcho = false;
+std::string fsRoot = "data";
+}  // namespace
+
+void nativeHalSetSerialEcho(bool enabled) {
+  serialEcho = enabled;
+}
+
+void nativeHalSetFsRoot(const char* path) {
+  fsRoot = path ? path : "";
+}
+
+const char* nativeHalFsRoot() {
+  return fsRoot.c_str();
+}
+
+// --- HardwareSerial -------------------------------------------------------------------------
+
+HardwareSerial Serial(0);
+HardwareSerial Serial2(2);
+
+void HardwareSerial::begin(unsigned long baud, uint32_t /*config*/, int8_t /*rxPin*/, int8_t /*txPin*/) {
+  baud_ = baud > 0 ? baud : 115200;
+  started_ = true;
+}
+
+void HardwareSerial::end() {
+  started_ = false;
+}
+
+size_t HardwareSerial::setTxBufferSize(size_t size) {
+  return size;
+}
+
+size_t HardwareSerial::setRxBufferSize(size_t size) {
+  return size;
+}
+
+int HardwareSerial::available() {
+  return static_cast<int>(rx_.size());
+}
+
+int HardwareSerial::read() {
+  if (rx_.empty()) {
+    return -1;
+  }
+  const int c = static_cast<uint8_t>(rx_.front());
+  rx_.erase(0, 1);
+  return c;
+}
+
+void HardwareSerial::flush() {
+  // UART flush blocks until the FIFO has drained; USB CDC is treated as free.
+  nativeHalAdvanceUs(pendingTxUs_);
+  pendingTxUs_ = 0;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (uartNum_ == 0) {
+    if (serialEcho) {
+      fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+  }
+  if (!started_) {
+    return 0;
+  }
+  tx_.append(reinterpret_cast<const char*>(buffer), size);
+  if (tx_.size() > 64 * 1024) {
+    tx_.erase(0, tx_.size() - 32 * 1024);
+  }
+  txTotal_ += size;
+  // 11 bit times per byte (start + 8 data + parity/stop).
+  pendingTxUs_ += (static_cast<uint64_t>(size) * 11ULL * 1000000ULL) / baud_;
+  return size;
+}
+
+// --- Wire -----------------------------------------------------------------------------------
+
+TwoWire Wire;
+
+namespace {
+bool i2cPresent[128] = {};
+bool i2cDefaultsApplied = false;
+
+void applyI2cDefaults() {
+  if (!i2cDefaultsApplied) {
+    i2cPresent[0x3C] = true;
+    i2cPresent[0x3D] = true;
+    i2cDefaultsApplied = true;
+  }
+}
+}  // namespace
+
+bool TwoWire::begin(int /*sda*/, int /*scl*/, uint32_t frequency) {
+  applyI2cDefaults();
+  if (frequency > 0) {
+    frequency_ = frequency;
+  }
+  return true;
+}
+
+bool TwoWire::end() {
+  return true;
+}
+
+void TwoWire::setClock(uint32_t frequency) {
+  if (frequency > 0) {
+    frequency_ = frequency;
+  }
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  address_ = address;
+  pending_ = 0;
+}
+
+size_t TwoWire::write(uint8_t /*data*/) {
+  pending_++;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* /*data*/, size_t len) {
+  pending_ += len;
+  return len;
+}
+
+uint8_t TwoWire::endTransmission(bool /*sendStop*/) {
+  applyI2cDefaults();
+  // Address byte + payload, 9 clocks per byte, plus start/stop overhead.
+  const uint64_t bytes = pending_ + 1;
+  nativeHalAdvanceUs((bytes * 9ULL * 1000000ULL) / frequency_ + 10ULL);
+  bytes_ += bytes;
+  pending_ = 0;
+  return (address_ < 128 && i2cPresent[address_]) ? 0 : 2;
+}
+
+size_t TwoWire::requestFrom(uint8_t /*address*/, size_t /*len*/, bool /*sendStop*/) {
+  return 0;
+}
+
+void TwoWire::hostSetDevicePresent(uint8_t address, bool present) {
+  applyI2cDefaults();
+  if (address < 128) {
+    i2cPresent[address] = present;
+  }
+}
+
+// --- Preferences ----------------------------------------------------------------------------
+
+namespace {
+std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvsStore;
+NativeNvsStats nvsStats = {0, 0, 0};
+}  // namespace
+
+NativeNvsStats nativeNvsStats() {
+  return nvsStats;
+}
+
+void nativeNvsReset() {
+  nvsStore.clear();
+  nvsStats = NativeNvsStats{0, 0, 0};
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* /*partitionLabel*/) {
+  if (name == nullptr || strlen(name) >= sizeof(namespace_)) {
+    return false;
+  }
+  strcpy(namespace_, name);
+  readOnly_ = readOnly;
+  open_ = true;
+  return true;
+}
+
+void Preferences::end() {
+  if (open_ && !readOnly_) {
+    nvsStats.commits++;
+  }
+  open_ = false;
+}
+
+bool Preferences::clear() {
+  if (!open_ || readOnly_) {
+    return false;
+  }
+  nvsStore[namespace_].clear();
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!open_ || readOnly_ || key == nullptr) {
+    return false;
+  }
+  return nvsStore[namespace_].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  if (!open_ || key == nullptr) {
+    return false;
+  }
+  const auto ns = nvsStore.find(namespace_);
+  return ns != nvsStore.end() && ns->second.count(key) > 0;
+}
+
+size_t Preferences::put(const char* key, const void* data, size_t len) {
+  if (!open_ || readOnly_ || key == nullptr) {
+    return 0;
+  }
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  nvsStore[namespace_][key].assign(bytes, bytes + len);
+  nvsStats.writeOps++;
+  // NVS writes whole 32-byte entries; count what actually hits flash.
+  nvsStats.bytesWritten += 32U * ((len + 31U) / 32U + (len > 8 ? 1U : 0U));
+  return len;
+}
+
+bool Preferences::get(const char* key, void* out, size_t len) {
+  if (!open_ || key == nullptr) {
+    return false;
+  }
+  const auto ns = nvsStore.find(namespace_);
+  if (ns == nvsStore.end()) {
+    return false;
+  }
+  const auto it = ns->second.find(key);
+  if (it == ns->second.end() || it->second.size() != len) {
+    return false;
+  }
+  memcpy(out, it->second.data(), len);
+  return true;
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value) {
+  return put(key, &value, sizeof(value));
+}
+size_t Preferences::putUShort(const char* key, uint16_t value) {
+  return put(key, &value, sizeof(value));
+}
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+  return put(key, &value, sizeof(value));
+}
+size_t Preferences::putInt(const char* key, int32_t value) {
+  return put(key, &value, sizeof(value));
+}
+size_t Preferences::putFloat(const char* key, float value) {
+  return put(key, &value, sizeof(value));
+}
+size_t Preferences::putBool(const char* key, bool value) {
+  const uint8_t v = value ? 1 : 0;
+  return put(key, &v, sizeof(v));
+}
+size_t Preferences::putString(const char* key, const char* value) {
+  if (value == nullptr) {
+    return 0;
+  }
+  const size_t len = strlen(value);
+  // Preferences reports the string length; an empty string is a valid 0-byte write.
+  return put(key, value, len + 1) > 0 ? len : 0;
+}
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+  return value == nullptr ? 0 : put(key, value, len);
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+  uint8_t v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+uint16_t Preferences::getUShort(const char* key, uint16_t defaultValue) {
+  uint16_t v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+  uint32_t v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+  int32_t v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+float Preferences::getFloat(const char* key, float defaultValue) {
+  float v = defaultValue;
+  return get(key, &v, sizeof(v)) ? v : defaultValue;
+}
+bool Preferences::getBool(const char* key, bool defaultValue) {
+  uint8_t v = 0;
+  return get(key, &v, sizeof(v)) ? v != 0 : defaultValue;
+}
+String Preferences::getString(const char* key, const String& defaultValue) {
+  if (!open_ || key == nullptr) {
+    return defaultValue;
+  }
+  const auto ns = nvsStore.find(namespace_);
+  if (ns == nvsStore.end()) {
+    return defaultValue;
+  }
+  const auto it = ns->second.find(key);
+  if (it == ns->second.end() || it->second.empty()) {
+    return defaultValue;
+  }
+  return String(reinterpret_cast<const char*>(it->second.data()));
+}
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+  const String s = getString(key, String());
+  if (value == nullptr || maxLen == 0 || s.length() + 1 > maxLen) {
+    return 0;
+  }
+  memcpy(value, s.c_str(), s.length() + 1);
+  return s.length() + 1;
+}
+size_t Preferences::getBytesLength(const char* key) {
+  if (!open_ || key == nullptr) {
+    return 0;
+  }
+  const auto ns = nvsStore.find(namespace_);
+  if (ns == nvsStore.end()) {
+    return 0;
+  }
+  const auto it = ns->second.find(key);
+  return it == ns->second.end() ? 0 : it->second.size();
+}
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  const size_t len = getBytesLength(key);
+  if (len == 0 || buf == nullptr || len > maxLen) {
+    return 0;
+  }
+  memcpy(buf, nvsStore[namespace_][key].data(), len);
+  return len;
+}
+
+// --- WiFi / mDNS ----------------------------------------------------------------------------
+
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+bool WiFiClass::mode(wifi_mode_t m) {
+  const bool staWasOn = mode_ == WIFI_STA || mode_ == WIFI_AP_STA;
+  const bool apWasUp = apUp_;
+  mode_ = m;
+  if (m != WIFI_AP && m != WIFI_AP_STA) {
+    apUp_ = false;
+  }
+  if (!staWasOn && (m == WIFI_STA || m == WIFI_AP_STA)) {
+    fireEvent(ARDUINO_EVENT_WIFI_STA_START);
+  }
+  if (apWasUp && !apUp_) {
+    fireEvent(ARDUINO_EVENT_WIFI_AP_STOP);
+  }
+  return true;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* /*password*/) {
+  snprintf(ssid_, sizeof(ssid_), "%s", ssid ? ssid : "");
+  status_ = WL_DISCONNECTED;
+  beginPending_ = ssid_[0] != '\0';
+  beginAtUs_ = nativeHalNowUs();
+  return status_;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+  const bool wasConnected = status_ == WL_CONNECTED;
+  status_ = WL_DISCONNECTED;
+  beginPending_ = false;
+  if (wasConnected) {
+    fireEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  }
+  if (wifiOff) {
+    mode(WIFI_OFF);
+  }
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  completeAssociation(nativeHalNowUs());
+  return status_;
+}
+
+bool WiFiClass::softAP(const char* /*ssid*/, const char* /*password*/) {
+  if (mode_ != WIFI_AP && mode_ != WIFI_AP_STA) {
+    return false;
+  }
+  if (!apUp_) {
+    apUp_ = true;
+    fireEvent(ARDUINO_EVENT_WIFI_AP_START);
+  }
+  return true;
+}
+
+IPAddress WiFiClass::localIP() {
+  return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress(0, 0, 0, 0);
+}
+
+IPAddress WiFiClass::softAPIP() const {
+  return apUp_ ? IPAddress(192, 168, 4, 1) : IPAddress(0, 0, 0, 0);
+}
+
+bool WiFiClass::setHostname(const char* name) {
+  snprintf(hostname_, sizeof(hostname_), "%s", name ? name : "");
+  return true;
+}
+
+void WiFiClass::hostSetStaBehaviour(int32_t connectAfterMs, int8_t rssi) {
+  connectAfterMs_ = connectAfterMs;
+  rssi_ = rssi;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventCb cb, arduino_event_id_t event) {
+  if (cb == nullptr || callbackCount_ >= kMaxEventCallbacks) {
+    return 0;
+  }
+  callbacks_[callbackCount_++] = EventCallback{cb, event};
+  return callbackCount_;
+}
+
+void WiFiClass::hostAdvance(uint64_t nowUs) {
+  completeAssociation(nowUs);
+}
+
+void WiFiClass::completeAssociation(uint64_t nowUs) {
+  if (!beginPending_ || connectAfterMs_ < 0 || (mode_ != WIFI_STA && mode_ != WIFI_AP_STA) ||
+      nowUs - beginAtUs_ < static_cast<uint64_t>(connectAfterMs_) * 1000ULL) {
+    return;
+  }
+  beginPending_ = false;
+  status_ = WL_CONNECTED;
+  fireEvent(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+  fireEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+}
+
+void WiFiClass::fireEvent(arduino_event_id_t event) {
+  for (uint8_t i = 0; i < callbackCount_; ++i) {
+    if (callbacks_[i].event == ARDUINO_EVENT_MAX || callbacks_[i].event == event) {
+      callbacks_[i].cb(event);
+    }
+  }
+}
+
+// --- LittleFS -------------------------------------------------------------------------------
+
+fs::LittleFSFS LittleFS;
+
+bool fs::LittleFSFS::begin(bool /*formatOnFail*/, const char* /*basePath*/, uint8_t /*maxOpenFiles*/,
+                           const char* /*partitionLabel*/) {
+  return true;
+}
+
+std::string fs::FS::hostPath(const char* path) const {
+  std::string p = fsRoot;
+  if (path == nullptr || path[0] != '/') {
+    p += '/';
+  }
+  p += path ? path : "";
+  return p;
+}
+
+namespace {
+// Overlay on the host directory: written files by path, nullptr for removed ones.
+std::map<std::string, std::shared_ptr<std::string>> fsOverlay;
+NativeFsStats fsStats = {0, 0, 0};
+
+bool readHostFile(const std::string& hostPath, std::string& out) {
+  std::ifstream f(hostPath, std::ios::binary);
+  if (!f.good()) {
+    return false;
+  }
+  std::ostringstream ss;
+  ss << f.rdbuf();
+  out = ss.str();
+  return true;
+}
+}  // namespace
+
+NativeFsStats nativeFsStats() {
+  return fsStats;
+}
+
+void nativeFsReset() {
+  fsOverlay.clear();
+  fsStats = NativeFsStats{0, 0, 0};
+}
+
+bool fs::FS::exists(const char* path) {
+  std::string unused;
+  return readAll(path, unused);
+}
+
+fs::File fs::FS::open(const char* path, const char* mode) {
+  const char m = mode != nullptr ? mode[0] : 'r';
+  const bool plus = mode != nullptr && strchr(mode, '+') != nullptr;
+  auto state = std::make_shared<FileState>();
+  state->path = path != nullptr ? path : "";
+  const bool found = readAll(path, state->data);
+  if (m == 'r' && !found) {
+    return File();
+  }
+  if (m == 'w') {
+    state->data.clear();
+    state->dirty = true;  // creates the file even if nothing is written
+  } else if (m == 'a') {
+    state->pos = state->data.size();
+    state->dirty = !found;
+  } else if (m != 'r') {
+    return File();
+  }
+  state->writable = m != 'r' || plus;
+  return File(state);
+}
+
+bool fs::FS::remove(const char* path) {
+  if (path == nullptr || !exists(path)) {
+    return false;
+  }
+  fsOverlay[path] = nullptr;
+  fsStats.removes++;
+  return true;
+}
+
+size_t fs::File::read(uint8_t* buf, size_t len) {
+  if (!state_ || state_->pos >= state_->data.size()) {
+    return 0;
+  }
+  const size_t n = len < state_->data.size() - state_->pos ? len : state_->data.size() - state_->pos;
+  memcpy(buf, state_->data.data() + state_->pos, n);
+  state_->pos += n;
+  return n;
+}
+
+size_t fs::File::write(const uint8_t* buf, size_t len) {
+  if (!state_ || !state_->writable || buf == nullptr) {
+    return 0;
+  }
+  if (state_->pos + len > state_->data.size()) {
+    state_->data.resize(state_->pos + len);
+  }
+  memcpy(&state_->data[state_->pos], buf, len);
+  state_->pos += len;
+  state_->dirty = true;
+  fsStats.writeOps++;
+  fsStats.bytesWritten += len;
+  return len;
+}
+
+bool fs::File::seek(uint32_t pos, SeekMode mode) {
+  if (!state_) {
+    return false;
+  }
+  const size_t base = mode == SeekCur ? state_->pos : (mode == SeekEnd ? state_->data.size() : 0);
+  if (base + pos > state_->data.size()) {
+    return false;
+  }
+  state_->pos = base + pos;
+  return true;
+}
+
+void fs::File::flush() {
+  if (state_ && state_->dirty) {
+    fsOverlay[state_->path] = std::make_shared<std::string>(state_->data);
+    state_->dirty = false;
+  }
+}
+
+void fs::File::close() {
+  flush();
+  state_.reset();
+}
+
+bool fs::FS::readAll(const char* path, std::string& out) {
+  const auto it = fsOverlay.find(path != nullptr ? path : "");
+  if (it != fsOverlay.end()) {
+    if (!it->second) {
+      return false;
+    }
+    out = *it->second;
+    return true;
+  }
+  return readHostFile(hostPath(path), out);
+}
+
+// --- ArduinoOTA / FastLED -------------------------------------------------------------------
+
+ArduinoOTAClass ArduinoOTA;
+CFastLED FastLED;
+
+void CFastLED::clear(bool writeData) {
+  for (int i = 0; i < count_; ++i) {
+    leds_[i] = CRGB::Black;
+  }
+  if (writeData) {
+    show();
+  }
+}
+
+void CFastLED::show() {
+  // WS2812: 24 bits x 1.25 us per LED plus the 50 us latch.
+  nativeHalAdvanceUs(static_cast<uint64_t>(count_) * 30ULL + 50ULL);
+  showCount_++;
+}
+
+// --- Light sleep ----------------------------------------------------------------------------
+
+namespace {
+constexpr int kMaxWakePins = 8;
+int wakePins[kMaxWakePins];
+int wakePinCount = 0;
+uint32_t sleepCapMs = 10000;
+uint64_t lightSleepCount = 0;
+esp_sleep_wakeup_cause_t lastWakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+}  // namespace
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio, gpio_int_type_t /*type*/) {
+  for (int i = 0; i < wakePinCount; ++i) {
+    if (wakePins[i] == gpio) {
+      return ESP_OK;
+    }
+  }
+  if (wakePinCount < kMaxWakePins) {
+    wakePins[wakePinCount++] = gpio;
+  }
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio) {
+  for (int i = 0; i < wakePinCount; ++i) {
+    if (wakePins[i] == gpio) {
+      wakePins[i] = wakePins[--wakePinCount];
+      break;
+    }
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+  return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+  lightSleepCount++;
+  const uint64_t until = nativeHalNowUs() + static_cast<uint64_t>(sleepCapMs) * 1000ULL;
+  while (nativeHalNowUs() < until) {
+    for (int i = 0; i < wakePinCount; ++i) {
+      if (digitalRead(static_cast<uint8_t>(wakePins[i])) == LOW) {
+        lastWakeCause = ESP_SLEEP_WAKEUP_GPIO;
+        return ESP_OK;
+      }
+    }
+    nativeHalAdvanceUs(1000);
+  }
+  lastWakeCause = ESP_SLEEP_WAKEUP_TIMER;
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return lastWakeCause;
+}
+
+void nativeHalSetSleepCapMs(uint32_t ms) {
+  sleepCapMs = ms;
+}
+
+uint64_t nativeHalLightSleepCount() {
+  return lightSleepCount;
+}
@@ -0,0 +1,413 @@
+// Host build: FreeRTOS tasks, queues and semaphores.
+//
+// Every task is a std::thread, but only one context runs at a time: a small discrete-event
+// scheduler passes a baton at each blocking call (vTaskDelay, xTaskDelayUntil, taskYIELD and
+// waits on queues/semaphores) to the context that can start earliest in virtual time. Each
+// context keeps its own clock, so tasks pinned to different cores overlap in virtual time the way
+// they would on the S3, while the run stays deterministic. Code between two blocking calls runs
+// atomically; its shared-memory effects land at the start of that slice. Tasks sharing a core are
+// not serialised against each other, and each delay first charges the runner's loop cost
+// (--loop-cost-us) to the task as the CPU time of that iteration.
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "native_hal.h"
+#include "native_hal_internal.h"
+
+struct NativeRtosTask {
+  enum class State : uint8_t { Ready, Waiting, Deleted };
+
+  std::string name;
+  TaskFunction_t fn = nullptr;
+  void* arg = nullptr;
+  int core = 1;
+  UBaseType_t priority = 1;
+  uint64_t clockUs = 0;
+  uint64_t readyAtUs = 0;  // earliest start of the next slice (UINT64_MAX: wait forever)
+  State state = State::Ready;
+  const NativeRtosQueue* waitingOn = nullptr;
+  uint64_t iterations = 0;
+  std::condition_variable cv;
+  std::thread thread;
+};
+
+struct NativeRtosQueue {
+  size_t itemSize = 0;
+  size_t capacity = 0;
+  size_t count = 0;  // zero-size items (semaphores)
+  std::deque<std::string> items;
+  bool mutex = false;
+  NativeRtosTask* owner = nullptr;
+};
+
+namespace {
+
+constexpr int kNoCore = -1;
+constexpr uint64_t kForever = UINT64_MAX;
+
+std::mutex schedMutex;
+std::vector<NativeRtosTask*> contexts;  // [0] is the runner / Arduino loopTask
+NativeRtosTask* current = nullptr;
+thread_local NativeRtosTask* self = nullptr;
+
+NativeRtosTask* mainContext() {
+  if (contexts.empty()) {
+    NativeRtosTask* m = new NativeRtosTask();
+    m->name = "main";
+    m->core = kNoCore;  // the runner does no firmware work after setup()
+    contexts.push_back(m);
+    current = m;
+    self = m;
+  }
+  return contexts[0];
+}
+
+NativeRtosTask* me() {
+  mainContext();
+  return self != nullptr ? self : contexts[0];
+}
+
+uint64_t startTimeOf(const NativeRtosTask* t) {
+  return t->readyAtUs > t->clockUs ? t->readyAtUs : t->clockUs;
+}
+
+NativeRtosTask* pickNext() {
+  if (nativeHalRestartRequested()) {
+    return contexts[0];
+  }
+  NativeRtosTask* best = nullptr;
+  for (NativeRtosTask* t : contexts) {
+    if (t->state == NativeRtosTask::State::Deleted || t->readyAtUs == kForever) {
+      continue;
+    }
+    if (best == nullptr || startTimeOf(t) < startTimeOf(best) ||
+        (startTimeOf(t) == startTimeOf(best) && t->priority > best->priority)) {
+      best = t;
+    }
+  }
+  return best;
+}
+
+void enterContext(NativeRtosTask* t) {
+  nativeHalEnterContextClock(t->clockUs);
+  nativeHalRunTickHook();
+}
+
+/** Gives up the baton (schedMutex held) and returns once this context is picked again. */
+void switchAway(std::unique_lock<std::mutex>& lock, NativeRtosTask* t) {
+  t->clockUs = nativeHalNowUs();
+  NativeRtosTask* next = pickNext();
+  if (next == nullptr) {
+    fprintf(stderr, "[native] FreeRTOS: every task is blocked forever (deadlock)\n");
+    fflush(nullptr);
+    _Exit(3);
+  }
+  next->clockUs = startTimeOf(next);
+  if (next != t) {
+    current = next;
+    next->cv.notify_one();
+    t->cv.wait(lock, [t] { return current == t; });
+  }
+  lock.unlock();
+  enterContext(t);
+  lock.lock();
+}
+
+void wakeWaiters(const NativeRtosQueue* q) {
+  const uint64_t now = nativeHalNowUs();
+  for (NativeRtosTask* t : contexts) {
+    if (t->state == NativeRtosTask::State::Waiting && t->waitingOn == q) {
+      t->state = NativeRtosTask::State::Ready;
+      t->waitingOn = nullptr;
+      t->readyAtUs = now;
+    }
+  }
+}
+
+/** Blocks until `ready()` holds or the timeout passes; schedMutex held. */
+template <typename Pred>
+bool waitFor(std::unique_lock<std::mutex>& lock, const NativeRtosQueue* q, TickType_t ticks, Pred ready) {
+  NativeRtosTask* t = me();
+  const uint64_t deadline = ticks == portMAX_DELAY ? kForever : nativeHalNowUs() + static_cast<uint64_t>(ticks) * 1000ULL;
+  while (!ready()) {
+    if (ticks == 0 || nativeHalNowUs() >= deadline) {
+      return false;
+    }
+    t->state = NativeRtosTask::State::Waiting;
+    t->waitingOn = q;
+    t->readyAtUs = deadline;
+    switchAway(lock, t);
+    t->state = NativeRtosTask::State::Ready;
+    t->waitingOn = nullptr;
+  }
+  return true;
+}
+
+void blockUntil(uint64_t wakeUs) {
+  std::unique_lock<std::mutex> lock(schedMutex);
+  NativeRtosTask* t = me();
+  t->iterations++;
+  t->readyAtUs = wakeUs;
+  switchAway(lock, t);
+}
+
+void taskMain(NativeRtosTask* t) {
+  {
+    std::unique_lock<std::mutex> lock(schedMutex);
+    self = t;
+    t->cv.wait(lock, [t] { return current == t; });
+  }
+  enterContext(t);
+  t->fn(t->arg);
+  vTaskDelete(nullptr);  // returning from a task function is not allowed in FreeRTOS either
+}
+
+}  // namespace
+
+// --- runner integration ---------------------------------------------------------------------
+
+bool nativeRtosActive() {
+  return contexts.size() > 1;
+}
+
+uintptr_t nativeRtosCurrentContext() {
+  return reinterpret_cast<uintptr_t>(me());
+}
+
+void nativeRtosRunUntil(uint64_t untilUs) {
+  NativeRtosTask* m = mainContext();
+  std::unique_lock<std::mutex> lock(schedMutex);
+  m->readyAtUs = untilUs;
+  switchAway(lock, m);
+}
+
+void nativeRtosPrintSummary(double simulatedSeconds) {
+  for (size_t i = 1; i < contexts.size(); ++i) {
+    const NativeRtosTask* t = contexts[i];
+    printf("[native] task %-10s core %d prio %2u: %llu iterations (%.0f/s simulated)\n", t->name.c_str(), t->core,
+           t->priority, static_cast<unsigned long long>(t->iterations),
+           simulatedSeconds > 0.0 ? static_cast<double>(t->iterations) / simulatedSeconds : 0.0);
+  }
+}
+
+uint64_t nativeHalTaskIterations(const char* name) {
+  for (const NativeRtosTask* t : contexts) {
+    if (t->name == name) {
+      return t->iterations;
+    }
+  }
+  return 0;
+}
+
+// --- tasks ----------------------------------------------------------------------------------
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn,
+                                   const char* name,
+                                   uint32_t /*stackDepth*/,
+                                   void* arg,
+                                   UBaseType_t priority,
+                                   TaskHandle_t* created,
+                                   BaseType_t coreId) {
+  mainContext();
+  std::lock_guard<std::mutex> lock(schedMutex);
+  NativeRtosTask* t = new NativeRtosTask();
+  t->name = name != nullptr ? name : "task";
+  t->fn = fn;
+  t->arg = arg;
+  t->priority = priority;
+  t->core = coreId == tskNO_AFFINITY ? kNoCore : static_cast<int>(coreId);
+  t->clockUs = nativeHalNowUs();
+  t->readyAtUs = t->clockUs;
+  contexts.push_back(t);
+  t->thread = std::thread(taskMain, t);
+  t->thread.detach();
+  if (created != nullptr) {
+    *created = t;
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn,
+                       const char* name,
+                       uint32_t stackDepth,
+                       void* arg,
+                       UBaseType_t priority,
+                       TaskHandle_t* created) {
+  return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  NativeRtosTask* t = task != nullptr ? task : me();
+  if (t == mainContext()) {
+    return;  // the runner keeps driving time; loop() deleting itself just ends loop() calls
+  }
+  std::unique_lock<std::mutex> lock(schedMutex);
+  t->state = NativeRtosTask::State::Deleted;
+  if (t != me()) {
+    return;
+  }
+  t->clockUs = nativeHalNowUs();
+  NativeRtosTask* next = pickNext();
+  if (next == nullptr) {
+    fprintf(stderr, "[native] FreeRTOS: every task is blocked forever (deadlock)\n");
+    fflush(nullptr);
+    _Exit(3);
+  }
+  next->clockUs = startTimeOf(next);
+  current = next;
+  next->cv.notify_one();
+  t->cv.wait(lock, [] { return false; });  // never resumed; the process exits around it
+}
+
+void vTaskDelay(TickType_t ticks) {
+  const uint64_t now = nativeHalNowUs();
+  nativeHalAdvanceUs(nativeHalLoopCostUs());
+  blockUntil(now + static_cast<uint64_t>(ticks) * 1000ULL);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+  nativeHalAdvanceUs(nativeHalLoopCostUs());
+  *previousWake += period;
+  const uint64_t wakeUs = static_cast<uint64_t>(*previousWake) * 1000ULL;
+  const bool late = wakeUs <= nativeHalNowUs();
+  // FreeRTOS returns at once when late; the host still yields so other contexts keep pace.
+  blockUntil(late ? nativeHalNowUs() : wakeUs);
+  return late ? pdFALSE : pdTRUE;
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+  (void)xTaskDelayUntil(previousWake, period);
+}
+
+TickType_t xTaskGetTickCount() {
+  return static_cast<TickType_t>(nativeHalNowUs() / 1000ULL);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return me();
+}
+
+BaseType_t xPortGetCoreID() {
+  const NativeRtosTask* t = me();
+  return t->core == kNoCore ? 1 : t->core;
+}
+
+void taskYIELD() {
+  blockUntil(nativeHalNowUs());
+}
+
+// --- queues and semaphores ------------------------------------------------------------------
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  NativeRtosQueue* q = new NativeRtosQueue();
+  q->capacity = length;
+  q->itemSize = itemSize;
+  return q;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(schedMutex);
+  if (!waitFor(lock, q, ticksToWait, [q] { return q->items.size() + q->count < q->capacity; })) {
+    return pdFALSE;
+  }
+  if (q->itemSize > 0) {
+    q->items.emplace_back(static_cast<const char*>(item), q->itemSize);
+  } else {
+    q->count++;
+  }
+  wakeWaiters(q);
+  return pdTRUE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t ticksToWait) {
+  return xQueueSend(q, item, ticksToWait);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(schedMutex);
+  if (!waitFor(lock, q, ticksToWait, [q] { return !q->items.empty() || q->count > 0; })) {
+    return pdFALSE;
+  }
+  if (q->itemSize > 0) {
+    memcpy(item, q->items.front().data(), q->itemSize);
+    q->items.pop_front();
+  } else {
+    q->count--;
+  }
+  wakeWaiters(q);
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lock(schedMutex);
+  return static_cast<UBaseType_t>(q->items.size() + q->count);
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lock(schedMutex);
+  q->items.clear();
+  q->count = 0;
+  wakeWaiters(q);
+  return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  NativeRtosQueue* q = new NativeRtosQueue();
+  q->capacity = 1;
+  q->count = 1;
+  q->mutex = true;
+  return q;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  NativeRtosQueue* q = new NativeRtosQueue();
+  q->capacity = 1;
+  return q;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> lock(schedMutex);
+  if (!waitFor(lock, sem, ticksToWait, [sem] { return sem->count > 0; })) {
+    return pdFALSE;
+  }
+  sem->count--;
+  if (sem->mutex) {
+    sem->owner = me();
+  }
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  std::lock_guard<std::mutex> lock(schedMutex);
+  if (sem->mutex && sem->owner != me()) {
+    return pdFALSE;
+  }
+  if (sem->count >= sem->capacity) {
+    return pdFALSE;
+  }
+  sem->count++;
+  sem->owner = nullptr;
+  wakeWaiters(sem);
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+  delete sem;
+}
@@ -0,0 +1,148 @@
+#include "adc_sampler.h"
+
+#include <Arduino.h>
+
+#include <atomic>
+
+namespace {
+
+// All pins must be on ADC1 (GPIO1..10), the only unit continuous mode drives on the S3.
+constexpr uint8_t kChannelPins[kAdcChannelCount] = {
+    6,  // Battery: pack voltage through the 330k/22k divider
+    4,  // Thermistor: NTC to 3V3, 10k to GND
+#if defined(NTC2_ADC_PIN)
+    NTC2_ADC_PIN,  // Thermistor2: same divider
+#endif
+};
+constexpr uint8_t kFilterFrames[kAdcChannelCount] = {
+    10,                   // Battery: 20 ms, short enough not to delay the undervoltage cutoff
+    kAdcFilterFramesMax,  // Thermistor: 100 ms, the NTC itself is far slower
+#if defined(NTC2_ADC_PIN)
+    kAdcFilterFramesMax,  // Thermistor2
+#endif
+};
+#if defined(NTC2_ADC_PIN)
+static_assert(NTC2_ADC_PIN >= 1 && NTC2_ADC_PIN <= 10, "NTC2_ADC_PIN must be an ADC1 pin");
+#endif
+// The Arduino driver's DMA pool holds two frames; frames finishing while it is full are dropped.
+constexpr uint32_t kDmaPoolFrames = 2;
+constexpr uint32_t kPatternRateHz =
+    static_cast<uint32_t>(kAdcChannelCount) * kAdcConversionsPerFrame * 1000000UL / kAdcFrameUs;
+
+struct ChannelRing {
+  uint16_t raw[kAdcFilterFramesMax];
+  uint16_t millivolts[kAdcFilterFramesMax];
+  uint32_t rawSum;
+  uint32_t millivoltSum;
+  uint8_t window;  // frames averaged, <= kAdcFilterFramesMax
+  uint8_t head;    // next slot to write
+  uint8_t fill;
+};
+
+ChannelRing rings[kAdcChannelCount];
+bool continuous = false;
+uint32_t lastPolledUs = 0;
+
+// Counted in the DMA conversion-done interrupt (also for frames the full pool drops):
+// analogContinuousRead() logs an error when no frame is waiting, so only that many reads are made.
+std::atomic<uint32_t> framesReady{0};
+
+void IRAM_ATTR onAdcFrame() {
+  framesReady.fetch_add(1, std::memory_order_relaxed);
+}
+
+void pushSample(ChannelRing& r, uint16_t raw, uint16_t millivolts) {
+  if (r.fill == r.window) {
+    r.rawSum -= r.raw[r.head];
+    r.millivoltSum -= r.millivolts[r.head];
+  } else {
+    r.fill++;
+  }
+  r.raw[r.head] = raw;
+  r.millivolts[r.head] = millivolts;
+  r.rawSum += raw;
+  r.millivoltSum += millivolts;
+  r.head = static_cast<uint8_t>((r.head + 1) % r.window);
+}
+
+void pushFrame(const adc_continuous_data_t* results) {
+  for (uint8_t i = 0; i < kAdcChannelCount; ++i) {
+    // Results are per configured pin; match by pin rather than relying on the driver's order.
+    for (uint8_t j = 0; j < kAdcChannelCount; ++j) {
+      if (results[j].pin == kChannelPins[i]) {
+        pushSample(rings[i], static_cast<uint16_t>(results[j].avg_read_raw),
+                   static_cast<uint16_t>(results[j].avg_read_mvolts));
+        break;
+      }
+    }
+  }
+}
+
+const ChannelRing& ring(AdcChannel channel) {
+  return rings[static_cast<uint8_t>(channel) % kAdcChannelCount];
+}
+
+}  // namespace
+
+void initAdcSampler() {
+  for (uint8_t i = 0; i < kAdcChannelCount; ++i) {
+    pinMode(kChannelPins[i], INPUT);
+    rings[i] = {};
+    rings[i].window = kFilterFrames[i];
+  }
+  continuous = analogContinuous(kChannelPins, kAdcChannelCount, kAdcConversionsPerFrame, kPatternRateHz,
+                                &onAdcFrame) &&
+               analogContinuousStart();
+  if (continuous) {
+    Serial.printf("[ADC] Continuous sampling: %u channels at %lu Hz, %u conversions per frame\n",
+                  kAdcChannelCount, static_cast<unsigned long>(kPatternRateHz), kAdcConversionsPerFrame);
+  } else {
+    Serial.println("[ADC] Continuous mode unavailable, sampling with analogRead()");
+  }
+  lastPolledUs = micros();
+}
+
+void updateAdcSampler() {
+  if (!continuous) {
+    const uint32_t now = micros();
+    if (now - lastPolledUs < kAdcFrameUs) {
+      return;
+    }
+    lastPolledUs = now;
+    for (uint8_t i = 0; i < kAdcChannelCount; ++i) {
+      pushSample(rings[i], analogRead(kChannelPins[i]), static_cast<uint16_t>(analogReadMilliVolts(kChannelPins[i])));
+    }
+    return;
+  }
+  uint32_t pending = framesReady.exchange(0, std::memory_order_relaxed);
+  if (pending > kDmaPoolFrames) {
+    pending = kDmaPoolFrames;
+  }
+  adc_continuous_data_t* results = nullptr;
+  while (pending-- > 0 && analogContinuousRead(&results, 0)) {
+    pushFrame(results);
+  }
+}
+
+AdcReading adcSamplerFiltered(AdcChannel channel) {
+  const ChannelRing& r = ring(channel);
+  if (r.fill == 0) {
+    return AdcReading{0, 0};
+  }
+  return AdcReading{static_cast<uint16_t>((r.rawSum + r.fill / 2) / r.fill),
+                    static_cast<uint16_t>((r.millivoltSum + r.fill / 2) / r.fill)};
+}
+
+AdcReading adcSamplerLatest(AdcChannel channel) {
+  const ChannelRing& r = ring(channel);
+  if (r.fill == 0) {
+    return AdcReading{0, 0};
+  }
+  const uint8_t last = static_cast<uint8_t>((r.head + r.window - 1) % r.window);
+  return AdcReading{r.raw[last], r.millivolts[last]};
+}
+
+bool adcSamplerReady(AdcChannel channel) {
+  const ChannelRing& r = ring(channel);
+  return r.window != 0 && r.fill == r.window;
+}
@@ -0,0 +1,49 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <stdint.h>
+
+/** Analog inputs converted by the continuous ADC; a new sensor (e.g. motor current) adds a channel here. */
+enum class AdcChannel : uint8_t {
+  Battery = 0,
+  Thermistor,
+#if defined(NTC2_ADC_PIN)
+  Thermistor2,  // optional second NTC (temperature.h)
+#endif
+  Count
+};
+
+constexpr uint8_t kAdcChannelCount = static_cast<uint8_t>(AdcChannel::Count);
+
+/**
+ * One DMA frame every 2 ms carries 16 conversions per channel. The filtered value averages 20 ms for the
+ * battery (undervoltage cutoff latency) and 100 ms for the thermistor.
+ */
+constexpr uint32_t kAdcFrameUs = 2000;
+constexpr uint8_t kAdcConversionsPerFrame = 16;
+constexpr uint8_t kAdcFilterFramesMax = 50;
+
+struct AdcReading {
+  uint16_t raw;         // 12-bit code
+  uint16_t millivolts;  // eFuse-calibrated pin voltage
+};
+
+/**
+ * Start continuous (DMA) sampling of all channels at a fixed rate. Falls back to one analogRead()
+ * per channel and frame if the driver cannot be started.
+ */
+void initAdcSampler();
+
+/** Move finished frames into the per-channel rings (control tick; never waits for the ADC). */
+void updateAdcSampler();
+
+/** Moving average over the channel's filter window. */
+AdcReading adcSamplerFiltered(AdcChannel channel);
+
+/** Newest frame only (high-rate streaming). */
+AdcReading adcSamplerLatest(AdcChannel channel);
+
+/** True once the channel's averaging window is full. */
+bool adcSamplerReady(AdcChannel channel);
+
+#endif  // ADC_SAMPLER_H
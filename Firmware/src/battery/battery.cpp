@@ -1,7 +1,6 @@
 #include <Arduino.h>
 #include "battery.h"
-
-#define VBAT_PIN 6
+#include "../adc_sampler/adc_sampler.h"
 
 // Hardware divider configuration
 const float VBAT_R_TOP = 330000.0f;  // 330k
@@ -19,19 +18,22 @@ float CAL_VMEAS2 = 35.280f;          // what your device "thinks" at 36.000 V
 float VBAT_CAL_SLOPE = 1.0f;
 float VBAT_CAL_OFFSET = 0.0f;
 
-// Sampling configuration
-const uint8_t N = 8;                 // Number of samples to average
-
 // State variables
 static float lastBatteryVoltage = 0.0f;
 static float lastBatteryVoltageRaw = 0.0f;
 static bool batteryReady = false;
 static unsigned long lastReadTime = 0;
-const unsigned long READ_INTERVAL = 100;  // Read every 100ms
+const unsigned long READ_INTERVAL = 100;  // Publish the 100 ms ADC average every 100 ms
+
+// Apply 2-point calibration, clamped for safety
+static float calibratedVoltage(float vmeas) {
+  float vcal = vmeas * VBAT_CAL_SLOPE + VBAT_CAL_OFFSET;
+  if (vcal < 0.0f) vcal = 0.0f;
+  if (vcal > 60.0f) vcal = 60.0f;
+  return vcal;
+}
 
 void initBattery() {
-  pinMode(VBAT_PIN, INPUT);
-  
   // Calculate calibration slope and offset
   VBAT_CAL_SLOPE = (CAL_VTRUE2 - CAL_VTRUE1) / (CAL_VMEAS2 - CAL_VMEAS1);
   VBAT_CAL_OFFSET = CAL_VTRUE1 - VBAT_CAL_SLOPE * CAL_VMEAS1;
@@ -49,30 +51,25 @@ void updateBattery() {
   
   lastReadTime = currentTime;
   
-  // Take N samples and average (using analogReadMilliVolts)
-  uint32_t mv = 0;
-  for (uint8_t i = 0; i < N; i++) {
-    mv += analogReadMilliVolts(VBAT_PIN);
+  if (!adcSamplerReady(AdcChannel::Battery)) {
+    return;
   }
-  
-  // Convert millivolts to volts at GPIO6
-  float vpin = (float)mv / (float)N / 1000.0f;
+
+  // Convert millivolts to volts at GPIO6 (ADC moving average, no conversions here)
+  float vpin = (float)adcSamplerFiltered(AdcChannel::Battery).millivolts / 1000.0f;
   
   // Calculate raw battery voltage from divider
   float vmeas = vpin * VBAT_SCALE;
   lastBatteryVoltageRaw = vmeas;
-  
-  // Apply 2-point calibration
-  float vcal = vmeas * VBAT_CAL_SLOPE + VBAT_CAL_OFFSET;
-  
-  // Clamp for safety
-  if (vcal < 0.0f) vcal = 0.0f;
-  if (vcal > 60.0f) vcal = 60.0f;
-  
-  lastBatteryVoltage = vcal;
+  lastBatteryVoltage = calibratedVoltage(vmeas);
   batteryReady = true;
 }
 
+float readBatteryVoltageNow() {
+  const float vpin = (float)adcSamplerLatest(AdcChannel::Battery).millivolts / 1000.0f;
+  return calibratedVoltage(vpin * VBAT_SCALE);
+}
+
 float getBatteryVoltage() {
   return lastBatteryVoltage;
 }
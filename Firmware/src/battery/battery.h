@@ -13,6 +13,9 @@ float getBatteryVoltage();
 // Get raw measured voltage (before calibration)
 float getBatteryVoltageRaw();
 
+// Newest 2 ms ADC frame, calibrated (for high-rate streaming; the 100 ms value is unaffected)
+float readBatteryVoltageNow();
+
 // Check if battery voltage is ready (has been read at least once)
 bool isBatteryReady();
 
@@ -0,0 +1,123 @@
+// NTC conversion check and benchmark (env:native-ntc-bench). Compares every 12-bit code of each
+// built-in channel table against the model evaluated with libm in double precision, then times the
+// table lookup against the per-sample logf Beta equation it replaced. Exits non-zero when a table
+// deviates by more than kMaxErrorC inside kCheckMinC..kCheckMaxC, so it doubles as a host test.
+#if defined(OSHVAC_NTC_BENCH)
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "native_hal.h"
+#include "../temperature/temperature.h"
+
+namespace {
+
+constexpr uint32_t kDefaultIterations = 20000000;
+constexpr double kMaxErrorC = 0.01;  // centi-degree rounding is 0.005
+constexpr double kCheckMinC = -40.0;
+constexpr double kCheckMaxC = 200.0;
+
+const char* const kChannelNames[kNtcChannelCount] = {"motor", "aux"};
+
+// The conversion temperature.cpp ran before the table (float, one logf per sample).
+constexpr float kSeriesR = 10000.0f;
+constexpr float kR0 = 10000.0f;
+constexpr float kT0K = 298.15f;
+constexpr float kBeta = 3950.0f;
+
+float betaLogf(uint16_t adc) {
+  if (adc < 1) {
+    adc = 1;
+  }
+  if (adc >= kNtcAdcMax) {
+    adc = kNtcAdcMax - 1;
+  }
+  const float rth = kSeriesR * (static_cast<float>(kNtcAdcMax - adc) / static_cast<float>(adc));
+  return 1.0f / (1.0f / kT0K + (1.0f / kBeta) * logf(rth / kR0)) - 273.15f;
+}
+
+/** Largest |table - model| over the checked range; false if the channel is not built in. */
+bool checkChannel(NtcChannel channel, double& maxErrorC, uint16_t& worstAdc, uint32_t& codesChecked) {
+  if (ntcCentiFromAdc(channel, 2048) == INT16_MIN) {
+    return false;
+  }
+  const NtcModel& model = ntcChannelModel(channel);
+  maxErrorC = 0.0;
+  worstAdc = 0;
+  codesChecked = 0;
+  for (uint32_t adc = 0; adc <= kNtcAdcMax; ++adc) {
+    const double exact = ntcCelsiusFromLnOhms(model, log(ntcOhms(model, static_cast<uint16_t>(adc))));
+    if (exact < kCheckMinC || exact > kCheckMaxC) {
+      continue;
+    }
+    const double error = fabs(ntcCentiFromAdc(channel, static_cast<uint16_t>(adc)) / 100.0 - exact);
+    ++codesChecked;
+    if (error > maxErrorC) {
+      maxErrorC = error;
+      worstAdc = static_cast<uint16_t>(adc);
+    }
+  }
+  return true;
+}
+
+// Codes vary per iteration (as the filtered ADC value does) and the sum keeps the work observable.
+template <typename Convert>
+double nsPerConversion(uint32_t iterations, Convert convert, double& sink) {
+  const auto start = std::chrono::steady_clock::now();
+  uint32_t code = 1234;
+  double sum = 0.0;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    code = (code * 1103515245u + 12345u) & kNtcAdcMax;
+    sum += convert(static_cast<uint16_t>(code));
+  }
+  const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  sink += sum;
+  return wallS * 1e9 / iterations;
+}
+
+}  // namespace
+
+int nativeHalMain(int argc, char** argv) {
+  uint32_t iterations = kDefaultIterations;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--iterations=", 13) == 0) {
+      iterations = static_cast<uint32_t>(strtoul(argv[i] + 13, nullptr, 10));
+    } else {
+      printf("usage: firmware [--iterations=N]\n");
+      return 2;
+    }
+  }
+  if (iterations == 0) {
+    iterations = 1;
+  }
+
+  bool ok = true;
+  printf("%-6s %6s %12s %10s\n", "ntc", "codes", "max err C", "at code");
+  for (uint8_t i = 0; i < kNtcChannelCount; ++i) {
+    double maxErrorC = 0.0;
+    uint16_t worstAdc = 0;
+    uint32_t codes = 0;
+    if (!checkChannel(static_cast<NtcChannel>(i), maxErrorC, worstAdc, codes)) {
+      printf("%-6s %6s\n", kChannelNames[i], "off");
+      continue;
+    }
+    const bool pass = maxErrorC <= kMaxErrorC;
+    ok = ok && pass;
+    printf("%-6s %6lu %12.4f %10u %s\n", kChannelNames[i], static_cast<unsigned long>(codes), maxErrorC, worstAdc,
+           pass ? "ok" : "FAIL");
+  }
+
+  double sink = 0.0;
+  const double tableNs =
+      nsPerConversion(iterations, [](uint16_t adc) { return ntcCentiFromAdc(NtcChannel::Motor, adc) / 100.0f; }, sink);
+  const double logfNs = nsPerConversion(iterations, betaLogf, sink);
+  printf("[bench] %lu conversions: table %.2f ns, logf Beta %.2f ns (checksum %.0f)\n",
+         static_cast<unsigned long>(iterations), tableNs, logfNs, sink);
+  return ok ? 0 : 1;
+}
+
+#endif  // OSHVAC_NTC_BENCH
@@ -0,0 +1,160 @@
+// Command-path benchmark (env:native-bench). Boots the firmware on the host HAL, parks the tasks and
+// feeds typical link commands straight into deviceProtocolHandleJson(): commands per wall-clock
+// second, heap allocations per command (global new/delete counters), peak stack of one call,
+// measured on a painted thread stack, and the NVS bytes one call ends up writing once the firmware
+// has had time to store it. Only the public protocol API and the host HAL are used, so the same
+// file can be dropped into an older tree to compare dispatchers.
+#if defined(OSHVAC_PROTOCOL_BENCH)
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#if defined(__unix__)
+#include <pthread.h>
+#define OSHVAC_BENCH_STACK 1
+#endif
+
+#include <Preferences.h>
+
+#include "native_hal.h"
+#include "../device_protocol/device_protocol.h"
+#include "../settings/settings.h"
+
+void setup();
+
+namespace {
+
+constexpr uint32_t kDefaultIterations = 20000;
+constexpr size_t kPaintedStackSize = 256 * 1024;
+constexpr uint8_t kStackPaint = 0xCD;
+// Long enough for a queued settings write to come due (kSettingsWriteQuietMs plus a few ticks).
+constexpr uint64_t kNvsSettleUs = 1500000;
+
+struct BenchCommand {
+  const char* name;
+  char json[160];
+};
+
+struct StackProbe {
+  const char* json;
+  size_t len;
+};
+
+size_t commandLength(const BenchCommand& c) {
+  return strlen(c.json);
+}
+
+#if defined(OSHVAC_BENCH_STACK)
+void* runProbe(void* arg) {
+  const StackProbe* probe = static_cast<const StackProbe*>(arg);
+  DeviceCommandResult result = deviceProtocolHandleJson(probe->json, probe->len);
+  (void)result;
+  return nullptr;
+}
+
+/** Bytes of a fresh thread stack that one command call dirtied (includes thread start-up). */
+size_t peakStackBytes(const BenchCommand& c) {
+  uint8_t* stack = static_cast<uint8_t*>(aligned_alloc(4096, kPaintedStackSize));
+  if (stack == nullptr) {
+    return 0;
+  }
+  memset(stack, kStackPaint, kPaintedStackSize);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, stack, kPaintedStackSize);
+  StackProbe probe = {c.json, commandLength(c)};
+  pthread_t thread;
+  size_t used = 0;
+  if (pthread_create(&thread, &attr, runProbe, &probe) == 0) {
+    pthread_join(thread, nullptr);
+    size_t untouched = 0;
+    while (untouched < kPaintedStackSize && stack[untouched] == kStackPaint) {
+      ++untouched;
+    }
+    used = kPaintedStackSize - untouched;
+  }
+  pthread_attr_destroy(&attr);
+  free(stack);
+  return used;
+}
+#else
+size_t peakStackBytes(const BenchCommand&) {
+  return 0;
+}
+#endif
+
+/** Flash bytes written because of one call, counting writes the firmware defers until it is idle. */
+uint64_t nvsBytesForOneCall(const BenchCommand& c) {
+  const uint64_t before = nativeNvsStats().bytesWritten;
+  DeviceCommandResult result = deviceProtocolHandleJson(c.json, commandLength(c));
+  (void)result;
+  nativeHalRunFor(kNvsSettleUs);
+  return nativeNvsStats().bytesWritten - before;
+}
+
+void runCommand(const BenchCommand& c, uint32_t iterations) {
+  const size_t len = commandLength(c);
+  const uint64_t nvsBytes = nvsBytesForOneCall(c);
+  const NativeHalHeapStats before = nativeHalHeapStats();
+  const auto start = std::chrono::steady_clock::now();
+  size_t replies = 0;
+  for (uint32_t i = 0; i < iterations; ++i) {
+    DeviceCommandResult result = deviceProtocolHandleJson(c.json, len);
+    replies += result.hasUnicast ? 1 : 0;
+  }
+  const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const NativeHalHeapStats after = nativeHalHeapStats();
+  const double allocs = static_cast<double>(after.allocCount - before.allocCount) / iterations;
+  printf("%-16s %10.0f %11.2f %9u %6s %7llu\n", c.name, wallS > 0.0 ? iterations / wallS : 0.0, allocs,
+         static_cast<unsigned>(peakStackBytes(c)), replies > 0 ? "yes" : "no",
+         static_cast<unsigned long long>(nvsBytes));
+}
+
+}  // namespace
+
+int nativeHalMain(int argc, char** argv) {
+  uint32_t iterations = kDefaultIterations;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--iterations=", 13) == 0) {
+      iterations = static_cast<uint32_t>(strtoul(argv[i] + 13, nullptr, 10));
+    } else if (strcmp(argv[i], "--echo") == 0) {
+      nativeHalSetSerialEcho(true);
+    } else {
+      printf("usage: firmware [--iterations=N] [--echo]\n");
+      return 2;
+    }
+  }
+  if (iterations == 0) {
+    iterations = 1;
+  }
+
+  setup();
+  nativeHalRunFor(500000 + kNvsSettleUs);  // boot, plus any NVS writes it queued
+
+  BenchCommand commands[] = {
+      {"heartbeat", "{\"command\":\"heartbeat\"}"},
+      {"speed", "{\"speed\":40}"},
+      {"set_format", "{\"command\":\"set_format\",\"format\":\"json\",\"interval_ms\":250}"},
+      {"subscribe", "{\"command\":\"subscribe\",\"topics\":{\"telemetry\":4,\"settings\":0,\"notify\":0}}"},
+      {"get_settings/304", ""},
+      {"stream_stop", "{\"command\":\"stream_stop\"}"},
+      {"unknown", "{\"command\":\"no_such_command\"}"},
+      {"set_setting", "{\"command\":\"set_setting\",\"key\":\"led_dim\",\"value\":8}"},
+      {"set_settings/3", "{\"command\":\"set_settings\",\"values\":{\"auto_off\":10,\"temp_lim\":55,\"spd_step\":25}}"},
+  };
+  snprintf(commands[4].json, sizeof(commands[4].json), "{\"command\":\"get_settings\",\"if_version\":%lu}",
+           static_cast<unsigned long>(runtimeSettingsVersion()));
+
+  printf("[bench] %lu iterations per command\n", static_cast<unsigned long>(iterations));
+  printf("%-16s %10s %11s %9s %6s %7s\n", "command", "cmds/s", "allocs/cmd", "stack B", "reply", "nvs B");
+  for (const BenchCommand& c : commands) {
+    runCommand(c, iterations);
+  }
+  return 0;
+}
+
+#endif  // OSHVAC_PROTOCOL_BENCH
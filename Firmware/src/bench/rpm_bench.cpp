@@ -0,0 +1,278 @@
+// Constant-RPM controller bench (env:native-rpm-bench). Boots the firmware on the host HAL with the
+// generic PWM driver in spd_ctl = RPM and closes the loop through a DC motor model: LEDC duty on
+// GPIO5 in, FG pulses on GPIO16 and pack voltage on the battery divider out. Runs speed steps, a pack
+// sag and a load step, prints rise time, overshoot and settling time per case and exits non-zero when
+// a case misses its limits, so it doubles as a host test. --duty runs the same cases open loop.
+#if defined(OSHVAC_RPM_BENCH)
+
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "native_hal.h"
+#include "../device_protocol/device_protocol.h"
+
+void setup();
+
+namespace {
+
+// Wiring; mirrors motor_generic_pwm.cpp, tachometer.cpp and battery.cpp (see also src/sim/sim.cpp).
+constexpr uint8_t kPwmPin = 5;
+constexpr uint8_t kFgPin = 16;
+constexpr uint8_t kVbatPin = 6;
+constexpr float kVbatScale = 16.0f;
+constexpr float kVbatCalSlope = (36.0f - 12.0f) / (35.28f - 11.64f);
+constexpr float kVbatCalOffset = 12.0f - kVbatCalSlope * 11.64f;
+
+constexpr uint8_t kCells = 5;
+constexpr uint8_t kRpmAtMaxK = 30;
+constexpr float kPackV = 18.5f;
+constexpr uint32_t kSettleBeforeMs = 2500;  // pre-step state reached before each case
+constexpr uint32_t kCaseMs = 3000;
+constexpr float kBand = 0.02f;            // settling band, fraction of the target
+constexpr uint32_t kFinalWindowMs = 300;  // steady-state error is averaged over the case's tail
+
+// Pass limits (closed loop only).
+constexpr float kMaxOvershoot = 0.10f;  // fraction of the speed step
+constexpr uint32_t kMaxSettleMs = 1000;
+constexpr float kMaxFinalError = 0.01f;
+
+/**
+ * Brushed/BLDC motor with a fan load: the rotor approaches kv * duty * pack volts with time constant
+ * tau, minus a drag that grows with RPM² (load RPM lost at kLoadRefRpm).
+ */
+struct MotorModel {
+  float kvRpmPerV = 2000.0f;
+  float tauS = 0.15f;
+  float load = 0.2f;
+  float packV = kPackV;
+  float rpm = 0.0f;
+};
+constexpr float kLoadRefRpm = 30000.0f;
+
+struct BenchCase {
+  const char* name;
+  uint8_t speedBefore;  // 0 = case starts the motor from rest
+  uint8_t speedAfter;
+  float packBeforeV;
+  float packAfterV;
+  uint32_t packRampMs;
+  float loadAfter;  // multiple of the model's load
+};
+
+const BenchCase kCases[] = {
+    {"start 0->60%", 0, 60, kPackV, kPackV, 0, 1.0f},
+    {"step 60->80%", 60, 80, kPackV, kPackV, 0, 1.0f},
+    {"step 80->40%", 80, 40, kPackV, kPackV, 0, 1.0f},
+    {"sag 18.5->16V", 60, 60, kPackV, 16.0f, 500, 1.0f},
+    {"load +50%", 60, 60, kPackV, kPackV, 0, 1.5f},
+    // 100 % is out of reach at 16 V: the output saturates for the whole lead-in (anti-windup).
+    {"windup 100->60%", 100, 60, 16.0f, 16.0f, 0, 1.0f},
+};
+
+struct Sample {
+  uint32_t tMs;
+  float rpm;
+  float duty;
+};
+
+struct Plant {
+  MotorModel model;
+  MotorModel base;
+  uint64_t lastUs;
+  // Case timeline (absolute virtual us); pack ramps linearly from rampFromV at rampStartUs.
+  uint64_t eventUs;
+  float rampFromV;
+  float rampToV;
+  uint32_t rampMs;
+  bool recording;
+  std::vector<Sample> samples;
+};
+
+Plant plant;
+
+uint32_t vbatMillivolts(float packV) {
+  const float vmeas = (packV - kVbatCalOffset) / kVbatCalSlope;
+  const float mv = vmeas / kVbatScale * 1000.0f;
+  return mv > 0.0f ? static_cast<uint32_t>(lroundf(mv)) : 0;
+}
+
+float pwmDuty() {
+  return nativeHalLedcAttached(kPwmPin) ? static_cast<float>(nativeHalLedcDuty(kPwmPin)) / 255.0f : 0.0f;
+}
+
+void onTick(uint64_t nowUs, void*) {
+  if (nowUs <= plant.lastUs) {
+    return;
+  }
+  MotorModel& m = plant.model;
+  if (plant.rampMs > 0 && nowUs >= plant.eventUs) {
+    const float f = fminf(1.0f, static_cast<float>(nowUs - plant.eventUs) / (plant.rampMs * 1000.0f));
+    m.packV = plant.rampFromV + (plant.rampToV - plant.rampFromV) * f;
+  }
+  const float duty = pwmDuty();
+  const float dtS = static_cast<float>(nowUs - plant.lastUs) / 1e6f;
+  const float drive = m.kvRpmPerV * m.packV * duty;
+  const float drag = m.load * m.rpm * m.rpm / kLoadRefRpm;
+  m.rpm += (drive - m.rpm - drag) * fminf(1.0f, dtS / m.tauS);
+  if (m.rpm < 0.0f) {
+    m.rpm = 0.0f;
+  }
+  plant.lastUs = nowUs;
+
+  nativeHalSetAnalogMillivolts(kVbatPin, vbatMillivolts(m.packV));
+  nativeHalSetPulseFrequency(kFgPin, m.rpm / 60.0f);
+  if (plant.recording && nowUs >= plant.eventUs) {
+    plant.samples.push_back(Sample{static_cast<uint32_t>((nowUs - plant.eventUs) / 1000ULL), m.rpm, duty});
+  }
+}
+
+void sendCommand(const char* json) {
+  DeviceCommandResult result = deviceProtocolHandleJson(json, strlen(json));
+  (void)result;
+}
+
+void setSpeed(uint8_t pct) {
+  char json[32];
+  snprintf(json, sizeof(json), "{\"speed\":%u}", static_cast<unsigned>(pct));
+  sendCommand(json);
+}
+
+struct CaseResult {
+  float targetRpm;
+  float riseMs;  // 10–90 % of a speed step, < 0 if not a step or never reached
+  float overshoot;
+  uint32_t settleMs;
+  float finalError;
+  bool pass;
+};
+
+CaseResult analyse(const BenchCase& c, float startRpm, bool closedLoop) {
+  CaseResult r = {};
+  r.targetRpm = kRpmAtMaxK * 1000.0f * c.speedAfter / 100.0f;
+  const float step = r.targetRpm - startRpm;
+  const bool isStep = c.speedBefore != c.speedAfter;
+  const float dir = step >= 0.0f ? 1.0f : -1.0f;
+  int32_t t10 = -1;
+  int32_t t90 = -1;
+  float peak = 0.0f;
+  double tailSum = 0.0;
+  uint32_t tailN = 0;
+  for (const Sample& s : plant.samples) {
+    const float progress = fabsf(step) > 1.0f ? (s.rpm - startRpm) / step : 1.0f;
+    if (t10 < 0 && progress >= 0.1f) t10 = static_cast<int32_t>(s.tMs);
+    if (t90 < 0 && progress >= 0.9f) t90 = static_cast<int32_t>(s.tMs);
+    const float beyond = isStep ? dir * (s.rpm - r.targetRpm) / fabsf(step) : fabsf(s.rpm - r.targetRpm) / r.targetRpm;
+    peak = fmaxf(peak, beyond);
+    if (fabsf(s.rpm - r.targetRpm) > kBand * r.targetRpm) {
+      r.settleMs = s.tMs;
+    }
+    if (s.tMs + kFinalWindowMs >= kCaseMs) {
+      tailSum += s.rpm;
+      ++tailN;
+    }
+  }
+  r.riseMs = isStep && t10 >= 0 && t90 >= 0 ? static_cast<float>(t90 - t10) : -1.0f;
+  r.overshoot = peak;
+  r.finalError = tailN ? static_cast<float>(tailSum / tailN - r.targetRpm) / r.targetRpm : 1.0f;
+  r.pass = !closedLoop || ((!isStep || r.overshoot <= kMaxOvershoot) && r.settleMs <= kMaxSettleMs &&
+                           fabsf(r.finalError) <= kMaxFinalError);
+  return r;
+}
+
+CaseResult runCase(const BenchCase& c, bool closedLoop) {
+  plant.model.load = plant.base.load;
+  plant.model.packV = c.packBeforeV;
+  plant.rampMs = 0;
+  plant.recording = false;
+  if (c.speedBefore == 0) {
+    sendCommand("{\"command\":\"motor_stop\"}");
+    setSpeed(c.speedAfter);
+  } else {
+    setSpeed(c.speedBefore);
+    sendCommand("{\"command\":\"motor_start\"}");
+  }
+  nativeHalRunFor(static_cast<uint64_t>(kSettleBeforeMs) * 1000ULL);
+
+  const float startRpm = plant.model.rpm;
+  plant.samples.clear();
+  plant.eventUs = nativeHalNowUs();
+  plant.recording = true;
+  plant.model.load = plant.base.load * c.loadAfter;
+  if (c.packRampMs > 0) {
+    plant.rampFromV = plant.model.packV;
+    plant.rampToV = c.packAfterV;
+    plant.rampMs = c.packRampMs;
+  }
+  if (c.speedBefore == 0) {
+    sendCommand("{\"command\":\"motor_start\"}");
+  } else if (c.speedAfter != c.speedBefore) {
+    setSpeed(c.speedAfter);
+  }
+  nativeHalRunFor(static_cast<uint64_t>(kCaseMs) * 1000ULL);
+  plant.recording = false;
+  return analyse(c, startRpm, closedLoop);
+}
+
+void printUsage() {
+  printf("usage: firmware [--duty] [--kv=RPM_PER_V] [--tau-ms=N] [--load=F] [--echo]\n");
+}
+
+}  // namespace
+
+int nativeHalMain(int argc, char** argv) {
+  bool closedLoop = true;
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    if (strcmp(a, "--duty") == 0) {
+      closedLoop = false;
+    } else if (strncmp(a, "--kv=", 5) == 0) {
+      plant.base.kvRpmPerV = strtof(a + 5, nullptr);
+    } else if (strncmp(a, "--tau-ms=", 9) == 0) {
+      plant.base.tauS = strtof(a + 9, nullptr) / 1000.0f;
+    } else if (strncmp(a, "--load=", 7) == 0) {
+      plant.base.load = strtof(a + 7, nullptr);
+    } else if (strcmp(a, "--echo") == 0) {
+      nativeHalSetSerialEcho(true);
+    } else {
+      printUsage();
+      return 2;
+    }
+  }
+  plant.model = plant.base;
+
+  nativeHalSetAnalogMillivolts(kVbatPin, vbatMillivolts(kPackV));
+  setup();
+  nativeHalSetTickHook(onTick, nullptr);
+  char settings[192];
+  snprintf(settings, sizeof(settings),
+           "{\"command\":\"set_settings\",\"values\":{\"mtr_type\":0,\"spd_ctl\":%u,\"rpm_max\":%u,\"bat_cells\":%u,"
+           "\"tach_ppr\":1,\"min_duty\":0,\"max_duty\":100,\"auto_off\":0,\"temp_lim\":0}}",
+           closedLoop ? 1U : 0U, static_cast<unsigned>(kRpmAtMaxK), static_cast<unsigned>(kCells));
+  sendCommand(settings);
+  nativeHalRunFor(500000);
+
+  printf("[bench] %s, motor kv %.0f RPM/V, tau %.0f ms, load %.2f, %uS %.1f V, rpm_max %uk\n",
+         closedLoop ? "constant RPM" : "open-loop duty", static_cast<double>(plant.base.kvRpmPerV),
+         static_cast<double>(plant.base.tauS * 1000.0f), static_cast<double>(plant.base.load),
+         static_cast<unsigned>(kCells), static_cast<double>(kPackV), static_cast<unsigned>(kRpmAtMaxK));
+  printf("%-16s %8s %8s %10s %10s %10s\n", "case", "target", "rise ms", "overshoot", "settle ms", "final err");
+  bool ok = true;
+  for (const BenchCase& c : kCases) {
+    const CaseResult r = runCase(c, closedLoop);
+    ok = ok && r.pass;
+    char rise[16];
+    snprintf(rise, sizeof(rise), r.riseMs >= 0.0f ? "%.0f" : "-", static_cast<double>(r.riseMs));
+    printf("%-16s %8.0f %8s %9.1f%% %10u %9.2f%% %s\n", c.name, static_cast<double>(r.targetRpm), rise,
+           static_cast<double>(r.overshoot * 100.0f), static_cast<unsigned>(r.settleMs),
+           static_cast<double>(r.finalError * 100.0f), r.pass ? (closedLoop ? "ok" : "") : "FAIL");
+  }
+  nativeHalSetTickHook(nullptr, nullptr);
+  return ok ? 0 : 1;
+}
+
+#endif  // OSHVAC_RPM_BENCH
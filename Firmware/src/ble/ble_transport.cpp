@@ -4,6 +4,9 @@
 #include <NimBLEDevice.h>
 #include <string.h>
 
+#include <atomic>
+
+#include "../device_link/device_link.h"
 #include "../device_protocol/device_protocol.h"
 
 namespace {
@@ -18,14 +21,31 @@ constexpr uint16_t kPreferredMtu = 517;
 constexpr size_t kMinAttPayload = 20;
 constexpr size_t kMinChunkPayload = 16;
 constexpr size_t kMaxPacketBuf = 520;
-constexpr unsigned long kFragIntervalMs = 35;
-constexpr uint8_t kMaxNotifyAttempts = 10;
+// TX window: notifications handed to NimBLE and not yet reported by onStatus(). It grows by one
+// after a full window of accepted notifies and shrinks to what is in flight when notify() finds no
+// free buffer; the fragment is then retried after an exponential backoff instead of a delay().
+constexpr uint8_t kTxWindowStart = 4;
+constexpr uint8_t kTxWindowMax = 12;
+constexpr uint8_t kTxBackoffMinMs = 2;
+constexpr uint8_t kTxBackoffMaxMs = 64;
+// ~2 s of backed-off retries before a payload is abandoned (link stalled or central gone).
+constexpr uint8_t kTxMaxConsecutiveRejects = 40;
+// Credits whose onStatus() never arrives (e.g. across a link loss) are reclaimed after this.
+constexpr uint32_t kTxStatusTimeoutMs = 250;
 // Even when a large ATT MTU is negotiated, some central stacks (notably macOS
 // Core Bluetooth) silently drop notifications above ~180 bytes and deliver an
 // empty event instead. Cap every notification well under that ceiling so large
 // payloads (settings schema) reassemble reliably across platforms.
 constexpr size_t kSafeNotifyPayload = 160;
 
+// Outgoing JSON queues, sized for the largest message of each class (settings schema for bulk).
+constexpr uint8_t kControlSlots = 8;
+constexpr size_t kControlSlotSize = 256;
+constexpr uint8_t kTelemetrySlots = 2;
+constexpr size_t kTelemetrySlotSize = 384;
+constexpr uint8_t kBulkSlots = 2;
+constexpr size_t kBulkSlotSize = 8192;
+
 NimBLEServer* bleServer = nullptr;
 NimBLECharacteristic* txCharacteristic = nullptr;
 bool bleInitialized = false;
@@ -36,15 +56,89 @@ uint16_t peerMtu = 23;
 char rxBuffer[kRxBufferSize];
 size_t rxLength = 0;
 
-String activeTxJson;
-String pendingTxJson;
-String pendingRxLine;
-bool pendingRxReady = false;
+// Preallocated FIFO of JSON messages; the one being fragmented stays at the head until it is done.
+template <uint8_t kSlots, size_t kSize>
+struct TxRing {
+  char data[kSlots][kSize];
+  uint16_t length[kSlots];
+  uint8_t head;
+  uint8_t count;
+
+  bool full() const { return count == kSlots; }
+  const char* front() const { return data[head]; }
+  size_t frontLength() const { return length[head]; }
+
+  bool push(const char* json, size_t len) {
+    if (count == kSlots || len > kSize) {
+      return false;
+    }
+    const uint8_t tail = static_cast<uint8_t>((head + count) % kSlots);
+    memcpy(data[tail], json, len);
+    length[tail] = static_cast<uint16_t>(len);
+    ++count;
+    return true;
+  }
+
+  void pop() {
+    if (count > 0) {
+      head = static_cast<uint8_t>((head + 1) % kSlots);
+      --count;
+    }
+  }
+
+  // Drops everything after the first `keep` entries.
+  void truncate(uint8_t keep) {
+    if (count > keep) {
+      count = keep;
+    }
+  }
+
+  void clear() {
+    head = 0;
+    count = 0;
+  }
+};
+
+TxRing<kControlSlots, kControlSlotSize> controlQueue;
+TxRing<kTelemetrySlots, kTelemetrySlotSize> telemetryQueue;
+TxRing<kBulkSlots, kBulkSlotSize> bulkQueue;
+LinkTxClass txActiveClass = LinkTxClass::Control;
+
+// Complete RX lines handed from the NimBLE host task (producer) to the I/O task (consumer).
+constexpr uint8_t kRxLineSlots = 8;
+static_assert((kRxLineSlots & (kRxLineSlots - 1)) == 0, "uint8_t head/tail wrap needs a power of two");
+char rxLines[kRxLineSlots][kRxBufferSize];
+std::atomic<uint8_t> rxLineHead{0};
+std::atomic<uint8_t> rxLineTail{0};
 bool txInProgress = false;
 uint8_t txFragIndex = 0;
 uint8_t txTotalFrags = 0;
 size_t txChunkPayload = kMinChunkPayload;
-unsigned long txLastFragMs = 0;
+
+enum class TxAttempt : uint8_t { Sent, Busy, Failed };
+
+std::atomic<uint8_t> txInFlight{0};
+std::atomic<uint32_t> txLastStatusMs{0};
+std::atomic<uint32_t> txStatusErrors{0};
+uint8_t txWindow = kTxWindowStart;
+uint8_t txCleanSends = 0;
+uint8_t txBackoffMs = 0;
+uint8_t txConsecutiveRejects = 0;
+uint32_t txRetryAtMs = 0;
+uint32_t txLastSendMs = 0;
+uint32_t txPayloadStartMs = 0;
+BleTxStats txStats = {};
+
+void resetTxWindow() {
+  txInFlight.store(0);
+  txStatusErrors.store(0);
+  txWindow = kTxWindowStart;
+  txCleanSends = 0;
+  txBackoffMs = 0;
+  txConsecutiveRejects = 0;
+  txRetryAtMs = 0;
+  txStats = {};
+}
 
 size_t attPayloadMax() {
   const size_t mtu = peerMtu > 3 ? static_cast<size_t>(peerMtu - 3) : kMinAttPayload;
@@ -79,80 +173,157 @@ void configureTxFraming(size_t totalLen) {
   txTotalFrags = static_cast<uint8_t>(frags > 255 ? 255 : frags);
 }
 
-bool notifyPacket(const uint8_t* data, size_t len) {
+TxAttempt notifyPacket(const uint8_t* data, size_t len) {
   if (!txCharacteristic || !clientConnected || len == 0 || len > notifyPayloadMax()) {
-    return false;
+    return TxAttempt::Failed;
   }
-  for (uint8_t attempt = 0; attempt < kMaxNotifyAttempts; ++attempt) {
-    txCharacteristic->setValue(data, len);
-    if (txCharacteristic->notify()) {
-      return true;
+  const uint32_t now = millis();
+  uint8_t inFlight = txInFlight.load();
+  if (inFlight > 0 && (now - txLastSendMs) >= kTxStatusTimeoutMs &&
+      (now - txLastStatusMs.load()) >= kTxStatusTimeoutMs) {
+    txInFlight.store(0);
+    inFlight = 0;
+  }
+  if (inFlight >= txWindow || (txBackoffMs != 0 && static_cast<int32_t>(now - txRetryAtMs) < 0)) {
+    return TxAttempt::Busy;
+  }
+
+  txCharacteristic->setValue(data, len);
+  if (!txCharacteristic->notify()) {
+    // NimBLE is out of notify buffers: what is in flight is all this central drains per event.
+    txStats.retries++;
+    txWindow = inFlight > 0 ? inFlight : 1;
+    txCleanSends = 0;
+    txBackoffMs = txBackoffMs == 0 ? kTxBackoffMinMs
+                                   : (txBackoffMs >= kTxBackoffMaxMs / 2 ? kTxBackoffMaxMs : txBackoffMs * 2);
+    txRetryAtMs = now + txBackoffMs;
+    if (++txConsecutiveRejects >= kTxMaxConsecutiveRejects) {
+      txConsecutiveRejects = 0;
+      return TxAttempt::Failed;
     }
-    delay(5);
+    return TxAttempt::Busy;
+  }
+
+  txInFlight.fetch_add(1);
+  txLastSendMs = now;
+  txBackoffMs = 0;
+  txConsecutiveRejects = 0;
+  txStats.notifications++;
+  txStats.bytes += len;
+  if (++txCleanSends >= txWindow && txWindow < kTxWindowMax) {
+    txWindow++;
+    txCleanSends = 0;
+  }
+  return TxAttempt::Sent;
+}
+
+const char* activeTxData() {
+  switch (txActiveClass) {
+    case LinkTxClass::Control:
+      return controlQueue.front();
+    case LinkTxClass::Telemetry:
+      return telemetryQueue.front();
+    default:
+      return bulkQueue.front();
   }
-  return false;
 }
 
-void finishTx() {
-  Serial.printf("[BLE] TX done (%u bytes)\n", static_cast<unsigned>(activeTxJson.length()));
+size_t activeTxLength() {
+  switch (txActiveClass) {
+    case LinkTxClass::Control:
+      return controlQueue.frontLength();
+    case LinkTxClass::Telemetry:
+      return telemetryQueue.frontLength();
+    default:
+      return bulkQueue.frontLength();
+  }
+}
+
+void clearTxQueues() {
+  controlQueue.clear();
+  telemetryQueue.clear();
+  bulkQueue.clear();
   txInProgress = false;
-  activeTxJson = "";
   txFragIndex = 0;
   txTotalFrags = 0;
-  txChunkPayload = kMinChunkPayload;
-  txLastFragMs = 0;
-
-  if (pendingTxJson.length() > 0) {
-    String next = pendingTxJson;
-    pendingTxJson = "";
-    activeTxJson = next;
-    configureTxFraming(activeTxJson.length());
-    txInProgress = true;
-    txFragIndex = 0;
-    txLastFragMs = 0;
-    Serial.printf("[BLE] TX queued next (%u bytes, %u frags, mtu=%u)\n",
-                  static_cast<unsigned>(activeTxJson.length()), txTotalFrags, peerMtu);
+}
+
+void finishTx(bool completed) {
+  const uint32_t elapsedMs = millis() - txPayloadStartMs;
+  const uint32_t length = activeTxLength();
+  if (completed) {
+    txStats.payloads++;
+    txStats.lastPayloadBytes = length;
+    txStats.lastPayloadMs = elapsedMs;
+    const uint32_t bytesPerSec = length * 1000UL / (elapsedMs > 0 ? elapsedMs : 1);
+    if (txTotalFrags > 1 && bytesPerSec > txStats.bestBytesPerSec) {
+      txStats.bestBytesPerSec = bytesPerSec;
+    }
+    Serial.printf("[BLE] TX done (%u bytes, %u frags, %lu ms, window=%u, retries=%lu)\n", static_cast<unsigned>(length),
+                  txTotalFrags, static_cast<unsigned long>(elapsedMs), txWindow,
+                  static_cast<unsigned long>(txStats.retries));
+  } else {
+    txStats.aborted++;
+  }
+  switch (txActiveClass) {
+    case LinkTxClass::Control:
+      controlQueue.pop();
+      break;
+    case LinkTxClass::Telemetry:
+      telemetryQueue.pop();
+      break;
+    case LinkTxClass::Bulk:
+      bulkQueue.pop();
+      break;
   }
+  txInProgress = false;
+  txFragIndex = 0;
+  txTotalFrags = 0;
+  txChunkPayload = kMinChunkPayload;
 }
 
 void startPendingTx() {
-  if (!clientConnected || !mtuReady || txInProgress || pendingTxJson.length() == 0) {
+  if (!clientConnected || !mtuReady || txInProgress) {
+    return;
+  }
+  // Acks and notifies first, then the latest telemetry, then bulk payloads (settings, profile).
+  if (controlQueue.count > 0) {
+    txActiveClass = LinkTxClass::Control;
+  } else if (telemetryQueue.count > 0) {
+    txActiveClass = LinkTxClass::Telemetry;
+  } else if (bulkQueue.count > 0) {
+    txActiveClass = LinkTxClass::Bulk;
+  } else {
     return;
   }
 
-  activeTxJson = pendingTxJson;
-  pendingTxJson = "";
-  configureTxFraming(activeTxJson.length());
+  configureTxFraming(activeTxLength());
   txFragIndex = 0;
-  txLastFragMs = 0;
   txInProgress = true;
+  txPayloadStartMs = millis();
   Serial.printf("[BLE] TX start (%u bytes, %u frags, mtu=%u, chunk=%u)\n",
-                static_cast<unsigned>(activeTxJson.length()), txTotalFrags, peerMtu,
+                static_cast<unsigned>(activeTxLength()), txTotalFrags, peerMtu,
                 static_cast<unsigned>(txChunkPayload));
 }
 
-bool sendCurrentTxFragment() {
-  if (!txInProgress || activeTxJson.length() == 0) {
-    return false;
+TxAttempt sendCurrentTxFragment() {
+  if (!txInProgress) {
+    return TxAttempt::Failed;
   }
 
-  const size_t totalLen = activeTxJson.length();
-  const char* json = activeTxJson.c_str();
+  const size_t totalLen = activeTxLength();
+  const char* json = activeTxData();
 
   if (txTotalFrags == 1) {
-    if (!notifyPacket(reinterpret_cast<const uint8_t*>(json), totalLen)) {
+    const TxAttempt attempt = notifyPacket(reinterpret_cast<const uint8_t*>(json), totalLen);
+    if (attempt == TxAttempt::Failed) {
       Serial.printf("[BLE] WARN: single notify failed (len=%u mtu=%u)\n", static_cast<unsigned>(totalLen),
                     peerMtu);
-      finishTx();
-      return false;
     }
-    finishTx();
-    return true;
-  }
-
-  if (txFragIndex >= txTotalFrags) {
-    finishTx();
-    return true;
+    if (attempt != TxAttempt::Busy) {
+      finishTx(attempt == TxAttempt::Sent);
+    }
+    return attempt;
   }
 
   const size_t offset = static_cast<size_t>(txFragIndex) * txChunkPayload;
@@ -162,8 +333,8 @@ bool sendCurrentTxFragment() {
   uint8_t packet[kMaxPacketBuf];
   if (partLen + 4 > kMaxPacketBuf || partLen + 4 > notifyPayloadMax()) {
     Serial.println("[BLE] WARN: fragment exceeds notify payload");
-    finishTx();
-    return false;
+    finishTx(false);
+    return TxAttempt::Failed;
   }
 
   packet[0] = 'O';
@@ -172,19 +343,29 @@ bool sendCurrentTxFragment() {
   packet[3] = txTotalFrags;
   memcpy(packet + 4, json + offset, partLen);
 
-  if (!notifyPacket(packet, partLen + 4)) {
+  const TxAttempt attempt = notifyPacket(packet, partLen + 4);
+  if (attempt == TxAttempt::Failed) {
     Serial.printf("[BLE] WARN: fragment %u/%u failed (mtu=%u chunk=%u)\n", txFragIndex + 1, txTotalFrags, peerMtu,
                   static_cast<unsigned>(txChunkPayload));
-    finishTx();
-    return false;
+    finishTx(false);
+    return attempt;
+  }
+  if (attempt == TxAttempt::Sent && ++txFragIndex >= txTotalFrags) {
+    finishTx(true);
   }
+  return attempt;
+}
 
-  txFragIndex++;
-  txLastFragMs = millis();
-  if (txFragIndex >= txTotalFrags) {
-    finishTx();
+// Fill the window: every fragment NimBLE accepts this pass goes out in the next connection events.
+void pumpTx() {
+  while (clientConnected) {
+    if (!txInProgress) {
+      startPendingTx();
+    }
+    if (!txInProgress || sendCurrentTxFragment() != TxAttempt::Sent) {
+      return;
+    }
   }
-  return true;
 }
 
 class BleServerCallbacks : public NimBLEServerCallbacks {
@@ -192,6 +373,7 @@ class BleServerCallbacks : public NimBLEServerCallbacks {
     clientConnected = true;
     mtuReady = false;
     peerMtu = connInfo.getMTU();
+    resetTxWindow();
     Serial.printf("[BLE] Client connected (mtu=%u)\n", peerMtu);
   }
 
@@ -207,18 +389,27 @@ class BleServerCallbacks : public NimBLEServerCallbacks {
     mtuReady = false;
     peerMtu = 23;
     rxLength = 0;
-    txInProgress = false;
-    activeTxJson = "";
-    pendingTxJson = "";
-    pendingRxLine = "";
-    pendingRxReady = false;
-    txFragIndex = 0;
-    txTotalFrags = 0;
-    Serial.println("[BLE] Client disconnected");
+    Serial.printf("[BLE] Client disconnected (tx: %lu notifies, %lu bytes, %lu retries, best %lu B/s)\n",
+                  static_cast<unsigned long>(txStats.notifications), static_cast<unsigned long>(txStats.bytes),
+                  static_cast<unsigned long>(txStats.retries), static_cast<unsigned long>(txStats.bestBytesPerSec));
+    txInFlight.store(0);
     server->startAdvertising();
   }
 };
 
+class BleTxCallbacks : public NimBLECharacteristicCallbacks {
+  // NimBLE host task: one call per notification handed to the controller.
+  void onStatus(NimBLECharacteristic* /*characteristic*/, int code) override {
+    uint8_t inFlight = txInFlight.load();
+    while (inFlight > 0 && !txInFlight.compare_exchange_weak(inFlight, static_cast<uint8_t>(inFlight - 1))) {
+    }
+    txLastStatusMs.store(millis());
+    if (code != 0) {
+      txStatusErrors.fetch_add(1);
+    }
+  }
+};
+
 class BleRxCallbacks : public NimBLECharacteristicCallbacks {
   void onWrite(NimBLECharacteristic* characteristic, NimBLEConnInfo& /*connInfo*/) override {
     const std::string& value = characteristic->getValue();
@@ -237,8 +428,13 @@ class BleRxCallbacks : public NimBLECharacteristicCallbacks {
         rxBuffer[rxLength - 1] = '\0';
         if (rxLength > 1) {
           Serial.printf("[BLE] Received: %s\n", rxBuffer);
-          pendingRxLine = rxBuffer;
-          pendingRxReady = true;
+          const uint8_t tail = rxLineTail.load(std::memory_order_relaxed);
+          if (static_cast<uint8_t>(tail - rxLineHead.load(std::memory_order_acquire)) >= kRxLineSlots) {
+            Serial.println("[BLE] RX queue full, dropping command");
+          } else {
+            memcpy(rxLines[tail % kRxLineSlots], rxBuffer, rxLength);
+            rxLineTail.store(static_cast<uint8_t>(tail + 1), std::memory_order_release);
+          }
         }
         rxLength = 0;
       }
@@ -247,21 +443,24 @@ class BleRxCallbacks : public NimBLECharacteristicCallbacks {
 };
 
 BleServerCallbacks bleServerCallbacks;
+BleTxCallbacks bleTxCallbacks;
 BleRxCallbacks bleRxCallbacks;
 
 void processPendingBleRx() {
-  if (!pendingRxReady) {
+  const uint8_t head = rxLineHead.load(std::memory_order_relaxed);
+  if (head == rxLineTail.load(std::memory_order_acquire)) {
     return;
   }
-  pendingRxReady = false;
-  const String line = pendingRxLine;
-  pendingRxLine = "";
-
-  DeviceCommandResult result = deviceProtocolHandleJson(line.c_str(), line.length());
+  const char* line = rxLines[head % kRxLineSlots];
+  DeviceCommandResult result = deviceProtocolHandleJson(line, strlen(line));
+  rxLineHead.store(static_cast<uint8_t>(head + 1), std::memory_order_release);
   if (result.hasUnicast) {
-    Serial.printf("[BLE] Scheduling TX response (%u bytes)\n", static_cast<unsigned>(result.unicastJson.length()));
-    bleTransportSendJson(result.unicastJson.c_str());
+    Serial.printf("[BLE] Scheduling TX response (%u bytes)\n", static_cast<unsigned>(result.unicastLength()));
+    if (!bleTransportQueueJson(LinkTxClass::Control, result.unicastData(), result.unicastLength())) {
+      Serial.println("[BLE] WARN: TX queue full, response dropped");
+    }
   }
+  deviceLinkApplyCommandResult(kLinkClientBle, result);
   deviceProtocolAfterCommand(result);
 }
 }  // namespace
@@ -283,6 +482,7 @@ void initBleTransport() {
       service->createCharacteristic(kRxUuid, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR);
   rxCharacteristic->setCallbacks(&bleRxCallbacks);
   txCharacteristic = service->createCharacteristic(kTxUuid, NIMBLE_PROPERTY::NOTIFY);
+  txCharacteristic->setCallbacks(&bleTxCallbacks);
 
   service->start();
 
@@ -296,44 +496,91 @@ void initBleTransport() {
 }
 
 void updateBleTransport() {
-  processPendingBleRx();
-
+  // The host task only flags a disconnect; queued lines and messages are owned (and dropped) here.
   if (!clientConnected) {
+    rxLineHead.store(rxLineTail.load(std::memory_order_acquire), std::memory_order_release);
+    if (txInProgress || controlQueue.count > 0 || telemetryQueue.count > 0 || bulkQueue.count > 0) {
+      clearTxQueues();
+    }
     return;
   }
-
-  if (!txInProgress) {
-    startPendingTx();
-  }
-
-  if (!txInProgress) {
-    return;
-  }
-
-  if (txLastFragMs != 0 && (millis() - txLastFragMs) < kFragIntervalMs) {
-    return;
+  for (uint8_t i = 0; i < kRxLineSlots; ++i) {
+    processPendingBleRx();
   }
 
-  sendCurrentTxFragment();
+  pumpTx();
 }
 
-void bleTransportSendJson(const char* json) {
-  if (!clientConnected || json == nullptr || json[0] == '\0') {
-    return;
+bool bleTransportQueueJson(LinkTxClass cls, const char* json, size_t length) {
+  if (!clientConnected || json == nullptr || length == 0) {
+    return false;
   }
-
-  if (!mtuReady) {
-    pendingTxJson = json;
-    return;
+  if (cls == LinkTxClass::Control && length > kControlSlotSize) {
+    cls = LinkTxClass::Bulk;
+  }
+  bool queued = false;
+  switch (cls) {
+    case LinkTxClass::Control:
+      queued = controlQueue.push(json, length);
+      break;
+    case LinkTxClass::Telemetry: {
+      // Only the newest telemetry matters: replace whatever has not started sending yet.
+      const uint8_t keep = txInProgress && txActiveClass == LinkTxClass::Telemetry ? 1 : 0;
+      if (telemetryQueue.count > keep) {
+        txStats.telemetryCoalesced++;
+        telemetryQueue.truncate(keep);
+      }
+      queued = telemetryQueue.push(json, length);
+      break;
+    }
+    case LinkTxClass::Bulk:
+      queued = bulkQueue.push(json, length);
+      break;
+  }
+  if (!queued) {
+    txStats.queueDrops++;
   }
+  return queued;
+}
 
-  pendingTxJson = json;
+bool bleTransportCanQueue(LinkTxClass cls) {
+  switch (cls) {
+    case LinkTxClass::Control:
+      return !controlQueue.full();
+    case LinkTxClass::Bulk:
+      return !bulkQueue.full();
+    default:
+      return true;
+  }
 }
 
 bool bleTransportHasClient() {
   return clientConnected;
 }
 
-bool bleTransportIsTxBusy() {
-  return txInProgress || pendingTxJson.length() > 0;
+size_t bleTransportFramePayloadMax() {
+  return mtuReady ? notifyPayloadMax() : kMinAttPayload;
+}
+
+bool bleTransportSendFrame(const uint8_t* frame, size_t length) {
+  if (length > bleTransportFramePayloadMax()) {
+    return false;
+  }
+  // One notification, never fragmented; binary clients tell it from 'OV' fragments and '{' JSON
+  // by its first byte, so it may go out between the fragments of a larger payload. It takes a window
+  // credit like any fragment and is dropped rather than retried when the window is full.
+  if (notifyPacket(frame, length) == TxAttempt::Sent) {
+    return true;
+  }
+  txStats.framesDropped++;
+  return false;
+}
+
+BleTxStats bleTransportTxStats() {
+  BleTxStats stats = txStats;
+  stats.statusErrors = txStatusErrors.load();
+  stats.inFlight = txInFlight.load();
+  stats.window = txWindow;
+  stats.mtu = peerMtu;
+  return stats;
 }
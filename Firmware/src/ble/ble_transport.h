@@ -1,17 +1,52 @@
 #ifndef BLE_TRANSPORT_H
 #define BLE_TRANSPORT_H
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include "../device_protocol/device_protocol.h"
+
 void initBleTransport();
 void updateBleTransport();
 
-/** Send JSON to the connected BLE client (chunked when needed). */
-void bleTransportSendJson(const char* json);
+/**
+ * Copy JSON into the preallocated queue for `cls` (chunked when sent). Control messages longer than
+ * a control slot (256 bytes) go to bulk; telemetry replaces any telemetry not yet started. False
+ * (counted as a queue drop) when there is no client or the queue is full.
+ */
+bool bleTransportQueueJson(LinkTxClass cls, const char* json, size_t length);
+
+/** Room for one more `cls` message (telemetry always has room). */
+bool bleTransportCanQueue(LinkTxClass cls);
 
 bool bleTransportHasClient();
 
-/** True while a (possibly multi-fragment) BLE TX is in progress or queued. */
-bool bleTransportIsTxBusy();
+/**
+ * TX counters for the current connection (reset on connect), for tuning the window per central.
+ * Throughput is measured over fragmented payloads, from the first fragment to the last accepted one.
+ */
+struct BleTxStats {
+  uint32_t notifications;    // accepted by notify()
+  uint32_t bytes;            // ATT payload bytes accepted
+  uint32_t retries;          // notify() found no free buffer; retried after a backoff
+  uint32_t statusErrors;     // onStatus() reported a notification as not sent
+  uint32_t payloads;         // JSON payloads completed
+  uint32_t aborted;          // JSON payloads given up after repeated rejects
+  uint32_t framesDropped;    // single binary frames skipped while the window was full
+  uint32_t queueDrops;       // JSON refused because its control/bulk queue was full
+  uint32_t telemetryCoalesced;  // unsent telemetry replaced by a newer one
+  uint32_t lastPayloadBytes;
+  uint32_t lastPayloadMs;
+  uint32_t bestBytesPerSec;
+  uint16_t mtu;
+  uint8_t window;            // current in-flight limit
+  uint8_t inFlight;
+};
+BleTxStats bleTransportTxStats();
+
+/** Largest binary frame bleTransportSendFrame() accepts (ATT payload, capped for macOS). */
+size_t bleTransportFramePayloadMax();
+/** Unfragmented binary notification (telemetry frame, stream batch); false if too large, window full or failed. */
+bool bleTransportSendFrame(const uint8_t* frame, size_t length);
 
 #endif  // BLE_TRANSPORT_H
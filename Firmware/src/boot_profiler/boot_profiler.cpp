@@ -0,0 +1,106 @@
+#include "boot_profiler.h"
+
+#include <Arduino.h>
+
+#include <atomic>
+
+namespace {
+
+constexpr const char* kStageNames[kBootStageCount] = {
+    "led", "serial", "buttons", "sensors", "settings", "motor", "stats", "power", "tasks",
+    "wifi", "link", "web_assets", "display",
+};
+
+constexpr const char* kMilestoneKeys[kBootMilestoneCount] = {
+    "controls_live_us", "first_motor_us", "wifi_ready_us", "deferred_done_us",
+};
+
+constexpr const char* kMilestoneLabels[kBootMilestoneCount] = {
+    "Controls live", "First motor start", "WiFi ready", "Deferred init done",
+};
+
+// Stages are written by setup() and then only by the I/O task, which also serves get_profile.
+BootStageRecord s_stages[kBootStageCount];
+std::atomic<uint32_t> s_milestones[kBootMilestoneCount];
+bool s_fastBoot = false;
+
+double toMs(uint32_t us) {
+  return static_cast<double>(us) / 1000.0;
+}
+
+}  // namespace
+
+uint32_t bootProfilerStamp() {
+  return micros();
+}
+
+void bootProfilerRecord(BootStage stage, uint32_t startUs, bool deferred) {
+  BootStageRecord& r = s_stages[static_cast<size_t>(stage)];
+  r.startUs = startUs;
+  r.us = micros() - startUs;
+  r.deferred = deferred;
+  r.done = true;
+}
+
+void bootProfilerMilestone(BootMilestone milestone) {
+  // 0 marks "not yet"; a milestone in the very first microsecond is stored as 1.
+  const uint32_t now = micros();
+  uint32_t expected = 0;
+  if (s_milestones[static_cast<size_t>(milestone)].compare_exchange_strong(expected, now > 0 ? now : 1U)) {
+    Serial.printf("[BOOT] %s %.1f ms after boot\n", kMilestoneLabels[static_cast<size_t>(milestone)], toMs(now));
+  }
+}
+
+uint32_t bootProfilerMilestoneUs(BootMilestone milestone) {
+  return s_milestones[static_cast<size_t>(milestone)].load();
+}
+
+void bootProfilerSetFastBoot(bool fastBoot) {
+  s_fastBoot = fastBoot;
+}
+
+BootStageRecord bootProfilerStage(BootStage stage) {
+  BootStageRecord r = s_stages[static_cast<size_t>(stage)];
+  r.name = kStageNames[static_cast<size_t>(stage)];
+  return r;
+}
+
+void bootProfilerPrint() {
+  Serial.printf("[BOOT] %s boot, stages (start / duration):\n", s_fastBoot ? "Fast" : "Full");
+  for (size_t i = 0; i < kBootStageCount; ++i) {
+    const BootStageRecord r = bootProfilerStage(static_cast<BootStage>(i));
+    if (!r.done) {
+      continue;
+    }
+    Serial.printf("[BOOT]   %-10s @%8.1f ms %8.1f ms%s\n", r.name, toMs(r.startUs), toMs(r.us),
+                  r.deferred ? "  (deferred)" : "");
+  }
+  for (size_t i = 0; i < kBootMilestoneCount; ++i) {
+    const uint32_t at = s_milestones[i].load();
+    if (at != 0) {
+      Serial.printf("[BOOT]   %-18s @%8.1f ms\n", kMilestoneLabels[i], toMs(at));
+    }
+  }
+}
+
+void bootProfilerWriteJson(JsonObject out) {
+  out["mode"] = s_fastBoot ? "fast" : "full";
+  JsonArray stages = out.createNestedArray("stages");
+  for (size_t i = 0; i < kBootStageCount; ++i) {
+    const BootStageRecord r = bootProfilerStage(static_cast<BootStage>(i));
+    if (!r.done) {
+      continue;
+    }
+    JsonObject j = stages.createNestedObject();
+    j["name"] = r.name;
+    j["start_us"] = r.startUs;
+    j["us"] = r.us;
+    j["deferred"] = r.deferred;
+  }
+  for (size_t i = 0; i < kBootMilestoneCount; ++i) {
+    const uint32_t at = s_milestones[i].load();
+    if (at != 0) {
+      out[kMilestoneKeys[i]] = at;
+    }
+  }
+}
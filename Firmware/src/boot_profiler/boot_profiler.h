@@ -0,0 +1,70 @@
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Init stages of setup() in boot order; WiFi..Display run from the I/O task in fast-boot mode. */
+enum class BootStage : uint8_t {
+  Led = 0,
+  Console,   // Serial.begin() and the optional monitor wait
+  Buttons,
+  Sensors,   // ADC sampler, NTC, battery, tachometer, MCU temperature
+  Settings,  // NVS mount and runtime settings
+  Motor,
+  Stats,     // max stats and SOC
+  Power,
+  Tasks,     // LED bar, loop profiler, control/I/O task start
+  WiFi,      // OTA state and the STA join
+  Link,      // WebSocket and BLE transport
+  WebAssets, // LittleFS mount and asset manifest
+  Display,   // bus scan, panel init and splash
+  Count,
+};
+
+/** One-off moments, each recorded the first time it happens. */
+enum class BootMilestone : uint8_t {
+  ControlsLive = 0,  // setup() returned; trigger, motor and cutoffs are running
+  FirstMotorStart,
+  WiFiReady,
+  DeferredDone,      // the last deferred stage finished
+  Count,
+};
+
+struct BootStageRecord {
+  const char* name;
+  uint32_t startUs;  // micros() since boot
+  uint32_t us;
+  bool deferred;     // ran from the I/O task after setup()
+  bool done;
+};
+
+constexpr size_t kBootStageCount = static_cast<size_t>(BootStage::Count);
+constexpr size_t kBootMilestoneCount = static_cast<size_t>(BootMilestone::Count);
+constexpr size_t kBootProfileJsonCapacity = JSON_OBJECT_SIZE(2 + kBootMilestoneCount) +
+                                            JSON_ARRAY_SIZE(kBootStageCount) +
+                                            kBootStageCount * JSON_OBJECT_SIZE(4);
+
+/** micros() timestamp to pass to bootProfilerRecord() when the stage is done. */
+uint32_t bootProfilerStamp();
+
+void bootProfilerRecord(BootStage stage, uint32_t startUs, bool deferred);
+
+/** Records the first occurrence only; callable from any task. */
+void bootProfilerMilestone(BootMilestone milestone);
+
+/** micros() of the milestone, 0 while it has not happened. */
+uint32_t bootProfilerMilestoneUs(BootMilestone milestone);
+
+void bootProfilerSetFastBoot(bool fastBoot);
+
+BootStageRecord bootProfilerStage(BootStage stage);
+
+/** One "[BOOT]" line per finished stage, then the milestones reached so far. */
+void bootProfilerPrint();
+
+/** {"mode","stages":[{name,start_us,us,deferred}],"controls_live_us",...}; milestones not reached are omitted. */
+void bootProfilerWriteJson(JsonObject out);
+
+#endif  // BOOT_PROFILER_H
@@ -84,9 +84,10 @@ void initButtons() {
   doublePressLatched = false;
   momentaryTriggerRun = false;
 
-  triggerLastState = digitalRead(TRIGGER_PIN);
-  upLastState = digitalRead(UP_PIN);
-  downLastState = digitalRead(DOWN_PIN);
+  // Pressed == LOW, as in updateButtons(): a trigger already held at power-on gives no press edge.
+  triggerLastState = !digitalRead(TRIGGER_PIN);
+  upLastState = !digitalRead(UP_PIN);
+  downLastState = !digitalRead(DOWN_PIN);
 }
 
 void updateButtons() {
@@ -33,10 +33,10 @@ bool isTriggerPressed();
 bool isMotorActive();
 void setMotorState(bool active); // true = motor_start, false = motor_stop
 
-// Display info mode: UP+DOWN long-press toggles menu on/off. UP/DOWN cycle pages (0–5 info, 6–18 settings).
+// Display info mode: UP+DOWN long-press toggles menu on/off. UP/DOWN cycle pages (0–6 info, 7+ settings).
 // TRIGGER on settings pages cycles value and saves NVS; on info pages TRIGGER does nothing.
 bool isDisplayInfoMode();
-uint8_t getDisplayInfoPage();  // 0–5 info pages, 6+ settings (see devMenuTotalPageCount)
+uint8_t getDisplayInfoPage();  // 0–6 info pages, 7+ settings (see devMenuTotalPageCount)
 // Reset runtime button/motor mode state while keeping the saved speed setting.
 void resetButtonRuntimeStateKeepSpeed();
 
@@ -0,0 +1,76 @@
+#include "control_tasks.h"
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "../loop_profiler/loop_profiler.h"
+
+namespace {
+constexpr BaseType_t kControlCore = 1;
+constexpr BaseType_t kIoCore = 0;
+// Above loopTask (1) and below the WiFi/BLE/lwIP tasks, which only live on core 0 anyway.
+constexpr UBaseType_t kControlPriority = 5;
+constexpr UBaseType_t kIoPriority = 1;
+constexpr uint32_t kControlStackBytes = 6144;
+constexpr uint32_t kIoStackBytes = 8192;
+
+SemaphoreHandle_t s_controlMutex = nullptr;
+bool s_tasksRunning = false;
+void (*s_controlTick)() = nullptr;
+void (*s_ioTick)() = nullptr;
+
+void controlTaskMain(void*) {
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    controlLock();
+    s_controlTick();
+    controlUnlock();
+    if (xTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kControlPeriodMs)) == pdFALSE) {
+      // Overran (or woke from light sleep): restart the cadence instead of bursting to catch up.
+      lastWake = xTaskGetTickCount();
+    }
+  }
+}
+
+void ioTaskMain(void*) {
+  for (;;) {
+    const uint32_t start = loopProfilerStamp();
+    s_ioTick();
+    loopProfilerLap(LoopProfileSection::Loop, start);
+    vTaskDelay(1);  // lets IDLE0 feed the task watchdog
+  }
+}
+}  // namespace
+
+void startControlTasks(void (*controlTick)(), void (*ioTick)()) {
+  s_controlTick = controlTick;
+  s_ioTick = ioTick;
+#ifndef OSHVAC_SINGLE_LOOP
+  s_controlMutex = xSemaphoreCreateMutex();
+  const bool controlOk = xTaskCreatePinnedToCore(controlTaskMain, "control", kControlStackBytes, nullptr,
+                                                 kControlPriority, nullptr, kControlCore) == pdPASS;
+  const bool ioOk =
+      xTaskCreatePinnedToCore(ioTaskMain, "io", kIoStackBytes, nullptr, kIoPriority, nullptr, kIoCore) == pdPASS;
+  s_tasksRunning = controlOk && ioOk;
+  Serial.printf("[Tasks] control: core %d every %u ms, io: core %d (%s)\n", static_cast<int>(kControlCore),
+                static_cast<unsigned>(kControlPeriodMs), static_cast<int>(kIoCore), s_tasksRunning ? "ok" : "FAILED");
+#endif
+}
+
+bool controlTasksRunning() {
+  return s_tasksRunning;
+}
+
+void controlLock() {
+  if (s_controlMutex != nullptr) {
+    xSemaphoreTake(s_controlMutex, portMAX_DELAY);
+  }
+}
+
+void controlUnlock() {
+  if (s_controlMutex != nullptr) {
+    xSemaphoreGive(s_controlMutex);
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef CONTROL_TASKS_H
+#define CONTROL_TASKS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Task split (default): a high-priority control task pinned to core 1 runs buttons, motor,
+ * sensors and the safety cutoffs at a fixed rate; an I/O task on core 0 (next to the WiFi/BLE
+ * stacks) runs LEDs, display, power management, OTA, web server and device link.
+ * Build with -D OSHVAC_SINGLE_LOOP to run both halves back to back from Arduino loop() instead.
+ */
+constexpr uint32_t kControlPeriodMs = 1;
+
+/** Starts the control and I/O tasks (no-op with OSHVAC_SINGLE_LOOP). Call at the end of setup(). */
+void startControlTasks(void (*controlTick)(), void (*ioTick)());
+
+/** True when loop() has to drive both ticks itself. */
+bool controlTasksRunning();
+
+/**
+ * Held by the control task for each tick. I/O-side code that changes motor, button or settings
+ * state (device commands, light sleep) takes it so those changes never interleave with a tick.
+ */
+void controlLock();
+void controlUnlock();
+
+class ControlLockGuard {
+ public:
+  ControlLockGuard() { controlLock(); }
+  ~ControlLockGuard() { controlUnlock(); }
+  ControlLockGuard(const ControlLockGuard&) = delete;
+  ControlLockGuard& operator=(const ControlLockGuard&) = delete;
+};
+
+#endif  // CONTROL_TASKS_H
@@ -0,0 +1,29 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * CRC-32 (IEEE 802.3, reflected, as zlib / Python binascii.crc32), nibble-table variant: 64 bytes
+ * of table, two lookups per byte. Chain calls by passing the previous result as `crc`.
+ */
+inline uint32_t crc32Update(uint32_t crc, const void* data, size_t len) {
+  static constexpr uint32_t kNibble[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+      0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+  };
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < len; ++i) {
+    crc = kNibble[(crc ^ p[i]) & 0x0F] ^ (crc >> 4);
+    crc = kNibble[(crc ^ (p[i] >> 4)) & 0x0F] ^ (crc >> 4);
+  }
+  return ~crc;
+}
+
+inline uint32_t crc32(const void* data, size_t len) {
+  return crc32Update(0, data, len);
+}
+
+#endif  // CRC32_H
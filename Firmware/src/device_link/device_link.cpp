@@ -1,38 +1,381 @@
 #include "device_link.h"
 
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <string.h>
+
 #include "../ble/ble_transport.h"
 #include "../device_protocol/device_protocol.h"
+#include "../loop_profiler/loop_profiler.h"
+#include "../session_log/session_log.h"
+#include "../telemetry_stream/telemetry_stream.h"
 #include "../websocket/websocket.h"
+#include "../wifi/wifi.h"
 
 namespace {
-volatile bool settingsBroadcastPending = false;
+std::atomic<bool> settingsBroadcastPending{false};
+
+struct PendingNotify {
+  char id[24];
+  char text[96];
+  char level[12];
+};
+constexpr UBaseType_t kNotifyQueueDepth = 4;
+QueueHandle_t notifyQueue = nullptr;
+
+// Per-connection state, owned by the I/O task; intervals are the per-topic minimum spacing (0 = no limit).
+struct LinkClient {
+  bool connected;
+  bool settingsPending;
+  // Version-aware clients (get_settings with if_version) get settings_delta from settingsVersion.
+  bool settingsDeltas;
+  uint32_t settingsVersion;
+  uint8_t topics;
+  TelemetryFormat format;
+  uint16_t intervalMs[kLinkTopicCount];
+  uint32_t lastSentMs[kLinkTopicCount];
+  // get_sessions dump in progress: next seq to send and records still owed.
+  bool sessionDump;
+  uint32_t sessionNextSeq;
+  uint32_t sessionRemaining;
+};
+LinkClient clients[kLinkClientCount];
+// Notify subscribers (bit n = client n), mirrored for deviceLinkHasActiveClients() on the control task.
+std::atomic<uint8_t> notifySubscribers{0};
+
+// Telemetry JSON is re-encoded only when the snapshot or the WiFi role (part of the JSON) changed.
+String telemetryJson;
+uint32_t telemetryJsonVersion = 0;
+WiFiLinkRole telemetryJsonRole = WiFiLinkRole::None;
+
+constexpr size_t kStreamWebSocketBatchMax = 512;
+constexpr uint8_t kStreamMaxBatchesPerUpdate = 4;
+constexpr size_t kSessionPageMax = 512;
+constexpr uint8_t kSessionPagesPerUpdate = 2;
+
+constexpr uint8_t topicIndex(LinkTopic topic) {
+  return static_cast<uint8_t>(topic);
+}
+
+void refreshNotifySubscribers() {
+  uint8_t mask = 0;
+  for (uint8_t i = 0; i < kLinkClientCount; ++i) {
+    if (clients[i].connected && (clients[i].topics & linkTopicBit(LinkTopic::Notify)) != 0) {
+      mask |= static_cast<uint8_t>(1U << i);
+    }
+  }
+  notifySubscribers.store(mask);
+}
+
+void resetClient(uint8_t id, bool connected) {
+  LinkClient& c = clients[id];
+  c = {};
+  c.connected = connected;
+  c.topics = connected ? kLinkTopicsDefault : 0;
+  c.format = TelemetryFormat::Json;
+  c.intervalMs[topicIndex(LinkTopic::Telemetry)] = kTelemetryDefaultIntervalMs;
+  c.intervalMs[topicIndex(LinkTopic::Profile)] = kProfilePushDefaultIntervalMs;
+  refreshNotifySubscribers();
+}
+
+bool subscribed(const LinkClient& c, LinkTopic topic) {
+  return c.connected && (c.topics & linkTopicBit(topic)) != 0;
+}
+
+bool due(const LinkClient& c, LinkTopic topic, uint32_t nowMs) {
+  const uint8_t i = topicIndex(topic);
+  return subscribed(c, topic) && (nowMs - c.lastSentMs[i]) >= c.intervalMs[i];
+}
+
+// Settings/profile wait (pending, or until due again) while the client's bulk queue share is full.
+bool bulkBlocked(uint8_t id) {
+  return id == kLinkClientBle ? !bleTransportCanQueue(LinkTxClass::Bulk) : !webSocketCanQueue(id, LinkTxClass::Bulk);
+}
+
+void sendText(uint8_t id, const String& json, LinkTxClass cls) {
+  if (id == kLinkClientBle) {
+    bleTransportQueueJson(cls, json.c_str(), json.length());
+  } else {
+    webSocketSendText(id, json.c_str(), json.length(), cls);
+  }
+}
+
+// Binary frames are telemetry frames, stream batches and session pages: dropped, not queued, on a
+// slow link. Session pages are resent from the same seq, so only their caller looks at the result.
+bool sendBinary(uint8_t id, const uint8_t* data, size_t length, LinkTxClass cls = LinkTxClass::Telemetry) {
+  if (id == kLinkClientBle) {
+    return bleTransportSendFrame(data, length);
+  }
+  return webSocketSendBinary(id, data, length, cls);
+}
+
+void pumpSettings(uint32_t nowMs) {
+  if (settingsBroadcastPending.exchange(false)) {
+    for (LinkClient& c : clients) {
+      c.settingsPending = c.settingsPending || subscribed(c, LinkTopic::Settings);
+    }
+  }
+  const uint32_t version = deviceProtocolSettingsVersion();
+  String payload;
+  String delta;
+  uint32_t deltaFrom = 0;
+  for (uint8_t i = 0; i < kLinkClientCount; ++i) {
+    LinkClient& c = clients[i];
+    // Rate-limited clients keep the flag, so bursts of changes collapse into one later push.
+    if (!c.settingsPending || !due(c, LinkTopic::Settings, nowMs) || bulkBlocked(i)) {
+      continue;
+    }
+    c.settingsPending = false;
+    if (c.settingsDeltas && c.settingsVersion == version) {
+      continue;
+    }
+    if (c.settingsDeltas && (c.settingsVersion == deltaFrom ||
+                             deviceProtocolBuildSettingsDelta(delta, c.settingsVersion))) {
+      deltaFrom = c.settingsVersion;
+      sendText(i, delta, LinkTxClass::Bulk);
+    } else {
+      if (payload.length() == 0) {
+        deviceProtocolBuildSettingsPayload(payload);
+      }
+      sendText(i, payload, LinkTxClass::Bulk);
+    }
+    c.settingsVersion = version;
+    c.lastSentMs[topicIndex(LinkTopic::Settings)] = nowMs;
+  }
+}
+
+void pumpNotifies() {
+  PendingNotify notify;
+  while (notifyQueue != nullptr && xQueueReceive(notifyQueue, &notify, 0) == pdTRUE) {
+    String json;
+    for (uint8_t i = 0; i < kLinkClientCount; ++i) {
+      if (!subscribed(clients[i], LinkTopic::Notify)) {
+        continue;
+      }
+      if (json.length() == 0) {
+        deviceProtocolBuildNotifyJson(json, notify.id, notify.text, notify.level);
+      }
+      sendText(i, json, LinkTxClass::Control);
+    }
+  }
+}
+
+void pumpProfile(uint32_t nowMs) {
+  String payload;
+  for (uint8_t i = 0; i < kLinkClientCount; ++i) {
+    LinkClient& c = clients[i];
+    if (!due(c, LinkTopic::Profile, nowMs) || bulkBlocked(i)) {
+      continue;
+    }
+    if (payload.length() == 0) {
+      deviceProtocolBuildProfilePayload(payload);
+    }
+    sendText(i, payload, LinkTxClass::Bulk);
+    c.lastSentMs[topicIndex(LinkTopic::Profile)] = nowMs;
+  }
+}
+
+void pumpTelemetryStream() {
+  const uint8_t subscribers = telemetryStreamSubscribers();
+  if (subscribers == 0) {
+    return;
+  }
+  // Every subscriber gets the same bytes, so a BLE subscriber bounds the batch for all.
+  const uint8_t bleBit = static_cast<uint8_t>(1U << kLinkClientBle);
+  const size_t capacity = (subscribers & bleBit) != 0 ? bleTransportFramePayloadMax() : kStreamWebSocketBatchMax;
+  uint8_t batch[kStreamWebSocketBatchMax];
+  for (uint8_t n = 0; n < kStreamMaxBatchesPerUpdate; ++n) {
+    const size_t len = telemetryStreamTakeBatch(batch, capacity);
+    if (len == 0) {
+      break;
+    }
+    for (uint8_t i = 0; i < kLinkClientCount; ++i) {
+      if ((subscribers & (1U << i)) != 0) {
+        sendBinary(i, batch, len);
+      }
+    }
+  }
+}
+
+void pumpSessionPages() {
+  uint8_t page[kSessionPageMax];
+  for (uint8_t i = 0; i < kLinkClientCount; ++i) {
+    LinkClient& c = clients[i];
+    // BLE pages are one notification each; until the MTU exchange a record does not fit.
+    const size_t capacity = i == kLinkClientBle ? bleTransportFramePayloadMax() : kSessionPageMax;
+    if (!c.connected || !c.sessionDump || capacity < kSessionPageHeaderSize + kSessionRecordSize) {
+      continue;
+    }
+    for (uint8_t n = 0; n < kSessionPagesPerUpdate && c.sessionDump && !bulkBlocked(i); ++n) {
+      uint32_t next = c.sessionNextSeq;
+      const size_t len = sessionLogReadPage(c.sessionNextSeq, c.sessionRemaining, page,
+                                            capacity < sizeof(page) ? capacity : sizeof(page), next);
+      if (!sendBinary(i, page, len, LinkTxClass::Bulk)) {
+        break;
+      }
+      const uint32_t sent = next - c.sessionNextSeq;
+      c.sessionNextSeq = next;
+      c.sessionRemaining -= sent < c.sessionRemaining ? sent : c.sessionRemaining;
+      // The count-0 page that ends the dump has just gone out.
+      c.sessionDump = len > kSessionPageHeaderSize;
+    }
+  }
+}
+
+const String& telemetryJsonFor(const TelemetrySnapshot& snapshot) {
+  const WiFiLinkRole role = getWiFiLinkRole();
+  if (telemetryJson.length() == 0 || telemetryJsonVersion != snapshot.version || telemetryJsonRole != role) {
+    telemetryJson = "";
+    deviceProtocolBuildTelemetryJson(telemetryJson,
+                                     snapshot.temperatureC,
+                                     snapshot.batteryVoltage,
+                                     snapshot.rpm,
+                                     snapshot.speedPercent,
+                                     snapshot.motorActive,
+                                     snapshot.batterySocPercent);
+    telemetryJsonVersion = snapshot.version;
+    telemetryJsonRole = role;
+  }
+  return telemetryJson;
+}
+
+void copyField(char* dst, size_t size, const char* src) {
+  strncpy(dst, src != nullptr ? src : "", size - 1);
+  dst[size - 1] = '\0';
+}
 }  // namespace
 
 void deviceLinkInit() {
+  for (uint8_t i = 0; i < kLinkClientCount; ++i) {
+    resetClient(i, false);
+  }
   initWebSocket();
   initBleTransport();
+  notifyQueue = xQueueCreate(kNotifyQueueDepth, sizeof(PendingNotify));
 }
 
 void deviceLinkUpdate() {
+  uint32_t t = loopProfilerStamp();
   updateWebSocket();
+  t = loopProfilerLap(LoopProfileSection::WebSocket, t);
+  // BLE (dis)connects arrive on the NimBLE host task; pick them up here, before any queued command.
+  const bool bleConnected = bleTransportHasClient();
+  if (bleConnected != clients[kLinkClientBle].connected) {
+    if (bleConnected) {
+      deviceLinkClientConnected(kLinkClientBle);
+    } else {
+      deviceLinkClientDisconnected(kLinkClientBle);
+    }
+  }
   updateBleTransport();
-  if (settingsBroadcastPending) {
-    settingsBroadcastPending = false;
-    String payload;
-    deviceProtocolBuildSettingsPayload(payload);
-    deviceLinkBroadcast(payload.c_str());
+  loopProfilerLap(LoopProfileSection::Ble, t);
+  const uint32_t now = millis();
+  pumpSettings(now);
+  pumpNotifies();
+  pumpProfile(now);
+  pumpTelemetryStream();
+  pumpSessionPages();
+}
+
+void deviceLinkPostNotify(const char* id, const char* text, const char* level) {
+  if (notifyQueue == nullptr) {
+    return;
+  }
+  PendingNotify notify;
+  copyField(notify.id, sizeof(notify.id), id);
+  copyField(notify.text, sizeof(notify.text), text);
+  copyField(notify.level, sizeof(notify.level), level);
+  // Never block the caller (control task); a full queue only drops the toast, not the stop.
+  xQueueSend(notifyQueue, &notify, 0);
+}
+
+void deviceLinkClientConnected(uint8_t client) {
+  if (client >= kLinkClientCount) {
+    return;
+  }
+  resetClient(client, true);
+  // WebSocket clients get the settings payload on connect; BLE centrals ask with get_settings.
+  clients[client].settingsPending = client != kLinkClientBle;
+}
+
+void deviceLinkClientDisconnected(uint8_t client) {
+  if (client >= kLinkClientCount) {
+    return;
+  }
+  telemetryStreamUnsubscribe(client);
+  resetClient(client, false);
+}
+
+void deviceLinkApplyCommandResult(uint8_t client, const DeviceCommandResult& result) {
+  if (client >= kLinkClientCount || !clients[client].connected) {
+    return;
+  }
+  LinkClient& c = clients[client];
+  const uint8_t streamBit = linkTopicBit(LinkTopic::Stream);
+  if (result.settingsVersionSent != 0) {
+    c.settingsVersion = result.settingsVersionSent;
+    c.settingsDeltas = c.settingsDeltas || result.settingsVersionAware;
+  }
+  if (result.setsTelemetryFormat) {
+    c.format = result.telemetryFormat;
+    c.intervalMs[topicIndex(LinkTopic::Telemetry)] = result.telemetryIntervalMs;
+  }
+  if (result.setsSubscriptions) {
+    if ((result.topics & streamBit) != 0 && (c.topics & streamBit) == 0) {
+      telemetryStreamSubscribe(client,
+                               telemetryStreamNormalize(kStreamDefaultRateHz, kStreamFieldAll, kStreamDefaultBatch));
+    } else if ((result.topics & streamBit) == 0 && (c.topics & streamBit) != 0) {
+      telemetryStreamUnsubscribe(client);
+    }
+    c.topics = result.topics;
+    memcpy(c.intervalMs, result.topicIntervalMs, sizeof(c.intervalMs));
+    refreshNotifySubscribers();
+  }
+  if (result.startsSessionDump) {
+    c.sessionDump = true;
+    c.sessionNextSeq = result.sessionFromSeq;
+    c.sessionRemaining = result.sessionCount;
+  }
+  if (result.startsStream) {
+    telemetryStreamSubscribe(client, result.streamConfig);
+    c.topics |= streamBit;
+  } else if (result.stopsStream) {
+    telemetryStreamUnsubscribe(client);
+    c.topics &= static_cast<uint8_t>(~streamBit);
   }
 }
 
-void deviceLinkBroadcast(const char* json) {
-  if (json == nullptr || json[0] == '\0') {
+void deviceLinkPublishTelemetry(const TelemetrySnapshot& snapshot) {
+  const uint32_t now = millis();
+  uint8_t jsonDue = 0;
+  uint8_t binaryDue = 0;
+  for (uint8_t i = 0; i < kLinkClientCount; ++i) {
+    if (due(clients[i], LinkTopic::Telemetry, now)) {
+      (clients[i].format == TelemetryFormat::Binary ? binaryDue : jsonDue) |= static_cast<uint8_t>(1U << i);
+    }
+  }
+  if (jsonDue == 0 && binaryDue == 0) {
     return;
   }
-  broadcastWebSocket(json);
-  // Skip BLE telemetry while a large payload (e.g. settings schema) is sending —
-  // interleaved small packets corrupt the WebUI fragment reassembly.
-  if (bleTransportHasClient() && !bleTransportIsTxBusy()) {
-    bleTransportSendJson(json);
+
+  uint8_t frame[kTelemetryFrameSize];
+  size_t frameLen = 0;
+  if (binaryDue != 0) {
+    frameLen = deviceProtocolBuildTelemetryFrame(frame, snapshot);
+  }
+  for (uint8_t i = 0; i < kLinkClientCount; ++i) {
+    const uint8_t bit = static_cast<uint8_t>(1U << i);
+    if ((binaryDue & bit) != 0) {
+      // A single notification, so BLE frames may go out between fragments of a larger payload.
+      sendBinary(i, frame, frameLen);
+    } else if ((jsonDue & bit) != 0) {
+      sendText(i, telemetryJsonFor(snapshot), LinkTxClass::Telemetry);
+    }
+    if (((jsonDue | binaryDue) & bit) != 0) {
+      clients[i].lastSentMs[topicIndex(LinkTopic::Telemetry)] = now;
+    }
   }
 }
 
@@ -41,9 +384,9 @@ void deviceLinkSendToWebSocketClient(uint8_t client, const char* json) {
 }
 
 void deviceLinkRequestSettingsBroadcast() {
-  settingsBroadcastPending = true;
+  settingsBroadcastPending.store(true);
 }
 
 bool deviceLinkHasActiveClients() {
-  return isWebSocketRunning() || bleTransportHasClient();
+  return notifySubscribers.load() != 0;
 }
@@ -3,21 +3,48 @@
 
 #include <stdint.h>
 
+#include "../device_protocol/device_protocol.h"
+#include "../telemetry_snapshot/telemetry_snapshot.h"
+
+/**
+ * Link client ids shared by every per-connection table (topics, telemetry format, stream):
+ * WebSocket client n is n, the BLE central is kLinkClientBle.
+ */
+constexpr uint8_t kLinkClientBle = kStreamClientBle;
+constexpr uint8_t kLinkClientCount = kLinkClientBle + 1;
+
 /** Initialize all device transports (WebSocket, BLE). */
 void deviceLinkInit();
 
 /** Pump transport event loops (call from main loop). */
 void deviceLinkUpdate();
 
-/** Broadcast JSON to all connected clients on every transport. */
-void deviceLinkBroadcast(const char* json);
+/**
+ * Queue a notify for the next deviceLinkUpdate(); safe from the control task (copies, never blocks).
+ * Strings are truncated to 23/95/11 chars.
+ */
+void deviceLinkPostNotify(const char* id, const char* text, const char* level);
+
+/** Transport hooks: reset a client to the default topics, or drop its subscriptions. */
+void deviceLinkClientConnected(uint8_t client);
+void deviceLinkClientDisconnected(uint8_t client);
+
+/** Apply the per-connection parts of a command (set_format, subscribe, stream_*) to `client`. */
+void deviceLinkApplyCommandResult(uint8_t client, const DeviceCommandResult& result);
+
+/**
+ * Telemetry to every telemetry subscriber whose interval (subscribe / set_format, default 250 ms)
+ * has elapsed, as JSON or as the binary frame. Call every pass; encodes nothing when no client is due.
+ */
+void deviceLinkPublishTelemetry(const TelemetrySnapshot& snapshot);
 
 /** Send JSON to a single WebSocket client (legacy client id). */
 void deviceLinkSendToWebSocketClient(uint8_t client, const char* json);
 
-/** Queue settings payload broadcast on next update tick. */
+/** Mark the settings payload pending for every settings subscriber (coalesced per client rate). */
 void deviceLinkRequestSettingsBroadcast();
 
+/** Some connected client subscribes to notify (safe from the control task). */
 bool deviceLinkHasActiveClients();
 
 #endif  // DEVICE_LINK_H
@@ -3,18 +3,61 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <ESP.h>
+#include <math.h>
 #include <string.h>
 
 #include "../motor/motor.h"
+#include "../ble/ble_transport.h"
+#include "../boot_profiler/boot_profiler.h"
 #include "../button/button.h"
+#include "../control_tasks/control_tasks.h"
+#include "../loop_profiler/loop_profiler.h"
+#include "../maximum_stats/maximum_stats.h"
+#include "../session_log/session_log.h"
 #include "../settings/dev_menu.h"
 #include "../settings/settings.h"
 #include "../settings/settings_api.h"
+#include "../websocket/websocket.h"
 #include "../wifi/wifi.h"
 #include "../wifi/wifi_credentials.h"
 
 namespace {
-constexpr size_t kSettingsJsonCapacity = 8192;
+constexpr size_t kProfileJsonCapacity = 7168 + kBootProfileJsonCapacity;
+constexpr size_t kBatchMaxCommands = 16;
+constexpr const char* kLinkTopicNames[kLinkTopicCount] = {"telemetry", "settings", "notify", "stream", "profile"};
+
+bool topicFromName(const char* name, LinkTopic& out) {
+  for (uint8_t i = 0; i < kLinkTopicCount; ++i) {
+    if (name != nullptr && strcmp(name, kLinkTopicNames[i]) == 0) {
+      out = static_cast<LinkTopic>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+uint16_t clampInterval(float ms, uint16_t lo, uint16_t hi) {
+  if (ms < lo) {
+    return lo;
+  }
+  return ms > hi ? hi : static_cast<uint16_t>(ms);
+}
+
+// max_hz <= 0 (or absent) picks the topic default; notify and stream are not rate limited here.
+uint16_t topicIntervalFromHz(LinkTopic topic, float hz) {
+  switch (topic) {
+    case LinkTopic::Telemetry:
+      return hz > 0.0f ? clampInterval(1000.0f / hz, kTelemetryMinIntervalMs, kTelemetryMaxIntervalMs)
+                       : kTelemetryDefaultIntervalMs;
+    case LinkTopic::Settings:
+      return hz > 0.0f ? clampInterval(1000.0f / hz, 0, kLinkTopicMaxIntervalMs) : 0;
+    case LinkTopic::Profile:
+      return hz > 0.0f ? clampInterval(1000.0f / hz, kProfilePushMinIntervalMs, kLinkTopicMaxIntervalMs)
+                       : kProfilePushDefaultIntervalMs;
+    default:
+      return 0;
+  }
+}
 
 void applyMotorTypeChangeIfNeeded(bool motorTypeChanged) {
   if (motorTypeChanged) {
@@ -52,121 +95,306 @@ bool isValidStaPassword(const char* password) {
   }
   return strlen(password) <= WIFI_STA_PASSWORD_MAX;
 }
-}  // namespace
 
-DeviceCommandResult deviceProtocolHandleJson(const char* json, size_t len) {
-  DeviceCommandResult result;
+// Acks go into the result's fixed buffer; only get_settings / get_profile (or an ack echoing an
+// oversized client string) build a String payload.
+void setAck(DeviceCommandResult& result, const JsonDocument& ackDoc) {
+  result.ackLength = serializeJson(ackDoc, result.ackJson, sizeof(result.ackJson));
+  if (result.ackLength + 1 >= sizeof(result.ackJson)) {
+    result.ackLength = 0;
+    serializeJson(ackDoc, result.unicastJson);
+  }
+  result.hasUnicast = true;
+}
 
-  StaticJsonDocument<768> doc;
-  DeserializationError error = deserializeJson(doc, json, len);
-  if (error) {
-    Serial.printf("[DeviceProtocol] JSON parse error: %s\n", error.c_str());
-    return result;
+void commandMotorStart(JsonObjectConst, DeviceCommandResult&) {
+  ControlLockGuard lock;
+  sessionLogNoteStart(SessionStartReason::Remote);
+  setMotorState(true);
+}
+
+void commandMotorStop(JsonObjectConst, DeviceCommandResult&) {
+  ControlLockGuard lock;
+  sessionLogNoteStop(SessionStopReason::Remote);
+  setMotorState(false);
+}
+
+void commandHeartbeat(JsonObjectConst, DeviceCommandResult&) {
+  ControlLockGuard lock;
+  handleMotorHeartbeat();
+}
+
+void commandGetSettings(JsonObjectConst args, DeviceCommandResult& result) {
+  // if_version marks the client as version-aware: "not modified" when it is current, and later
+  // changes arrive as settings_delta instead of the full payload.
+  const JsonVariantConst ifVersion = args["if_version"];
+  const uint32_t version = runtimeSettingsVersion();
+  if (!ifVersion.isNull()) {
+    result.settingsVersionAware = true;
+  }
+  if (!ifVersion.isNull() && (ifVersion | 0UL) == version) {
+    StaticJsonDocument<128> ackDoc;
+    ackDoc["ack"] = "get_settings";
+    ackDoc["ok"] = true;
+    ackDoc["not_modified"] = true;
+    ackDoc["version"] = version;
+    setAck(result, ackDoc);
+  } else {
+    deviceProtocolBuildSettingsPayload(result.unicastJson);
+    result.hasUnicast = true;
   }
+  result.settingsVersionSent = version;
+}
 
-  if (doc.containsKey("command") && doc["command"].is<const char*>()) {
-    const char* command = doc["command"];
-    if (strcmp(command, "motor_start") == 0) {
-      setMotorState(true);
-      result.handled = true;
-      return result;
-    }
-    if (strcmp(command, "motor_stop") == 0) {
-      setMotorState(false);
-      result.handled = true;
-      return result;
+void commandGetProfile(JsonObjectConst args, DeviceCommandResult& result) {
+  deviceProtocolBuildProfilePayload(result.unicastJson);
+  if (args["reset"] | false) {
+    loopProfilerReset();
+  }
+  result.hasUnicast = true;
+}
+
+void commandSetSetting(JsonObjectConst args, DeviceCommandResult& result) {
+  ControlLockGuard lock;
+  const char* key = args["key"] | "";
+  const JsonVariantConst value = args["value"];
+  RuntimeSettings& rs = getRuntimeSettings();
+  const MotorType oldType = rs.motorType;
+  const bool ok = settingsApiApplySetting(rs, key, value);
+  result.motorTypeChanged = ok && oldType != rs.motorType;
+  applyMotorTypeChangeIfNeeded(result.motorTypeChanged);
+
+  StaticJsonDocument<160> ackDoc;
+  ackDoc["ack"] = "set_setting";
+  ackDoc["key"] = key;
+  ackDoc["ok"] = ok;
+  setAck(result, ackDoc);
+}
+
+void commandSetSettings(JsonObjectConst args, DeviceCommandResult& result) {
+  ControlLockGuard lock;
+  JsonObjectConst values = args["values"].as<JsonObjectConst>();
+  RuntimeSettings& rs = getRuntimeSettings();
+  const MotorType oldType = rs.motorType;
+  uint8_t applied = 0;
+  uint8_t failed = 0;
+  for (JsonPairConst kv : values) {
+    if (settingsApiApplySetting(rs, kv.key().c_str(), kv.value())) {
+      ++applied;
+    } else {
+      ++failed;
     }
-    if (strcmp(command, "heartbeat") == 0) {
-      handleMotorHeartbeat();
-      result.handled = true;
-      return result;
+  }
+  result.motorTypeChanged = applied > 0 && oldType != rs.motorType;
+  applyMotorTypeChangeIfNeeded(result.motorTypeChanged);
+
+  StaticJsonDocument<160> ackDoc;
+  ackDoc["ack"] = "set_settings";
+  ackDoc["applied"] = applied;
+  ackDoc["failed"] = failed;
+  ackDoc["ok"] = failed == 0;
+  setAck(result, ackDoc);
+}
+
+void commandSetFormat(JsonObjectConst args, DeviceCommandResult& result) {
+  const char* format = args["format"] | "json";
+  const bool binary = strcmp(format, "binary") == 0;
+  const bool ok = binary || strcmp(format, "json") == 0;
+  uint32_t intervalMs = args["interval_ms"] | static_cast<uint32_t>(kTelemetryDefaultIntervalMs);
+  if (intervalMs < kTelemetryMinIntervalMs) {
+    intervalMs = kTelemetryMinIntervalMs;
+  }
+  if (intervalMs > kTelemetryMaxIntervalMs) {
+    intervalMs = kTelemetryMaxIntervalMs;
+  }
+  if (ok) {
+    result.setsTelemetryFormat = true;
+    result.telemetryFormat = binary ? TelemetryFormat::Binary : TelemetryFormat::Json;
+    result.telemetryIntervalMs = static_cast<uint16_t>(intervalMs);
+  }
+
+  StaticJsonDocument<160> ackDoc;
+  ackDoc["ack"] = "set_format";
+  ackDoc["ok"] = ok;
+  ackDoc["format"] = ok ? (binary ? "binary" : "json") : format;
+  ackDoc["version"] = kTelemetryFrameVersion;
+  ackDoc["interval_ms"] = intervalMs;
+  setAck(result, ackDoc);
+}
+
+void commandSubscribe(JsonObjectConst args, DeviceCommandResult& result) {
+  // {"topics":["telemetry","notify"]} or {"topics":{"telemetry":20,"profile":1}} (value = max Hz).
+  const JsonVariantConst topics = args["topics"];
+  uint8_t mask = 0;
+  uint16_t intervals[kLinkTopicCount] = {};
+  const char* unknown = nullptr;
+  auto add = [&](const char* name, float hz) {
+    LinkTopic topic;
+    if (!topicFromName(name, topic)) {
+      unknown = name;
+      return;
     }
-    if (strcmp(command, "get_settings") == 0) {
-      deviceProtocolBuildSettingsPayload(result.unicastJson);
-      result.hasUnicast = true;
-      result.handled = true;
-      return result;
+    mask |= linkTopicBit(topic);
+    intervals[static_cast<uint8_t>(topic)] = topicIntervalFromHz(topic, hz);
+  };
+  if (topics.is<JsonArrayConst>()) {
+    for (JsonVariantConst name : topics.as<JsonArrayConst>()) {
+      add(name.as<const char*>(), 0.0f);
     }
-    if (strcmp(command, "set_setting") == 0) {
-      const char* key = doc["key"] | "";
-      const JsonVariantConst value = doc["value"];
-      RuntimeSettings& rs = getRuntimeSettings();
-      const MotorType oldType = rs.motorType;
-      const bool ok = settingsApiApplySetting(rs, key, value);
-      result.motorTypeChanged = ok && oldType != rs.motorType;
-      applyMotorTypeChangeIfNeeded(result.motorTypeChanged);
-
-      StaticJsonDocument<160> ackDoc;
-      ackDoc["ack"] = "set_setting";
-      ackDoc["key"] = key;
-      ackDoc["ok"] = ok;
-      serializeJson(ackDoc, result.unicastJson);
-      result.hasUnicast = true;
-      result.handled = true;
-      return result;
+  } else if (topics.is<JsonObjectConst>()) {
+    for (JsonPairConst kv : topics.as<JsonObjectConst>()) {
+      add(kv.key().c_str(), kv.value() | 0.0f);
     }
-    if (strcmp(command, "set_settings") == 0) {
-      JsonObjectConst values = doc["values"].as<JsonObjectConst>();
-      RuntimeSettings& rs = getRuntimeSettings();
-      const MotorType oldType = rs.motorType;
-      uint8_t applied = 0;
-      uint8_t failed = 0;
-      for (JsonPairConst kv : values) {
-        if (settingsApiApplySetting(rs, kv.key().c_str(), kv.value())) {
-          ++applied;
-        } else {
-          ++failed;
-        }
+  } else {
+    unknown = "";
+  }
+  const bool ok = unknown == nullptr;
+  if (ok) {
+    result.setsSubscriptions = true;
+    result.topics = mask;
+    memcpy(result.topicIntervalMs, intervals, sizeof(intervals));
+  }
+
+  StaticJsonDocument<256> ackDoc;
+  ackDoc["ack"] = "subscribe";
+  ackDoc["ok"] = ok;
+  if (ok) {
+    JsonObject effective = ackDoc.createNestedObject("topics");
+    for (uint8_t i = 0; i < kLinkTopicCount; ++i) {
+      if ((mask & (1U << i)) != 0) {
+        effective[kLinkTopicNames[i]] = intervals[i] > 0 ? 1000.0f / intervals[i] : 0.0f;
       }
-      result.motorTypeChanged = applied > 0 && oldType != rs.motorType;
-      applyMotorTypeChangeIfNeeded(result.motorTypeChanged);
-
-      StaticJsonDocument<160> ackDoc;
-      ackDoc["ack"] = "set_settings";
-      ackDoc["applied"] = applied;
-      ackDoc["failed"] = failed;
-      ackDoc["ok"] = failed == 0;
-      serializeJson(ackDoc, result.unicastJson);
-      result.hasUnicast = true;
-      result.handled = true;
-      return result;
     }
-    if (strcmp(command, "set_wifi") == 0) {
-      const char* ssid = doc["ssid"] | "";
-      const char* password = doc["password"] | "";
-      const bool inApMode = getWiFiLinkRole() == WiFiLinkRole::AccessPoint;
-      const bool valid = inApMode && isValidStaSsid(ssid) && isValidStaPassword(password);
-      bool ok = false;
-
-      if (valid) {
-        ok = wifiCredentialsSave(ssid, password);
-        if (ok) {
-          wifiCredentialsSetProbePending();
-          result.requestRestart = true;
-        }
-      }
+  } else {
+    ackDoc["error"] = "unknown_topic";
+    ackDoc["topic"] = unknown;
+  }
+  setAck(result, ackDoc);
+}
 
-      StaticJsonDocument<192> ackDoc;
-      ackDoc["ack"] = "set_wifi";
-      ackDoc["ok"] = ok;
-      if (!inApMode) {
-        ackDoc["error"] = "not_ap_mode";
-      } else if (!isValidStaSsid(ssid)) {
-        ackDoc["error"] = "invalid_ssid";
-      } else if (!isValidStaPassword(password)) {
-        ackDoc["error"] = "invalid_password";
-      } else if (!ok) {
-        ackDoc["error"] = "save_failed";
-      }
-      serializeJson(ackDoc, result.unicastJson);
-      result.hasUnicast = true;
-      result.handled = true;
-      return result;
+void commandStreamStart(JsonObjectConst args, DeviceCommandResult& result) {
+  const uint32_t rate = args["rate_hz"] | static_cast<uint32_t>(kStreamDefaultRateHz);
+  const uint32_t batch = args["batch"] | static_cast<uint32_t>(kStreamDefaultBatch);
+  const uint32_t mask = args["mask"] | static_cast<uint32_t>(kStreamFieldAll);
+  result.startsStream = true;
+  result.streamConfig = telemetryStreamNormalize(static_cast<uint16_t>(rate > 0xFFFFU ? 0xFFFFU : rate),
+                                                 static_cast<uint8_t>(mask & 0xFFU),
+                                                 static_cast<uint8_t>(batch > 0xFFU ? 0xFFU : batch));
+
+  StaticJsonDocument<192> ackDoc;
+  ackDoc["ack"] = "stream_start";
+  ackDoc["ok"] = true;
+  ackDoc["version"] = kStreamBatchVersion;
+  ackDoc["period_ms"] = result.streamConfig.periodMs;
+  ackDoc["rate_hz"] = 1000U / result.streamConfig.periodMs;
+  ackDoc["mask"] = result.streamConfig.fieldMask;
+  ackDoc["batch"] = result.streamConfig.batch;
+  setAck(result, ackDoc);
+}
+
+void commandStreamStop(JsonObjectConst, DeviceCommandResult& result) {
+  result.stopsStream = true;
+  StaticJsonDocument<96> ackDoc;
+  ackDoc["ack"] = "stream_stop";
+  ackDoc["ok"] = true;
+  ackDoc["dropped"] = telemetryStreamDropped();
+  setAck(result, ackDoc);
+}
+
+// {"command":"get_sessions","from":<seq>,"count":<n>}: the ack says what is kept, then the
+// records follow as binary session pages on this connection.
+void commandGetSessions(JsonObjectConst args, DeviceCommandResult& result) {
+  const bool ok = sessionLogReady();
+  const uint32_t oldest = sessionLogOldestSeq();
+  const uint32_t newest = sessionLogNewestSeq();
+  uint32_t from = args["from"] | oldest;
+  from = from < oldest ? oldest : from;
+  const uint32_t available = oldest == 0 || from > newest ? 0 : newest - from + 1;
+  const uint32_t wanted = args["count"] | kSessionLogCapacity;
+  const uint32_t count = wanted < available ? wanted : available;
+  if (ok) {
+    result.startsSessionDump = true;
+    result.sessionFromSeq = from;
+    result.sessionCount = count;
+  }
+
+  StaticJsonDocument<160> ackDoc;
+  ackDoc["ack"] = "get_sessions";
+  ackDoc["ok"] = ok;
+  ackDoc["version"] = kSessionLogVersion;
+  ackDoc["oldest"] = oldest;
+  ackDoc["newest"] = newest;
+  ackDoc["count"] = count;
+  setAck(result, ackDoc);
+}
+
+// Standard base64 with padding; `out` needs 4 * ((len + 2) / 3) + 1 bytes.
+void base64Encode(const uint8_t* data, size_t len, char* out) {
+  static constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  for (size_t i = 0; i < len; i += 3) {
+    const uint32_t n = (static_cast<uint32_t>(data[i]) << 16) | (i + 1 < len ? data[i + 1] << 8 : 0) |
+                       (i + 2 < len ? data[i + 2] : 0);
+    *out++ = kAlphabet[(n >> 18) & 0x3F];
+    *out++ = kAlphabet[(n >> 12) & 0x3F];
+    *out++ = i + 1 < len ? kAlphabet[(n >> 6) & 0x3F] : '=';
+    *out++ = i + 2 < len ? kAlphabet[n & 0x3F] : '=';
+  }
+  *out = '\0';
+}
+
+// {"command":"get_stats"}: the load statistics export blob, base64 so it travels as one reply on
+// any transport.
+void commandGetStats(JsonObjectConst, DeviceCommandResult& result) {
+  // Static: 1.5 KB is too much for the I/O task stack, and commands only run on that task.
+  static uint8_t blob[kMotorStatsBlobSize];
+  static char encoded[4 * ((kMotorStatsBlobSize + 2) / 3) + 1];
+  const size_t len = maximumStatsExport(blob, sizeof(blob));
+  base64Encode(blob, len, encoded);
+
+  StaticJsonDocument<160> ackDoc;
+  ackDoc["ack"] = "get_stats";
+  ackDoc["ok"] = len > 0;
+  ackDoc["version"] = kMotorStatsBlobVersion;
+  ackDoc["size"] = len;
+  ackDoc["blob"] = static_cast<const char*>(encoded);
+  setAck(result, ackDoc);
+}
+
+void commandSetWifi(JsonObjectConst args, DeviceCommandResult& result) {
+  const char* ssid = args["ssid"] | "";
+  const char* password = args["password"] | "";
+  const bool inApMode = getWiFiLinkRole() == WiFiLinkRole::AccessPoint;
+  const bool valid = inApMode && isValidStaSsid(ssid) && isValidStaPassword(password);
+  bool ok = false;
+
+  if (valid) {
+    ok = wifiCredentialsSave(ssid, password);
+    if (ok) {
+      wifiCredentialsSetProbePending();
+      result.requestRestart = true;
     }
   }
 
-  JsonObject obj = doc.as<JsonObject>();
-  for (JsonPair pair : obj) {
+  StaticJsonDocument<192> ackDoc;
+  ackDoc["ack"] = "set_wifi";
+  ackDoc["ok"] = ok;
+  if (!inApMode) {
+    ackDoc["error"] = "not_ap_mode";
+  } else if (!isValidStaSsid(ssid)) {
+    ackDoc["error"] = "invalid_ssid";
+  } else if (!isValidStaPassword(password)) {
+    ackDoc["error"] = "invalid_password";
+  } else if (!ok) {
+    ackDoc["error"] = "save_failed";
+  }
+  setAck(result, ackDoc);
+}
+
+// Plain objects without "command" are motor keys ({"speed":n}, …); true if any key was used.
+bool applyMotorKeys(JsonObjectConst obj) {
+  bool handled = false;
+  ControlLockGuard lock;
+  for (JsonPairConst pair : obj) {
     const char* key = pair.key().c_str();
 
     if (strcmp(key, "speed") == 0) {
@@ -183,7 +411,7 @@ DeviceCommandResult deviceProtocolHandleJson(const char* json, size_t len) {
         speed = 100;
       }
       setSpeed(static_cast<uint8_t>(speed));
-      result.handled = true;
+      handled = true;
       continue;
     }
 
@@ -191,24 +419,313 @@ DeviceCommandResult deviceProtocolHandleJson(const char* json, size_t len) {
       const int value = pair.value().is<int>() ? pair.value().as<int>()
                                                : static_cast<int>(pair.value().as<float>());
       handleMotorCommand(key, value);
+      handled = true;
+    }
+  }
+  return handled;
+}
+
+using CommandHandler = void (*)(JsonObjectConst args, DeviceCommandResult& result);
+
+struct CommandEntry {
+  const char* name;
+  CommandHandler handler;
+};
+
+void commandBatch(JsonObjectConst args, DeviceCommandResult& result);
+
+constexpr CommandEntry kCommands[] = {
+    {"motor_start", commandMotorStart},
+    {"motor_stop", commandMotorStop},
+    {"heartbeat", commandHeartbeat},
+    {"get_settings", commandGetSettings},
+    {"get_profile", commandGetProfile},
+    {"set_setting", commandSetSetting},
+    {"set_settings", commandSetSettings},
+    {"set_format", commandSetFormat},
+    {"subscribe", commandSubscribe},
+    {"stream_start", commandStreamStart},
+    {"stream_stop", commandStreamStop},
+    {"get_sessions", commandGetSessions},
+    {"get_stats", commandGetStats},
+    {"set_wifi", commandSetWifi},
+    {"batch", commandBatch},
+};
+constexpr size_t kCommandCount = sizeof(kCommands) / sizeof(kCommands[0]);
+
+// Perfect hash over the command names: the compiler searches for a seed that gives every name its
+// own slot, so a lookup is one hash, one table read and one strcmp to reject unknown names.
+constexpr uint32_t kCommandSlotBits = 5;
+constexpr size_t kCommandSlots = size_t{1} << kCommandSlotBits;
+static_assert(kCommandSlots >= 2 * kCommandCount, "command slot table too small");
+
+constexpr uint32_t commandHash(const char* name, uint32_t seed) {
+  uint32_t h = 2166136261U ^ seed;  // FNV-1a
+  for (; *name != '\0'; ++name) {
+    h = (h ^ static_cast<uint8_t>(*name)) * 16777619U;
+  }
+  return h;
+}
+
+// FNV-1a's low bits only see the low bits of each byte, so the slot comes from the top bits.
+constexpr size_t commandSlot(const char* name, uint32_t seed) {
+  return commandHash(name, seed) >> (32 - kCommandSlotBits);
+}
+
+constexpr bool commandSeedIsPerfect(uint32_t seed) {
+  bool used[kCommandSlots] = {};
+  for (size_t i = 0; i < kCommandCount; ++i) {
+    const size_t slot = commandSlot(kCommands[i].name, seed);
+    if (used[slot]) {
+      return false;
+    }
+    used[slot] = true;
+  }
+  return true;
+}
+
+constexpr uint32_t findCommandSeed() {
+  for (uint32_t seed = 0; seed < 4096; ++seed) {
+    if (commandSeedIsPerfect(seed)) {
+      return seed;
+    }
+  }
+  return UINT32_MAX;
+}
+
+constexpr uint32_t kCommandSeed = findCommandSeed();
+static_assert(kCommandSeed != UINT32_MAX, "no collision-free seed; grow kCommandSlots");
+
+struct CommandSlotTable {
+  int8_t index[kCommandSlots];
+};
+
+constexpr CommandSlotTable buildCommandSlots() {
+  CommandSlotTable table{};
+  for (size_t i = 0; i < kCommandSlots; ++i) {
+    table.index[i] = -1;
+  }
+  for (size_t i = 0; i < kCommandCount; ++i) {
+    table.index[commandSlot(kCommands[i].name, kCommandSeed)] = static_cast<int8_t>(i);
+  }
+  return table;
+}
+
+constexpr CommandSlotTable kCommandSlotTable = buildCommandSlots();
+
+const CommandEntry* findCommand(const char* name) {
+  const int8_t index = kCommandSlotTable.index[commandSlot(name, kCommandSeed)];
+  if (index < 0 || strcmp(kCommands[index].name, name) != 0) {
+    return nullptr;
+  }
+  return &kCommands[index];
+}
+
+// Appends to the fixed ack buffer and moves the reply to unicastJson once it would not fit.
+void appendReply(DeviceCommandResult& result, const char* text, size_t len) {
+  if (result.unicastJson.length() == 0 && result.ackLength + len < sizeof(result.ackJson)) {
+    memcpy(result.ackJson + result.ackLength, text, len);
+    result.ackLength += len;
+    result.ackJson[result.ackLength] = '\0';
+    return;
+  }
+  if (result.ackLength > 0) {
+    result.unicastJson.concat(result.ackJson, static_cast<unsigned>(result.ackLength));
+    result.ackLength = 0;
+  }
+  result.unicastJson.concat(text, static_cast<unsigned>(len));
+}
+
+void appendReply(DeviceCommandResult& result, const char* text) {
+  appendReply(result, text, strlen(text));
+}
+
+// Folds one batched command's side effects into the batch result; the last command of a kind wins.
+void mergeCommandResult(DeviceCommandResult& into, const DeviceCommandResult& from) {
+  into.motorTypeChanged = into.motorTypeChanged || from.motorTypeChanged;
+  into.requestSettingsBroadcast = into.requestSettingsBroadcast || from.requestSettingsBroadcast;
+  into.requestRestart = into.requestRestart || from.requestRestart;
+  if (from.setsTelemetryFormat) {
+    into.setsTelemetryFormat = true;
+    into.telemetryFormat = from.telemetryFormat;
+    into.telemetryIntervalMs = from.telemetryIntervalMs;
+  }
+  if (from.setsSubscriptions) {
+    // The new topic set decides the stream; device_link applies subscriptions before stream_*.
+    into.setsSubscriptions = true;
+    into.topics = from.topics;
+    memcpy(into.topicIntervalMs, from.topicIntervalMs, sizeof(into.topicIntervalMs));
+    into.startsStream = into.startsStream && (from.topics & linkTopicBit(LinkTopic::Stream)) != 0;
+    into.stopsStream = false;
+  }
+  if (from.startsStream || from.stopsStream) {
+    into.startsStream = from.startsStream;
+    into.stopsStream = from.stopsStream;
+    into.streamConfig = from.streamConfig;
+  }
+  if (from.settingsVersionSent > into.settingsVersionSent) {
+    into.settingsVersionSent = from.settingsVersionSent;
+  }
+  into.settingsVersionAware = into.settingsVersionAware || from.settingsVersionAware;
+  if (from.startsSessionDump) {
+    into.startsSessionDump = true;
+    into.sessionFromSeq = from.sessionFromSeq;
+    into.sessionCount = from.sessionCount;
+  }
+}
+
+// {"command":"batch","commands":[{…},{…}]} runs each entry in order (a command or motor keys) and
+// replies once: {"ack":"batch","ok":all handled,"results":[<ack> or {"ok":bool}, …]}.
+void commandBatch(JsonObjectConst args, DeviceCommandResult& result) {
+  const JsonArrayConst commands = args["commands"].as<JsonArrayConst>();
+  size_t count = 0;
+  bool allHandled = !commands.isNull();
+  appendReply(result, "{\"ack\":\"batch\",\"results\":[");
+  for (JsonVariantConst item : commands) {
+    if (count == kBatchMaxCommands) {
+      allHandled = false;
+      break;
+    }
+    appendReply(result, count++ > 0 ? "," : "");
+    const JsonObjectConst sub = item.as<JsonObjectConst>();
+    const char* name = sub["command"].as<const char*>();
+    if (name != nullptr && strcmp(name, "batch") == 0) {
+      appendReply(result, "{\"ok\":false,\"error\":\"nested_batch\"}");
+      allHandled = false;
+      continue;
+    }
+    DeviceCommandResult subResult;
+    const CommandEntry* entry = name != nullptr ? findCommand(name) : nullptr;
+    if (entry != nullptr) {
+      entry->handler(sub, subResult);
+      subResult.handled = true;
+    } else if (!sub.isNull()) {
+      subResult.handled = applyMotorKeys(sub);
+    }
+    if (subResult.hasUnicast) {
+      appendReply(result, subResult.unicastData(), subResult.unicastLength());
+    } else {
+      appendReply(result, subResult.handled ? "{\"ok\":true}" : "{\"ok\":false,\"error\":\"unknown_command\"}");
+    }
+    allHandled = allHandled && subResult.handled;
+    mergeCommandResult(result, subResult);
+  }
+  appendReply(result, allHandled ? "],\"ok\":true}" : "],\"ok\":false}");
+  result.hasUnicast = true;
+}
+}  // namespace
+
+DeviceCommandResult deviceProtocolHandleJson(const char* json, size_t len) {
+  DeviceCommandResult result;
+
+  StaticJsonDocument<768> doc;
+  DeserializationError error = deserializeJson(doc, json, len);
+  if (error) {
+    Serial.printf("[DeviceProtocol] JSON parse error: %s\n", error.c_str());
+    return result;
+  }
+
+  const char* command = doc["command"].as<const char*>();
+  if (command != nullptr) {
+    const CommandEntry* entry = findCommand(command);
+    if (entry != nullptr) {
+      entry->handler(doc.as<JsonObjectConst>(), result);
       result.handled = true;
+      return result;
     }
   }
 
+  result.handled = applyMotorKeys(doc.as<JsonObjectConst>());
   return result;
 }
 
 void deviceProtocolBuildSettingsPayload(String& out) {
-  DynamicJsonDocument outDoc(kSettingsJsonCapacity);
-  JsonObject root = outDoc.to<JsonObject>();
-  settingsApiWritePayload(root);
-  deviceProtocolWriteWifiStatus(root);
+  RuntimeSettings rs;
+  uint32_t version = 0;
+  {
+    ControlLockGuard lock;
+    rs = getRuntimeSettings();
+    version = runtimeSettingsVersion();
+  }
+  // WiFi status members, spliced into the payload without their braces.
+  StaticJsonDocument<192> wifiDoc;
+  deviceProtocolWriteWifiStatus(wifiDoc.to<JsonObject>());
+  char wifi[160];
+  const size_t wifiLen = serializeJson(wifiDoc, wifi, sizeof(wifi));
+  if (wifiLen >= 2) {
+    wifi[wifiLen - 1] = '\0';
+  }
+  settingsApiBuildPayload(out, rs, version, wifiLen >= 2 ? wifi + 1 : "");
+  Serial.printf("[DeviceProtocol] settings payload %u bytes (v%lu)\n", static_cast<unsigned>(out.length()),
+                static_cast<unsigned long>(version));
+}
+
+bool deviceProtocolBuildSettingsDelta(String& out, uint32_t fromVersion) {
+  RuntimeSettings before;
+  RuntimeSettings now;
+  uint32_t version = 0;
+  {
+    ControlLockGuard lock;
+    version = runtimeSettingsVersion();
+    if (fromVersion == version || !runtimeSettingsAtVersion(fromVersion, before)) {
+      return false;
+    }
+    now = getRuntimeSettings();
+  }
+  settingsApiBuildDelta(out, before, fromVersion, now, version);
+  return true;
+}
+
+uint32_t deviceProtocolSettingsVersion() {
+  return runtimeSettingsVersion();
+}
+
+void deviceProtocolBuildProfilePayload(String& out) {
+  DynamicJsonDocument outDoc(kProfileJsonCapacity);
+  JsonObject profile = outDoc.createNestedObject("profile");
+  loopProfilerWriteJson(profile);
+  bootProfilerWriteJson(profile.createNestedObject("boot"));
+  if (bleTransportHasClient()) {
+    const BleTxStats ble = bleTransportTxStats();
+    JsonObject tx = outDoc.createNestedObject("ble_tx");
+    tx["mtu"] = ble.mtu;
+    tx["window"] = ble.window;
+    tx["in_flight"] = ble.inFlight;
+    tx["notifications"] = ble.notifications;
+    tx["bytes"] = ble.bytes;
+    tx["retries"] = ble.retries;
+    tx["status_errors"] = ble.statusErrors;
+    tx["payloads"] = ble.payloads;
+    tx["aborted"] = ble.aborted;
+    tx["frames_dropped"] = ble.framesDropped;
+    tx["queue_drops"] = ble.queueDrops;
+    tx["telemetry_coalesced"] = ble.telemetryCoalesced;
+    tx["last_payload_bytes"] = ble.lastPayloadBytes;
+    tx["last_payload_ms"] = ble.lastPayloadMs;
+    tx["best_bytes_per_s"] = ble.bestBytesPerSec;
+  }
+  JsonArray wsTx;
+  for (uint8_t i = 0; i < kWebSocketMaxClients; ++i) {
+    WebSocketClientStats ws;
+    if (!webSocketClientStats(i, ws)) {
+      continue;
+    }
+    if (wsTx.isNull()) {
+      wsTx = outDoc.createNestedArray("ws_tx");
+    }
+    JsonObject tx = wsTx.createNestedObject();
+    tx["client"] = i;
+    tx["queue"] = ws.queueDepth;
+    tx["peak"] = ws.peakQueueDepth;
+    tx["sent"] = ws.sent;
+    tx["bytes"] = ws.bytes;
+    tx["dropped"] = ws.dropped;
+    tx["telemetry_dropped"] = ws.telemetryDropped;
+  }
   if (outDoc.overflowed()) {
-    Serial.println("[DeviceProtocol] WARN: settings payload JSON overflow");
+    Serial.println("[DeviceProtocol] WARN: profile payload JSON overflow");
   }
-  out.reserve(6144);
   serializeJson(outDoc, out);
-  Serial.printf("[DeviceProtocol] settings payload %u bytes\n", static_cast<unsigned>(out.length()));
 }
 
 void deviceProtocolBuildTelemetryJson(String& out,
@@ -248,6 +765,72 @@ void deviceProtocolBuildTelemetryJson(String& out,
   }
 }
 
+namespace {
+void putU16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void putU32(uint8_t* p, uint32_t v) {
+  putU16(p, static_cast<uint16_t>(v));
+  putU16(p + 2, static_cast<uint16_t>(v >> 16));
+}
+
+int16_t centiClamped(float value) {
+  const float c = value * 100.0f;
+  if (c >= 32767.0f) {
+    return INT16_MAX;
+  }
+  if (c <= -32768.0f) {
+    return INT16_MIN;
+  }
+  return static_cast<int16_t>(lroundf(c));
+}
+}  // namespace
+
+size_t deviceProtocolBuildTelemetryFrame(uint8_t* out, const TelemetrySnapshot& snapshot) {
+  memset(out, 0, kTelemetryFrameSize);
+  uint8_t present = kTelemetryFrameHasSpeed | kTelemetryFrameHasMcuTemp;
+  if (snapshot.temperatureReady) {
+    present |= kTelemetryFrameHasTemp;
+    putU16(out + 6, static_cast<uint16_t>(centiClamped(snapshot.temperatureC)));
+  }
+  if (snapshot.batteryVoltage > 0.0f) {
+    present |= kTelemetryFrameHasBattery;
+    const float mv = snapshot.batteryVoltage * 1000.0f;
+    putU16(out + 8, mv >= 65535.0f ? 65535U : static_cast<uint16_t>(lroundf(mv)));
+  }
+  if (snapshot.rpmReady) {
+    present |= kTelemetryFrameHasRpm;
+    putU32(out + 10, snapshot.rpm > 0.0f ? static_cast<uint32_t>(lroundf(snapshot.rpm)) : 0U);
+  }
+  if (snapshot.batterySocPercent >= 0) {
+    present |= kTelemetryFrameHasSoc;
+    out[15] = static_cast<uint8_t>(snapshot.batterySocPercent);
+  }
+  uint8_t role = 0;
+  switch (getWiFiLinkRole()) {
+    case WiFiLinkRole::Sta:
+      role = 1;
+      break;
+    case WiFiLinkRole::AccessPoint:
+      role = 2;
+      break;
+    default:
+      break;
+  }
+
+  out[0] = kTelemetryFrameMagic;
+  out[1] = kTelemetryFrameVersion;
+  out[2] = present;
+  out[3] = static_cast<uint8_t>((snapshot.motorActive ? kTelemetryFrameFlagMotorActive : 0U) |
+                                (role << kTelemetryFrameRoleShift));
+  putU16(out + 4, static_cast<uint16_t>(snapshot.version));
+  out[14] = snapshot.speedPercent;
+  putU16(out + 16, static_cast<uint16_t>(centiClamped(snapshot.mcuTemperatureC)));
+  return kTelemetryFrameSize;
+}
+
 void deviceProtocolBuildNotifyJson(String& out,
                                    const char* id,
                                    const char* text,
@@ -260,8 +843,15 @@ void deviceProtocolBuildNotifyJson(String& out,
   serializeJson(doc, out);
 }
 
+const char* deviceProtocolTopicName(LinkTopic topic) {
+  const uint8_t index = static_cast<uint8_t>(topic);
+  return index < kLinkTopicCount ? kLinkTopicNames[index] : "";
+}
+
 void deviceProtocolAfterCommand(const DeviceCommandResult& result) {
   if (result.requestRestart) {
+    flushRuntimeSettings();
+    maximumStatsFlush();
     delay(800);
     ESP.restart();
   }
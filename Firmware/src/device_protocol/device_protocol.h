@@ -6,24 +6,116 @@
 
 #include <WString.h>
 
+#include "../telemetry_snapshot/telemetry_snapshot.h"
+#include "../telemetry_stream/telemetry_stream.h"
+
+/**
+ * Outgoing traffic classes shared by the transports: acks/notifies, latest telemetry (may be dropped
+ * or coalesced when a link is slow), bulk payloads (held back while the link's queue is full).
+ */
+enum class LinkTxClass : uint8_t { Control, Telemetry, Bulk };
+
+/** Telemetry encoding per connection; every client starts on JSON until it sends set_format. */
+enum class TelemetryFormat : uint8_t { Json = 0, Binary = 1 };
+
+constexpr uint16_t kTelemetryDefaultIntervalMs = 250;
+constexpr uint16_t kTelemetryMinIntervalMs = 20;
+constexpr uint16_t kTelemetryMaxIntervalMs = 5000;
+
+/**
+ * Binary telemetry frame v1: 20 bytes, little-endian, fixed offsets (fits one BLE notify at MTU 23).
+ *   0 u8 magic 0xA5   1 u8 version   2 u8 present bits   3 u8 flags
+ *   4 u16 seq (low bits of the snapshot version)   6 i16 motor temp [0.01 °C]   8 u16 pack [mV]
+ *  10 u32 rpm   14 u8 speed [%]   15 u8 soc [%]   16 i16 MCU temp [0.01 °C]   18 u16 reserved (0)
+ * Fields whose present bit is clear are 0 and must be ignored.
+ */
+constexpr uint8_t kTelemetryFrameMagic = 0xA5;
+constexpr uint8_t kTelemetryFrameVersion = 1;
+constexpr size_t kTelemetryFrameSize = 20;
+constexpr uint8_t kTelemetryFrameHasTemp = 1U << 0;
+constexpr uint8_t kTelemetryFrameHasBattery = 1U << 1;
+constexpr uint8_t kTelemetryFrameHasRpm = 1U << 2;
+constexpr uint8_t kTelemetryFrameHasSpeed = 1U << 3;
+constexpr uint8_t kTelemetryFrameHasSoc = 1U << 4;
+constexpr uint8_t kTelemetryFrameHasMcuTemp = 1U << 5;
+/** flags: bit 0 motor active, bits 1–2 WiFi role (0 none, 1 STA, 2 AP). */
+constexpr uint8_t kTelemetryFrameFlagMotorActive = 1U << 0;
+constexpr uint8_t kTelemetryFrameRoleShift = 1;
+
+/**
+ * Topics a link client subscribes to (bit n = topic n). New connections get telemetry, settings and
+ * notify; `subscribe` replaces the set, and payloads nobody is due for are never serialized.
+ */
+enum class LinkTopic : uint8_t { Telemetry = 0, Settings = 1, Notify = 2, Stream = 3, Profile = 4 };
+constexpr uint8_t kLinkTopicCount = 5;
+constexpr uint8_t linkTopicBit(LinkTopic topic) { return static_cast<uint8_t>(1U << static_cast<uint8_t>(topic)); }
+constexpr uint8_t kLinkTopicsDefault =
+    linkTopicBit(LinkTopic::Telemetry) | linkTopicBit(LinkTopic::Settings) | linkTopicBit(LinkTopic::Notify);
+/** Settings pushes are unlimited (0) by default; profile pushes run at 1 Hz unless a rate is given. */
+constexpr uint16_t kProfilePushDefaultIntervalMs = 1000;
+constexpr uint16_t kProfilePushMinIntervalMs = 250;
+constexpr uint16_t kLinkTopicMaxIntervalMs = 60000;
+
+/** Command acks are serialized into DeviceCommandResult::ackJson; larger replies use unicastJson. */
+constexpr size_t kDeviceAckCapacity = 256;
+
 struct DeviceCommandResult {
   bool handled = false;
   bool motorTypeChanged = false;
   bool requestSettingsBroadcast = false;
   bool requestRestart = false;
+  /** Reply for the sender: an ack in the fixed ackJson buffer, or the get_settings / get_profile payload. */
   bool hasUnicast = false;
+  char ackJson[kDeviceAckCapacity];
+  size_t ackLength = 0;
   String unicastJson;
+  /** set_format: the sending connection switches encoding/interval (applied by its transport). */
+  bool setsTelemetryFormat = false;
+  TelemetryFormat telemetryFormat = TelemetryFormat::Json;
+  uint16_t telemetryIntervalMs = kTelemetryDefaultIntervalMs;
+  /** stream_start / stream_stop for the sending connection (applied by its transport). */
+  bool startsStream = false;
+  bool stopsStream = false;
+  TelemetryStreamConfig streamConfig = {};
+  /** subscribe: replaces the sending connection's topics; 0 interval = no limit (applied by device_link). */
+  bool setsSubscriptions = false;
+  uint8_t topics = kLinkTopicsDefault;
+  uint16_t topicIntervalMs[kLinkTopicCount] = {};
+  /** get_settings: settings version the reply brings the client to; if_version opts into deltas. */
+  uint32_t settingsVersionSent = 0;
+  bool settingsVersionAware = false;
+  /** get_sessions: the sending connection receives session pages from this seq (sent by device_link). */
+  bool startsSessionDump = false;
+  uint32_t sessionFromSeq = 0;
+  uint32_t sessionCount = 0;
+
+  const char* unicastData() const { return ackLength > 0 ? ackJson : unicastJson.c_str(); }
+  size_t unicastLength() const { return ackLength > 0 ? ackLength : unicastJson.length(); }
 };
 
-/** Parse a JSON command from any transport (WebSocket, BLE, …). */
+/** Wire name of a topic ("telemetry", "settings", "notify", "stream", "profile"). */
+const char* deviceProtocolTopicName(LinkTopic topic);
+
+/**
+ * Parse a JSON command from any transport (WebSocket, BLE, …). "command" names are looked up in a
+ * compile-time perfect-hash table; other objects are motor keys ({"speed":n}, …).
+ */
 DeviceCommandResult deviceProtocolHandleJson(const char* json, size_t len);
 
 /** Run post-command side effects (e.g. restart after WiFi provisioning). */
 void deviceProtocolAfterCommand(const DeviceCommandResult& result);
 
-/** Full settings + schema payload (same shape as WebSocket get_settings). */
+/** Full settings + schema payload (same shape as WebSocket get_settings), tagged with its version. */
 void deviceProtocolBuildSettingsPayload(String& out);
 
+/** settings_delta from `fromVersion` to the current version; false if current or no longer kept. */
+bool deviceProtocolBuildSettingsDelta(String& out, uint32_t fromVersion);
+
+uint32_t deviceProtocolSettingsVersion();
+
+/** Per-section loop timing (get_profile): {"profile":{"sections":[{name,count,mean_us,p99_us,max_us,hist}]}}. */
+void deviceProtocolBuildProfilePayload(String& out);
+
 /** Live telemetry JSON broadcast every control loop tick. */
 void deviceProtocolBuildTelemetryJson(String& out,
                                       float tempC,
@@ -33,6 +125,9 @@ void deviceProtocolBuildTelemetryJson(String& out,
                                       bool motorActive,
                                       int8_t batterySoc);
 
+/** Binary counterpart of the telemetry JSON (layout above); returns kTelemetryFrameSize. */
+size_t deviceProtocolBuildTelemetryFrame(uint8_t* out, const TelemetrySnapshot& snapshot);
+
 /** One-shot user notification (WebUI toast). */
 void deviceProtocolBuildNotifyJson(String& out,
                                    const char* id,
@@ -15,7 +15,7 @@ struct DisplayTelemetry {
   int8_t batterySocPercent;  // 0-100, or -1 if unavailable
   bool motorActive;
   bool displayInfoMode;
-  uint8_t displayInfoPage;  // 0–5 info; 6+ settings (see devMenuTotalPageCount)
+  uint8_t displayInfoPage;  // 0–6 info; 7+ settings (see devMenuTotalPageCount)
   uint32_t uptimeSeconds;
   uint32_t freeHeapBytes;
   uint8_t batterySeriesCells;
@@ -2,6 +2,7 @@
 #include "boot_bitmap.h"
 #include "../button/button.h"
 #include "../settings/dev_menu.h"
+#include "../loop_profiler/loop_profiler.h"
 
 #include <Arduino.h>
 #include "../wifi/wifi.h"
@@ -295,6 +296,25 @@ void drawInfoPage091(uint8_t page, uint32_t uptimeSec, uint32_t freeHeap, uint8_
       break;
     }
 
+    case 6: {
+      drawBoldText091("Loop Profile", 0, 0);
+      char t[12];
+      const LoopProfileStats whole = loopProfilerStats(LoopProfileSection::Loop);
+      loopProfilerFormatUs(t, sizeof(t), whole.p99Us);
+      oled.setCursor(0, 8);
+      snprintf(line, sizeof(line), "Loop p99 %s", t);
+      oled.print(line);
+      LoopProfileStats worst[2];
+      const size_t n = loopProfilerWorstSections(worst, 2);
+      for (size_t i = 0; i < n; ++i) {
+        loopProfilerFormatUs(t, sizeof(t), worst[i].p99Us);
+        oled.setCursor(0, static_cast<int16_t>(16 + 8 * i));
+        snprintf(line, sizeof(line), "%-9s %s", worst[i].name, t);
+        oled.print(line);
+      }
+      break;
+    }
+
     default:
       if (page >= kDevMenuInfoPageCount) {
         const DevSettingDescriptor* d =
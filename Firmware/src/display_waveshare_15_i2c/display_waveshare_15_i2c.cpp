@@ -1,6 +1,7 @@
 #include "display_waveshare_15_i2c.h"
 #include "../button/button.h"
 #include "../settings/dev_menu.h"
+#include "../loop_profiler/loop_profiler.h"
 
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1327.h>
@@ -488,6 +489,31 @@ void drawInfoPage15(uint8_t page, uint32_t uptimeSec, uint32_t freeHeap, uint8_t
       break;
     }
 
+    case 6: {
+      display.setTextSize(2);
+      drawBoldText15("Loop Profile", 14, 8);
+      display.setTextSize(1);
+      char p99[12];
+      char worstUs[12];
+      const LoopProfileStats whole = loopProfilerStats(LoopProfileSection::Loop);
+      loopProfilerFormatUs(p99, sizeof(p99), whole.p99Us);
+      loopProfilerFormatUs(worstUs, sizeof(worstUs), whole.maxUs);
+      display.setCursor(8, 32);
+      snprintf(buf, sizeof(buf), "Loop p99/max %s/%s", p99, worstUs);
+      display.print(buf);
+      display.setCursor(8, 44);
+      display.print("Worst modules (p99)");
+      LoopProfileStats worst[5];
+      const size_t n = loopProfilerWorstSections(worst, 5);
+      for (size_t i = 0; i < n; ++i) {
+        loopProfilerFormatUs(p99, sizeof(p99), worst[i].p99Us);
+        display.setCursor(8, static_cast<int16_t>(58 + 12 * i));
+        snprintf(buf, sizeof(buf), "%-10s %s", worst[i].name, p99);
+        display.print(buf);
+      }
+      break;
+    }
+
     default:
       if (page >= kDevMenuInfoPageCount) {
         const DevSettingDescriptor* d =
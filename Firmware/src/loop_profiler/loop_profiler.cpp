@@ -0,0 +1,155 @@
+#include "loop_profiler.h"
+
+#include <Arduino.h>
+#include <ESP.h>
+#include <stdio.h>
+
+namespace {
+
+constexpr size_t kSectionCount = static_cast<size_t>(LoopProfileSection::Count);
+
+constexpr const char* kSectionNames[kSectionCount] = {
+    "buttons", "motor", "adc", "temp", "mcu_temp", "battery", "soc", "tach", "wifi", "ota", "max_stats", "led",
+    "cutoffs", "power", "settings", "sessions", "display", "motor_hb", "webserver", "link", "websocket", "ble", "telemetry",
+    "loop", "control",
+};
+
+struct SectionProfile {
+  uint32_t count;
+  uint64_t totalUs;
+  uint32_t maxUs;
+  uint32_t buckets[kLoopProfileBuckets];
+};
+
+SectionProfile s_sections[kSectionCount];
+uint32_t s_cyclesPerUs = 240;
+
+uint8_t bucketFor(uint32_t us) {
+  if (us < 2U) {
+    return 0;
+  }
+  const uint8_t b = static_cast<uint8_t>(31 - __builtin_clz(us));
+  return b < kLoopProfileBuckets ? b : static_cast<uint8_t>(kLoopProfileBuckets - 1U);
+}
+
+/** p99 from the log2 histogram, interpolated linearly inside the bucket and capped at the observed max. */
+uint32_t percentile99(const SectionProfile& p) {
+  if (p.count == 0) {
+    return 0;
+  }
+  const uint32_t target = p.count - p.count / 100U;
+  uint32_t seen = 0;
+  for (uint8_t b = 0; b < kLoopProfileBuckets; ++b) {
+    const uint32_t n = p.buckets[b];
+    if (n == 0) {
+      continue;
+    }
+    if (seen + n >= target) {
+      const uint32_t lo = b == 0 ? 0U : (1UL << b);
+      const uint32_t hi = b + 1U < kLoopProfileBuckets ? (1UL << (b + 1U)) : p.maxUs;
+      const uint32_t est = lo + static_cast<uint32_t>(static_cast<uint64_t>(hi - lo) * (target - seen) / n);
+      return est < p.maxUs ? est : p.maxUs;
+    }
+    seen += n;
+  }
+  return p.maxUs;
+}
+
+}  // namespace
+
+void initLoopProfiler() {
+  const uint32_t mhz = ESP.getCpuFreqMHz();
+  s_cyclesPerUs = mhz > 0 ? mhz : 240;
+  loopProfilerReset();
+}
+
+uint32_t loopProfilerStamp() {
+  return ESP.getCycleCount();
+}
+
+uint32_t loopProfilerLap(LoopProfileSection section, uint32_t since) {
+  const uint32_t now = ESP.getCycleCount();
+  const uint32_t us = (now - since) / s_cyclesPerUs;
+  SectionProfile& p = s_sections[static_cast<size_t>(section)];
+  p.count++;
+  p.totalUs += us;
+  if (us > p.maxUs) {
+    p.maxUs = us;
+  }
+  p.buckets[bucketFor(us)]++;
+  // Exclude the bookkeeping above from the next section.
+  return ESP.getCycleCount();
+}
+
+void loopProfilerReset() {
+  for (SectionProfile& p : s_sections) {
+    p = SectionProfile{};
+  }
+}
+
+LoopProfileStats loopProfilerStats(LoopProfileSection section) {
+  const SectionProfile& p = s_sections[static_cast<size_t>(section)];
+  LoopProfileStats s{};
+  s.name = kSectionNames[static_cast<size_t>(section)];
+  s.count = p.count;
+  s.meanUs = p.count > 0 ? static_cast<uint32_t>(p.totalUs / p.count) : 0U;
+  s.p99Us = percentile99(p);
+  s.maxUs = p.maxUs;
+  return s;
+}
+
+size_t loopProfilerWorstSections(LoopProfileStats* out, size_t maxCount) {
+  LoopProfileStats all[kSectionCount];
+  size_t n = 0;
+  for (size_t i = 0; i < kSectionCount; ++i) {
+    const auto section = static_cast<LoopProfileSection>(i);
+    if (section == LoopProfileSection::Loop || s_sections[i].count == 0) {
+      continue;
+    }
+    const LoopProfileStats s = loopProfilerStats(section);
+    size_t pos = n++;
+    while (pos > 0 && all[pos - 1].p99Us < s.p99Us) {
+      all[pos] = all[pos - 1];
+      --pos;
+    }
+    all[pos] = s;
+  }
+  const size_t count = n < maxCount ? n : maxCount;
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = all[i];
+  }
+  return count;
+}
+
+void loopProfilerFormatUs(char* out, size_t outSize, uint32_t us) {
+  if (us < 1000U) {
+    snprintf(out, outSize, "%luus", static_cast<unsigned long>(us));
+  } else {
+    snprintf(out, outSize, "%.1fms", static_cast<double>(us) / 1000.0);
+  }
+}
+
+void loopProfilerWriteJson(JsonObject out) {
+  out["cpu_mhz"] = s_cyclesPerUs;
+  out["uptime_ms"] = millis();
+  JsonArray sections = out.createNestedArray("sections");
+  for (size_t i = 0; i < kSectionCount; ++i) {
+    const SectionProfile& p = s_sections[i];
+    const LoopProfileStats s = loopProfilerStats(static_cast<LoopProfileSection>(i));
+    JsonObject j = sections.createNestedObject();
+    j["name"] = s.name;
+    j["count"] = s.count;
+    j["mean_us"] = s.meanUs;
+    j["p99_us"] = s.p99Us;
+    j["max_us"] = s.maxUs;
+    // Trailing empty buckets are dropped to keep the reply small.
+    uint8_t used = kLoopProfileBuckets;
+    while (used > 0 && p.buckets[used - 1U] == 0) {
+      --used;
+    }
+    JsonArray hist = j.createNestedArray("hist");
+    for (uint8_t b = 0; b < used; ++b) {
+      hist.add(p.buckets[b]);
+    }
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Timed sections of loop(); WebSocket and Ble are measured inside DeviceLink. */
+enum class LoopProfileSection : uint8_t {
+  Buttons = 0,
+  Motor,
+  Adc,
+  Temperature,
+  McuTemp,
+  Battery,
+  BatterySoc,
+  Tachometer,
+  WiFi,
+  Ota,
+  MaxStats,
+  Led,
+  Cutoffs,
+  Power,
+  Settings,  // queued NVS writes
+  Sessions,  // run recorder (LittleFS)
+  Display,
+  MotorHeartbeat,
+  WebServer,
+  DeviceLink,
+  WebSocket,
+  Ble,
+  Telemetry,
+  Loop,     // whole loop() iteration (I/O task iteration when the control task is split off)
+  Control,  // whole control tick
+  Count,
+};
+
+/** Histogram bucket b holds durations in [2^b, 2^(b+1)) us; bucket 0 also holds 0 us, the last is open-ended. */
+constexpr uint8_t kLoopProfileBuckets = 20;
+
+struct LoopProfileStats {
+  const char* name;
+  uint32_t count;
+  uint32_t meanUs;
+  uint32_t p99Us;
+  uint32_t maxUs;
+};
+
+void initLoopProfiler();
+
+/** Cycle-counter timestamp to start a section. */
+uint32_t loopProfilerStamp();
+
+/** Records the time since `since` against `section` and returns a fresh stamp for the next one. */
+uint32_t loopProfilerLap(LoopProfileSection section, uint32_t since);
+
+void loopProfilerReset();
+
+LoopProfileStats loopProfilerStats(LoopProfileSection section);
+
+/** Fills `out` with the sections (whole loop excluded) that have samples, worst p99 first. */
+size_t loopProfilerWorstSections(LoopProfileStats* out, size_t maxCount);
+
+/** "850us" / "12.4ms" for the info pages. */
+void loopProfilerFormatUs(char* out, size_t outSize, uint32_t us);
+
+/** Writes counts, mean/p99/max and the raw histogram of every section into `out`. */
+void loopProfilerWriteJson(JsonObject out);
+
+#endif  // LOOP_PROFILER_H
@@ -1,11 +1,17 @@
 #include <Arduino.h>
 #include <ESP.h>
+#include <stdarg.h>
 #include <stdio.h>
+
+#include <atomic>
+
 #include "wifi/wifi.h"
 #include "led/led.h"
+#include "adc_sampler/adc_sampler.h"
 #include "temperature/temperature.h"
 #include "battery/battery.h"
 #include "battery_soc/battery_soc.h"
+#include "boot_profiler/boot_profiler.h"
 #include "tachometer/tachometer.h"
 #include "websocket/websocket.h"
 #include "device_link/device_link.h"
@@ -20,115 +26,156 @@
 #include "display/display.h"
 #include "mcu_temp/mcu_temp.h"
 #include "power/power.h"
+#include "session_log/session_log.h"
 #include "maximum_stats/maximum_stats.h"
+#include "loop_profiler/loop_profiler.h"
+#include "control_tasks/control_tasks.h"
+#include "telemetry_snapshot/telemetry_snapshot.h"
+#include "telemetry_stream/telemetry_stream.h"
+
+// Wait for a USB-CDC monitor to attach before the first log lines; 0 brings the controls up at once.
+#ifndef SERIAL_BOOT_WAIT_MS
+#define SERIAL_BOOT_WAIT_MS 0
+#endif
 
 long nextBroadcastTime = 0;
 int broadcastInterval = 250;
 
 namespace {
+// Settings can change from the control task (dev menu) or the I/O task (device link); the
+// display belongs to the I/O side, so the contrast is only applied there.
+std::atomic<bool> displayContrastPending{false};
+// Bumped on every settings change so the I/O side refreshes its copies of the settings fields.
+std::atomic<uint32_t> settingsVersion{0};
+
 void onRuntimeSettingsChanged(const RuntimeSettings& settings) {
-  applyDisplayContrast(settings.displayContrastPercent);
+  (void)settings;
+  displayContrastPending.store(true, std::memory_order_release);
+  settingsVersion.fetch_add(1, std::memory_order_acq_rel);
   deviceLinkRequestSettingsBroadcast();
 }
-}  // namespace
 
-void setup() {
-  // Pull IO7 low (will be controlled by button module)
-  pinMode(7, OUTPUT);
-  digitalWrite(7, LOW);
+constexpr uint32_t kSplashHoldMs = 100;
 
-  // Black out WS2812 as early as possible (before USB wait) so they stay off until boot glow.
-  initLED();
+// Fast boot leaves these to the I/O task, one per tick; the display goes first so the splash is up
+// while the radios start.
+constexpr BootStage kDeferredStages[] = {BootStage::Display, BootStage::WiFi, BootStage::Link, BootStage::WebAssets};
+constexpr size_t kDeferredStageCount = sizeof(kDeferredStages) / sizeof(kDeferredStages[0]);
+size_t deferredNext = kDeferredStageCount;  // fast boot rewinds it to 0
+bool splashHold = false;
+uint32_t splashUntilMs = 0;
 
-  Serial.begin(115200);
-  delay(1000);  // Blocking wait only in setup() (Serial/USB attach)
+void onWiFiReady(WiFiLinkRole role) {
+  (void)role;
+  bootProfilerMilestone(BootMilestone::WiFiReady);
+  printNetworkSummaryToSerial();
+}
 
-  initButtons();
-  initTemperature();
-  initBattery();
-  initTachometer();
+void runDeferrableStage(BootStage stage, bool deferred) {
+  const uint32_t start = bootProfilerStamp();
+  switch (stage) {
+    case BootStage::Display:
+      initDisplay(getRuntimeSettings());
+      // Optional settle time for the 1.5" splash: blocking in setup(), held-back updates otherwise.
+      if (getRuntimeSettings().displayType == DisplayType::Waveshare15I2C) {
+        if (deferred) {
+          splashHold = true;
+          splashUntilMs = millis() + kSplashHoldMs;
+        } else {
+          delay(kSplashHoldMs);
+        }
+      }
+      break;
+    case BootStage::WiFi:
+      initOTA();
+      setWiFiReadyCallback(onWiFiReady);
+      setupWiFi();  // returns at once; ioTick() finishes the bring-up and the servers start when it is ready
+      break;
+    case BootStage::Link:
+      deviceLinkInit();
+      break;
+    case BootStage::WebAssets:
 #ifndef OSHVAC_BLE_PRIMARY
-  initWebServer();
+      initWebServer();
 #endif
-  initOTA();
-  setupWiFi();
-  deviceLinkInit();
-  initSettings();
-  loadRuntimeSettings();
-  setRuntimeSettingsChangedCallback(onRuntimeSettingsChanged);
-  initMotor(getRuntimeSettings().motorType);
-  devMenuRebuildVisible();
-  initMaximumStats();
-  initBatterySOC(getRuntimeSettings().batterySeriesCells);
-  initDisplay(getRuntimeSettings());
-  initMcuTemperature();
-  initPowerManagement();
-  // Optional settle time for 1.5" splash (blocking only allowed in setup()).
-  if (getRuntimeSettings().displayType == DisplayType::Waveshare15I2C) {
-    delay(100);
+      break;
+    default:
+      break;
   }
+  bootProfilerRecord(stage, start, deferred);
+}
 
-  printNetworkSummaryToSerial();
-  enableLEDBarDisplay(static_cast<uint8_t>(getRuntimeSettings().ledTheme));
+void postCutoffNotify(const char* id, const char* level, const char* format, ...) {
+  if (!deviceLinkHasActiveClients()) {
+    return;
+  }
+  char text[96];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  deviceLinkPostNotify(id, text, level);
 }
 
-void loop() {
+/** Real-time half: inputs, motor output and safety cutoffs. Never touches the display or radios. */
+void controlTick() {
   static uint32_t motorRunStartMs = 0;
   static uint32_t undervoltageBelowSinceMs = 0;
+  const uint32_t tickStart = loopProfilerStamp();
+  uint32_t t = tickStart;
 
   // Update buttons (handles speed changes and trigger state)
   updateButtons();
-  
+  t = loopProfilerLap(LoopProfileSection::Buttons, t);
+
   if (isMotorActive()) {
     const uint8_t speed = getSpeed();
     setMotorSpeedPercent(speed);
     startMotor();
     if (motorRunStartMs == 0) {
       motorRunStartMs = millis();
+      bootProfilerMilestone(BootMilestone::FirstMotorStart);
     }
   } else {
     // Motor is stopped: stop PWM output
     stopMotor();
     motorRunStartMs = 0;
   }
-  
+  t = loopProfilerLap(LoopProfileSection::Motor, t);
+
+  updateAdcSampler();
+  t = loopProfilerLap(LoopProfileSection::Adc, t);
   updateTemperature();
+  t = loopProfilerLap(LoopProfileSection::Temperature, t);
   updateMcuTemperature();
+  t = loopProfilerLap(LoopProfileSection::McuTemp, t);
   updateBattery();
+  t = loopProfilerLap(LoopProfileSection::Battery, t);
   updateBatterySOC();
+  t = loopProfilerLap(LoopProfileSection::BatterySoc, t);
   updateTachometer();
-  updateOTA();
+  t = loopProfilerLap(LoopProfileSection::Tachometer, t);
+
+  // Read every sensor once per tick; cutoffs, max stats and all I/O-side consumers use this.
+  TelemetrySnapshot snap{};
+  snap.batteryVoltage = getBatteryVoltage();
+  snap.temperatureC = getTemperature();
+  snap.temperatureReady = isTemperatureReady();
+  snap.mcuTemperatureC = getMcuTemperatureC();
+  snap.rpm = motorGetRpm();
+  snap.rpmReady = motorIsRpmReady();
+  snap.batterySocPercent = getBatterySOC();
 
   maximumStatsOnMotorLoop(
       isMotorActive(),
-      motorGetRpm(),
-      motorIsRpmReady(),
-      getBatteryVoltage(),
-      getTemperature(),
-      isTemperatureReady());
-
-  {
-    const RuntimeSettings& rsLed = getRuntimeSettings();
-    const MaximumStatsForDisplay mxLed = maximumStatsGetForDisplay();
-    updateLEDBarGraph(
-        getBatterySOC(),
-        motorGetRpm(),
-        motorIsRpmReady(),
-        mxLed.maxRpm,
-        mxLed.hasMaxRpm,
-        getSpeed(),
-        getTemperature(),
-        isTemperatureReady(),
-        rsLed.tempLimitC,
-        isMotorActive(),
-        static_cast<uint8_t>(rsLed.ledIdleDisplayMode),
-        static_cast<uint8_t>(rsLed.ledDisplayMode),
-        rsLed.ledDimPercent,
-        static_cast<uint8_t>(rsLed.ledTheme),
-        isOtaUpdateActive(),
-        getOtaProgressPercent());
-  }
-  updateLED();
+      getSpeed(),
+      snap.rpm,
+      snap.rpmReady,
+      snap.batteryVoltage,
+      getRuntimeSettings().batterySeriesCells,
+      snap.temperatureC,
+      snap.temperatureReady);
+  t = loopProfilerLap(LoopProfileSection::MaxStats, t);
 
   if (isMotorActive()) {
     const uint8_t autoOffMin = getRuntimeSettings().autoOffMinutes;
@@ -136,43 +183,30 @@ void loop() {
       const uint32_t runElapsedMs = millis() - motorRunStartMs;
       const uint32_t autoOffMs = static_cast<uint32_t>(autoOffMin) * 60UL * 1000UL;
       if (runElapsedMs >= autoOffMs) {
+        sessionLogNoteStop(SessionStopReason::AutoOff);
         setMotorState(false);
         motorRunStartMs = 0;
         Serial.printf("[Main] Motor stopped: auto-off after %u min\n", static_cast<unsigned>(autoOffMin));
-        if (deviceLinkHasActiveClients()) {
-          String notifyJson;
-          char text[96];
-          snprintf(text,
-                   sizeof(text),
-                   "Motor stopped: auto-off after %u min",
-                   static_cast<unsigned>(autoOffMin));
-          deviceProtocolBuildNotifyJson(notifyJson, "auto_off", text, "info");
-          deviceLinkBroadcast(notifyJson.c_str());
-        }
+        postCutoffNotify("auto_off", "info", "Motor stopped: auto-off after %u min", static_cast<unsigned>(autoOffMin));
       }
     }
 
     const uint8_t lim = getRuntimeSettings().tempLimitC;
-    if (lim > 0 && isTemperatureReady() && getTemperature() > static_cast<float>(lim)) {
+    if (lim > 0 && snap.temperatureReady && snap.temperatureC > static_cast<float>(lim)) {
+      sessionLogNoteStop(SessionStopReason::Thermal);
       setMotorState(false);
       motorRunStartMs = 0;
       triggerThermalOffBlink();
       Serial.printf("[Main] Motor stopped: NTC > %u C\n", static_cast<unsigned>(lim));
-      if (deviceLinkHasActiveClients()) {
-        String notifyJson;
-        char text[96];
-        snprintf(text,
-                 sizeof(text),
-                 "Motor stopped due to over-temperature (limit %u °C)",
-                 static_cast<unsigned>(lim));
-        deviceProtocolBuildNotifyJson(notifyJson, "thermal_stop", text, "warning");
-        deviceLinkBroadcast(notifyJson.c_str());
-      }
+      postCutoffNotify("thermal_stop",
+                       "warning",
+                       "Motor stopped due to over-temperature (limit %u °C)",
+                       static_cast<unsigned>(lim));
     }
 
     const uint8_t cells = getRuntimeSettings().batterySeriesCells;
     if (cells > 0) {
-      const float packV = getBatteryVoltage();
+      const float packV = snap.batteryVoltage;
       if (packV > 0.05f) {
         const float cellV = packV / static_cast<float>(cells);
         const float minCellV = SettingsConfig::DEFAULT_MIN_CELL_VOLTAGE_CUTOFF;
@@ -181,23 +215,18 @@ void loop() {
           if (undervoltageBelowSinceMs == 0) {
             undervoltageBelowSinceMs = now;
           } else if ((now - undervoltageBelowSinceMs) >= 400) {
+            sessionLogNoteStop(SessionStopReason::Undervoltage);
             setMotorState(false);
             motorRunStartMs = 0;
             undervoltageBelowSinceMs = 0;
             Serial.printf("[Main] Motor stopped: pack undervoltage (%.2f V, %.2f V/cell)\n",
                           static_cast<double>(packV),
                           static_cast<double>(cellV));
-            if (deviceLinkHasActiveClients()) {
-              String notifyJson;
-              char text[96];
-              snprintf(text,
-                       sizeof(text),
-                       "Motor stopped: battery undervoltage (%.2f V, %.2f V/cell)",
-                       static_cast<double>(packV),
-                       static_cast<double>(cellV));
-              deviceProtocolBuildNotifyJson(notifyJson, "undervoltage_stop", text, "warning");
-              deviceLinkBroadcast(notifyJson.c_str());
-            }
+            postCutoffNotify("undervoltage_stop",
+                             "warning",
+                             "Motor stopped: battery undervoltage (%.2f V, %.2f V/cell)",
+                             static_cast<double>(packV),
+                             static_cast<double>(cellV));
           }
         } else {
           undervoltageBelowSinceMs = 0;
@@ -207,85 +236,265 @@ void loop() {
   } else {
     undervoltageBelowSinceMs = 0;
   }
+  t = loopProfilerLap(LoopProfileSection::Cutoffs, t);
+
+  updateMotor();  // Check heartbeat timeout
+  t = loopProfilerLap(LoopProfileSection::MotorHeartbeat, t);
+
+  // Motor, speed and button state as the cutoffs/heartbeat left them.
+  snap.speedPercent = getSpeed();
+  snap.triggerHeld = isTriggerPressed();
+  snap.motorActive = isMotorActive();
+  snap.displayInfoMode = isDisplayInfoMode();
+  snap.displayInfoPage = getDisplayInfoPage();
+  snap.maxStats = maximumStatsGetForDisplay();
+  telemetrySnapshotPublish(snap);
+  telemetryStreamSample(snap);
+  sessionLogOnControlTick(snap);
+  loopProfilerLap(LoopProfileSection::Control, tickStart);
+}
+
+void fillDisplayFromSnapshot(DisplayTelemetry& d, const TelemetrySnapshot& snap) {
+  d.speedPercent = snap.speedPercent;
+  d.batteryVoltage = snap.batteryVoltage;
+  d.temperatureC = snap.temperatureC;
+  d.motorTemperatureReady = snap.temperatureReady;
+  d.mcuTempC = snap.mcuTemperatureC;
+  d.rpm = snap.rpm;
+  d.triggerHeld = snap.triggerHeld;
+  d.rpmReady = snap.rpmReady;
+  d.batterySocPercent = snap.batterySocPercent;
+  d.motorActive = snap.motorActive;
+  d.displayInfoMode = snap.displayInfoMode;
+  d.displayInfoPage = snap.displayInfoPage;
+  d.maxStatsRpm = snap.maxStats.maxRpm;
+  d.maxStatsHasRpm = snap.maxStats.hasMaxRpm;
+  d.maxStatsVoltageV = snap.maxStats.maxVoltageV;
+  d.maxStatsHasVoltage = snap.maxStats.hasMaxVoltage;
+  d.maxStatsMotorTempC = snap.maxStats.maxMotorTempC;
+  d.maxStatsHasMotorTemp = snap.maxStats.hasMaxMotorTemp;
+}
 
-  const bool buttonActivity = hadButtonActivityAndClear();
-  if (updatePowerManagement(buttonActivity, isMotorActive(), isOtaUpdateActive())) {
+void fillDisplayFromSettings(DisplayTelemetry& d, const RuntimeSettings& rs) {
+  d.batterySeriesCells = rs.batterySeriesCells;
+  d.autoOffMinutes = rs.autoOffMinutes;
+  d.sleepTimerMinutes = rs.sleepTimerMinutes;
+  d.tempLimitC = rs.tempLimitC;
+  d.speedStepPercent = rs.speedStepPercent;
+  d.minDutyPercent = rs.minDutyPercent;
+  d.maxDutyPercent = rs.maxDutyPercent;
+  d.motorDisplayMode = static_cast<uint8_t>(rs.motorDisplayMode);
+  d.triggerMode = static_cast<uint8_t>(rs.triggerMode);
+  d.ledIdleDisplayMode = static_cast<uint8_t>(rs.ledIdleDisplayMode);
+  d.ledDisplayMode = static_cast<uint8_t>(rs.ledDisplayMode);
+  d.ledDimPercent = rs.ledDimPercent;
+  d.ledTheme = static_cast<uint8_t>(rs.ledTheme);
+  d.motorType = static_cast<uint8_t>(rs.motorType);
+}
+
+/** Everything that may block or take long: OTA, LEDs, power, display, web server, device link. */
+void ioTick() {
+  // Consumer state: what the display/LED bar/telemetry last saw, so unchanged ticks cost nothing.
+  static DisplayTelemetry display{};
+  static uint32_t seenVersion = 0;
+  static uint32_t seenSettingsVersion = UINT32_MAX;
+  static bool seenOtaActive = false;
+  static uint8_t seenOtaPercent = 0;
+  static bool refreshAfterSleep = true;
+
+  if (deferredNext < kDeferredStageCount) {
+    // Nothing network- or display-side runs until its init has; the controls are live meanwhile.
+    runDeferrableStage(kDeferredStages[deferredNext++], true);
+    if (deferredNext == kDeferredStageCount) {
+      bootProfilerMilestone(BootMilestone::DeferredDone);
+      bootProfilerPrint();
+      loopProfilerReset();  // keep the one-off init out of the I/O iteration histogram
+    }
     return;
   }
+
+  uint32_t t = loopProfilerStamp();
+  updateWiFi();
+  t = loopProfilerLap(LoopProfileSection::WiFi, t);
+  updateOTA();
+  t = loopProfilerLap(LoopProfileSection::Ota, t);
+
+  if (displayContrastPending.exchange(false, std::memory_order_acq_rel)) {
+    applyDisplayContrast(getRuntimeSettings().displayContrastPercent);
+  }
+
+  TelemetrySnapshot snap;
+  telemetrySnapshotRead(snap);
   const RuntimeSettings& rs = getRuntimeSettings();
-  const MaximumStatsForDisplay mx = maximumStatsGetForDisplay();
-  DisplayTelemetry telemetry {
-    getSpeed(),
-    getBatteryVoltage(),
-    getTemperature(),
-    isTemperatureReady(),
-    getMcuTemperatureC(),
-    motorGetRpm(),
-    isTriggerPressed(),
-    motorIsRpmReady(),
-    getBatterySOC(),
-    isMotorActive(),
-    isDisplayInfoMode(),
-    getDisplayInfoPage(),
-    static_cast<uint32_t>(millis() / 1000UL),
-    ESP.getFreeHeap(),
-    rs.batterySeriesCells,
-    isOtaUpdateActive(),
-    getOtaProgressPercent(),
-    rs.autoOffMinutes,
-    rs.sleepTimerMinutes,
-    rs.tempLimitC,
-    rs.speedStepPercent,
-    rs.minDutyPercent,
-    rs.maxDutyPercent,
-    static_cast<uint8_t>(rs.motorDisplayMode),
-    static_cast<uint8_t>(rs.triggerMode),
-    static_cast<uint8_t>(rs.ledIdleDisplayMode),
-    static_cast<uint8_t>(rs.ledDisplayMode),
-    rs.ledDimPercent,
-    static_cast<uint8_t>(rs.ledTheme),
-    static_cast<uint8_t>(rs.motorType),
-    mx.maxRpm,
-    mx.hasMaxRpm,
-    mx.maxVoltageV,
-    mx.hasMaxVoltage,
-    mx.maxMotorTempC,
-    mx.hasMaxMotorTemp,
-  };
-  updateDisplay(telemetry);
-  updateMotor();  // Check heartbeat timeout
+  const uint32_t settingsNow = settingsVersion.load(std::memory_order_acquire);
+  const bool otaActive = isOtaUpdateActive();
+  const uint8_t otaPercent = getOtaProgressPercent();
+  const bool snapshotChanged = snap.version != seenVersion;
+  const bool settingsChanged = settingsNow != seenSettingsVersion;
+  const bool otaChanged = otaActive != seenOtaActive || otaPercent != seenOtaPercent;
+
+  if (snapshotChanged || settingsChanged || otaChanged || refreshAfterSleep) {
+    updateLEDBarGraph(
+        snap.batterySocPercent,
+        snap.rpm,
+        snap.rpmReady,
+        snap.maxStats.maxRpm,
+        snap.maxStats.hasMaxRpm,
+        snap.speedPercent,
+        snap.temperatureC,
+        snap.temperatureReady,
+        rs.tempLimitC,
+        snap.motorActive,
+        static_cast<uint8_t>(rs.ledIdleDisplayMode),
+        static_cast<uint8_t>(rs.ledDisplayMode),
+        rs.ledDimPercent,
+        static_cast<uint8_t>(rs.ledTheme),
+        otaActive,
+        otaPercent);
+    refreshAfterSleep = false;
+  }
+  updateLED();
+  t = loopProfilerLap(LoopProfileSection::Led, t);
+
+  bool sleptOrSleeping = false;
+  {
+    // Light sleep stops the motor and resets button state; keep the control tick out meanwhile.
+    ControlLockGuard lock;
+    const bool buttonActivity = hadButtonActivityAndClear();
+    sleptOrSleeping = updatePowerManagement(buttonActivity, isMotorActive(), otaActive);
+  }
+  t = loopProfilerLap(LoopProfileSection::Power, t);
+  updateSettingsStore();
+  updateMaximumStatsStore();
+  t = loopProfilerLap(LoopProfileSection::Settings, t);
+  updateSessionLog();
+  t = loopProfilerLap(LoopProfileSection::Sessions, t);
+  if (sleptOrSleeping) {
+    refreshAfterSleep = true;
+    return;
+  }
+
+  if (snapshotChanged) {
+    fillDisplayFromSnapshot(display, snap);
+  }
+  if (settingsChanged) {
+    fillDisplayFromSettings(display, rs);
+  }
+  display.uptimeSeconds = static_cast<uint32_t>(millis() / 1000UL);
+  display.freeHeapBytes = ESP.getFreeHeap();
+  display.otaActive = otaActive;
+  display.otaProgressPercent = otaPercent;
+  seenVersion = snap.version;
+  seenSettingsVersion = settingsNow;
+  seenOtaActive = otaActive;
+  seenOtaPercent = otaPercent;
+  if (splashHold && static_cast<int32_t>(millis() - splashUntilMs) >= 0) {
+    splashHold = false;
+  }
+  if (!splashHold) {
+    updateDisplay(display);  // still every pass: the renderers animate and diff on their own
+  }
+  t = loopProfilerLap(LoopProfileSection::Display, t);
 #ifndef OSHVAC_BLE_PRIMARY
   updateWebServer();
+  t = loopProfilerLap(LoopProfileSection::WebServer, t);
 #endif
   deviceLinkUpdate();
+  t = loopProfilerLap(LoopProfileSection::DeviceLink, t);
 
-  if (millis() > nextBroadcastTime) {
-    const uint8_t speedPercent = getSpeed();
-    const float batteryVoltage = getBatteryVoltage();
-    const float rpmValue = motorGetRpm();
-    const bool motorActive = isMotorActive();
+  deviceLinkPublishTelemetry(snap);
+  t = loopProfilerLap(LoopProfileSection::Telemetry, t);
 
+  if (millis() > nextBroadcastTime) {
     char serialLine[160];
     snprintf(serialLine, sizeof(serialLine),
              "Temperature: %.2f / Battery: %.2f / RPM: %.0f / Speed: %u%%",
-             getTemperature(), batteryVoltage, rpmValue, static_cast<unsigned>(speedPercent));
+             snap.temperatureC, snap.batteryVoltage, snap.rpm, static_cast<unsigned>(snap.speedPercent));
     Serial.println(serialLine);
+    nextBroadcastTime = millis() + broadcastInterval;
+  }
+}
+}  // namespace
 
-    if (deviceLinkHasActiveClients()) {
-      String jsonBuffer;
-      deviceProtocolBuildTelemetryJson(jsonBuffer,
-                                       getTemperature(),
-                                       getBatteryVoltage(),
-                                       motorGetRpm(),
-                                       speedPercent,
-                                       motorActive,
-                                       getBatterySOC());
-      if (jsonBuffer.length() > 0) {
-        deviceLinkBroadcast(jsonBuffer.c_str());
-      }
+void setup() {
+  uint32_t stage = bootProfilerStamp();
+  // Pull IO7 low (will be controlled by button module)
+  pinMode(7, OUTPUT);
+  digitalWrite(7, LOW);
+
+  // Black out WS2812 as early as possible (before USB wait) so they stay off until boot glow.
+  initLED();
+  bootProfilerRecord(BootStage::Led, stage, false);
+
+  stage = bootProfilerStamp();
+  Serial.begin(115200);
+#if SERIAL_BOOT_WAIT_MS > 0
+  delay(SERIAL_BOOT_WAIT_MS);  // Blocking wait only in setup() (Serial/USB attach)
+#endif
+  bootProfilerRecord(BootStage::Console, stage, false);
+
+  stage = bootProfilerStamp();
+  initButtons();
+  bootProfilerRecord(BootStage::Buttons, stage, false);
+
+  stage = bootProfilerStamp();
+  initAdcSampler();
+  initTemperature();
+  initBattery();
+  initTachometer();
+  initMcuTemperature();
+  bootProfilerRecord(BootStage::Sensors, stage, false);
+
+  stage = bootProfilerStamp();
+  initSettings();
+  loadRuntimeSettings();
+  setRuntimeSettingsChangedCallback(onRuntimeSettingsChanged);
+  bootProfilerRecord(BootStage::Settings, stage, false);
+
+  stage = bootProfilerStamp();
+  initMotor(getRuntimeSettings().motorType);
+  devMenuRebuildVisible();
+  bootProfilerRecord(BootStage::Motor, stage, false);
+
+  stage = bootProfilerStamp();
+  initMaximumStats();
+  initSessionLog();
+  initBatterySOC(getRuntimeSettings().batterySeriesCells);
+  bootProfilerRecord(BootStage::Stats, stage, false);
+
+  stage = bootProfilerStamp();
+  initPowerManagement();
+  bootProfilerRecord(BootStage::Power, stage, false);
+
+  const bool fastBoot = getRuntimeSettings().bootMode == BootMode::Fast;
+  bootProfilerSetFastBoot(fastBoot);
+  if (fastBoot) {
+    deferredNext = 0;
+  } else {
+    for (const BootStage deferrable : kDeferredStages) {
+      runDeferrableStage(deferrable, false);
     }
-    
-    nextBroadcastTime = millis() + broadcastInterval;
+  }
+
+  stage = bootProfilerStamp();
+  enableLEDBarDisplay(static_cast<uint8_t>(getRuntimeSettings().ledTheme));
+  initLoopProfiler();
+  startControlTasks(controlTick, ioTick);
+  bootProfilerRecord(BootStage::Tasks, stage, false);
+  bootProfilerMilestone(BootMilestone::ControlsLive);
+  if (!fastBoot) {
+    bootProfilerPrint();
   }
 }
 
+void loop() {
+  if (controlTasksRunning()) {
+    // Both halves run in their own pinned tasks; loopTask has nothing left to do.
+    vTaskDelete(nullptr);
+    return;
+  }
+  const uint32_t loopStart = loopProfilerStamp();
+  controlTick();
+  ioTick();
+  loopProfilerLap(LoopProfileSection::Loop, loopStart);
+}
@@ -3,6 +3,12 @@
 #include <Arduino.h>
 #include <Preferences.h>
 #include <math.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "../control_tasks/control_tasks.h"
+#include "../crc32/crc32.h"
 
 namespace {
 
@@ -11,6 +17,11 @@ constexpr char KEY_FLAGS[] = "mstat_fl";
 constexpr char KEY_RPM[] = "mstat_rpm";
 constexpr char KEY_VOLT[] = "mstat_vf";
 constexpr char KEY_TEMP[] = "mstat_tf";
+constexpr char KEY_LIFETIME[] = "mstat_life";  // u8 version, lifetime set, u32 CRC-32
+constexpr size_t kLifetimeRecordSize = 1 + kMotorStatsSetSize + 4;
+// The lifetime record is rewritten only once the motor has stayed off this long (or on a flush before
+// a restart), so start/stop bursts cost one flash write instead of one per stop.
+constexpr uint32_t kLifetimeWriteQuietMs = 30000;
 
 constexpr uint8_t FL_RPM = 1U;
 constexpr uint8_t FL_VOLT = 2U;
@@ -23,11 +34,42 @@ struct PackedStats {
   float maxMotorTempC;
 };
 
+struct RunningStat {
+  uint32_t n;
+  double mean;
+  double m2;
+};
+
+struct LoadStats {
+  uint32_t samples;
+  uint32_t starts;
+  uint32_t speedBand[kMotorStatsSpeedBands];
+  uint32_t rpmHist[kMotorStatsBuckets];
+  uint32_t tempHist[kMotorStatsBuckets];
+  uint32_t cellHist[kMotorStatsBuckets];
+  RunningStat rpm;
+  RunningStat temp;
+  RunningStat cell;
+  uint32_t hotSamples;
+  uint32_t sagSamples;
+  uint32_t highRpmSamples;
+};
+
 PackedStats g_live{};
 PackedStats g_lastNvs{};
+// Written by the control tick; the I/O task copies them under the control lock.
+LoadStats g_run{};
+LoadStats g_lifetime{};
 
 bool s_lastMotorActive = false;
 bool s_prefsReady = false;
+uint32_t s_lastTickMs = 0;
+uint32_t s_unsampledMs = 0;
+std::atomic<bool> s_storePending{false};
+// I/O task only.
+bool s_lifetimeQueued = false;
+uint32_t s_lifetimeQueuedMs = 0;
+uint32_t s_lifetimeNvsSamples = 0;  // samples in the stored lifetime record
 
 bool nearlySameFloat(float a, float b) {
   return fabsf(a - b) < 0.0005f;
@@ -49,31 +91,205 @@ bool packedEqual(const PackedStats& a, const PackedStats& b) {
   return true;
 }
 
-bool writeStatsToNvs(const PackedStats& s) {
-  Preferences prefs;
-  if (!prefs.begin(PREFS_NS, false)) {
-    return false;
-  }
+bool writePeaks(Preferences& prefs, const PackedStats& s) {
   const bool okFl = prefs.putUChar(KEY_FLAGS, s.flags) > 0;
   const bool okRpm = prefs.putUInt(KEY_RPM, s.maxRpm) > 0;
   const bool okV = prefs.putFloat(KEY_VOLT, s.maxVoltageV) > 0;
   const bool okT = prefs.putFloat(KEY_TEMP, s.maxMotorTempC) > 0;
-  prefs.end();
   return okFl && okRpm && okV && okT;
 }
 
-void persistIfChanged() {
-  if (!s_prefsReady) {
+// Welford's update; one division per sample.
+void addSample(RunningStat& s, double x) {
+  s.n++;
+  const double delta = x - s.mean;
+  s.mean += delta / s.n;
+  s.m2 += delta * (x - s.mean);
+}
+
+uint8_t bucketOf(float value, float first, float width) {
+  if (value < first + width) {
+    return 0;
+  }
+  const float b = (value - first) / width;
+  return b >= kMotorStatsBuckets - 1 ? kMotorStatsBuckets - 1 : static_cast<uint8_t>(b);
+}
+
+struct LoadSample {
+  uint8_t speedBand;
+  bool hasRpm;
+  float rpm;
+  bool hasTemp;
+  float tempC;
+  bool hasCell;
+  float cellV;
+};
+
+void addLoadSample(LoadStats& s, const LoadSample& x) {
+  s.samples++;
+  s.speedBand[x.speedBand]++;
+  if (x.hasRpm) {
+    s.rpmHist[bucketOf(x.rpm, 0.0f, kMotorStatsRpmBucketWidth)]++;
+    addSample(s.rpm, x.rpm);
+    s.highRpmSamples += x.rpm >= kMotorStatsHighRpm ? 1U : 0U;
+  }
+  if (x.hasTemp) {
+    s.tempHist[bucketOf(x.tempC, 0.0f, kMotorStatsTempBucketWidthC)]++;
+    addSample(s.temp, x.tempC);
+    s.hotSamples += x.tempC >= kMotorStatsHotC ? 1U : 0U;
+  }
+  if (x.hasCell) {
+    s.cellHist[bucketOf(x.cellV * 1000.0f, kMotorStatsCellFirstMv, kMotorStatsCellBucketWidthMv)]++;
+    addSample(s.cell, x.cellV);
+    s.sagSamples += x.cellV * 1000.0f < kMotorStatsSagCellMv ? 1U : 0U;
+  }
+}
+
+uint8_t* put16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+  return p + 2;
+}
+
+uint8_t* put32(uint8_t* p, uint32_t v) {
+  return put16(put16(p, static_cast<uint16_t>(v)), static_cast<uint16_t>(v >> 16));
+}
+
+uint8_t* put64(uint8_t* p, double v) {
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return put32(put32(p, static_cast<uint32_t>(bits)), static_cast<uint32_t>(bits >> 32));
+}
+
+uint8_t* putCounts(uint8_t* p, const uint32_t* counts, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    p = put32(p, counts[i]);
+  }
+  return p;
+}
+
+uint8_t* putRunning(uint8_t* p, const RunningStat& s) {
+  return put64(put64(put32(p, s.n), s.mean), s.m2);
+}
+
+uint32_t get32(const uint8_t*& p) {
+  const uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  p += 4;
+  return v;
+}
+
+double get64(const uint8_t*& p) {
+  const uint32_t lo = get32(p);
+  const uint64_t bits = lo | (static_cast<uint64_t>(get32(p)) << 32);
+  double v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+void getCounts(const uint8_t*& p, uint32_t* counts, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    counts[i] = get32(p);
+  }
+}
+
+void getRunning(const uint8_t*& p, RunningStat& s) {
+  s.n = get32(p);
+  s.mean = get64(p);
+  s.m2 = get64(p);
+}
+
+static_assert(8 + 4 * (kMotorStatsSpeedBands + 3 * kMotorStatsBuckets) + 3 * 20 + 12 == kMotorStatsSetSize,
+              "encodeSet() and the documented set layout disagree");
+
+uint8_t* encodeSet(uint8_t* p, const LoadStats& s) {
+  p = put32(put32(p, s.samples), s.starts);
+  p = putCounts(p, s.speedBand, kMotorStatsSpeedBands);
+  p = putCounts(p, s.rpmHist, kMotorStatsBuckets);
+  p = putCounts(p, s.tempHist, kMotorStatsBuckets);
+  p = putCounts(p, s.cellHist, kMotorStatsBuckets);
+  p = putRunning(putRunning(putRunning(p, s.rpm), s.temp), s.cell);
+  return put32(put32(put32(p, s.hotSamples), s.sagSamples), s.highRpmSamples);
+}
+
+void decodeSet(const uint8_t* p, LoadStats& s) {
+  s.samples = get32(p);
+  s.starts = get32(p);
+  getCounts(p, s.speedBand, kMotorStatsSpeedBands);
+  getCounts(p, s.rpmHist, kMotorStatsBuckets);
+  getCounts(p, s.tempHist, kMotorStatsBuckets);
+  getCounts(p, s.cellHist, kMotorStatsBuckets);
+  getRunning(p, s.rpm);
+  getRunning(p, s.temp);
+  getRunning(p, s.cell);
+  s.hotSamples = get32(p);
+  s.sagSamples = get32(p);
+  s.highRpmSamples = get32(p);
+}
+
+void loadLifetime(Preferences& prefs) {
+  uint8_t record[kLifetimeRecordSize];
+  const uint8_t* crcAt = record + kLifetimeRecordSize - 4;
+  if (prefs.getBytesLength(KEY_LIFETIME) == sizeof(record) && prefs.getBytes(KEY_LIFETIME, record, sizeof(record)) == sizeof(record) &&
+      record[0] == kMotorStatsBlobVersion && get32(crcAt) == crc32(record, kLifetimeRecordSize - 4)) {
+    decodeSet(record + 1, g_lifetime);
+  } else {
+    g_lifetime = {};
+  }
+  s_lifetimeNvsSamples = g_lifetime.samples;
+}
+
+bool writeLifetime(Preferences& prefs, const LoadStats& s) {
+  uint8_t record[kLifetimeRecordSize];
+  record[0] = kMotorStatsBlobVersion;
+  uint8_t* end = encodeSet(record + 1, s);
+  put32(end, crc32(record, static_cast<size_t>(end - record)));
+  return prefs.putBytes(KEY_LIFETIME, record, sizeof(record)) == sizeof(record);
+}
+
+// I/O task: writes the peaks if they changed, and the lifetime set if it gained samples and is due
+// (quiet period over with the motor still off, or `flush`).
+void writeStats(bool flush) {
+  PackedStats peaks;
+  LoadStats lifetime;
+  bool motorActive;
+  {
+    ControlLockGuard lock;
+    peaks = g_live;
+    lifetime = g_lifetime;
+    motorActive = s_lastMotorActive;
+  }
+  const uint32_t now = millis();
+  bool lifetimeDue = flush;
+  if (s_lifetimeQueued && now - s_lifetimeQueuedMs >= kLifetimeWriteQuietMs) {
+    // A run started in the meantime queues the set again when it stops.
+    lifetimeDue = lifetimeDue || !motorActive;
+    s_lifetimeQueued = false;
+  }
+  if (flush) {
+    s_lifetimeQueued = false;
+  }
+  const bool peaksChanged = !packedEqual(peaks, g_lastNvs);
+  const bool lifetimeChanged = lifetimeDue && lifetime.samples != s_lifetimeNvsSamples;
+  if (!peaksChanged && !lifetimeChanged) {
     return;
   }
-  if (packedEqual(g_live, g_lastNvs)) {
+  Preferences prefs;
+  if (!prefs.begin(PREFS_NS, false)) {
+    Serial.println("[MaxStats] NVS write failed");
     return;
   }
-  if (writeStatsToNvs(g_live)) {
-    g_lastNvs = g_live;
-    Serial.println("[MaxStats] NVS updated");
-  } else {
+  const bool ok = (!peaksChanged || writePeaks(prefs, peaks)) && (!lifetimeChanged || writeLifetime(prefs, lifetime));
+  prefs.end();
+  if (!ok) {
     Serial.println("[MaxStats] NVS write failed");
+    return;
+  }
+  g_lastNvs = peaks;
+  if (lifetimeChanged) {
+    s_lifetimeNvsSamples = lifetime.samples;
+    Serial.printf("[MaxStats] NVS updated (%.2f h motor-on)\n", lifetime.samples * (kMotorStatsSamplePeriodMs / 3.6e6));
+  } else {
+    Serial.println("[MaxStats] NVS peaks updated");
   }
 }
 
@@ -81,27 +297,44 @@ void persistIfChanged() {
 
 void initMaximumStats() {
   Preferences prefs;
+  s_lastMotorActive = false;
+  s_lifetimeQueued = false;
+  g_run = {};
   if (!prefs.begin(PREFS_NS, true)) {
     g_live = {};
     g_lastNvs = {};
+    g_lifetime = {};
     s_prefsReady = false;
-    s_lastMotorActive = false;
     return;
   }
   g_live.flags = prefs.getUChar(KEY_FLAGS, 0);
   g_live.maxRpm = prefs.getUInt(KEY_RPM, 0);
   g_live.maxVoltageV = prefs.getFloat(KEY_VOLT, 0.0f);
   g_live.maxMotorTempC = prefs.getFloat(KEY_TEMP, 0.0f);
+  loadLifetime(prefs);
   prefs.end();
   if (g_live.flags > (FL_RPM | FL_VOLT | FL_TEMP)) {
     g_live = {};
   }
   g_lastNvs = g_live;
   s_prefsReady = true;
-  s_lastMotorActive = false;
 }
 
-void maximumStatsOnMotorLoop(bool motorActive, float rpm, bool rpmReady, float batteryVoltage, float motorTempC, bool motorTempReady) {
+void maximumStatsOnMotorLoop(bool motorActive,
+                             uint8_t speedPercent,
+                             float rpm,
+                             bool rpmReady,
+                             float batteryVoltage,
+                             uint8_t seriesCells,
+                             float motorTempC,
+                             bool motorTempReady) {
+  const uint32_t now = millis();
+  if (motorActive && !s_lastMotorActive) {
+    g_run = {};
+    g_run.starts = 1;
+    g_lifetime.starts++;
+    s_unsampledMs = 0;
+  }
   if (motorActive) {
     if (rpmReady) {
       const uint32_t r = static_cast<uint32_t>(lroundf(rpm < 0.0f ? 0.0f : rpm));
@@ -122,24 +355,87 @@ void maximumStatsOnMotorLoop(bool motorActive, float rpm, bool rpmReady, float b
         g_live.flags |= FL_TEMP;
       }
     }
+
+    // At most one sample per tick; a late tick leaves the rest for the following ones.
+    s_unsampledMs += now - s_lastTickMs;
+    if (s_unsampledMs >= kMotorStatsSamplePeriodMs) {
+      s_unsampledMs -= kMotorStatsSamplePeriodMs;
+      LoadSample x{};
+      x.speedBand = speedPercent >= 100 ? kMotorStatsSpeedBands - 1 : speedPercent / 10;
+      x.hasRpm = rpmReady;
+      x.rpm = rpm < 0.0f ? 0.0f : rpm;
+      x.hasTemp = motorTempReady;
+      x.tempC = motorTempC;
+      x.hasCell = batteryVoltage > 0.05f && seriesCells > 0;
+      x.cellV = x.hasCell ? batteryVoltage / seriesCells : 0.0f;
+      addLoadSample(g_run, x);
+      addLoadSample(g_lifetime, x);
+    }
   }
+  s_lastTickMs = now;
 
-  if (motorActive != s_lastMotorActive) {
-    s_lastMotorActive = motorActive;
-    persistIfChanged();
+  if (!motorActive && s_lastMotorActive) {
+    s_storePending.store(true, std::memory_order_release);
   }
+  s_lastMotorActive = motorActive;
+}
+
+void updateMaximumStatsStore() {
+  if (!s_prefsReady) {
+    return;
+  }
+  const uint32_t now = millis();
+  const bool peaksDue = s_storePending.exchange(false, std::memory_order_acq_rel);
+  if (peaksDue) {
+    s_lifetimeQueued = true;
+    s_lifetimeQueuedMs = now;
+  }
+  if (peaksDue || (s_lifetimeQueued && now - s_lifetimeQueuedMs >= kLifetimeWriteQuietMs)) {
+    writeStats(false);
+  }
+}
+
+void maximumStatsFlush() {
+  if (!s_prefsReady) {
+    return;
+  }
+  s_storePending.store(false, std::memory_order_release);
+  writeStats(true);
 }
 
 void maximumStatsClearPersisted() {
   g_live = {};
-  g_lastNvs = {};
-  if (writeStatsToNvs(g_live)) {
-    g_lastNvs = g_live;
-    s_prefsReady = true;
-    Serial.println("[MaxStats] Cleared");
-  } else {
-    Serial.println("[MaxStats] Clear NVS failed");
+  s_storePending.store(true, std::memory_order_release);
+  Serial.println("[MaxStats] Cleared");
+}
+
+size_t maximumStatsExport(uint8_t* out, size_t capacity) {
+  if (capacity < kMotorStatsBlobSize) {
+    return 0;
+  }
+  LoadStats run;
+  LoadStats lifetime;
+  {
+    ControlLockGuard lock;
+    run = g_run;
+    lifetime = g_lifetime;
   }
+  uint8_t* p = out;
+  *p++ = kMotorStatsBlobMagic;
+  *p++ = kMotorStatsBlobVersion;
+  p = put16(put16(p, static_cast<uint16_t>(kMotorStatsBlobSize)), kMotorStatsSamplePeriodMs);
+  *p++ = kMotorStatsBuckets;
+  *p++ = kMotorStatsBuckets;
+  *p++ = kMotorStatsBuckets;
+  *p++ = kMotorStatsSpeedBands;
+  p = put16(p, kMotorStatsRpmBucketWidth);
+  *p++ = kMotorStatsTempBucketWidthC;
+  *p++ = static_cast<uint8_t>(kMotorStatsCellBucketWidthMv / 10);
+  p = put16(put16(put16(p, kMotorStatsCellFirstMv), kMotorStatsHotC), kMotorStatsSagCellMv);
+  p = put32(p, kMotorStatsHighRpm);
+  p = encodeSet(encodeSet(p, run), lifetime);
+  p = put32(p, crc32(out, static_cast<size_t>(p - out)));
+  return static_cast<size_t>(p - out);
 }
 
 MaximumStatsForDisplay maximumStatsGetForDisplay() {
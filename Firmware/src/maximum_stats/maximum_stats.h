@@ -2,6 +2,7 @@
 #define MAXIMUM_STATS_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 struct MaximumStatsForDisplay {
@@ -13,13 +14,81 @@ struct MaximumStatsForDisplay {
   bool hasMaxMotorTemp;
 };
 
+/**
+ * Load statistics, kept for the current (or last) motor run and for the device's lifetime. While the
+ * motor runs, one sample is taken per kMotorStatsSamplePeriodMs of motor-on time (O(1) per loop,
+ * no allocation). Each sample goes into fixed-bucket histograms of RPM, motor temperature and
+ * per-cell pack voltage, running mean/variance (Welford) of the same three values,
+ * above-threshold counters and a per-speed-band counter. All counts are in samples, so
+ * samples / 36000 is hours.
+ *
+ * Export blob v1 (little-endian, kMotorStatsBlobSize bytes):
+ *   0 u8 magic 0xA9   1 u8 version   2 u16 blob size   4 u16 sample period [ms]
+ *   6 u8 rpm / temp / cell-voltage buckets (3 bytes)   9 u8 speed bands
+ *  10 u16 rpm bucket width [rpm]   12 u8 temp bucket width [°C]   13 u8 cell bucket width [mV / 10]
+ *  14 u16 first cell bucket [mV]   16 u16 hot threshold [°C]   18 u16 sag threshold [mV/cell]
+ *  20 u32 high-rpm threshold
+ *  24 set "run" (the current run, or the last one while stopped)   24 + kMotorStatsSetSize set "lifetime"
+ *  end - 4: u32 CRC-32 of everything before it
+ *
+ * Set (kMotorStatsSetSize bytes):
+ *   0 u32 samples   4 u32 motor starts   8 u32[11] samples per speed band (0–9 %, 10–19 %, …, 100 %)
+ *  52 u32[16] rpm histogram (bucket b = [b·width, (b+1)·width), the last one open-ended)
+ * 116 u32[16] motor temp histogram (from 0 °C; below 0 counts in bucket 0, the last one open-ended)
+ * 180 u32[16] cell voltage histogram (from the first cell bucket; first and last are open-ended)
+ * 244 rpm, temp [°C], cell voltage [V] running stats, each u32 n, f64 mean, f64 M2 (variance = M2 / n)
+ * 304 u32 samples with motor temp >= hot threshold   308 u32 cell voltage < sag threshold
+ * 312 u32 rpm >= high-rpm threshold
+ *
+ * Only samples with a valid reading enter a value's histogram and running stats; the sample and speed
+ * counters cover all motor-on time.
+ */
+constexpr uint8_t kMotorStatsBlobMagic = 0xA9;
+constexpr uint8_t kMotorStatsBlobVersion = 1;
+constexpr uint16_t kMotorStatsSamplePeriodMs = 100;
+constexpr uint8_t kMotorStatsBuckets = 16;
+constexpr uint8_t kMotorStatsSpeedBands = 11;
+constexpr uint16_t kMotorStatsRpmBucketWidth = 7500;
+constexpr uint8_t kMotorStatsTempBucketWidthC = 5;
+constexpr uint16_t kMotorStatsCellBucketWidthMv = 100;
+constexpr uint16_t kMotorStatsCellFirstMv = 2800;
+constexpr uint16_t kMotorStatsHotC = 60;
+constexpr uint16_t kMotorStatsSagCellMv = 3300;
+constexpr uint32_t kMotorStatsHighRpm = 100000;
+constexpr size_t kMotorStatsHeaderSize = 24;
+constexpr size_t kMotorStatsSetSize = 316;
+constexpr size_t kMotorStatsBlobSize = kMotorStatsHeaderSize + 2 * kMotorStatsSetSize + 4;
+
 void initMaximumStats();
 
-/** Call each loop after sensors; updates peaks while motor runs and persists on motor on/off edges. */
-void maximumStatsOnMotorLoop(bool motorActive, float rpm, bool rpmReady, float batteryVoltage, float motorTempC, bool motorTempReady);
+/**
+ * Call each control tick after the sensors. Updates peaks and the load statistics while the motor
+ * runs; a motor stop (or a clear) schedules the NVS write for updateMaximumStatsStore().
+ */
+void maximumStatsOnMotorLoop(bool motorActive,
+                             uint8_t speedPercent,
+                             float rpm,
+                             bool rpmReady,
+                             float batteryVoltage,
+                             uint8_t seriesCells,
+                             float motorTempC,
+                             bool motorTempReady);
+
+/**
+ * I/O task: writes changed peaks once a run has ended. The lifetime statistics follow after the motor
+ * has stayed off for 30 s, and only if they gained samples.
+ */
+void updateMaximumStatsStore();
 
+/** I/O task: writes anything not yet in NVS right away (before a restart). */
+void maximumStatsFlush();
+
+/** Clears the peaks (not the lifetime statistics); the NVS write follows in the I/O task. */
 void maximumStatsClearPersisted();
 
+/** I/O task: encodes the export blob (takes the control lock for the copy); 0 if `capacity` is short. */
+size_t maximumStatsExport(uint8_t* out, size_t capacity);
+
 MaximumStatsForDisplay maximumStatsGetForDisplay();
 
 #endif  // MAXIMUM_STATS_H
@@ -3,6 +3,7 @@
 #include <Arduino.h>
 #include <string.h>
 
+#include "../battery/battery.h"
 #include "../settings/settings.h"
 #include "../tachometer/tachometer.h"
 
@@ -20,7 +21,39 @@ constexpr uint8_t kMaxSynthLevels = 101;
 static MotorSpeedLevel s_levels[kMaxSynthLevels];
 static char s_levelLabels[kMaxSynthLevels][12];
 
-void applyDutyFromSpeedPercent(uint8_t speedPct) {
+// Constant-RPM mode (spd_ctl): a PI loop on the tachometer, stepped on a fixed 100 Hz schedule
+// whatever the control tick does. The open-loop duty for the speed %, scaled for pack sag, is the
+// feed-forward; the PI term only trims it. Error is in fractions of rpm_max, output in fractions of
+// full duty. Tuned with env:native-rpm-bench.
+constexpr uint32_t kRpmLoopUs = 10000;
+constexpr float kRpmLoopDtS = kRpmLoopUs / 1e6f;
+constexpr uint32_t kRpmLoopMaxCatchUp = 5;  // missed steps replayed after a late tick; beyond that, resync
+constexpr float kRpmKp = 2.5f;
+constexpr float kRpmKi = 8.0f;  // per second
+// The min/max duty curve is taken to be set up at this cell voltage; feed-forward scales by it.
+constexpr float kFeedForwardCellV = 3.7f;
+constexpr float kFeedForwardScaleMin = 0.8f;
+constexpr float kFeedForwardScaleMax = 1.3f;
+// No RPM this long after the start means no FG wiring: hold the feed-forward duty (open loop).
+constexpr uint32_t kTachTimeoutUs = 1000000;
+
+struct RpmLoop {
+  bool active;
+  bool tachFault;
+  uint8_t speedPct;
+  float integral;  // duty fraction added to the feed-forward
+  uint32_t startedUs;
+  uint32_t nextStepUs;
+};
+
+static RpmLoop s_rpm = {};
+
+bool rpmModeSelected() {
+  return getRuntimeSettings().speedControl == SpeedControlMode::Rpm;
+}
+
+/** PWM duty (0–255) the min/max duty curve gives for a speed; 0 at speed 0. */
+int openLoopDuty(uint8_t speedPct) {
   const uint8_t minP = getRuntimeSettings().minDutyPercent;
   const uint8_t maxP = clampMaxDutyPercent(getRuntimeSettings().maxDutyPercent, minP);
   int pwmDuty = 0;
@@ -29,7 +62,95 @@ void applyDutyFromSpeedPercent(uint8_t speedPct) {
     const int maxDuty = static_cast<int>((maxP * 255) / 100);
     pwmDuty = minDuty + (static_cast<int>(speedPct) * (maxDuty - minDuty)) / 100;
   }
-  motorGenericPwmSetDuty(pwmDuty);
+  return pwmDuty;
+}
+
+float clampf(float v, float lo, float hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+/** Open-loop duty raised as the pack sags below (and lowered above) kFeedForwardCellV per cell. */
+float feedForwardDuty(uint8_t speedPct) {
+  const uint8_t cells = getRuntimeSettings().batterySeriesCells;
+  const float packV = getBatteryVoltage();
+  float scale = 1.0f;
+  if (cells > 0 && packV > 1.0f) {
+    scale = clampf(kFeedForwardCellV * static_cast<float>(cells) / packV, kFeedForwardScaleMin, kFeedForwardScaleMax);
+  }
+  return clampf(static_cast<float>(openLoopDuty(speedPct)) / 255.0f * scale, 0.0f, 1.0f);
+}
+
+void setDutyFraction(float d) {
+  motorGenericPwmSetDuty(static_cast<int>(d * 255.0f + 0.5f));
+}
+
+void applyDutyFromSpeedPercent(uint8_t speedPct) {
+  motorGenericPwmSetDuty(openLoopDuty(speedPct));
+}
+
+void rpmLoopStep(uint32_t now) {
+  const uint8_t pct = s_rpm.speedPct;
+  const float ff = feedForwardDuty(pct);
+  if (pct == 0) {
+    s_rpm.integral = 0.0f;
+    setDutyFraction(0.0f);
+    return;
+  }
+  const float rpm = getRPM();
+  if (!s_rpm.tachFault && rpm <= 0.0f && now - s_rpm.startedUs >= kTachTimeoutUs) {
+    s_rpm.tachFault = true;
+    Serial.println("[Motor] No tachometer signal, constant RPM falls back to open-loop duty");
+  }
+  if (s_rpm.tachFault || rpm <= 0.0f) {
+    setDutyFraction(ff);  // spinning up (or no FG): nothing to close the loop on yet
+    return;
+  }
+
+  const RuntimeSettings& rs = getRuntimeSettings();
+  const float fullScaleRpm = static_cast<float>(rs.rpmAtMaxK) * 1000.0f;
+  if (fullScaleRpm <= 0.0f) {
+    setDutyFraction(ff);  // no full-scale RPM configured: nothing to normalise the error against
+    return;
+  }
+  const float error = (fullScaleRpm * static_cast<float>(pct) / 100.0f - rpm) / fullScaleRpm;
+  const uint8_t minP = rs.minDutyPercent;
+  const float outMin = fmaxf(static_cast<float>(minP) / 100.0f, 1.0f / 255.0f);
+  const float outMax = static_cast<float>(clampMaxDutyPercent(rs.maxDutyPercent, minP)) / 100.0f;
+
+  // Anti-windup: the integrator only moves while the output is unsaturated or the error pulls it back.
+  const float integral = clampf(s_rpm.integral + kRpmKi * error * kRpmLoopDtS, -1.0f, 1.0f);
+  const float out = ff + kRpmKp * error + integral;
+  if (!((out > outMax && error > 0.0f) || (out < outMin && error < 0.0f))) {
+    s_rpm.integral = integral;
+  }
+  setDutyFraction(clampf(ff + kRpmKp * error + s_rpm.integral, outMin, outMax));
+}
+
+void rpmLoopUpdate() {
+  if (!running || !rpmModeSelected()) {
+    s_rpm.active = false;
+    return;
+  }
+  const uint32_t now = micros();
+  if (!s_rpm.active) {
+    s_rpm.active = true;
+    s_rpm.tachFault = false;
+    s_rpm.integral = 0.0f;
+    s_rpm.startedUs = now;
+    s_rpm.nextStepUs = now;
+  }
+  if (static_cast<int32_t>(now - s_rpm.nextStepUs) < 0) {
+    return;
+  }
+  uint32_t steps = (now - s_rpm.nextStepUs) / kRpmLoopUs + 1;
+  if (steps > kRpmLoopMaxCatchUp) {
+    steps = 1;
+    s_rpm.nextStepUs = now;
+  }
+  for (; steps > 0; --steps) {
+    rpmLoopStep(now);
+    s_rpm.nextStepUs += kRpmLoopUs;
+  }
 }
 
 void pwmInit() {
@@ -44,7 +165,9 @@ void pwmDeinit() {
   motorGenericPwmStop();
 }
 
-void pwmUpdate() {}
+void pwmUpdate() {
+  rpmLoopUpdate();
+}
 
 void pwmOnPowerOn() {}
 
@@ -54,7 +177,14 @@ void pwmSetSpeedPercent(uint8_t percent) {
   if (percent > 100) {
     percent = 100;
   }
-  applyDutyFromSpeedPercent(percent);
+  if (!rpmModeSelected()) {
+    applyDutyFromSpeedPercent(percent);
+    return;
+  }
+  s_rpm.speedPct = percent;
+  if (!s_rpm.active || percent == 0) {
+    setDutyFraction(feedForwardDuty(percent));  // start from the feed-forward; pwmUpdate() takes over
+  }
 }
 
 bool pwmIsRunning() {
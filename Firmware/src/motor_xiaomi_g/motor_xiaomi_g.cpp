@@ -224,7 +224,8 @@ void xgHandleWsCommand(const char* key, int value) {
 void xgHandleHeartbeat(void) {}
 
 bool xgSupportsGlobal(DevSettingId id) {
-  return id != DevSettingId::SpeedStep && id != DevSettingId::MinDuty && id != DevSettingId::MaxDuty;
+  return id != DevSettingId::SpeedStep && id != DevSettingId::MinDuty && id != DevSettingId::MaxDuty &&
+         id != DevSettingId::TachPulsesPerRev && id != DevSettingId::SpeedControl && id != DevSettingId::RpmAtMax;
 }
 
 MotorDriverSettings xgDriverSettings(void) {
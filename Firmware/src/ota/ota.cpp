@@ -5,6 +5,8 @@
 
 #include "display/display.h"
 #include "led/led.h"
+#include "maximum_stats/maximum_stats.h"
+#include "settings/settings.h"
 #include "settings/settings_config.h"
 #include "wifi/wifi.h"
 
@@ -51,6 +53,8 @@ void updateOTA() {
       updateDisplayOtaScreen(100);
       ledNotifyOtaProgressFromCallback(true, 100);
       Serial.println("\n[OTA] End");
+      flushRuntimeSettings();
+      maximumStatsFlush();
       delay(200);
       ESP.restart();
     });
@@ -8,6 +8,7 @@
 #include "../display/display.h"
 #include "../led/led.h"
 #include "../motor/motor.h"
+#include "../session_log/session_log.h"
 #include "../settings/settings.h"
 #include "../settings/settings_config.h"
 
@@ -63,6 +64,7 @@ bool updatePowerManagement(bool buttonActivity, bool motorActive, bool otaActive
     return false;
   }
 
+  sessionLogNoteStop(SessionStopReason::Sleep);
   stopMotor();
   setMotorState(false);
   turnOffLEDsNow();
@@ -0,0 +1,426 @@
+#include "session_log.h"
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <string.h>
+
+#include "../crc32/crc32.h"
+#include "../settings/settings.h"
+
+namespace {
+
+constexpr size_t kPageBytes = 256;  // flash program page
+constexpr uint32_t kRecordsPerPage = kPageBytes / kSessionRecordSize;
+constexpr UBaseType_t kQueueDepth = 4;
+constexpr uint8_t kSocUnknown = 0xFF;
+constexpr uint16_t kPackMaxMv = 0xFFFF;
+static_assert(kSessionSegmentBytes % kPageBytes == 0, "segments are whole pages");
+
+// --- Control task -------------------------------------------------------------------------
+
+// Notes are written under the control lock or by the control tick itself, so plain fields do.
+SessionStartReason s_startNote = SessionStartReason::Trigger;
+SessionStopReason s_stopNote = SessionStopReason::Trigger;
+
+struct RunAccumulator {
+  bool active;
+  SessionStartReason startReason;
+  uint32_t startMs;
+  uint32_t lastMs;
+  uint32_t speedMs[kSessionSpeedBuckets];
+  uint64_t speedPercentMs;
+  uint32_t rpmMs[kSessionRpmBuckets];
+  uint32_t rpmValidMs;
+  uint32_t peakRpm;
+  uint16_t packMinMv;
+  uint16_t packMaxMv;
+  uint64_t packMvMs;
+  uint32_t packMs;
+  int16_t peakTempCenti;
+  uint8_t socStart;
+  uint8_t socEnd;
+};
+
+RunAccumulator s_run{};
+QueueHandle_t s_finished = nullptr;
+
+uint8_t share255(uint32_t partMs, uint32_t totalMs) {
+  return totalMs == 0 ? 0 : static_cast<uint8_t>((static_cast<uint64_t>(partMs) * 255U + totalMs / 2) / totalMs);
+}
+
+uint8_t socByte(int8_t soc) {
+  return soc < 0 ? kSocUnknown : static_cast<uint8_t>(soc);
+}
+
+void startRun(const TelemetrySnapshot& snap, uint32_t now) {
+  s_run = {};
+  s_run.active = true;
+  s_run.startReason = s_startNote;
+  s_run.startMs = now;
+  s_run.lastMs = now;
+  s_run.packMinMv = kPackMaxMv;
+  s_run.peakTempCenti = INT16_MIN;
+  s_run.socStart = socByte(snap.batterySocPercent);
+  s_startNote = SessionStartReason::Trigger;
+  s_stopNote = SessionStopReason::Trigger;
+}
+
+void accumulate(const TelemetrySnapshot& snap, uint32_t now) {
+  const uint32_t dt = now - s_run.lastMs;
+  s_run.lastMs = now;
+  const uint8_t speed = snap.speedPercent > 100 ? 100 : snap.speedPercent;
+  s_run.speedMs[speed >= 100 ? kSessionSpeedBuckets - 1 : speed / 10] += dt;
+  s_run.speedPercentMs += static_cast<uint64_t>(speed) * dt;
+  if (snap.rpmReady) {
+    const uint32_t rpm = snap.rpm > 0.0f ? static_cast<uint32_t>(snap.rpm) : 0U;
+    const uint32_t band = rpm / kSessionRpmBucketWidth;
+    s_run.rpmMs[band >= kSessionRpmBuckets ? kSessionRpmBuckets - 1 : band] += dt;
+    s_run.rpmValidMs += dt;
+    if (rpm > s_run.peakRpm) {
+      s_run.peakRpm = rpm;
+    }
+  }
+  if (snap.batteryVoltage > 0.05f) {
+    const float mv = snap.batteryVoltage * 1000.0f;
+    const uint16_t packMv = mv >= kPackMaxMv ? kPackMaxMv : static_cast<uint16_t>(mv + 0.5f);
+    s_run.packMinMv = packMv < s_run.packMinMv ? packMv : s_run.packMinMv;
+    s_run.packMaxMv = packMv > s_run.packMaxMv ? packMv : s_run.packMaxMv;
+    s_run.packMvMs += static_cast<uint64_t>(packMv) * dt;
+    s_run.packMs += dt;
+  }
+  if (snap.temperatureReady) {
+    const float centi = snap.temperatureC * 100.0f;
+    const int16_t t = centi >= 32767.0f ? INT16_MAX : (centi <= -32767.0f ? -32767 : static_cast<int16_t>(centi));
+    s_run.peakTempCenti = t > s_run.peakTempCenti ? t : s_run.peakTempCenti;
+  }
+  s_run.socEnd = socByte(snap.batterySocPercent);
+}
+
+void finishRun(uint32_t now) {
+  const uint32_t duration = now - s_run.startMs;
+  SessionRecord r{};
+  r.startReason = s_run.startReason;
+  r.stopReason = s_stopNote;
+  r.startMs = s_run.startMs;
+  r.durationMs = duration;
+  if (s_run.packMs > 0) {
+    r.packMinMv = s_run.packMinMv;
+    r.packMeanMv = static_cast<uint16_t>(s_run.packMvMs / s_run.packMs);
+    r.packMaxMv = s_run.packMaxMv;
+  }
+  r.peakTempCenti = s_run.peakTempCenti;
+  r.peakRpm = s_run.peakRpm;
+  for (uint8_t i = 0; i < kSessionSpeedBuckets; ++i) {
+    r.speedShare[i] = share255(s_run.speedMs[i], duration);
+  }
+  for (uint8_t i = 0; i < kSessionRpmBuckets; ++i) {
+    r.rpmShare[i] = share255(s_run.rpmMs[i], s_run.rpmValidMs);
+  }
+  r.socStart = s_run.socStart;
+  r.socEnd = s_run.socEnd == 0 && s_run.socStart == kSocUnknown ? kSocUnknown : s_run.socEnd;
+  r.meanSpeedPercent = duration == 0 ? 0 : static_cast<uint8_t>((s_run.speedPercentMs + duration / 2) / duration);
+  r.motorType = static_cast<uint8_t>(getRuntimeSettings().motorType);
+  s_run.active = false;
+  s_startNote = SessionStartReason::Trigger;
+  s_stopNote = SessionStopReason::Trigger;
+  if (s_finished != nullptr) {
+    // Never block the control tick; with four runs already waiting, this one is lost.
+    xQueueSend(s_finished, &r, 0);
+  }
+}
+
+// --- I/O task: the ring -------------------------------------------------------------------
+
+struct Segment {
+  uint32_t firstSeq;
+  uint32_t count;
+};
+
+Segment s_segments[kSessionSegmentCount];
+uint8_t s_head = 0;
+uint32_t s_newestSeq = 0;
+bool s_scanned = false;
+bool s_ready = false;
+// The page being filled in the head segment; rewritten whole for every record added to it.
+uint8_t s_page[kPageBytes];
+SessionRecord s_retry{};
+bool s_hasRetry = false;
+
+void put16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+  put16(p, static_cast<uint16_t>(v));
+  put16(p + 2, static_cast<uint16_t>(v >> 16));
+}
+
+uint16_t get16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t get32(const uint8_t* p) {
+  return get16(p) | (static_cast<uint32_t>(get16(p + 2)) << 16);
+}
+
+void encodeRecord(const SessionRecord& r, uint8_t* out) {
+  memset(out, 0, kSessionRecordSize);
+  out[0] = kSessionRecordMagic;
+  out[1] = kSessionLogVersion;
+  out[2] = static_cast<uint8_t>(r.startReason);
+  out[3] = static_cast<uint8_t>(r.stopReason);
+  put32(out + 4, r.seq);
+  put32(out + 8, r.startMs);
+  put32(out + 12, r.durationMs);
+  put16(out + 16, r.packMinMv);
+  put16(out + 18, r.packMeanMv);
+  put16(out + 20, r.packMaxMv);
+  put16(out + 22, static_cast<uint16_t>(r.peakTempCenti));
+  put32(out + 24, r.peakRpm);
+  memcpy(out + 28, r.speedShare, kSessionSpeedBuckets);
+  memcpy(out + 38, r.rpmShare, kSessionRpmBuckets);
+  out[46] = r.socStart;
+  out[47] = r.socEnd;
+  out[48] = r.meanSpeedPercent;
+  out[49] = r.motorType;
+  put32(out + 60, crc32(out, 60));
+}
+
+void segmentPath(uint8_t index, char* out, size_t size) {
+  snprintf(out, size, "/session_%u.bin", static_cast<unsigned>(index));
+}
+
+void scanSegment(uint8_t index) {
+  Segment& seg = s_segments[index];
+  seg = {};
+  char path[24];
+  segmentPath(index, path, sizeof(path));
+  File f = LittleFS.open(path, "r");
+  if (!f) {
+    return;
+  }
+  uint8_t raw[kSessionRecordSize];
+  SessionRecord r;
+  while (seg.count < kSessionRecordsPerSegment && f.read(raw, sizeof(raw)) == sizeof(raw) &&
+         sessionLogDecode(raw, r) && (seg.count == 0 || r.seq == seg.firstSeq + seg.count)) {
+    if (seg.count == 0) {
+      seg.firstSeq = r.seq;
+    }
+    ++seg.count;
+  }
+  f.close();
+}
+
+void loadHeadPage() {
+  memset(s_page, 0, sizeof(s_page));
+  const Segment& seg = s_segments[s_head];
+  const uint32_t filled = seg.count % kRecordsPerPage;
+  if (filled == 0) {
+    return;
+  }
+  char path[24];
+  segmentPath(s_head, path, sizeof(path));
+  File f = LittleFS.open(path, "r");
+  if (f && f.seek((seg.count - filled) * kSessionRecordSize)) {
+    f.read(s_page, filled * kSessionRecordSize);
+  }
+  if (f) {
+    f.close();
+  }
+}
+
+void scanRing() {
+  s_scanned = true;
+  if (!LittleFS.begin(true)) {
+    Serial.println("[Sessions] LittleFS mount failed, recorder off");
+    return;
+  }
+  s_newestSeq = 0;
+  s_head = 0;
+  uint32_t kept = 0;
+  for (uint8_t i = 0; i < kSessionSegmentCount; ++i) {
+    scanSegment(i);
+    const Segment& seg = s_segments[i];
+    kept += seg.count;
+    if (seg.count > 0 && seg.firstSeq + seg.count - 1 > s_newestSeq) {
+      s_newestSeq = seg.firstSeq + seg.count - 1;
+      s_head = i;
+    }
+  }
+  loadHeadPage();
+  s_ready = true;
+  Serial.printf("[Sessions] %lu runs kept, newest #%lu\n", static_cast<unsigned long>(kept),
+                static_cast<unsigned long>(s_newestSeq));
+}
+
+bool appendRecord(SessionRecord& r) {
+  if (s_segments[s_head].count >= kSessionRecordsPerSegment) {
+    s_head = static_cast<uint8_t>((s_head + 1) % kSessionSegmentCount);
+    s_segments[s_head] = {};
+    memset(s_page, 0, sizeof(s_page));
+  }
+  Segment& seg = s_segments[s_head];
+  r.seq = s_newestSeq + 1;
+  const uint32_t slot = seg.count;
+  encodeRecord(r, s_page + (slot % kRecordsPerPage) * kSessionRecordSize);
+
+  char path[24];
+  segmentPath(s_head, path, sizeof(path));
+  if (slot == 0) {
+    LittleFS.remove(path);  // a recycled segment starts on fresh blocks
+  }
+  File f = LittleFS.open(path, slot == 0 ? "w" : "r+");
+  bool ok = static_cast<bool>(f) && f.seek((slot / kRecordsPerPage) * kPageBytes) &&
+            f.write(s_page, sizeof(s_page)) == sizeof(s_page);
+  if (f) {
+    f.close();
+  }
+  if (!ok) {
+    Serial.println("[Sessions] Write failed, will retry");
+    return false;
+  }
+  if (slot == 0) {
+    seg.firstSeq = r.seq;
+  }
+  ++seg.count;
+  s_newestSeq = r.seq;
+  return true;
+}
+
+int8_t segmentOf(uint32_t seq) {
+  for (uint8_t i = 0; i < kSessionSegmentCount; ++i) {
+    const Segment& seg = s_segments[i];
+    if (seg.count > 0 && seq >= seg.firstSeq && seq < seg.firstSeq + seg.count) {
+      return static_cast<int8_t>(i);
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+void initSessionLog() {
+  if (s_finished == nullptr) {
+    s_finished = xQueueCreate(kQueueDepth, sizeof(SessionRecord));
+  }
+}
+
+void sessionLogNoteStart(SessionStartReason reason) {
+  s_startNote = reason;
+}
+
+void sessionLogNoteStop(SessionStopReason reason) {
+  s_stopNote = reason;
+}
+
+void sessionLogOnControlTick(const TelemetrySnapshot& snapshot) {
+  const uint32_t now = millis();
+  if (snapshot.motorActive && !s_run.active) {
+    startRun(snapshot, now);
+  }
+  if (!s_run.active) {
+    return;
+  }
+  // The tick that stops the motor still counts: its readings are what tripped a cutoff.
+  accumulate(snapshot, now);
+  if (!snapshot.motorActive) {
+    finishRun(now);
+  }
+}
+
+void updateSessionLog() {
+  if (!s_scanned) {
+    scanRing();
+  }
+  if (!s_ready) {
+    return;
+  }
+  if (!s_hasRetry) {
+    s_hasRetry = s_finished != nullptr && xQueueReceive(s_finished, &s_retry, 0) == pdTRUE;
+  }
+  if (s_hasRetry && appendRecord(s_retry)) {
+    s_hasRetry = false;
+  }
+}
+
+bool sessionLogReady() {
+  return s_ready;
+}
+
+uint32_t sessionLogOldestSeq() {
+  uint32_t oldest = 0;
+  for (const Segment& seg : s_segments) {
+    if (seg.count > 0 && (oldest == 0 || seg.firstSeq < oldest)) {
+      oldest = seg.firstSeq;
+    }
+  }
+  return oldest;
+}
+
+uint32_t sessionLogNewestSeq() {
+  return s_newestSeq;
+}
+
+size_t sessionLogReadPage(uint32_t fromSeq, uint32_t maxRecords, uint8_t* out, size_t capacity, uint32_t& nextSeq) {
+  if (capacity < kSessionPageHeaderSize) {
+    nextSeq = fromSeq;
+    return 0;
+  }
+  const uint32_t oldest = sessionLogOldestSeq();
+  const uint32_t from = fromSeq < oldest ? oldest : fromSeq;
+  uint32_t count = 0;
+  const int8_t index = s_ready ? segmentOf(from) : -1;
+  if (index >= 0) {
+    const Segment& seg = s_segments[index];
+    const uint32_t slot = from - seg.firstSeq;
+    count = seg.count - slot;
+    const uint32_t fits = (capacity - kSessionPageHeaderSize) / kSessionRecordSize;
+    count = count < fits ? count : fits;
+    count = count < maxRecords ? count : maxRecords;
+    count = count > 0xFF ? 0xFF : count;
+    char path[24];
+    segmentPath(static_cast<uint8_t>(index), path, sizeof(path));
+    File f = LittleFS.open(path, "r");
+    const size_t want = count * kSessionRecordSize;
+    if (!f || !f.seek(slot * kSessionRecordSize) || f.read(out + kSessionPageHeaderSize, want) != want) {
+      count = 0;
+    }
+    if (f) {
+      f.close();
+    }
+  }
+  out[0] = kSessionPageMagic;
+  out[1] = kSessionLogVersion;
+  out[2] = static_cast<uint8_t>(count);
+  out[3] = static_cast<uint8_t>(kSessionRecordSize);
+  put32(out + 4, count > 0 ? from : 0);
+  put32(out + 8, s_newestSeq);
+  nextSeq = from + count;
+  return kSessionPageHeaderSize + count * kSessionRecordSize;
+}
+
+bool sessionLogDecode(const uint8_t* raw, SessionRecord& out) {
+  if (raw[0] != kSessionRecordMagic || raw[1] != kSessionLogVersion || get32(raw + 60) != crc32(raw, 60)) {
+    return false;
+  }
+  out.startReason = static_cast<SessionStartReason>(raw[2]);
+  out.stopReason = static_cast<SessionStopReason>(raw[3]);
+  out.seq = get32(raw + 4);
+  out.startMs = get32(raw + 8);
+  out.durationMs = get32(raw + 12);
+  out.packMinMv = get16(raw + 16);
+  out.packMeanMv = get16(raw + 18);
+  out.packMaxMv = get16(raw + 20);
+  out.peakTempCenti = static_cast<int16_t>(get16(raw + 22));
+  out.peakRpm = get32(raw + 24);
+  memcpy(out.speedShare, raw + 28, kSessionSpeedBuckets);
+  memcpy(out.rpmShare, raw + 38, kSessionRpmBuckets);
+  out.socStart = raw[46];
+  out.socEnd = raw[47];
+  out.meanSpeedPercent = raw[48];
+  out.motorType = raw[49];
+  return true;
+}
@@ -0,0 +1,100 @@
+#ifndef SESSION_LOG_H
+#define SESSION_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../telemetry_snapshot/telemetry_snapshot.h"
+
+/**
+ * Motor-run recorder. The control tick accumulates each run in O(1) per tick and hands the finished
+ * record to the I/O task, which appends it to a ring of segment files on LittleFS
+ * (/session_<n>.bin). Each segment holds one flash sector of records. A record is written by
+ * rewriting its whole 256-byte page from a static page buffer. A full ring drops its oldest
+ * segment: remove() and re-create, so LittleFS places it on whichever blocks its allocator
+ * picks next, and wear spreads over the partition.
+ *
+ * Record v1 (64 bytes, little-endian):
+ *   0 u8 magic 0xA7   1 u8 version   2 u8 start reason   3 u8 stop reason
+ *   4 u32 seq (1, 2, … across reboots)   8 u32 start [ms since boot]   12 u32 duration [ms]
+ *  16 u16 pack min [mV]   18 u16 pack mean [mV]   20 u16 pack max [mV]   (0 = no reading)
+ *  22 i16 peak motor temp [0.01 °C] (INT16_MIN = no reading)   24 u32 peak rpm
+ *  28 u8[10] share of the run per speed decile (0–9 %, …, 90–100 %), n/255
+ *  38 u8[8] share of the RPM-valid time per 15000-rpm band (last band open-ended), n/255
+ *  46 u8 SOC at start [%]   47 u8 SOC at stop [%] (0xFF = unknown)   48 u8 mean speed [%]
+ *  49 u8 motor type   50..59 reserved (0)   60 u32 CRC-32 of bytes 0–59
+ *
+ * Page v1 (binary link message answering get_sessions), little-endian:
+ *   0 u8 magic 0xA8   1 u8 version   2 u8 record count   3 u8 record size
+ *   4 u32 seq of the first record   8 u32 newest seq in the log   12 records
+ * A page with count 0 ends the dump.
+ */
+enum class SessionStartReason : uint8_t { Trigger = 0, Remote = 1 };
+enum class SessionStopReason : uint8_t { Trigger = 0, Remote, AutoOff, Thermal, Undervoltage, Sleep };
+
+constexpr uint8_t kSessionRecordMagic = 0xA7;
+constexpr uint8_t kSessionPageMagic = 0xA8;
+constexpr uint8_t kSessionLogVersion = 1;
+constexpr size_t kSessionRecordSize = 64;
+constexpr size_t kSessionPageHeaderSize = 12;
+constexpr uint8_t kSessionSpeedBuckets = 10;
+constexpr uint8_t kSessionRpmBuckets = 8;
+constexpr uint32_t kSessionRpmBucketWidth = 15000;
+constexpr uint8_t kSessionSegmentCount = 8;
+constexpr size_t kSessionSegmentBytes = 4096;
+constexpr uint32_t kSessionRecordsPerSegment = kSessionSegmentBytes / kSessionRecordSize;
+/** Records kept; the ring holds between this and one segment less after a wrap. */
+constexpr uint32_t kSessionLogCapacity = kSessionSegmentCount * kSessionRecordsPerSegment;
+
+struct SessionRecord {
+  uint32_t seq;
+  SessionStartReason startReason;
+  SessionStopReason stopReason;
+  uint32_t startMs;
+  uint32_t durationMs;
+  uint16_t packMinMv;
+  uint16_t packMeanMv;
+  uint16_t packMaxMv;
+  int16_t peakTempCenti;
+  uint32_t peakRpm;
+  uint8_t speedShare[kSessionSpeedBuckets];
+  uint8_t rpmShare[kSessionRpmBuckets];
+  uint8_t socStart;
+  uint8_t socEnd;
+  uint8_t meanSpeedPercent;
+  uint8_t motorType;
+};
+
+/** Creates the hand-off queue; call in setup() before the control task starts. */
+void initSessionLog();
+
+/**
+ * Why the next start / stop happens. Call under the control lock (or from the control tick) just
+ * before switching the motor; an edge without a note counts as the trigger.
+ */
+void sessionLogNoteStart(SessionStartReason reason);
+void sessionLogNoteStop(SessionStopReason reason);
+
+/** Control tick, with the published snapshot. No allocation, no flash. */
+void sessionLogOnControlTick(const TelemetrySnapshot& snapshot);
+
+/** I/O task: mounts and scans the ring on the first call, then writes finished runs. */
+void updateSessionLog();
+
+/** Ring scanned and writable. */
+bool sessionLogReady();
+/** 0 while the log is empty. */
+uint32_t sessionLogOldestSeq();
+uint32_t sessionLogNewestSeq();
+
+/**
+ * I/O task: encodes a page of up to `maxRecords` records from `fromSeq` (moved up to the oldest kept
+ * one) into `out`, bounded by `capacity` and by the end of a segment. `nextSeq` is the seq to ask for
+ * next. Returns the page length; a page without records (count 0) means nothing is left.
+ */
+size_t sessionLogReadPage(uint32_t fromSeq, uint32_t maxRecords, uint8_t* out, size_t capacity, uint32_t& nextSeq);
+
+/** Checks magic, version and CRC of one stored record. */
+bool sessionLogDecode(const uint8_t* raw, SessionRecord& out);
+
+#endif  // SESSION_LOG_H
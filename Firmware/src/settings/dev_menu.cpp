@@ -37,6 +37,10 @@ void formatLedDimVal(char* out, size_t n) { settingsFormatValue(DevSettingId::Le
 void formatLedThemeVal(char* out, size_t n) { settingsFormatValue(DevSettingId::LedTheme, getRuntimeSettings(), out, n); }
 void formatDisplayContrastVal(char* out, size_t n) { settingsFormatValue(DevSettingId::DisplayContrast, getRuntimeSettings(), out, n); }
 void formatMotorTypeVal(char* out, size_t n) { settingsFormatValue(DevSettingId::MotorType, getRuntimeSettings(), out, n); }
+void formatTachPprVal(char* out, size_t n) { settingsFormatValue(DevSettingId::TachPulsesPerRev, getRuntimeSettings(), out, n); }
+void formatSpeedControlVal(char* out, size_t n) { settingsFormatValue(DevSettingId::SpeedControl, getRuntimeSettings(), out, n); }
+void formatRpmMaxVal(char* out, size_t n) { settingsFormatValue(DevSettingId::RpmAtMax, getRuntimeSettings(), out, n); }
+void formatBootModeVal(char* out, size_t n) { settingsFormatValue(DevSettingId::BootMode, getRuntimeSettings(), out, n); }
 void formatBatteryCellsSub(char* out, size_t n) { settingsFormatSubline(DevSettingId::BatteryCells, getRuntimeSettings(), out, n); }
 void formatTrigModeSub(char* out, size_t n) { settingsFormatSubline(DevSettingId::TriggerMode, getRuntimeSettings(), out, n); }
 void formatMotorDispSub(char* out, size_t n) { settingsFormatSubline(DevSettingId::MotorDisplayMode, getRuntimeSettings(), out, n); }
@@ -44,6 +48,8 @@ void formatLedIdleSub(char* out, size_t n) { settingsFormatSubline(DevSettingId:
 void formatLedMotorSub(char* out, size_t n) { settingsFormatSubline(DevSettingId::LedDisplay, getRuntimeSettings(), out, n); }
 void formatLedThemeSub(char* out, size_t n) { settingsFormatSubline(DevSettingId::LedTheme, getRuntimeSettings(), out, n); }
 void formatMotorTypeSub(char* out, size_t n) { settingsFormatSubline(DevSettingId::MotorType, getRuntimeSettings(), out, n); }
+void formatSpeedControlSub(char* out, size_t n) { settingsFormatSubline(DevSettingId::SpeedControl, getRuntimeSettings(), out, n); }
+void formatBootModeSub(char* out, size_t n) { settingsFormatSubline(DevSettingId::BootMode, getRuntimeSettings(), out, n); }
 
 void cycleAndSave(DevSettingId id) {
   RuntimeSettings& rs = getRuntimeSettings();
@@ -66,6 +72,10 @@ void cycleLedDim() { cycleAndSave(DevSettingId::LedDim); }
 void cycleLedTheme() { cycleAndSave(DevSettingId::LedTheme); }
 void cycleDisplayContrast() { cycleAndSave(DevSettingId::DisplayContrast); }
 void cycleMotorType() { cycleAndSave(DevSettingId::MotorType); }
+void cycleTachPpr() { cycleAndSave(DevSettingId::TachPulsesPerRev); }
+void cycleSpeedControl() { cycleAndSave(DevSettingId::SpeedControl); }
+void cycleRpmMax() { cycleAndSave(DevSettingId::RpmAtMax); }
+void cycleBootMode() { cycleAndSave(DevSettingId::BootMode); }
 
 static DevSettingDescriptor kGlobalDescriptors[] = {
     {true, DevSettingId::AutoOff, nullptr, "Auto-Off", formatAutoOffVal, "Motor Shutdown", nullptr, cycleAutoOff},
@@ -83,6 +93,10 @@ static DevSettingDescriptor kGlobalDescriptors[] = {
     {true, DevSettingId::LedTheme, nullptr, "LED Theme", formatLedThemeVal, nullptr, formatLedThemeSub, cycleLedTheme},
     {true, DevSettingId::DisplayContrast, nullptr, "Display Brightness", formatDisplayContrastVal, "OLED Contrast", nullptr, cycleDisplayContrast},
     {true, DevSettingId::MotorType, nullptr, "Motor Type", formatMotorTypeVal, nullptr, formatMotorTypeSub, cycleMotorType},
+    {true, DevSettingId::TachPulsesPerRev, nullptr, "Tacho Pulses", formatTachPprVal, "per Revolution", nullptr, cycleTachPpr},
+    {true, DevSettingId::SpeedControl, nullptr, "Speed Control", formatSpeedControlVal, nullptr, formatSpeedControlSub, cycleSpeedControl},
+    {true, DevSettingId::RpmAtMax, nullptr, "Max RPM", formatRpmMaxVal, "at 100% Speed", nullptr, cycleRpmMax},
+    {true, DevSettingId::BootMode, nullptr, "Boot Mode", formatBootModeVal, nullptr, formatBootModeSub, cycleBootMode},
 };
 
 static_assert(
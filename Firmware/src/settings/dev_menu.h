@@ -20,6 +20,10 @@ enum class DevSettingId : uint8_t {
   LedTheme,
   DisplayContrast,
   MotorType,
+  TachPulsesPerRev,
+  SpeedControl,
+  RpmAtMax,
+  BootMode,
   GlobalCount,
 };
 
@@ -44,8 +48,8 @@ void devMenuRebuildVisible();
 size_t devMenuVisibleCount();
 const DevSettingDescriptor* devMenuVisibleAt(size_t idx);
 
-/** Info pages 0..5 (Maximum Stats, Battery, WiFi, BLE, Sensor, System). */
-constexpr uint8_t kDevMenuInfoPageCount = 6;
+/** Info pages 0..6 (Maximum Stats, Battery, WiFi, BLE, Sensor, System, Loop Profile). */
+constexpr uint8_t kDevMenuInfoPageCount = 7;
 
 uint8_t devMenuTotalPageCount();
 
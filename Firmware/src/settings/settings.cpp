@@ -1,9 +1,14 @@
 #include "settings.h"
 #include "settings_config.h"
 
+#include "../control_tasks/control_tasks.h"
+
+#include <Arduino.h>
 #include <Preferences.h>
 #include <string.h>
 
+#include <atomic>
+
 namespace {
 constexpr char SETTINGS_NAMESPACE[] = "oshvac";
 constexpr char KEY_DISPLAY_TYPE[] = "display_type";
@@ -22,6 +27,10 @@ constexpr char KEY_LED_DIM[] = "led_dim";
 constexpr char KEY_DISP_CONTRAST[] = "disp_contrast";
 constexpr char KEY_LED_THEME[] = "led_theme";
 constexpr char KEY_MTR_TYPE[] = "mtr_type";
+constexpr char KEY_TACH_PPR[] = "tach_ppr";
+constexpr char KEY_SPD_CTL[] = "spd_ctl";
+constexpr char KEY_RPM_MAX[] = "rpm_max";
+constexpr char KEY_BOOT_MODE[] = "boot_mode";
 constexpr char DISPLAY_091[] = "0.91-I2C-Waveshare";
 constexpr char DISPLAY_15[] = "1.5-I2C-Waveshare";
 constexpr char DISPLAY_NONE[] = "none";
@@ -29,6 +38,25 @@ constexpr char DISPLAY_NONE[] = "none";
 static RuntimeSettings s_rt;
 static RuntimeSettingsChangedCallback s_changedCallback = nullptr;
 
+// Recent saved states by version, so link clients can be sent a delta from the version they hold.
+constexpr uint32_t kSettingsHistoryDepth = 8;
+static RuntimeSettings s_history[kSettingsHistoryDepth];
+static std::atomic<uint32_t> s_version{0};
+
+// Written by the I/O task only (and by setup() before the tasks start).
+static RuntimeSettings s_stored;
+// Guarded by the control lock, like every caller of saveRuntimeSettings().
+static RuntimeSettings s_queued;
+static bool s_writeQueued = false;
+static uint32_t s_queuedSinceMs = 0;
+static uint32_t s_lastChangeMs = 0;
+
+void recordSettingsVersion(const RuntimeSettings& settings) {
+  const uint32_t next = s_version.load() + 1;
+  s_history[next % kSettingsHistoryDepth] = settings;
+  s_version.store(next);
+}
+
 uint8_t clampAutoOff(uint8_t v) {
   if (v == 0 || v == 1 || v == 2 || v == 5 || v == 10 || v == 30) {
     return v;
@@ -116,6 +144,13 @@ LedTheme clampLedTheme(uint8_t v) {
   return static_cast<LedTheme>(SettingsConfig::DEFAULT_LED_THEME);
 }
 
+uint8_t clampTachPulsesPerRev(uint8_t v) {
+  if (v >= 1 && v <= 12) {
+    return v;
+  }
+  return RuntimeSettings{}.tachPulsesPerRev;
+}
+
 MotorType clampMotorType(uint8_t v) {
   if (v <= static_cast<uint8_t>(MotorType::XiaomiG)) {
     return static_cast<MotorType>(v);
@@ -124,6 +159,27 @@ MotorType clampMotorType(uint8_t v) {
 }
 }  // namespace
 
+SpeedControlMode clampSpeedControl(uint8_t v) {
+  if (v <= static_cast<uint8_t>(SpeedControlMode::Rpm)) {
+    return static_cast<SpeedControlMode>(v);
+  }
+  return RuntimeSettings{}.speedControl;
+}
+
+uint8_t clampRpmAtMaxK(uint8_t v) {
+  if (v >= 5 && v <= 120) {
+    return v;
+  }
+  return RuntimeSettings{}.rpmAtMaxK;
+}
+
+BootMode clampBootMode(uint8_t v) {
+  if (v <= static_cast<uint8_t>(BootMode::Full)) {
+    return static_cast<BootMode>(v);
+  }
+  return RuntimeSettings{}.bootMode;
+}
+
 uint8_t maxDutyPercentLowerBound(uint8_t minDutyPercent) {
   uint8_t m = minDutyPercent;
   if (!(m == 0 || (m >= 1 && m <= 30))) {
@@ -204,7 +260,7 @@ const char* motorTypeDisplayName(MotorType type) {
   }
 }
 
-RuntimeSettings& loadRuntimeSettings() {
+static void loadRuntimeSettingsFromNvs() {
   s_rt.displayType = parseDisplayType(SettingsConfig::DEFAULT_DISPLAY_TYPE);
   s_rt.batterySeriesCells = SettingsConfig::DEFAULT_BATTERY_SERIES_CELLS;
   s_rt.autoOffMinutes = SettingsConfig::DEFAULT_AUTO_OFF_MINUTES;
@@ -221,10 +277,14 @@ RuntimeSettings& loadRuntimeSettings() {
   s_rt.displayContrastPercent = clampDisplayContrastPercent(SettingsConfig::DEFAULT_DISPLAY_CONTRAST_PERCENT);
   s_rt.ledTheme = clampLedTheme(SettingsConfig::DEFAULT_LED_THEME);
   s_rt.motorType = clampMotorType(SettingsConfig::DEFAULT_MOTOR_TYPE);
+  s_rt.tachPulsesPerRev = RuntimeSettings{}.tachPulsesPerRev;
+  s_rt.speedControl = RuntimeSettings{}.speedControl;
+  s_rt.rpmAtMaxK = RuntimeSettings{}.rpmAtMaxK;
+  s_rt.bootMode = RuntimeSettings{}.bootMode;
 
   Preferences prefs;
   if (!prefs.begin(SETTINGS_NAMESPACE, true)) {
-    return s_rt;
+    return;
   }
 
   // display_type follows compile-time DEFAULT_DISPLAY_TYPE (hardware selection).
@@ -248,57 +308,181 @@ RuntimeSettings& loadRuntimeSettings() {
   s_rt.displayContrastPercent = clampDisplayContrastPercent(prefs.getUChar(KEY_DISP_CONTRAST, s_rt.displayContrastPercent));
   s_rt.ledTheme = clampLedTheme(prefs.getUChar(KEY_LED_THEME, static_cast<uint8_t>(s_rt.ledTheme)));
   s_rt.motorType = clampMotorType(prefs.getUChar(KEY_MTR_TYPE, static_cast<uint8_t>(s_rt.motorType)));
+  s_rt.tachPulsesPerRev = clampTachPulsesPerRev(prefs.getUChar(KEY_TACH_PPR, s_rt.tachPulsesPerRev));
+  s_rt.speedControl = clampSpeedControl(prefs.getUChar(KEY_SPD_CTL, static_cast<uint8_t>(s_rt.speedControl)));
+  s_rt.rpmAtMaxK = clampRpmAtMaxK(prefs.getUChar(KEY_RPM_MAX, s_rt.rpmAtMaxK));
+  s_rt.bootMode = clampBootMode(prefs.getUChar(KEY_BOOT_MODE, static_cast<uint8_t>(s_rt.bootMode)));
 
   prefs.end();
-  return s_rt;
 }
 
-RuntimeSettings& getRuntimeSettings() {
-  return s_rt;
+namespace {
+
+// The settings as their NVS keys hold them, so "changed" means "a key would be rewritten".
+RuntimeSettings storedForm(const RuntimeSettings& settings) {
+  RuntimeSettings s = settings;
+  s.batterySeriesCells = settings.batterySeriesCells < 1 ? 1 : (settings.batterySeriesCells > 32 ? 32 : settings.batterySeriesCells);
+  s.autoOffMinutes = clampAutoOff(settings.autoOffMinutes);
+  s.sleepTimerMinutes = clampSleepTimer(settings.sleepTimerMinutes);
+  s.tempLimitC = clampTempLim(settings.tempLimitC);
+  s.speedStepPercent = clampSpeedStep(settings.speedStepPercent);
+  s.minDutyPercent = clampMinDuty(settings.minDutyPercent);
+  s.maxDutyPercent = clampMaxDutyPercent(settings.maxDutyPercent, s.minDutyPercent);
+  s.motorDisplayMode = clampMotorDisp(static_cast<uint8_t>(settings.motorDisplayMode));
+  s.triggerMode = clampTriggerMode(static_cast<uint8_t>(settings.triggerMode));
+  s.ledIdleDisplayMode = clampLedIdle(static_cast<uint8_t>(settings.ledIdleDisplayMode));
+  s.ledDisplayMode = clampLedDisp(static_cast<uint8_t>(settings.ledDisplayMode));
+  s.ledDimPercent = clampLedDimPercent(settings.ledDimPercent);
+  s.displayContrastPercent = clampDisplayContrastPercent(settings.displayContrastPercent);
+  s.ledTheme = clampLedTheme(static_cast<uint8_t>(settings.ledTheme));
+  s.motorType = clampMotorType(static_cast<uint8_t>(settings.motorType));
+  s.tachPulsesPerRev = clampTachPulsesPerRev(settings.tachPulsesPerRev);
+  s.speedControl = clampSpeedControl(static_cast<uint8_t>(settings.speedControl));
+  s.rpmAtMaxK = clampRpmAtMaxK(settings.rpmAtMaxK);
+  s.bootMode = clampBootMode(static_cast<uint8_t>(settings.bootMode));
+  return s;
 }
 
-bool saveRuntimeSettings(const RuntimeSettings& settings) {
+template <typename T>
+bool putIfChanged(Preferences& prefs, const char* key, T next, T stored, uint8_t& written) {
+  if (next == stored) {
+    return true;
+  }
+  ++written;
+  return prefs.putUChar(key, static_cast<uint8_t>(next)) > 0;
+}
+
+// Writes the keys of `next` that differ from s_stored; s_stored follows whatever was written.
+bool writeChangedKeys(const RuntimeSettings& next) {
   Preferences prefs;
   if (!prefs.begin(SETTINGS_NAMESPACE, false)) {
     return false;
   }
-
-  const bool okDisplay = prefs.putString(KEY_DISPLAY_TYPE, displayTypeToString(settings.displayType)) > 0;
-  const uint8_t cells = settings.batterySeriesCells < 1 ? 1 : (settings.batterySeriesCells > 32 ? 32 : settings.batterySeriesCells);
-  const bool okCells = prefs.putUChar(KEY_BAT_CELLS, cells) > 0;
-  const bool okAuto = prefs.putUChar(KEY_AUTO_OFF, clampAutoOff(settings.autoOffMinutes)) > 0;
-  const bool okSleep = prefs.putUChar(KEY_SLEEP_TMR, clampSleepTimer(settings.sleepTimerMinutes)) > 0;
-  const bool okTemp = prefs.putUChar(KEY_TEMP_LIM, clampTempLim(settings.tempLimitC)) > 0;
-  const bool okStep = prefs.putUChar(KEY_SPD_STEP, clampSpeedStep(settings.speedStepPercent)) > 0;
-  const uint8_t minClamped = clampMinDuty(settings.minDutyPercent);
-  const bool okMin = prefs.putUChar(KEY_MIN_DUTY, minClamped) > 0;
-  const uint8_t maxClamped = clampMaxDutyPercent(settings.maxDutyPercent, minClamped);
-  const bool okMaxDuty = prefs.putUChar(KEY_MAX_DUTY, maxClamped) > 0;
-  const uint8_t md = static_cast<uint8_t>(clampMotorDisp(static_cast<uint8_t>(settings.motorDisplayMode)));
-  const bool okDisp = prefs.putUChar(KEY_MTR_DISP, md) > 0;
-  const uint8_t tm = static_cast<uint8_t>(clampTriggerMode(static_cast<uint8_t>(settings.triggerMode)));
-  const bool okTrigMode = prefs.putUChar(KEY_TRIG_MODE, tm) > 0;
-  const uint8_t li = static_cast<uint8_t>(clampLedIdle(static_cast<uint8_t>(settings.ledIdleDisplayMode)));
-  const bool okLedIdle = prefs.putUChar(KEY_LED_IDLE, li) > 0;
-  const uint8_t ld = static_cast<uint8_t>(clampLedDisp(static_cast<uint8_t>(settings.ledDisplayMode)));
-  const bool okLedDisp = prefs.putUChar(KEY_LED_DISP, ld) > 0;
-  const uint8_t dim = clampLedDimPercent(settings.ledDimPercent);
-  const bool okLedDim = prefs.putUChar(KEY_LED_DIM, dim) > 0;
-  const uint8_t dispContrast = clampDisplayContrastPercent(settings.displayContrastPercent);
-  const bool okDispContrast = prefs.putUChar(KEY_DISP_CONTRAST, dispContrast) > 0;
-  const uint8_t th = static_cast<uint8_t>(clampLedTheme(static_cast<uint8_t>(settings.ledTheme)));
-  const bool okLedTheme = prefs.putUChar(KEY_LED_THEME, th) > 0;
-  const uint8_t mt = static_cast<uint8_t>(clampMotorType(static_cast<uint8_t>(settings.motorType)));
-  const bool okMotorType = prefs.putUChar(KEY_MTR_TYPE, mt) > 0;
-  const bool ok = okDisplay && okCells && okAuto && okSleep && okTemp && okStep && okMin && okMaxDuty && okDisp &&
-                  okTrigMode && okLedIdle && okLedDisp && okLedDim && okDispContrast && okLedTheme && okMotorType;
+  const RuntimeSettings& old = s_stored;
+  uint8_t written = 0;
+  bool ok = true;
+  if (next.displayType != old.displayType) {
+    ++written;
+    ok = prefs.putString(KEY_DISPLAY_TYPE, displayTypeToString(next.displayType)) > 0 && ok;
+  }
+  ok = putIfChanged(prefs, KEY_BAT_CELLS, next.batterySeriesCells, old.batterySeriesCells, written) && ok;
+  ok = putIfChanged(prefs, KEY_AUTO_OFF, next.autoOffMinutes, old.autoOffMinutes, written) && ok;
+  ok = putIfChanged(prefs, KEY_SLEEP_TMR, next.sleepTimerMinutes, old.sleepTimerMinutes, written) && ok;
+  ok = putIfChanged(prefs, KEY_TEMP_LIM, next.tempLimitC, old.tempLimitC, written) && ok;
+  ok = putIfChanged(prefs, KEY_SPD_STEP, next.speedStepPercent, old.speedStepPercent, written) && ok;
+  ok = putIfChanged(prefs, KEY_MIN_DUTY, next.minDutyPercent, old.minDutyPercent, written) && ok;
+  ok = putIfChanged(prefs, KEY_MAX_DUTY, next.maxDutyPercent, old.maxDutyPercent, written) && ok;
+  ok = putIfChanged(prefs, KEY_MTR_DISP, next.motorDisplayMode, old.motorDisplayMode, written) && ok;
+  ok = putIfChanged(prefs, KEY_TRIG_MODE, next.triggerMode, old.triggerMode, written) && ok;
+  ok = putIfChanged(prefs, KEY_LED_IDLE, next.ledIdleDisplayMode, old.ledIdleDisplayMode, written) && ok;
+  ok = putIfChanged(prefs, KEY_LED_DISP, next.ledDisplayMode, old.ledDisplayMode, written) && ok;
+  ok = putIfChanged(prefs, KEY_LED_DIM, next.ledDimPercent, old.ledDimPercent, written) && ok;
+  ok = putIfChanged(prefs, KEY_DISP_CONTRAST, next.displayContrastPercent, old.displayContrastPercent, written) && ok;
+  ok = putIfChanged(prefs, KEY_LED_THEME, next.ledTheme, old.ledTheme, written) && ok;
+  ok = putIfChanged(prefs, KEY_MTR_TYPE, next.motorType, old.motorType, written) && ok;
+  ok = putIfChanged(prefs, KEY_TACH_PPR, next.tachPulsesPerRev, old.tachPulsesPerRev, written) && ok;
+  ok = putIfChanged(prefs, KEY_SPD_CTL, next.speedControl, old.speedControl, written) && ok;
+  ok = putIfChanged(prefs, KEY_RPM_MAX, next.rpmAtMaxK, old.rpmAtMaxK, written) && ok;
+  ok = putIfChanged(prefs, KEY_BOOT_MODE, next.bootMode, old.bootMode, written) && ok;
   prefs.end();
-  if (ok && s_changedCallback) {
-    s_changedCallback(settings);
+  if (ok) {
+    s_stored = next;
+    if (written > 0) {
+      Serial.printf("[Settings] Stored %u changed key(s)\n", static_cast<unsigned>(written));
+    }
+  } else {
+    Serial.println("[Settings] NVS write failed, will retry");
   }
   return ok;
 }
 
+// Takes the queued settings under the control lock and writes them without it; a failed write is
+// queued again unless a newer change already is.
+bool writeQueuedSettings() {
+  RuntimeSettings next;
+  {
+    ControlLockGuard lock;
+    if (!s_writeQueued) {
+      return true;
+    }
+    next = s_queued;
+    s_writeQueued = false;
+  }
+  if (writeChangedKeys(next)) {
+    return true;
+  }
+  ControlLockGuard lock;
+  if (!s_writeQueued) {
+    s_queued = next;
+    s_writeQueued = true;
+    s_queuedSinceMs = s_lastChangeMs = millis();
+  }
+  return false;
+}
+
+}  // namespace
+
+RuntimeSettings& loadRuntimeSettings() {
+  loadRuntimeSettingsFromNvs();
+  s_stored = storedForm(s_rt);
+  recordSettingsVersion(s_rt);
+  return s_rt;
+}
+
+RuntimeSettings& getRuntimeSettings() {
+  return s_rt;
+}
+
+bool saveRuntimeSettings(const RuntimeSettings& settings) {
+  const uint32_t now = millis();
+  if (!s_writeQueued) {
+    s_queuedSinceMs = now;
+  }
+  s_queued = storedForm(settings);
+  s_writeQueued = true;
+  s_lastChangeMs = now;
+  recordSettingsVersion(settings);
+  if (s_changedCallback) {
+    s_changedCallback(settings);
+  }
+  return true;
+}
+
+void updateSettingsStore() {
+  const uint32_t now = millis();
+  bool due = false;
+  {
+    ControlLockGuard lock;
+    due = s_writeQueued &&
+          (now - s_lastChangeMs >= kSettingsWriteQuietMs || now - s_queuedSinceMs >= kSettingsWriteMaxDelayMs);
+  }
+  if (due) {
+    writeQueuedSettings();
+  }
+}
+
+bool flushRuntimeSettings() {
+  return writeQueuedSettings();
+}
+
+bool runtimeSettingsWritePending() {
+  ControlLockGuard lock;
+  return s_writeQueued;
+}
+
 void setRuntimeSettingsChangedCallback(RuntimeSettingsChangedCallback callback) {
   s_changedCallback = callback;
 }
+
+uint32_t runtimeSettingsVersion() {
+  return s_version.load();
+}
+
+bool runtimeSettingsAtVersion(uint32_t version, RuntimeSettings& out) {
+  const uint32_t current = s_version.load();
+  if (version == 0 || version > current || current - version >= kSettingsHistoryDepth) {
+    return false;
+  }
+  out = s_history[version % kSettingsHistoryDepth];
+  return true;
+}
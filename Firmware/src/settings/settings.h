@@ -48,6 +48,18 @@ enum class LedTheme : uint8_t {
   Yellow = 6,
 };
 
+/** Generic PWM speed: open-loop duty, or a PI loop holding the RPM the speed % asks for. */
+enum class SpeedControlMode : uint8_t {
+  Duty = 0,
+  Rpm = 1,
+};
+
+/** Fast: setup() brings up controls, motor and cutoffs only; WiFi, BLE, web assets and display follow from the I/O task. */
+enum class BootMode : uint8_t {
+  Fast = 0,
+  Full = 1,
+};
+
 /** Motor control backend (NVS + dev menu). */
 enum class MotorType : uint8_t {
   GenericPwm = 0,
@@ -79,6 +91,13 @@ struct RuntimeSettings {
   uint8_t displayContrastPercent = 20;
   LedTheme ledTheme = LedTheme::White;
   MotorType motorType = MotorType::GenericPwm;
+  /** Tachometer FG pulses per motor revolution (1–12; generic PWM motors). */
+  uint8_t tachPulsesPerRev = 1;
+  SpeedControlMode speedControl = SpeedControlMode::Duty;
+  /** Constant-RPM target at speed 100 %, in thousands of RPM (5–120). */
+  uint8_t rpmAtMaxK = 30;
+  /** Takes effect at the next power-on. */
+  BootMode bootMode = BootMode::Fast;
 };
 
 typedef void (*RuntimeSettingsChangedCallback)(const RuntimeSettings& settings);
@@ -89,10 +108,32 @@ void initSettings();
 // Load persisted runtime settings into internal store and return reference.
 RuntimeSettings& loadRuntimeSettings();
 
-// Save full runtime settings to NVS.
+/**
+ * Publishes `settings` (new version, changed callback) and queues them for NVS. The write happens
+ * in updateSettingsStore() once no change came in for kSettingsWriteQuietMs, and covers only the
+ * keys that differ from what is stored. Callers hold the control lock.
+ */
 bool saveRuntimeSettings(const RuntimeSettings& settings);
 void setRuntimeSettingsChangedCallback(RuntimeSettingsChangedCallback callback);
 
+constexpr uint32_t kSettingsWriteQuietMs = 1000;
+constexpr uint32_t kSettingsWriteMaxDelayMs = 5000;  // a steady stream of changes still gets written
+
+/** I/O task: writes queued settings when they are due. Takes the control lock briefly. */
+void updateSettingsStore();
+/** Writes queued settings now (before a restart). Must not be called with the control lock held. */
+bool flushRuntimeSettings();
+/** True while a change is waiting for its NVS write. */
+bool runtimeSettingsWritePending();
+
+/** 1 after loadRuntimeSettings(), then bumped by every successful save. */
+uint32_t runtimeSettingsVersion();
+/**
+ * Settings as saved at `version` while it is among the last 8 versions (callers writing settings hold
+ * the control lock; hold it too when reading so the slot is not being overwritten).
+ */
+bool runtimeSettingsAtVersion(uint32_t version, RuntimeSettings& out);
+
 // Mutable live settings (populated by loadRuntimeSettings in setup).
 RuntimeSettings& getRuntimeSettings();
 
@@ -100,6 +141,12 @@ RuntimeSettings& getRuntimeSettings();
 DisplayType parseDisplayType(const char* value);
 const char* displayTypeToString(DisplayType type);
 
+/** Out-of-range speed-control values fall back to the default mode. */
+SpeedControlMode clampSpeedControl(uint8_t v);
+/** Full-scale RPM in thousands, 5–120; anything else falls back to the default. */
+uint8_t clampRpmAtMaxK(uint8_t v);
+/** Out-of-range boot modes fall back to the default mode. */
+BootMode clampBootMode(uint8_t v);
 /** Lowest allowed max-duty % for a given minimum duty (>= 50 and >= min+1). */
 uint8_t maxDutyPercentLowerBound(uint8_t minDutyPercent);
 /** Clamp max duty to 50–100 % and strictly above min duty. */
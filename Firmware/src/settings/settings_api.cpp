@@ -1,57 +1,80 @@
 #include "settings_api.h"
 
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "settings_schema.h"
 
 namespace {
 
-void writeSchema(JsonObject outSchema, const RuntimeSettings& rs) {
-  JsonArray entries = outSchema.createNestedArray("entries");
+struct DynamicEntryState {
+  bool visible;
+  bool hasRange;
+  uint8_t rangeMin;
+  uint8_t rangeMax;
+  char subline[48];
+
+  bool operator==(const DynamicEntryState& other) const {
+    return visible == other.visible && hasRange == other.hasRange && rangeMin == other.rangeMin &&
+           rangeMax == other.rangeMax && strcmp(subline, other.subline) == 0;
+  }
+};
+
+DynamicEntryState dynamicState(const SettingSchemaEntry& entry, const RuntimeSettings& rs) {
+  DynamicEntryState state = {};
+  state.visible = settingsGlobalVisibleForMotorType(entry.id, rs.motorType);
+  settingsFormatSubline(entry.id, rs, state.subline, sizeof(state.subline));
+  settingsGetAllowedRange(entry.id, rs, &state.rangeMin, &state.rangeMax, &state.hasRange);
+  return state;
+}
+
+void appendf(String& out, const char* format, ...) {
+  char buffer[96];
+  va_list args;
+  va_start(args, format);
+  const int n = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (n > 0) {
+    out.concat(buffer, static_cast<size_t>(n) < sizeof(buffer) ? static_cast<unsigned>(n) : sizeof(buffer) - 1);
+  }
+}
+
+void appendJsonString(String& out, const char* text) {
+  out += '"';
+  for (const char* p = text; *p != '\0'; ++p) {
+    if (*p == '"' || *p == '\\') {
+      out += '\\';
+    }
+    out += *p;
+  }
+  out += '"';
+}
+
+void appendValues(String& out, const RuntimeSettings& rs, const RuntimeSettings* before) {
+  out += '{';
+  bool first = true;
   for (size_t i = 0; i < settingsSchemaEntryCount(); ++i) {
     const SettingSchemaEntry* entry = settingsSchemaEntryAt(i);
-    if (!entry) {
+    const uint8_t value = settingsValue(entry->id, rs);
+    if (before != nullptr && settingsValue(entry->id, *before) == value) {
       continue;
     }
-    JsonObject j = entries.createNestedObject();
-    j["id"] = static_cast<uint8_t>(entry->id);
-    j["key"] = entry->key;
-    j["title"] = entry->title;
-    j["visible"] = settingsGlobalVisibleForMotorType(entry->id, rs.motorType);
-    j["def"] = settingsDefaultValue(entry->id);
-    if (entry->subline) {
-      j["subline"] = entry->subline;
-    }
-    char dynamicSubline[48];
-    settingsFormatSubline(entry->id, rs, dynamicSubline, sizeof(dynamicSubline));
-    if (dynamicSubline[0] != '\0') {
-      j["subline_dynamic"] = dynamicSubline;
-    }
+    appendf(out, "%s\"%s\":%u", first ? "" : ",", entry->key, static_cast<unsigned>(value));
+    first = false;
+  }
+  out += '}';
+}
 
-    size_t allowedCount = 0;
-    const uint8_t* allowed = settingsGetAllowedValues(entry->id, &allowedCount);
-    if (allowed && allowedCount > 0) {
-      JsonArray vals = j.createNestedArray("allowed_values");
-      for (size_t k = 0; k < allowedCount; ++k) {
-        vals.add(allowed[k]);
-      }
-    }
-    uint8_t rangeMin = 0;
-    uint8_t rangeMax = 0;
-    bool hasRange = false;
-    settingsGetAllowedRange(entry->id, rs, &rangeMin, &rangeMax, &hasRange);
-    if (hasRange) {
-      j["range_min"] = rangeMin;
-      j["range_max"] = rangeMax;
-    }
-    if (entry->enumOptions && entry->enumOptionCount > 0) {
-      JsonArray enums = j.createNestedArray("enum_options");
-      for (size_t e = 0; e < entry->enumOptionCount; ++e) {
-        JsonObject o = enums.createNestedObject();
-        o["value"] = entry->enumOptions[e].value;
-        o["label"] = entry->enumOptions[e].label;
-      }
-    }
+void appendDynamicFields(String& out, const DynamicEntryState& state) {
+  out += state.visible ? ",\"visible\":true" : ",\"visible\":false";
+  if (state.subline[0] != '\0') {
+    out += ",\"subline_dynamic\":";
+    appendJsonString(out, state.subline);
+  }
+  if (state.hasRange) {
+    appendf(out, ",\"range_min\":%u,\"range_max\":%u", state.rangeMin, state.rangeMax);
   }
 }
 
@@ -81,29 +104,54 @@ uint8_t parseNumeric(JsonVariantConst value, uint8_t fallback) {
 
 }  // namespace
 
-void settingsApiWriteValues(JsonObject outValues, const RuntimeSettings& rs) {
-  outValues["auto_off"] = rs.autoOffMinutes;
-  outValues["temp_lim"] = rs.tempLimitC;
-  outValues["spd_step"] = rs.speedStepPercent;
-  outValues["min_duty"] = rs.minDutyPercent;
-  outValues["max_duty"] = rs.maxDutyPercent;
-  outValues["bat_cells"] = rs.batterySeriesCells;
-  outValues["sleep_tmr"] = rs.sleepTimerMinutes;
-  outValues["trig_mode"] = static_cast<uint8_t>(rs.triggerMode);
-  outValues["mtr_disp"] = static_cast<uint8_t>(rs.motorDisplayMode);
-  outValues["led_idle"] = static_cast<uint8_t>(rs.ledIdleDisplayMode);
-  outValues["led_disp"] = static_cast<uint8_t>(rs.ledDisplayMode);
-  outValues["led_dim"] = rs.ledDimPercent;
-  outValues["disp_contrast"] = rs.displayContrastPercent;
-  outValues["led_theme"] = static_cast<uint8_t>(rs.ledTheme);
-  outValues["mtr_type"] = static_cast<uint8_t>(rs.motorType);
+void settingsApiBuildPayload(String& out, const RuntimeSettings& rs, uint32_t version, const char* extraMembers) {
+  out = "";
+  out.reserve(settingsSchemaStaticJsonSize() + 1024);
+  out += "{\"settings\":";
+  appendValues(out, rs, nullptr);
+  out += ",\"schema\":{\"entries\":[";
+  for (size_t i = 0; i < settingsSchemaEntryCount(); ++i) {
+    if (i > 0) {
+      out += ',';
+    }
+    size_t staticLen = 0;
+    const char* staticJson = settingsSchemaStaticJson(i, &staticLen);
+    out.concat(staticJson, static_cast<unsigned>(staticLen));
+    appendDynamicFields(out, dynamicState(*settingsSchemaEntryAt(i), rs));
+    out += '}';
+  }
+  appendf(out, "]},\"motor_type\":%u,\"version\":%lu", static_cast<unsigned>(rs.motorType),
+          static_cast<unsigned long>(version));
+  if (extraMembers != nullptr && extraMembers[0] != '\0') {
+    out += ',';
+    out += extraMembers;
+  }
+  out += '}';
 }
 
-void settingsApiWritePayload(JsonObject out) {
-  RuntimeSettings& rs = getRuntimeSettings();
-  settingsApiWriteValues(out.createNestedObject("settings"), rs);
-  writeSchema(out.createNestedObject("schema"), rs);
-  out["motor_type"] = static_cast<uint8_t>(rs.motorType);
+void settingsApiBuildDelta(String& out,
+                           const RuntimeSettings& before,
+                           uint32_t fromVersion,
+                           const RuntimeSettings& now,
+                           uint32_t version) {
+  out = "";
+  appendf(out, "{\"settings_delta\":{\"from\":%lu,\"version\":%lu,\"settings\":", static_cast<unsigned long>(fromVersion),
+          static_cast<unsigned long>(version));
+  appendValues(out, now, &before);
+  out += ",\"entries\":[";
+  bool first = true;
+  for (size_t i = 0; i < settingsSchemaEntryCount(); ++i) {
+    const SettingSchemaEntry* entry = settingsSchemaEntryAt(i);
+    const DynamicEntryState state = dynamicState(*entry, now);
+    if (state == dynamicState(*entry, before)) {
+      continue;
+    }
+    appendf(out, "%s{\"id\":%u", first ? "" : ",", static_cast<unsigned>(entry->id));
+    appendDynamicFields(out, state);
+    out += '}';
+    first = false;
+  }
+  appendf(out, "],\"motor_type\":%u}}", static_cast<unsigned>(now.motorType));
 }
 
 bool settingsApiApplySetting(RuntimeSettings& rs, const char* key, JsonVariantConst value) {
@@ -141,6 +189,14 @@ bool settingsApiApplySetting(RuntimeSettings& rs, const char* key, JsonVariantCo
     rs.ledTheme = static_cast<LedTheme>(parseNumeric(value, static_cast<uint8_t>(rs.ledTheme)));
   } else if (strcmp(key, "mtr_type") == 0) {
     rs.motorType = parseMotorType(parseNumeric(value, static_cast<uint8_t>(rs.motorType)));
+  } else if (strcmp(key, "tach_ppr") == 0) {
+    rs.tachPulsesPerRev = parseNumeric(value, rs.tachPulsesPerRev);
+  } else if (strcmp(key, "spd_ctl") == 0) {
+    rs.speedControl = clampSpeedControl(parseNumeric(value, static_cast<uint8_t>(rs.speedControl)));
+  } else if (strcmp(key, "rpm_max") == 0) {
+    rs.rpmAtMaxK = clampRpmAtMaxK(parseNumeric(value, rs.rpmAtMaxK));
+  } else if (strcmp(key, "boot_mode") == 0) {
+    rs.bootMode = clampBootMode(parseNumeric(value, static_cast<uint8_t>(rs.bootMode)));
   } else {
     return false;
   }
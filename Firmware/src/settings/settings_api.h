@@ -2,11 +2,26 @@
 #define SETTINGS_API_H
 
 #include <ArduinoJson.h>
+#include <WString.h>
 
 #include "settings.h"
 
-void settingsApiWritePayload(JsonObject out);
-void settingsApiWriteValues(JsonObject outValues, const RuntimeSettings& rs);
+/**
+ * get_settings payload: {"settings":{…},"schema":{"entries":[…]},"motor_type":n,"version":v,<extra>}.
+ * Static entry fields are copied from the flash schema; only visible, subline_dynamic and ranges are
+ * formatted here.
+ */
+void settingsApiBuildPayload(String& out, const RuntimeSettings& rs, uint32_t version, const char* extraMembers);
+
+/**
+ * {"settings_delta":{"from","version","settings":{changed keys},"entries":[{id + dynamic fields}],"motor_type"}}
+ * with the values and the entries whose dynamic fields differ between the two states.
+ */
+void settingsApiBuildDelta(String& out,
+                           const RuntimeSettings& before,
+                           uint32_t fromVersion,
+                           const RuntimeSettings& now,
+                           uint32_t version);
 bool settingsApiApplySetting(RuntimeSettings& rs, const char* key, JsonVariantConst value);
 
 #endif  // SETTINGS_API_H
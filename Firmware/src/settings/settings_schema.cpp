@@ -21,6 +21,10 @@ constexpr char KEY_LED_DIM[] = "led_dim";
 constexpr char KEY_DISP_CONTRAST[] = "disp_contrast";
 constexpr char KEY_LED_THEME[] = "led_theme";
 constexpr char KEY_MTR_TYPE[] = "mtr_type";
+constexpr char KEY_TACH_PPR[] = "tach_ppr";
+constexpr char KEY_SPD_CTL[] = "spd_ctl";
+constexpr char KEY_RPM_MAX[] = "rpm_max";
+constexpr char KEY_BOOT_MODE[] = "boot_mode";
 
 constexpr uint8_t kAutoOffValues[] = {0, 1, 2, 5, 10, 30};
 constexpr uint8_t kTempValues[] = {0, 30, 35, 40, 45, 50, 55, 60, 65, 70};
@@ -31,6 +35,8 @@ constexpr uint8_t kBatteryCellsValues[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12
 constexpr uint8_t kSleepValues[] = {1, 2, 5, 10, 30};
 constexpr uint8_t kLedDimValues[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 15, 20, 25, 30, 35, 40, 45, 50};
 constexpr uint8_t kDisplayContrastValues[] = {10, 20, 30, 40, 50, 60, 70, 80, 90, 100};
+constexpr uint8_t kTachPprValues[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+constexpr uint8_t kRpmMaxValues[] = {5, 10, 15, 20, 25, 30, 35, 40, 50, 60, 80, 100, 120};
 
 constexpr SettingEnumOption kTriggerOptions[] = {{static_cast<uint8_t>(TriggerMode::Hold), "Hold"},
                                                  {static_cast<uint8_t>(TriggerMode::DoublePress), "Double-Press"}};
@@ -54,24 +60,186 @@ constexpr SettingEnumOption kThemeOptions[] = {{static_cast<uint8_t>(LedTheme::O
                                                {static_cast<uint8_t>(LedTheme::Yellow), "Yellow"}};
 constexpr SettingEnumOption kMotorTypeOptions[] = {{static_cast<uint8_t>(MotorType::GenericPwm), "Generic (PWM)"},
                                                    {static_cast<uint8_t>(MotorType::XiaomiG), "Xiaomi G"}};
+constexpr SettingEnumOption kSpeedControlOptions[] = {{static_cast<uint8_t>(SpeedControlMode::Duty), "Duty"},
+                                                      {static_cast<uint8_t>(SpeedControlMode::Rpm), "Constant RPM"}};
+constexpr SettingEnumOption kBootModeOptions[] = {{static_cast<uint8_t>(BootMode::Fast), "Fast"},
+                                                  {static_cast<uint8_t>(BootMode::Full), "Full"}};
 
 constexpr SettingSchemaEntry kEntries[] = {
-    {DevSettingId::AutoOff, KEY_AUTO_OFF, "Auto-Off", "Motor Shutdown", nullptr, 0},
-    {DevSettingId::TempLimit, KEY_TEMP_LIM, "Temp. Shutdown", "Motor NTC", nullptr, 0},
-    {DevSettingId::SpeedStep, KEY_SPD_STEP, "Speed Steps", "Increase by ...", nullptr, 0},
-    {DevSettingId::MinDuty, KEY_MIN_DUTY, "Minimum Duty", "Motor PWM Floor", nullptr, 0},
-    {DevSettingId::MaxDuty, KEY_MAX_DUTY, "Maximum Duty", "@ speed 100%", nullptr, 0},
-    {DevSettingId::BatteryCells, KEY_BAT_CELLS, "Battery Cells", nullptr, nullptr, 0},
-    {DevSettingId::SleepTimer, KEY_SLEEP_TMR, "Sleep Timer", "UI + Controller", nullptr, 0},
-    {DevSettingId::TriggerMode, KEY_TRIG_MODE, "Trigger Mode", nullptr, kTriggerOptions, sizeof(kTriggerOptions) / sizeof(kTriggerOptions[0])},
-    {DevSettingId::MotorDisplayMode, KEY_MTR_DISP, "Live-Display", nullptr, kMotorDispOptions, sizeof(kMotorDispOptions) / sizeof(kMotorDispOptions[0])},
-    {DevSettingId::LedIdle, KEY_LED_IDLE, "LED (Idle)", nullptr, kLedIdleOptions, sizeof(kLedIdleOptions) / sizeof(kLedIdleOptions[0])},
-    {DevSettingId::LedDisplay, KEY_LED_DISP, "LED (Motor On)", nullptr, kLedDispOptions, sizeof(kLedDispOptions) / sizeof(kLedDispOptions[0])},
-    {DevSettingId::LedDim, KEY_LED_DIM, "Off-Led", "Brightness", nullptr, 0},
-    {DevSettingId::LedTheme, KEY_LED_THEME, "LED Theme", nullptr, kThemeOptions, sizeof(kThemeOptions) / sizeof(kThemeOptions[0])},
-    {DevSettingId::DisplayContrast, KEY_DISP_CONTRAST, "Display Brightness", "OLED Contrast", nullptr, 0},
-    {DevSettingId::MotorType, KEY_MTR_TYPE, "Motor Type", nullptr, kMotorTypeOptions, sizeof(kMotorTypeOptions) / sizeof(kMotorTypeOptions[0])},
+    {DevSettingId::AutoOff, KEY_AUTO_OFF, "Auto-Off", "Motor Shutdown", nullptr, 0, kAutoOffValues, sizeof(kAutoOffValues)},
+    {DevSettingId::TempLimit, KEY_TEMP_LIM, "Temp. Shutdown", "Motor NTC", nullptr, 0, kTempValues, sizeof(kTempValues)},
+    {DevSettingId::SpeedStep, KEY_SPD_STEP, "Speed Steps", "Increase by ...", nullptr, 0, kSpeedStepValues, sizeof(kSpeedStepValues)},
+    {DevSettingId::MinDuty, KEY_MIN_DUTY, "Minimum Duty", "Motor PWM Floor", nullptr, 0, kMinDutyValues, sizeof(kMinDutyValues)},
+    {DevSettingId::MaxDuty, KEY_MAX_DUTY, "Maximum Duty", "@ speed 100%", nullptr, 0, nullptr, 0},
+    {DevSettingId::BatteryCells, KEY_BAT_CELLS, "Battery Cells", nullptr, nullptr, 0, kBatteryCellsValues, sizeof(kBatteryCellsValues)},
+    {DevSettingId::SleepTimer, KEY_SLEEP_TMR, "Sleep Timer", "UI + Controller", nullptr, 0, kSleepValues, sizeof(kSleepValues)},
+    {DevSettingId::TriggerMode, KEY_TRIG_MODE, "Trigger Mode", nullptr, kTriggerOptions, sizeof(kTriggerOptions) / sizeof(kTriggerOptions[0]), nullptr, 0},
+    {DevSettingId::MotorDisplayMode, KEY_MTR_DISP, "Live-Display", nullptr, kMotorDispOptions, sizeof(kMotorDispOptions) / sizeof(kMotorDispOptions[0]), nullptr, 0},
+    {DevSettingId::LedIdle, KEY_LED_IDLE, "LED (Idle)", nullptr, kLedIdleOptions, sizeof(kLedIdleOptions) / sizeof(kLedIdleOptions[0]), nullptr, 0},
+    {DevSettingId::LedDisplay, KEY_LED_DISP, "LED (Motor On)", nullptr, kLedDispOptions, sizeof(kLedDispOptions) / sizeof(kLedDispOptions[0]), nullptr, 0},
+    {DevSettingId::LedDim, KEY_LED_DIM, "Off-Led", "Brightness", nullptr, 0, kLedDimValues, sizeof(kLedDimValues)},
+    {DevSettingId::LedTheme, KEY_LED_THEME, "LED Theme", nullptr, kThemeOptions, sizeof(kThemeOptions) / sizeof(kThemeOptions[0]), nullptr, 0},
+    {DevSettingId::DisplayContrast, KEY_DISP_CONTRAST, "Display Brightness", "OLED Contrast", nullptr, 0, kDisplayContrastValues, sizeof(kDisplayContrastValues)},
+    {DevSettingId::MotorType, KEY_MTR_TYPE, "Motor Type", nullptr, kMotorTypeOptions, sizeof(kMotorTypeOptions) / sizeof(kMotorTypeOptions[0]), nullptr, 0},
+    {DevSettingId::TachPulsesPerRev, KEY_TACH_PPR, "Tacho Pulses", "per Revolution", nullptr, 0, kTachPprValues, sizeof(kTachPprValues)},
+    {DevSettingId::SpeedControl, KEY_SPD_CTL, "Speed Control", nullptr, kSpeedControlOptions, sizeof(kSpeedControlOptions) / sizeof(kSpeedControlOptions[0]), nullptr, 0},
+    {DevSettingId::RpmAtMax, KEY_RPM_MAX, "Max RPM", "at 100% Speed", nullptr, 0, kRpmMaxValues, sizeof(kRpmMaxValues)},
+    {DevSettingId::BootMode, KEY_BOOT_MODE, "Boot Mode", nullptr, kBootModeOptions, sizeof(kBootModeOptions) / sizeof(kBootModeOptions[0]), nullptr, 0},
 };
+constexpr size_t kEntryCount = sizeof(kEntries) / sizeof(kEntries[0]);
+
+constexpr RuntimeSettings kDefaults{};
+
+constexpr uint8_t valueOf(DevSettingId id, const RuntimeSettings& rs) {
+  switch (id) {
+    case DevSettingId::AutoOff:
+      return rs.autoOffMinutes;
+    case DevSettingId::TempLimit:
+      return rs.tempLimitC;
+    case DevSettingId::SpeedStep:
+      return rs.speedStepPercent;
+    case DevSettingId::MinDuty:
+      return rs.minDutyPercent;
+    case DevSettingId::MaxDuty:
+      return rs.maxDutyPercent;
+    case DevSettingId::BatteryCells:
+      return rs.batterySeriesCells;
+    case DevSettingId::SleepTimer:
+      return rs.sleepTimerMinutes;
+    case DevSettingId::TriggerMode:
+      return static_cast<uint8_t>(rs.triggerMode);
+    case DevSettingId::MotorDisplayMode:
+      return static_cast<uint8_t>(rs.motorDisplayMode);
+    case DevSettingId::LedIdle:
+      return static_cast<uint8_t>(rs.ledIdleDisplayMode);
+    case DevSettingId::LedDisplay:
+      return static_cast<uint8_t>(rs.ledDisplayMode);
+    case DevSettingId::LedDim:
+      return rs.ledDimPercent;
+    case DevSettingId::DisplayContrast:
+      return rs.displayContrastPercent;
+    case DevSettingId::LedTheme:
+      return static_cast<uint8_t>(rs.ledTheme);
+    case DevSettingId::MotorType:
+      return static_cast<uint8_t>(rs.motorType);
+    case DevSettingId::TachPulsesPerRev:
+      return rs.tachPulsesPerRev;
+    case DevSettingId::SpeedControl:
+      return static_cast<uint8_t>(rs.speedControl);
+    case DevSettingId::RpmAtMax:
+      return rs.rpmAtMaxK;
+    case DevSettingId::BootMode:
+      return static_cast<uint8_t>(rs.bootMode);
+    default:
+      return 0;
+  }
+}
+
+// Compile-time JSON writer: with out == nullptr it only counts, so the same code sizes and fills the blob.
+struct ConstJsonWriter {
+  char* out;
+  size_t len;
+
+  constexpr void put(char c) {
+    if (out != nullptr) {
+      out[len] = c;
+    }
+    ++len;
+  }
+  constexpr void raw(const char* text) {
+    while (*text != '\0') {
+      put(*text++);
+    }
+  }
+  constexpr void string(const char* text) {
+    put('"');
+    for (; *text != '\0'; ++text) {
+      if (*text == '"' || *text == '\\') {
+        put('\\');
+      }
+      put(*text);
+    }
+    put('"');
+  }
+  constexpr void number(unsigned v) {
+    if (v >= 100) {
+      put(static_cast<char>('0' + v / 100));
+    }
+    if (v >= 10) {
+      put(static_cast<char>('0' + (v / 10) % 10));
+    }
+    put(static_cast<char>('0' + v % 10));
+  }
+};
+
+/** Static members of one schema entry in wire order, without the closing brace. */
+constexpr void writeStaticEntry(ConstJsonWriter& w, const SettingSchemaEntry& entry) {
+  w.raw("{\"id\":");
+  w.number(static_cast<uint8_t>(entry.id));
+  w.raw(",\"key\":");
+  w.string(entry.key);
+  w.raw(",\"title\":");
+  w.string(entry.title);
+  w.raw(",\"def\":");
+  w.number(valueOf(entry.id, kDefaults));
+  if (entry.subline != nullptr) {
+    w.raw(",\"subline\":");
+    w.string(entry.subline);
+  }
+  if (entry.allowedValueCount > 0) {
+    w.raw(",\"allowed_values\":[");
+    for (size_t i = 0; i < entry.allowedValueCount; ++i) {
+      if (i > 0) {
+        w.put(',');
+      }
+      w.number(entry.allowedValues[i]);
+    }
+    w.put(']');
+  }
+  if (entry.enumOptionCount > 0) {
+    w.raw(",\"enum_options\":[");
+    for (size_t i = 0; i < entry.enumOptionCount; ++i) {
+      w.raw(i > 0 ? ",{\"value\":" : "{\"value\":");
+      w.number(entry.enumOptions[i].value);
+      w.raw(",\"label\":");
+      w.string(entry.enumOptions[i].label);
+      w.put('}');
+    }
+    w.put(']');
+  }
+}
+
+constexpr size_t writeStaticSchema(char* out, uint16_t* offsets) {
+  ConstJsonWriter w{out, 0};
+  for (size_t i = 0; i < kEntryCount; ++i) {
+    if (offsets != nullptr) {
+      offsets[i] = static_cast<uint16_t>(w.len);
+    }
+    writeStaticEntry(w, kEntries[i]);
+  }
+  if (offsets != nullptr) {
+    offsets[kEntryCount] = static_cast<uint16_t>(w.len);
+  }
+  return w.len;
+}
+
+constexpr size_t kStaticSchemaSize = writeStaticSchema(nullptr, nullptr);
+static_assert(kStaticSchemaSize < 65536, "schema offsets are 16-bit");
+
+struct StaticSchema {
+  char text[kStaticSchemaSize + 1];
+  uint16_t offsets[kEntryCount + 1];
+};
+
+constexpr StaticSchema buildStaticSchema() {
+  StaticSchema schema{};
+  writeStaticSchema(schema.text, schema.offsets);
+  return schema;
+}
+
+// Evaluated by the compiler; lives in .rodata (flash on the ESP32) and is never built at runtime.
+constexpr StaticSchema kStaticSchema = buildStaticSchema();
+
 
 void cycleInList(uint8_t& v, const uint8_t* list, size_t n) {
   for (size_t i = 0; i < n; ++i) {
@@ -87,7 +255,7 @@ void cycleInList(uint8_t& v, const uint8_t* list, size_t n) {
 
 const SettingSchemaEntry* settingsSchemaById(DevSettingId id) {
   const size_t idx = static_cast<size_t>(id);
-  if (idx >= sizeof(kEntries) / sizeof(kEntries[0])) {
+  if (idx >= kEntryCount) {
     return nullptr;
   }
   return &kEntries[idx];
@@ -97,7 +265,7 @@ const SettingSchemaEntry* settingsSchemaByKey(const char* key) {
   if (!key || key[0] == '\0') {
     return nullptr;
   }
-  for (size_t i = 0; i < sizeof(kEntries) / sizeof(kEntries[0]); ++i) {
+  for (size_t i = 0; i < kEntryCount; ++i) {
     if (strcmp(key, kEntries[i].key) == 0) {
       return &kEntries[i];
     }
@@ -106,7 +274,7 @@ const SettingSchemaEntry* settingsSchemaByKey(const char* key) {
 }
 
 size_t settingsSchemaEntryCount() {
-  return sizeof(kEntries) / sizeof(kEntries[0]);
+  return kEntryCount;
 }
 
 const SettingSchemaEntry* settingsSchemaEntryAt(size_t idx) {
@@ -116,42 +284,25 @@ const SettingSchemaEntry* settingsSchemaEntryAt(size_t idx) {
   return &kEntries[idx];
 }
 
+uint8_t settingsValue(DevSettingId id, const RuntimeSettings& rs) {
+  return valueOf(id, rs);
+}
+
 uint8_t settingsDefaultValue(DevSettingId id) {
-  static const RuntimeSettings d{};
-  switch (id) {
-    case DevSettingId::AutoOff:
-      return d.autoOffMinutes;
-    case DevSettingId::TempLimit:
-      return d.tempLimitC;
-    case DevSettingId::SpeedStep:
-      return d.speedStepPercent;
-    case DevSettingId::MinDuty:
-      return d.minDutyPercent;
-    case DevSettingId::MaxDuty:
-      return d.maxDutyPercent;
-    case DevSettingId::BatteryCells:
-      return d.batterySeriesCells;
-    case DevSettingId::SleepTimer:
-      return d.sleepTimerMinutes;
-    case DevSettingId::TriggerMode:
-      return static_cast<uint8_t>(d.triggerMode);
-    case DevSettingId::MotorDisplayMode:
-      return static_cast<uint8_t>(d.motorDisplayMode);
-    case DevSettingId::LedIdle:
-      return static_cast<uint8_t>(d.ledIdleDisplayMode);
-    case DevSettingId::LedDisplay:
-      return static_cast<uint8_t>(d.ledDisplayMode);
-    case DevSettingId::LedDim:
-      return d.ledDimPercent;
-    case DevSettingId::DisplayContrast:
-      return d.displayContrastPercent;
-    case DevSettingId::LedTheme:
-      return static_cast<uint8_t>(d.ledTheme);
-    case DevSettingId::MotorType:
-      return static_cast<uint8_t>(d.motorType);
-    default:
-      return 0;
+  return valueOf(id, kDefaults);
+}
+
+const char* settingsSchemaStaticJson(size_t idx, size_t* outLen) {
+  if (idx >= kEntryCount) {
+    if (outLen) *outLen = 0;
+    return nullptr;
   }
+  if (outLen) *outLen = kStaticSchema.offsets[idx + 1] - kStaticSchema.offsets[idx];
+  return kStaticSchema.text + kStaticSchema.offsets[idx];
+}
+
+size_t settingsSchemaStaticJsonSize() {
+  return kStaticSchemaSize;
 }
 
 void settingsFormatValue(DevSettingId id, const RuntimeSettings& rs, char* out, size_t n) {
@@ -201,6 +352,18 @@ void settingsFormatValue(DevSettingId id, const RuntimeSettings& rs, char* out,
     case DevSettingId::MotorType:
       snprintf(out, n, "%u", static_cast<unsigned>(rs.motorType) + 1U);
       break;
+    case DevSettingId::TachPulsesPerRev:
+      snprintf(out, n, "%u", static_cast<unsigned>(rs.tachPulsesPerRev));
+      break;
+    case DevSettingId::SpeedControl:
+      snprintf(out, n, "%u", static_cast<unsigned>(rs.speedControl) + 1U);
+      break;
+    case DevSettingId::RpmAtMax:
+      snprintf(out, n, "%uk", static_cast<unsigned>(rs.rpmAtMaxK));
+      break;
+    case DevSettingId::BootMode:
+      snprintf(out, n, "%u", static_cast<unsigned>(rs.bootMode) + 1U);
+      break;
     default:
       snprintf(out, n, "-");
       break;
@@ -230,6 +393,12 @@ void settingsFormatSubline(DevSettingId id, const RuntimeSettings& rs, char* out
     case DevSettingId::MotorType:
       snprintf(out, n, "%s", motorTypeDisplayName(rs.motorType));
       break;
+    case DevSettingId::SpeedControl:
+      snprintf(out, n, "%s", kSpeedControlOptions[static_cast<uint8_t>(rs.speedControl)].label);
+      break;
+    case DevSettingId::BootMode:
+      snprintf(out, n, "%s", kBootModeOptions[static_cast<uint8_t>(rs.bootMode)].label);
+      break;
     default:
       out[0] = '\0';
       break;
@@ -292,6 +461,18 @@ void settingsCycleGlobalValue(RuntimeSettings& rs, DevSettingId id) {
     case DevSettingId::MotorType:
       rs.motorType = rs.motorType == MotorType::GenericPwm ? MotorType::XiaomiG : MotorType::GenericPwm;
       break;
+    case DevSettingId::TachPulsesPerRev:
+      cycleInList(rs.tachPulsesPerRev, kTachPprValues, sizeof(kTachPprValues));
+      break;
+    case DevSettingId::SpeedControl:
+      rs.speedControl = rs.speedControl == SpeedControlMode::Duty ? SpeedControlMode::Rpm : SpeedControlMode::Duty;
+      break;
+    case DevSettingId::RpmAtMax:
+      cycleInList(rs.rpmAtMaxK, kRpmMaxValues, sizeof(kRpmMaxValues));
+      break;
+    case DevSettingId::BootMode:
+      rs.bootMode = rs.bootMode == BootMode::Fast ? BootMode::Full : BootMode::Fast;
+      break;
     default:
       break;
   }
@@ -299,7 +480,8 @@ void settingsCycleGlobalValue(RuntimeSettings& rs, DevSettingId id) {
 
 bool settingsGlobalVisibleForMotorType(DevSettingId id, MotorType type) {
   if (type == MotorType::XiaomiG) {
-    return id != DevSettingId::SpeedStep && id != DevSettingId::MinDuty && id != DevSettingId::MaxDuty;
+    return id != DevSettingId::SpeedStep && id != DevSettingId::MinDuty && id != DevSettingId::MaxDuty &&
+           id != DevSettingId::TachPulsesPerRev && id != DevSettingId::SpeedControl && id != DevSettingId::RpmAtMax;
   }
   return true;
 }
@@ -320,35 +502,9 @@ void settingsGetAllowedRange(DevSettingId id, const RuntimeSettings& rs, uint8_t
 }
 
 const uint8_t* settingsGetAllowedValues(DevSettingId id, size_t* outCount) {
+  const SettingSchemaEntry* entry = settingsSchemaById(id);
   if (outCount) {
-    *outCount = 0;
-  }
-  switch (id) {
-    case DevSettingId::AutoOff:
-      if (outCount) *outCount = sizeof(kAutoOffValues);
-      return kAutoOffValues;
-    case DevSettingId::TempLimit:
-      if (outCount) *outCount = sizeof(kTempValues);
-      return kTempValues;
-    case DevSettingId::SpeedStep:
-      if (outCount) *outCount = sizeof(kSpeedStepValues);
-      return kSpeedStepValues;
-    case DevSettingId::MinDuty:
-      if (outCount) *outCount = sizeof(kMinDutyValues);
-      return kMinDutyValues;
-    case DevSettingId::BatteryCells:
-      if (outCount) *outCount = sizeof(kBatteryCellsValues);
-      return kBatteryCellsValues;
-    case DevSettingId::SleepTimer:
-      if (outCount) *outCount = sizeof(kSleepValues);
-      return kSleepValues;
-    case DevSettingId::LedDim:
-      if (outCount) *outCount = sizeof(kLedDimValues);
-      return kLedDimValues;
-    case DevSettingId::DisplayContrast:
-      if (outCount) *outCount = sizeof(kDisplayContrastValues);
-      return kDisplayContrastValues;
-    default:
-      return nullptr;
+    *outCount = entry ? entry->allowedValueCount : 0;
   }
+  return entry && entry->allowedValueCount > 0 ? entry->allowedValues : nullptr;
 }
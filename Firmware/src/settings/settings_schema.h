@@ -19,6 +19,8 @@ struct SettingSchemaEntry {
   const char* subline;
   const SettingEnumOption* enumOptions;
   size_t enumOptionCount;
+  const uint8_t* allowedValues;
+  size_t allowedValueCount;
 };
 
 const SettingSchemaEntry* settingsSchemaById(DevSettingId id);
@@ -26,6 +28,17 @@ const SettingSchemaEntry* settingsSchemaByKey(const char* key);
 size_t settingsSchemaEntryCount();
 const SettingSchemaEntry* settingsSchemaEntryAt(size_t idx);
 
+/**
+ * Static JSON of schema entry `idx` (id, key, title, def, subline, allowed_values, enum_options),
+ * rendered at compile time into flash and left open (no closing brace) for the dynamic fields.
+ */
+const char* settingsSchemaStaticJson(size_t idx, size_t* outLen);
+/** Total size of the static schema text, for sizing payload buffers. */
+size_t settingsSchemaStaticJsonSize();
+
+/** Current wire value of a setting (the `settings` object value for its key). */
+uint8_t settingsValue(DevSettingId id, const RuntimeSettings& rs);
+
 /** Factory-default value for a setting (from a default-constructed store). */
 uint8_t settingsDefaultValue(DevSettingId id);
 
@@ -0,0 +1,996 @@
+// Virtual-time cutoff simulator (env:native-sim). Boots the real firmware on the host HAL in a
+// forked process per scenario (threads do not survive fork(), so each child boots its own control
+// and I/O tasks), replays the scenario's sensor traces and reports when auto-off / thermal-stop / undervoltage-stop fired versus when the trace crossed
+// the limit, plus loop iterations per simulated second. --boot times a single power-on instead,
+// --sessions exercises the run recorder and --stats the load statistics.
+#if defined(OSHVAC_SIM)
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#define OSHVAC_SIM_FORK 1
+#endif
+
+#include "native_hal.h"
+#include "sim_scenario.h"
+#include "../button/button.h"
+#include "../adc_sampler/adc_sampler.h"
+#include "../battery/battery.h"
+#include "../boot_profiler/boot_profiler.h"
+#include "../control_tasks/control_tasks.h"
+#include "../crc32/crc32.h"
+#include "../maximum_stats/maximum_stats.h"
+#include "../session_log/session_log.h"
+#include "../settings/settings.h"
+#include "../settings/settings_config.h"
+#include "../wifi/wifi.h"
+
+extern AsyncWebSocket webSocket;
+
+namespace {
+
+// Plant wiring; mirrors adc_sampler.cpp, temperature.cpp, battery.cpp and tachometer.cpp.
+constexpr uint8_t kThermPin = 4;
+constexpr uint8_t kVbatPin = 6;
+constexpr uint8_t kFgPin = 16;
+constexpr float kAdcFullScaleMv = 3100.0f;
+constexpr float kNtcSeriesR = 10000.0f;
+constexpr float kNtcR0 = 10000.0f;
+constexpr float kNtcT0K = 298.15f;
+constexpr float kNtcBeta = 3950.0f;
+constexpr float kVbatScale = 16.0f;
+// The ADC reads low the way battery.cpp's calibration points (12.000 V -> 11.640 V,
+// 36.000 V -> 35.280 V) say, so the firmware's calibrated value equals the trace value.
+constexpr float kVbatCalSlope = (36.0f - 12.0f) / (35.28f - 11.64f);
+constexpr float kVbatCalOffset = 12.0f - kVbatCalSlope * 11.64f;
+
+constexpr float kAmbientC = 25.0f;
+constexpr float kNominalCellV = 3.9f;
+constexpr uint32_t kBootSettleMs = 3000;  // STA association + WebSocket client attach
+constexpr uint32_t kTailMs = 500;         // keep running after a stop to catch the notify frame
+constexpr uint32_t kWindowMs = 1000;
+// --boot: the trigger goes down this long after power-on and stays held; controls must be live
+// within kBootLiveBudgetMs in fast-boot mode and the motor must start within kBootStartSlackMs of
+// the hold-to-start time, counted from the press or from setup() returning, whichever is later.
+constexpr uint32_t kBootPressMs = 100;
+constexpr uint32_t kBootLiveBudgetMs = 200;
+constexpr uint32_t kBootStartSlackMs = 50;
+constexpr uint32_t kBootRunMs = 15000;
+// --sessions: enough short runs to wrap the ring, then one long remote run and one thermal stop.
+constexpr uint32_t kSessionShortRuns = kSessionLogCapacity + 8;
+constexpr uint32_t kSessionLongRunMs = 3000;
+constexpr float kSessionLongRunRpm = 50000.0f;
+constexpr float kSessionHotC = 70.0f;
+// --stats: a cool run at 60 % and a hot, sagging run at 100 %.
+constexpr uint32_t kStatsCoolRunMs = 3000;
+constexpr uint32_t kStatsHotRunMs = 2000;
+constexpr uint64_t kStatsLifetimeQuietUs = 31000000;  // maximum_stats writes the lifetime set after 30 s off
+constexpr float kStatsCoolRpm = 50000.0f;
+constexpr float kStatsHotRpm = 80000.0f;
+// --adc: ripple and noise on the battery and NTC pins, as the motor's PWM current puts there.
+constexpr uint32_t kAdcRippleMv = 80;
+constexpr float kAdcRippleHz = 130.0f;
+constexpr uint32_t kAdcNoiseMv = 20;
+constexpr uint64_t kAdcProbeUs = 2000000;
+constexpr float kStatsHotC = 67.0f;
+constexpr float kStatsSagCellV = 3.2f;
+
+enum class Cause : uint8_t { None, AutoOff, Thermal, Undervoltage, Unknown };
+
+const char* causeName(Cause c) {
+  switch (c) {
+    case Cause::AutoOff:
+      return "auto_off";
+    case Cause::Thermal:
+      return "thermal_stop";
+    case Cause::Undervoltage:
+      return "undervoltage_stop";
+    case Cause::Unknown:
+      return "unknown";
+    default:
+      return "none";
+  }
+}
+
+Cause causeFromName(const char* name) {
+  if (strcmp(name, "auto_off") == 0) return Cause::AutoOff;
+  if (strcmp(name, "thermal_stop") == 0) return Cause::Thermal;
+  if (strcmp(name, "undervoltage_stop") == 0) return Cause::Undervoltage;
+  return Cause::None;
+}
+
+/** Fixed-size record a forked scenario writes back to the parent (well under PIPE_BUF). */
+struct SimResult {
+  uint32_t index;
+  Cause expected;
+  Cause fired;
+  bool phaseDependent;
+  uint32_t onsetMs;
+  uint32_t firedMs;
+  uint32_t startedMs;
+  uint32_t simulatedMs;
+  float loopsPerSecMean;
+  float loopsPerSecMin;
+  float loopsPerSecMax;
+};
+
+struct SimRun {
+  const SimScenario* scenario;
+  uint64_t baseUs;
+  int client;
+  bool settingsSent;
+  bool motorCommandsSent;
+  bool wasActive;
+  bool stopped;
+  uint32_t stopMs;
+  uint32_t startedMs;
+  uint64_t windowStartLoops;
+  uint32_t windowStartMs;
+  uint32_t windows;
+  double loopsSum;
+  float loopsMin;
+  float loopsMax;
+  uint8_t cells;
+};
+
+uint32_t ntcMillivolts(float celsius) {
+  const float tK = celsius + 273.15f;
+  const float rth = kNtcR0 * expf(kNtcBeta * (1.0f / tK - 1.0f / kNtcT0K));
+  return static_cast<uint32_t>(lroundf(kAdcFullScaleMv * kNtcSeriesR / (rth + kNtcSeriesR)));
+}
+
+uint32_t vbatMillivolts(float packV) {
+  const float vmeas = (packV - kVbatCalOffset) / kVbatCalSlope;
+  const float mv = vmeas / kVbatScale * 1000.0f;
+  return mv > 0.0f ? static_cast<uint32_t>(lroundf(mv)) : 0;
+}
+
+void applyPlant(const SimScenario* s, uint32_t tMs, uint8_t cells) {
+  const float healthyPackV = kNominalCellV * static_cast<float>(cells);
+  nativeHalSetAnalogMillivolts(kThermPin, ntcMillivolts(s ? s->tempC.at(tMs, kAmbientC) : kAmbientC));
+  nativeHalSetAnalogMillivolts(kVbatPin, vbatMillivolts(s ? s->packV.at(tMs, healthyPackV) : healthyPackV));
+  nativeHalSetPulseFrequency(kFgPin, (s ? s->rpm.at(tMs, 0.0f) : 0.0f) / 60.0f * getRuntimeSettings().tachPulsesPerRev);
+  if (s && !s->dieTempC.empty()) {
+    nativeHalSetDieTemperatureC(s->dieTempC.at(tMs, 40.0f));
+  }
+}
+
+/** I/O-side iterations: the "io" task when the control task is split off, loop() otherwise. */
+uint64_t loopIterations() {
+  return controlTasksRunning() ? nativeHalTaskIterations("io") : nativeHalLoopIterations();
+}
+
+void closeWindow(SimRun& run, uint32_t tMs) {
+  const uint64_t loops = loopIterations();
+  const float perSec = static_cast<float>(loops - run.windowStartLoops) * 1000.0f /
+                       static_cast<float>(tMs - run.windowStartMs);
+  run.loopsSum += perSec;
+  run.loopsMin = run.windows == 0 ? perSec : fminf(run.loopsMin, perSec);
+  run.loopsMax = run.windows == 0 ? perSec : fmaxf(run.loopsMax, perSec);
+  run.windows++;
+  run.windowStartLoops = loops;
+  run.windowStartMs = tMs;
+}
+
+void onTick(uint64_t nowUs, void* ctx) {
+  SimRun& run = *static_cast<SimRun*>(ctx);
+  const SimScenario& s = *run.scenario;
+  const uint32_t tMs = static_cast<uint32_t>((nowUs - run.baseUs) / 1000ULL);
+
+  applyPlant(&s, tMs, run.cells);
+
+  if (!run.settingsSent) {
+    std::string cmd = "{\"command\":\"set_settings\",\"values\":{";
+    for (size_t i = 0; i < s.settings.size(); ++i) {
+      cmd += (i ? ",\"" : "\"") + s.settings[i].first + "\":" + std::to_string(s.settings[i].second);
+    }
+    cmd += "}}";
+    webSocket.hostSendText(static_cast<uint8_t>(run.client), cmd);
+    run.settingsSent = true;
+  }
+  if (!run.motorCommandsSent && tMs >= s.motorStartMs) {
+    webSocket.hostSendText(static_cast<uint8_t>(run.client), "{\"speed\":" + std::to_string(s.speedPercent) + "}");
+    webSocket.hostSendText(static_cast<uint8_t>(run.client), "{\"command\":\"motor_start\"}");
+    run.motorCommandsSent = true;
+  }
+
+  // State as the previous loop() left it; the MOSFET edge dates the switch within that loop,
+  // ahead of whatever the rest of the iteration (display push, notify) cost.
+  const bool active = isMotorActive();
+  const uint32_t edgeMs = static_cast<uint32_t>((nativeHalDigitalOutputChangedUs(MOSFET_PIN) - run.baseUs) / 1000ULL);
+  if (active && !run.wasActive && run.startedMs == 0) {
+    run.startedMs = edgeMs;
+  }
+  if (!active && run.wasActive && !run.stopped) {
+    run.stopped = true;
+    run.stopMs = edgeMs;
+  }
+  run.wasActive = active;
+
+  if (tMs - run.windowStartMs >= kWindowMs) {
+    closeWindow(run, tMs);
+  }
+}
+
+Cause causeFromFrames(uint8_t client) {
+  for (const auto& frame : webSocket.hostReceived(client)) {
+    const size_t at = frame.data.find("\"notify\"");
+    if (at == std::string::npos) {
+      continue;
+    }
+    const size_t id = frame.data.find("\"id\":\"", at);
+    if (id == std::string::npos) {
+      continue;
+    }
+    const size_t begin = id + 6;
+    const size_t end = frame.data.find('"', begin);
+    const Cause c = causeFromName(frame.data.substr(begin, end - begin).c_str());
+    if (c != Cause::None) {
+      return c;
+    }
+  }
+  return Cause::Unknown;
+}
+
+SimResult runScenario(const SimScenario& s, uint32_t index, int client) {
+  const RuntimeSettings& rs = getRuntimeSettings();
+  const uint8_t cells = static_cast<uint8_t>(simScenarioSetting(s, "bat_cells", rs.batterySeriesCells));
+  const SimExpectation expect = simExpectedCutoff(
+      s, static_cast<uint8_t>(simScenarioSetting(s, "temp_lim", rs.tempLimitC)), cells,
+      static_cast<uint8_t>(simScenarioSetting(s, "auto_off", rs.autoOffMinutes)),
+      SettingsConfig::DEFAULT_MIN_CELL_VOLTAGE_CUTOFF);
+
+  SimRun run = {};
+  run.scenario = &s;
+  run.baseUs = nativeHalNowUs();
+  run.client = client;
+  run.cells = cells;
+  run.windowStartLoops = loopIterations();
+  webSocket.hostReceived(static_cast<uint8_t>(client)).clear();
+  nativeHalSetTickHook(onTick, &run);
+
+  const uint64_t stepUs = 50000;
+  while (!nativeHalRestartRequested()) {
+    const uint32_t tMs = static_cast<uint32_t>((nativeHalNowUs() - run.baseUs) / 1000ULL);
+    if (tMs >= s.durationMs || (run.stopped && tMs >= run.stopMs + kTailMs)) {
+      break;
+    }
+    nativeHalRunFor(stepUs);
+  }
+  nativeHalSetTickHook(nullptr, nullptr);
+
+  SimResult r = {};
+  r.index = index;
+  r.expected = causeFromName(expect.cause);
+  r.phaseDependent = expect.phaseDependent;
+  r.onsetMs = expect.onsetMs;
+  if (r.expected == Cause::AutoOff && run.startedMs != 0) {
+    // The run timer starts when the firmware switched the motor on, not when the command was sent.
+    r.onsetMs = run.startedMs + (expect.onsetMs - s.motorStartMs);
+  }
+  r.fired = run.stopped ? causeFromFrames(static_cast<uint8_t>(client)) : Cause::None;
+  r.firedMs = run.stopMs;
+  r.startedMs = run.startedMs;
+  r.simulatedMs = static_cast<uint32_t>((nativeHalNowUs() - run.baseUs) / 1000ULL);
+  r.loopsPerSecMean = run.windows ? static_cast<float>(run.loopsSum / run.windows) : 0.0f;
+  r.loopsPerSecMin = run.loopsMin;
+  r.loopsPerSecMax = run.loopsMax;
+  return r;
+}
+
+/** Boots with a healthy plant and connects one WebSocket client; returns its id or -1. */
+int bootFirmware() {
+  applyPlant(nullptr, 0, getRuntimeSettings().batterySeriesCells);
+  setup();
+  applyPlant(nullptr, 0, getRuntimeSettings().batterySeriesCells);
+  nativeHalRunFor(static_cast<uint64_t>(kBootSettleMs) * 1000ULL);
+  const int client = webSocket.hostConnect();
+  nativeHalRunFor(100000);
+  if (client < 0 || !webSocket.hostRunning()) {
+    fprintf(stderr, "[sim] WebSocket server not reachable after boot\n");
+    return -1;
+  }
+  return client;
+}
+
+struct BootProbe {
+  uint64_t motorOnUs;
+  uint64_t wifiReadyUs;
+  uint64_t serverUpUs;
+};
+
+void onBootTick(uint64_t nowUs, void* ctx) {
+  BootProbe& probe = *static_cast<BootProbe*>(ctx);
+  if (probe.motorOnUs == 0 && nativeHalGetDigitalOutput(MOSFET_PIN) == HIGH) {
+    probe.motorOnUs = nativeHalDigitalOutputChangedUs(MOSFET_PIN);
+  }
+  if (probe.wifiReadyUs == 0 && getWiFiBringUpState() == WiFiBringUpState::Ready) {
+    probe.wifiReadyUs = nowUs;
+  }
+  if (probe.serverUpUs == 0 && webSocket.hostRunning()) {
+    probe.serverUpUs = nowUs;
+  }
+}
+
+void printBootMs(const char* what, uint64_t us) {
+  if (us == 0) {
+    printf("[boot] %-22s never\n", what);
+  } else {
+    printf("[boot] %-22s @%6.1f ms\n", what, static_cast<double>(us) / 1000.0);
+  }
+}
+
+/**
+ * Powers on with the trigger pressed kBootPressMs later and held, and times setup(), the first
+ * motor start and the network coming up. staConnects=false never answers the STA join, so the
+ * firmware has to fall back to its soft AP; fullBoot stores boot_mode=Full first.
+ */
+int runBootProbe(bool staConnects, bool fullBoot) {
+  if (fullBoot) {
+    Preferences prefs;
+    prefs.begin("oshvac", false);
+    prefs.putUChar("boot_mode", static_cast<uint8_t>(BootMode::Full));
+    prefs.end();
+  }
+  WiFi.hostSetStaBehaviour(staConnects ? 1500 : -1);
+  nativeHalSetDigitalInputAt(TRIGGER_PIN, LOW, static_cast<uint64_t>(kBootPressMs) * 1000ULL);
+  applyPlant(nullptr, 0, getRuntimeSettings().batterySeriesCells);
+  setup();
+  const uint64_t setupUs = nativeHalNowUs();
+  BootProbe probe = {};
+  nativeHalSetTickHook(onBootTick, &probe);
+  nativeHalRunFor(static_cast<uint64_t>(kBootRunMs) * 1000ULL - setupUs);
+  nativeHalSetTickHook(nullptr, nullptr);
+
+  const uint32_t holdMs = getRuntimeSettings().triggerMode == TriggerMode::Hold ? TRIGGER_START_HOLD_MS : 0;
+  printf("[boot] %s boot, STA %s, trigger held from %u ms (hold-to-start %u ms)\n", fullBoot ? "full" : "fast",
+         staConnects ? "joins after 1500 ms" : "never joins", static_cast<unsigned>(kBootPressMs),
+         static_cast<unsigned>(holdMs));
+  for (size_t i = 0; i < kBootStageCount; ++i) {
+    const BootStageRecord r = bootProfilerStage(static_cast<BootStage>(i));
+    if (r.done) {
+      printf("[boot]   %-10s @%7.1f ms %7.1f ms%s\n", r.name, r.startUs / 1000.0, r.us / 1000.0,
+             r.deferred ? "  (deferred)" : "");
+    }
+  }
+  printBootMs("setup() returned", setupUs);
+  printBootMs("first motor start", probe.motorOnUs);
+  printBootMs("WiFi ready", probe.wifiReadyUs);
+  printBootMs("WebSocket server up", probe.serverUpUs);
+
+  const bool liveOk = fullBoot || setupUs <= static_cast<uint64_t>(kBootLiveBudgetMs) * 1000ULL;
+  const uint64_t pressUs = static_cast<uint64_t>(kBootPressMs) * 1000ULL;
+  const uint64_t startDeadlineUs =
+      (setupUs > pressUs ? setupUs : pressUs) + static_cast<uint64_t>(holdMs + kBootStartSlackMs) * 1000ULL;
+  const bool startOk = probe.motorOnUs != 0 && probe.motorOnUs <= startDeadlineUs;
+  if (probe.motorOnUs != 0) {
+    printf("[boot] trigger to motor  %6.1f ms (%.1f ms beyond hold-to-start)\n",
+           static_cast<double>(probe.motorOnUs) / 1000.0 - kBootPressMs,
+           static_cast<double>(probe.motorOnUs) / 1000.0 - kBootPressMs - holdMs);
+  }
+  printf("[boot] %s\n", liveOk && startOk && probe.serverUpUs != 0 ? "ok" : "FAILED");
+  return liveOk && startOk && probe.serverUpUs != 0 ? 0 : 1;
+}
+
+void sendCommand(int client, const std::string& json) {
+  webSocket.hostSendText(static_cast<uint8_t>(client), json);
+}
+
+/** Runs the motor from remote commands; returns the simulated run time until it was seen stopped. */
+uint32_t remoteRun(int client, uint32_t maxMs, bool stopAtEnd, void (*plant)(uint32_t tMs, void* ctx), void* ctx) {
+  const uint64_t startUs = nativeHalNowUs();
+  sendCommand(client, "{\"command\":\"motor_start\"}");
+  uint32_t tMs = 0;
+  while (tMs < maxMs) {
+    if (plant != nullptr) {
+      plant(tMs, ctx);
+    }
+    nativeHalRunFor(10000);
+    tMs = static_cast<uint32_t>((nativeHalNowUs() - startUs) / 1000ULL);
+    if (!stopAtEnd && tMs > 100 && !isMotorActive()) {
+      break;
+    }
+  }
+  if (stopAtEnd) {
+    sendCommand(client, "{\"command\":\"motor_stop\"}");
+  }
+  // Idle long enough for the I/O task to act on the stop (a display redraw may delay it).
+  nativeHalRunFor(300000);
+  return tMs;
+}
+
+void longRunPlant(uint32_t tMs, void* ctx) {
+  // The pack sags from 4.1 to 3.7 V/cell over the run; the motor spins at a steady 50000 rpm.
+  const uint8_t cells = *static_cast<uint8_t*>(ctx);
+  const float perCell = 4.1f - 0.4f * static_cast<float>(tMs) / kSessionLongRunMs;
+  nativeHalSetAnalogMillivolts(kVbatPin, vbatMillivolts(perCell * cells));
+  nativeHalSetPulseFrequency(kFgPin, kSessionLongRunRpm / 60.0f * getRuntimeSettings().tachPulsesPerRev);
+}
+
+void hotRunPlant(uint32_t tMs, void*) {
+  nativeHalSetAnalogMillivolts(kThermPin, ntcMillivolts(tMs >= 500 ? kSessionHotC : kAmbientC));
+}
+
+/**
+ * Records kSessionShortRuns short remote runs (wrapping the ring), a long run with a sagging pack
+ * and a run ended by the thermal cutoff, then reads everything back with get_sessions and checks
+ * sequence numbers, ring bounds, reasons and durations.
+ */
+int runSessionProbe() {
+  const int client = bootFirmware();
+  if (client < 0) {
+    return 1;
+  }
+  uint8_t cells = getRuntimeSettings().batterySeriesCells;
+  sendCommand(client, "{\"speed\":60}");
+  for (uint32_t i = 0; i < kSessionShortRuns; ++i) {
+    remoteRun(client, 200, true, nullptr, nullptr);
+  }
+  remoteRun(client, kSessionLongRunMs, true, longRunPlant, &cells);
+  applyPlant(nullptr, 0, cells);
+  remoteRun(client, 5000, false, hotRunPlant, nullptr);
+  applyPlant(nullptr, 0, cells);
+  nativeHalRunFor(500000);
+
+  webSocket.hostReceived(static_cast<uint8_t>(client)).clear();
+  sendCommand(client, "{\"command\":\"get_sessions\",\"from\":0}");
+  std::vector<SessionRecord> records;
+  bool ended = false;
+  uint32_t pages = 0;
+  size_t seen = 0;
+  for (uint32_t waitedMs = 0; !ended && waitedMs < 10000; waitedMs += 50) {
+    nativeHalRunFor(50000);
+    auto& frames = webSocket.hostReceived(static_cast<uint8_t>(client));
+    for (; seen < frames.size(); ++seen) {
+      const std::string& d = frames[seen].data;
+      if (!frames[seen].binary) {
+        if (d.find("\"get_sessions\"") != std::string::npos) {
+          printf("[sessions] ack %s\n", d.c_str());
+        }
+        continue;
+      }
+      if (d.size() < kSessionPageHeaderSize || static_cast<uint8_t>(d[0]) != kSessionPageMagic) {
+        continue;
+      }
+      ++pages;
+      const uint8_t count = static_cast<uint8_t>(d[2]);
+      ended = count == 0;
+      for (uint8_t r = 0; r < count; ++r) {
+        SessionRecord rec;
+        if (sessionLogDecode(reinterpret_cast<const uint8_t*>(d.data()) + kSessionPageHeaderSize + r * kSessionRecordSize, rec)) {
+          records.push_back(rec);
+        }
+      }
+    }
+  }
+
+  const uint32_t total = kSessionShortRuns + 2;
+  bool ok = ended && records.size() >= kSessionLogCapacity - kSessionRecordsPerSegment &&
+            records.size() <= kSessionLogCapacity;
+  for (size_t i = 1; i < records.size(); ++i) {
+    ok = ok && records[i].seq == records[i - 1].seq + 1;
+  }
+  ok = ok && !records.empty() && records.back().seq == total;
+  printf("[sessions] %u runs recorded, %u read back in %u pages (seq %u..%u)\n", static_cast<unsigned>(total),
+         static_cast<unsigned>(records.size()), static_cast<unsigned>(pages),
+         records.empty() ? 0U : static_cast<unsigned>(records.front().seq),
+         records.empty() ? 0U : static_cast<unsigned>(records.back().seq));
+  if (records.size() >= 3) {
+    const SessionRecord& shortRun = records[records.size() - 3];
+    const SessionRecord& longRun = records[records.size() - 2];
+    const SessionRecord& hotRun = records.back();
+    for (const SessionRecord* r : {&shortRun, &longRun, &hotRun}) {
+      printf("[sessions] #%u start %u stop %u  %6u ms  pack %u/%u/%u mV  peak %.2f C  %u rpm  speed %u%%  rpm band3 %u/255\n",
+             static_cast<unsigned>(r->seq), static_cast<unsigned>(r->startReason),
+             static_cast<unsigned>(r->stopReason), static_cast<unsigned>(r->durationMs),
+             static_cast<unsigned>(r->packMinMv), static_cast<unsigned>(r->packMeanMv),
+             static_cast<unsigned>(r->packMaxMv), r->peakTempCenti / 100.0, static_cast<unsigned>(r->peakRpm),
+             static_cast<unsigned>(r->meanSpeedPercent), static_cast<unsigned>(r->rpmShare[3]));
+    }
+    const uint32_t longTarget = kSessionLongRunMs;
+    ok = ok && shortRun.startReason == SessionStartReason::Remote && shortRun.stopReason == SessionStopReason::Remote &&
+         shortRun.durationMs >= 150 && shortRun.durationMs <= 300;
+    ok = ok && longRun.stopReason == SessionStopReason::Remote && longRun.durationMs + 100 >= longTarget &&
+         longRun.durationMs <= longTarget + 300 && longRun.packMaxMv > longRun.packMinMv &&
+         longRun.peakRpm >= kSessionLongRunRpm * 0.95f && longRun.meanSpeedPercent == 60;
+    ok = ok && hotRun.startReason == SessionStartReason::Remote && hotRun.stopReason == SessionStopReason::Thermal &&
+         hotRun.peakTempCenti > getRuntimeSettings().tempLimitC * 100;
+  } else {
+    ok = false;
+  }
+  printf("[sessions] %s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
+
+struct StatsPlant {
+  uint8_t cells;
+  float rpm;
+  float tempC;
+  float cellV;
+};
+
+void statsPlant(uint32_t, void* ctx) {
+  const StatsPlant& p = *static_cast<StatsPlant*>(ctx);
+  nativeHalSetAnalogMillivolts(kThermPin, ntcMillivolts(p.tempC));
+  nativeHalSetAnalogMillivolts(kVbatPin, vbatMillivolts(p.cellV * p.cells));
+  nativeHalSetPulseFrequency(kFgPin, p.rpm / 60.0f * getRuntimeSettings().tachPulsesPerRev);
+}
+
+bool base64Decode(const std::string& in, std::string& out) {
+  static const std::string kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  uint32_t acc = 0;
+  int bits = 0;
+  out.clear();
+  for (char c : in) {
+    if (c == '=') {
+      break;
+    }
+    const size_t v = kAlphabet.find(c);
+    if (v == std::string::npos) {
+      return false;
+    }
+    acc = (acc << 6) | static_cast<uint32_t>(v);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      out.push_back(static_cast<char>((acc >> bits) & 0xFF));
+    }
+  }
+  return true;
+}
+
+/** Sends get_stats and returns the decoded blob (empty if none arrived or the CRC is wrong). */
+std::string fetchStatsBlob(int client) {
+  auto& frames = webSocket.hostReceived(static_cast<uint8_t>(client));
+  frames.clear();
+  sendCommand(client, "{\"command\":\"get_stats\"}");
+  nativeHalRunFor(200000);
+  for (const auto& frame : frames) {
+    const size_t at = frame.data.find("\"blob\":\"");
+    if (frame.binary || frame.data.find("\"get_stats\"") == std::string::npos || at == std::string::npos) {
+      continue;
+    }
+    const size_t begin = at + 8;
+    std::string blob;
+    if (!base64Decode(frame.data.substr(begin, frame.data.find('"', begin) - begin), blob) ||
+        blob.size() != kMotorStatsBlobSize) {
+      return std::string();
+    }
+    uint32_t crc = 0;
+    memcpy(&crc, blob.data() + blob.size() - 4, 4);
+    return crc == crc32(blob.data(), blob.size() - 4) ? blob : std::string();
+  }
+  return std::string();
+}
+
+uint32_t blobU32(const std::string& blob, size_t at) {
+  uint32_t v = 0;
+  memcpy(&v, blob.data() + at, sizeof(v));
+  return v;
+}
+
+double blobF64(const std::string& blob, size_t at) {
+  double v = 0.0;
+  memcpy(&v, blob.data() + at, sizeof(v));
+  return v;
+}
+
+bool near(uint32_t value, uint32_t expected, uint32_t slack) {
+  return value + slack >= expected && value <= expected + slack;
+}
+
+/**
+ * Two remote runs with known plant values (a cool one at 60 % and a hot, sagging one at 100 %), then
+ * get_stats: checks sample, speed-band, histogram and above-threshold counts against the run lengths,
+ * that the lifetime set reaches NVS only after the motor has stayed off for the quiet period, and that
+ * it survives initMaximumStats() reloading it from NVS.
+ */
+int runStatsProbe() {
+  const int client = bootFirmware();
+  if (client < 0) {
+    return 1;
+  }
+  StatsPlant plant = {getRuntimeSettings().batterySeriesCells, kStatsCoolRpm, kAmbientC, 4.0f};
+  sendCommand(client, "{\"command\":\"set_setting\",\"key\":\"temp_lim\",\"value\":0}");
+  sendCommand(client, "{\"speed\":60}");
+  remoteRun(client, kStatsCoolRunMs, true, statsPlant, &plant);
+  plant = {plant.cells, kStatsHotRpm, kStatsHotC, kStatsSagCellV};
+  sendCommand(client, "{\"speed\":100}");
+  remoteRun(client, kStatsHotRunMs, true, statsPlant, &plant);
+  applyPlant(nullptr, 0, plant.cells);
+  nativeHalRunFor(500000);
+
+  const std::string blob = fetchStatsBlob(client);
+  if (blob.empty()) {
+    printf("[stats] no valid get_stats blob\n");
+    printf("[stats] FAILED\n");
+    return 1;
+  }
+  // Set offsets from maximum_stats.h.
+  const size_t run = kMotorStatsHeaderSize;
+  const size_t life = run + kMotorStatsSetSize;
+  const uint32_t coolSamples = kStatsCoolRunMs / kMotorStatsSamplePeriodMs;
+  const uint32_t hotSamples = kStatsHotRunMs / kMotorStatsSamplePeriodMs;
+  const uint32_t coolRpmBucket = static_cast<uint32_t>(kStatsCoolRpm / kMotorStatsRpmBucketWidth);
+  const uint32_t hotRpmBucket = static_cast<uint32_t>(kStatsHotRpm / kMotorStatsRpmBucketWidth);
+  const uint32_t hotTempBucket = static_cast<uint32_t>(kStatsHotC / kMotorStatsTempBucketWidthC);
+  printf("[stats] blob %u bytes, run: %u samples, lifetime: %u samples / %u starts\n",
+         static_cast<unsigned>(blob.size()), static_cast<unsigned>(blobU32(blob, run)),
+         static_cast<unsigned>(blobU32(blob, life)), static_cast<unsigned>(blobU32(blob, life + 4)));
+  printf("[stats] lifetime speed 60 %%: %u, 100 %%: %u; rpm bucket %u: %u, bucket %u: %u; temp bucket %u: %u\n",
+         static_cast<unsigned>(blobU32(blob, life + 8 + 6 * 4)), static_cast<unsigned>(blobU32(blob, life + 8 + 10 * 4)),
+         static_cast<unsigned>(coolRpmBucket), static_cast<unsigned>(blobU32(blob, life + 52 + coolRpmBucket * 4)),
+         static_cast<unsigned>(hotRpmBucket), static_cast<unsigned>(blobU32(blob, life + 52 + hotRpmBucket * 4)),
+         static_cast<unsigned>(hotTempBucket), static_cast<unsigned>(blobU32(blob, life + 116 + hotTempBucket * 4)));
+  const double rpmMean = blobF64(blob, life + 244 + 4);
+  const uint32_t rpmN = blobU32(blob, life + 244);
+  const double rpmSd = rpmN > 0 ? sqrt(blobF64(blob, life + 244 + 12) / rpmN) : 0.0;
+  printf("[stats] lifetime rpm mean %.0f sd %.0f (n %u); hot %u, sag %u, high rpm %u samples\n", rpmMean, rpmSd,
+         static_cast<unsigned>(rpmN), static_cast<unsigned>(blobU32(blob, life + 304)),
+         static_cast<unsigned>(blobU32(blob, life + 308)), static_cast<unsigned>(blobU32(blob, life + 312)));
+
+  // Sensor filters and run start/stop latency blur the edges; allow a few samples either way.
+  const uint32_t slack = 4;
+  bool ok = static_cast<uint8_t>(blob[0]) == kMotorStatsBlobMagic && blobU32(blob, life + 4) == 2 &&
+            near(blobU32(blob, life), coolSamples + hotSamples, slack) && near(blobU32(blob, run), hotSamples, slack) &&
+            near(blobU32(blob, life + 8 + 6 * 4), coolSamples, slack) &&
+            near(blobU32(blob, life + 8 + 10 * 4), hotSamples, slack) &&
+            near(blobU32(blob, life + 52 + coolRpmBucket * 4), coolSamples, slack) &&
+            near(blobU32(blob, life + 52 + hotRpmBucket * 4), hotSamples, slack) &&
+            near(blobU32(blob, life + 116 + hotTempBucket * 4), hotSamples, slack) &&
+            near(blobU32(blob, life + 304), hotSamples, slack) && near(blobU32(blob, life + 308), hotSamples, slack) &&
+            blobU32(blob, life + 312) == 0 && rpmMean > kStatsCoolRpm && rpmMean < kStatsHotRpm && rpmSd > 0.0;
+
+  const auto storedLifetimeBytes = []() {
+    Preferences prefs;
+    prefs.begin("oshvac", true);
+    const size_t n = prefs.getBytesLength("mstat_life");
+    prefs.end();
+    return n;
+  };
+  const bool deferred = storedLifetimeBytes() == 0;
+  nativeHalRunFor(kStatsLifetimeQuietUs);
+  const bool written = storedLifetimeBytes() != 0;
+  printf("[stats] lifetime set %s right after the stop, %s after the quiet period\n",
+         deferred ? "not stored" : "STORED", written ? "stored" : "NOT STORED");
+  ok = ok && deferred && written;
+
+  {
+    ControlLockGuard lock;
+    initMaximumStats();  // as after a reboot: the lifetime set comes back from NVS
+  }
+  const std::string reloaded = fetchStatsBlob(client);
+  const bool kept = !reloaded.empty() && blobU32(reloaded, run) == 0 &&
+                    reloaded.compare(life, kMotorStatsSetSize, blob, life, kMotorStatsSetSize) == 0;
+  printf("[stats] lifetime set %s after reload from NVS\n", kept ? "identical" : "DIFFERENT");
+  ok = ok && kept;
+  printf("[stats] %s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
+
+struct AdcProbe {
+  AdcReading vbat0;
+  AdcReading ntc0;
+  float packV0;
+  int32_t rawDevMv;  // newest frame, to show the ripple reaches the ADC at all
+  int32_t vbatDevMv;
+  int32_t ntcDevMv;
+  float packDevV;
+};
+
+void onAdcTick(uint64_t, void* ctx) {
+  AdcProbe& probe = *static_cast<AdcProbe*>(ctx);
+  const int32_t vbatDev = static_cast<int32_t>(adcSamplerFiltered(AdcChannel::Battery).millivolts) - probe.vbat0.millivolts;
+  const int32_t ntcDev = static_cast<int32_t>(adcSamplerFiltered(AdcChannel::Thermistor).millivolts) - probe.ntc0.millivolts;
+  const int32_t rawDev = static_cast<int32_t>(adcSamplerLatest(AdcChannel::Battery).millivolts) - probe.vbat0.millivolts;
+  probe.rawDevMv = std::max(probe.rawDevMv, abs(rawDev));
+  probe.vbatDevMv = std::max(probe.vbatDevMv, abs(vbatDev));
+  probe.ntcDevMv = std::max(probe.ntcDevMv, abs(ntcDev));
+  probe.packDevV = fmaxf(probe.packDevV, fabsf(getBatteryVoltage() - probe.packV0));
+}
+
+/**
+ * Puts a kAdcRippleMv sine plus kAdcNoiseMv noise on the battery and NTC pins of an idle device and
+ * checks that the filtered readings and the published pack voltage stay near their ripple-free
+ * values: the 20 ms battery window leaves a fraction of the ripple, the 100 ms NTC window almost none.
+ */
+int runAdcProbe() {
+  if (bootFirmware() < 0) {
+    return 1;
+  }
+  AdcProbe probe = {};
+  probe.vbat0 = adcSamplerFiltered(AdcChannel::Battery);
+  probe.ntc0 = adcSamplerFiltered(AdcChannel::Thermistor);
+  probe.packV0 = getBatteryVoltage();
+  nativeHalSetAnalogWaveform(kVbatPin, kAdcRippleMv, kAdcRippleHz, kAdcNoiseMv);
+  nativeHalSetAnalogWaveform(kThermPin, kAdcRippleMv, kAdcRippleHz, kAdcNoiseMv);
+  nativeHalSetTickHook(onAdcTick, &probe);
+  nativeHalRunFor(kAdcProbeUs);
+  nativeHalSetTickHook(nullptr, nullptr);
+  nativeHalSetAnalogWaveform(kVbatPin, 0, 0.0f, 0);
+  nativeHalSetAnalogWaveform(kThermPin, 0, 0.0f, 0);
+
+  // Bands: a quarter of the ripple on the battery pin (x kVbatScale on the pack), an eighth on the NTC.
+  const int32_t vbatBandMv = static_cast<int32_t>(kAdcRippleMv / 4);
+  const int32_t ntcBandMv = static_cast<int32_t>(kAdcRippleMv / 8);
+  const float packBandV = vbatBandMv * kVbatScale * kVbatCalSlope / 1000.0f;
+  printf("[adc] %u mV ripple at %.0f Hz, +-%u mV noise on both pins for %.1f s\n", static_cast<unsigned>(kAdcRippleMv),
+         static_cast<double>(kAdcRippleHz), static_cast<unsigned>(kAdcNoiseMv), kAdcProbeUs / 1e6);
+  printf("[adc] battery pin %u mV, newest frame off by up to %d mV, filtered by up to %d mV (band %d)\n",
+         static_cast<unsigned>(probe.vbat0.millivolts), static_cast<int>(probe.rawDevMv),
+         static_cast<int>(probe.vbatDevMv), static_cast<int>(vbatBandMv));
+  printf("[adc] ntc pin %u mV, filtered off by up to %d mV (band %d)\n", static_cast<unsigned>(probe.ntc0.millivolts),
+         static_cast<int>(probe.ntcDevMv), static_cast<int>(ntcBandMv));
+  printf("[adc] pack %.2f V, published off by up to %.3f V (band %.3f)\n", static_cast<double>(probe.packV0),
+         static_cast<double>(probe.packDevV), static_cast<double>(packBandV));
+  const bool ok = probe.packV0 > 0.05f && probe.rawDevMv > vbatBandMv && probe.vbatDevMv <= vbatBandMv && probe.ntcDevMv <= ntcBandMv &&
+                  probe.packDevV <= packBandV;
+  printf("[adc] %s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
+
+void printResult(const SimScenario& s, const SimResult& r) {
+  const long latency = r.fired != Cause::None && r.expected != Cause::None
+                           ? static_cast<long>(r.firedMs) - static_cast<long>(r.onsetMs)
+                           : 0;
+  printf("%-40s start @%6u ms  expect %-17s @%8u ms  fired %-17s @%8u ms  latency %6ld ms  loops/s %6.0f (%5.0f..%5.0f)\n",
+         s.name.c_str(), static_cast<unsigned>(r.startedMs), causeName(r.expected), static_cast<unsigned>(r.onsetMs), causeName(r.fired),
+         static_cast<unsigned>(r.firedMs), latency, static_cast<double>(r.loopsPerSecMean),
+         static_cast<double>(r.loopsPerSecMin), static_cast<double>(r.loopsPerSecMax));
+}
+
+struct CauseSummary {
+  uint32_t count = 0;
+  uint32_t missed = 0;
+  uint32_t wrong = 0;
+  uint32_t skipped = 0;  // phase-dependent runs the debounce filtered out
+  long latencyMin = 0;
+  long latencyMax = 0;
+  double latencySum = 0.0;
+};
+
+void printUsage() {
+  printf("usage: firmware [--sweep=thermal|undervoltage|auto_off|all] [--scenarios=FILE] [--trace=CSV]\n"
+         "                [--boot[=sta|ap] [--full-boot]] [--sessions] [--stats] [--adc] [--jobs=N] [--loop-cost-us=N] [--fs-root=DIR] [--verbose] [--echo]\n");
+}
+
+}  // namespace
+
+int nativeHalMain(int argc, char** argv) {
+  std::vector<SimScenario> scenarios;
+  std::string error;
+  unsigned jobs = 1;
+  bool verbose = false;
+  bool echo = false;
+  int bootProbe = -1;  // -1: off, 1: STA joins, 0: falls back to AP
+  bool fullBoot = false;
+  bool sessionProbe = false;
+  bool statsProbe = false;
+  bool adcProbe = false;
+#if defined(OSHVAC_SIM_FORK)
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  jobs = cpus > 0 ? static_cast<unsigned>(cpus) : 1;
+#endif
+
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    if (strncmp(a, "--sweep=", 8) == 0) {
+      if (!simBuildSweep(a + 8, scenarios)) {
+        fprintf(stderr, "[sim] unknown sweep '%s'\n", a + 8);
+        return 2;
+      }
+    } else if (strncmp(a, "--scenarios=", 12) == 0) {
+      if (!simLoadScenarioFile(a + 12, scenarios, error)) {
+        fprintf(stderr, "[sim] %s\n", error.c_str());
+        return 2;
+      }
+    } else if (strncmp(a, "--trace=", 8) == 0) {
+      SimScenario s;
+      s.name = a + 8;
+      if (!simLoadTraceCsv(a + 8, s, error)) {
+        fprintf(stderr, "[sim] %s\n", error.c_str());
+        return 2;
+      }
+      scenarios.push_back(s);
+    } else if (strncmp(a, "--jobs=", 7) == 0) {
+      jobs = static_cast<unsigned>(strtoul(a + 7, nullptr, 10));
+    } else if (strncmp(a, "--loop-cost-us=", 15) == 0) {
+      nativeHalSetLoopCostUs(static_cast<uint32_t>(strtoul(a + 15, nullptr, 10)));
+    } else if (strncmp(a, "--fs-root=", 10) == 0) {
+      nativeHalSetFsRoot(a + 10);
+    } else if (strcmp(a, "--boot") == 0 || strcmp(a, "--boot=sta") == 0) {
+      bootProbe = 1;
+    } else if (strcmp(a, "--boot=ap") == 0) {
+      bootProbe = 0;
+    } else if (strcmp(a, "--sessions") == 0) {
+      sessionProbe = true;
+    } else if (strcmp(a, "--stats") == 0) {
+      statsProbe = true;
+    } else if (strcmp(a, "--adc") == 0) {
+      adcProbe = true;
+    } else if (strcmp(a, "--full-boot") == 0) {
+      fullBoot = true;
+    } else if (strcmp(a, "--verbose") == 0) {
+      verbose = true;
+    } else if (strcmp(a, "--echo") == 0) {
+      echo = true;
+    } else {
+      printUsage();
+      return 2;
+    }
+  }
+  if (bootProbe >= 0) {
+    nativeHalSetSerialEcho(echo);
+    return runBootProbe(bootProbe == 1, fullBoot);
+  }
+  if (sessionProbe) {
+    nativeHalSetSerialEcho(echo);
+    return runSessionProbe();
+  }
+  if (statsProbe) {
+    nativeHalSetSerialEcho(echo);
+    return runStatsProbe();
+  }
+  if (adcProbe) {
+    nativeHalSetSerialEcho(echo);
+    return runAdcProbe();
+  }
+  if (scenarios.empty()) {
+    printUsage();
+    return 2;
+  }
+  if (jobs == 0) {
+    jobs = 1;
+  }
+  nativeHalSetSerialEcho(echo);
+
+  const auto wallStart = std::chrono::steady_clock::now();
+  fflush(stdout);
+
+  std::vector<SimResult> results(scenarios.size());
+  std::vector<bool> have(scenarios.size(), false);
+
+#if defined(OSHVAC_SIM_FORK)
+  // Each scenario runs in a fork of the booted firmware so runs are independent; results come
+  // back as fixed-size records on one pipe (writes under PIPE_BUF are atomic).
+  int fds[2];
+  if (pipe(fds) != 0) {
+    perror("[sim] pipe");
+    return 1;
+  }
+  size_t next = 0;
+  unsigned running = 0;
+  while (next < scenarios.size() || running > 0) {
+    while (running < jobs && next < scenarios.size()) {
+      const pid_t pid = fork();
+      if (pid == 0) {
+        close(fds[0]);
+        const int client = bootFirmware();
+        if (client < 0) {
+          _exit(1);
+        }
+        const SimResult r = runScenario(scenarios[next], static_cast<uint32_t>(next), client);
+        fflush(stdout);
+        const ssize_t n = write(fds[1], &r, sizeof(r));
+        _exit(n == static_cast<ssize_t>(sizeof(r)) ? 0 : 1);
+      }
+      if (pid < 0) {
+        perror("[sim] fork");
+        return 1;
+      }
+      ++next;
+      ++running;
+    }
+    SimResult r;
+    if (read(fds[0], &r, sizeof(r)) == static_cast<ssize_t>(sizeof(r)) && r.index < results.size()) {
+      results[r.index] = r;
+      have[r.index] = true;
+    }
+    int status = 0;
+    if (wait(&status) > 0) {
+      --running;
+    }
+  }
+  close(fds[0]);
+  close(fds[1]);
+#else
+  // No fork(): scenarios run back to back on one firmware instance (state carries over).
+  (void)jobs;
+  const int client = bootFirmware();
+  if (client < 0) {
+    return 1;
+  }
+  for (size_t i = 0; i < scenarios.size(); ++i) {
+    results[i] = runScenario(scenarios[i], static_cast<uint32_t>(i), client);
+    have[i] = true;
+    nativeHalRunFor(static_cast<uint64_t>(kBootSettleMs) * 1000ULL);
+  }
+#endif
+
+  const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+  CauseSummary summary[5];
+  uint32_t failed = 0;
+  double simulatedS = 0.0;
+  double loopsSum = 0.0;
+  float loopsMin = 0.0f;
+  float loopsMax = 0.0f;
+  uint32_t loopsN = 0;
+  for (size_t i = 0; i < scenarios.size(); ++i) {
+    if (!have[i]) {
+      printf("%-40s (no result)\n", scenarios[i].name.c_str());
+      ++failed;
+      continue;
+    }
+    const SimResult& r = results[i];
+    simulatedS += r.simulatedMs / 1000.0;
+    if (r.loopsPerSecMean > 0.0f) {
+      loopsSum += r.loopsPerSecMean;
+      loopsMin = loopsN == 0 ? r.loopsPerSecMin : fminf(loopsMin, r.loopsPerSecMin);
+      loopsMax = loopsN == 0 ? r.loopsPerSecMax : fmaxf(loopsMax, r.loopsPerSecMax);
+      ++loopsN;
+    }
+    CauseSummary& cs = summary[static_cast<uint8_t>(r.expected)];
+    ++cs.count;
+    const bool skipped = r.phaseDependent && r.fired == Cause::None;
+    const bool mismatch = r.fired != r.expected && !skipped;
+    if (skipped) {
+      ++cs.skipped;
+    } else if (r.expected != Cause::None && r.fired == Cause::None) {
+      ++cs.missed;
+    } else if (mismatch) {
+      ++cs.wrong;
+    } else if (r.expected != Cause::None) {
+      const long latency = static_cast<long>(r.firedMs) - static_cast<long>(r.onsetMs);
+      const uint32_t ok = cs.count - cs.missed - cs.wrong - cs.skipped;
+      cs.latencyMin = ok == 1 ? latency : std::min(cs.latencyMin, latency);
+      cs.latencyMax = ok == 1 ? latency : std::max(cs.latencyMax, latency);
+      cs.latencySum += latency;
+    }
+    if (verbose || mismatch) {
+      printResult(scenarios[i], r);
+    }
+  }
+
+  printf("[sim] %zu scenarios, %.0f s simulated in %.2f s wall (%.0f scenarios/min), jobs %u\n", scenarios.size(),
+         simulatedS, wallS, wallS > 0.0 ? scenarios.size() * 60.0 / wallS : 0.0, jobs);
+  if (loopsN > 0) {
+    printf("[sim] loop iterations per simulated second: mean %.0f, min %.0f, max %.0f\n", loopsSum / loopsN,
+           static_cast<double>(loopsMin), static_cast<double>(loopsMax));
+  }
+  for (uint8_t c = 0; c < 4; ++c) {
+    const CauseSummary& cs = summary[c];
+    if (cs.count == 0) {
+      continue;
+    }
+    const uint32_t fired = cs.count - cs.missed - cs.wrong - cs.skipped;
+    printf("[sim] %-17s %5u runs, %5u as expected", causeName(static_cast<Cause>(c)), static_cast<unsigned>(cs.count),
+           static_cast<unsigned>(fired + cs.skipped));
+    if (c != static_cast<uint8_t>(Cause::None) && fired > 0) {
+      printf(", latency min %ld / mean %.0f / max %ld ms", cs.latencyMin, cs.latencySum / fired, cs.latencyMax);
+    }
+    if (cs.skipped) {
+      printf(" (%u phase-dependent, filtered out)", static_cast<unsigned>(cs.skipped));
+    }
+    if (cs.missed || cs.wrong) {
+      printf(" (%u not fired, %u other cause)", static_cast<unsigned>(cs.missed), static_cast<unsigned>(cs.wrong));
+    }
+    printf("\n");
+  }
+  return failed == 0 ? 0 : 1;
+}
+
+#endif  // OSHVAC_SIM
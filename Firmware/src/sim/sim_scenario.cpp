@@ -0,0 +1,367 @@
+#if defined(OSHVAC_SIM)
+
+#include "sim_scenario.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+constexpr float kNominalCellV = 3.9f;
+constexpr float kAmbientC = 25.0f;
+// Firmware timing the undervoltage expectation has to follow: adc_sampler's battery moving average,
+// battery.cpp's publish interval and the debounce in main.cpp's cutoff check.
+constexpr uint32_t kUndervoltageFilterMs = 20;
+constexpr uint32_t kBatterySampleMs = 100;
+constexpr uint32_t kUndervoltageDebounceMs = 400;
+
+bool parseChannel(const char* spec, SimChannel& out) {
+  out.points.clear();
+  const char* p = spec;
+  while (*p != '\0') {
+    char* end = nullptr;
+    const float value = strtof(p, &end);
+    if (end == p || *end != '@') {
+      return false;
+    }
+    p = end + 1;
+    const unsigned long t = strtoul(p, &end, 10);
+    if (end == p) {
+      return false;
+    }
+    if (!out.points.empty() && t < out.points.back().first) {
+      return false;
+    }
+    out.points.emplace_back(static_cast<uint32_t>(t), value);
+    p = end;
+    if (*p == ',') {
+      ++p;
+    } else if (*p != '\0') {
+      return false;
+    }
+  }
+  return !out.points.empty();
+}
+
+void setSetting(SimScenario& s, const char* key, int value) {
+  for (auto& kv : s.settings) {
+    if (kv.first == key) {
+      kv.second = value;
+      return;
+    }
+  }
+  s.settings.emplace_back(key, value);
+}
+
+SimScenario baseScenario(const char* name, uint32_t startMs) {
+  SimScenario s;
+  s.name = name;
+  s.motorStartMs = startMs;
+  // Isolate the cutoff under test: everything else off unless the sweep sets it.
+  setSetting(s, "auto_off", 0);
+  setSetting(s, "temp_lim", 0);
+  setSetting(s, "sleep_tmr", 30);
+  return s;
+}
+
+}  // namespace
+
+float SimChannel::at(uint32_t tMs, float fallback) const {
+  if (points.empty()) {
+    return fallback;
+  }
+  if (tMs <= points.front().first) {
+    return points.front().second;
+  }
+  for (size_t i = 1; i < points.size(); ++i) {
+    if (tMs <= points[i].first) {
+      const auto& a = points[i - 1];
+      const auto& b = points[i];
+      if (b.first == a.first) {
+        return b.second;
+      }
+      const float f = static_cast<float>(tMs - a.first) / static_cast<float>(b.first - a.first);
+      return a.second + (b.second - a.second) * f;
+    }
+  }
+  return points.back().second;
+}
+
+bool simParseScenarioLine(const char* line, SimScenario& out, std::string& error) {
+  std::istringstream in(line);
+  std::string tok;
+  out = SimScenario();
+  bool named = false;
+  while (in >> tok) {
+    if (tok[0] == '#') {
+      break;
+    }
+    const size_t eq = tok.find('=');
+    if (eq == std::string::npos) {
+      if (named) {
+        error = "unexpected token '" + tok + "'";
+        return false;
+      }
+      out.name = tok;
+      named = true;
+      continue;
+    }
+    const std::string key = tok.substr(0, eq);
+    const std::string value = tok.substr(eq + 1);
+    if (key == "temp" || key == "pack_v" || key == "rpm" || key == "die_temp") {
+      SimChannel& ch = key == "temp" ? out.tempC : key == "pack_v" ? out.packV : key == "rpm" ? out.rpm : out.dieTempC;
+      if (!parseChannel(value.c_str(), ch)) {
+        error = "bad channel '" + tok + "' (want value@ms,...)";
+        return false;
+      }
+    } else if (key == "trace") {
+      if (!simLoadTraceCsv(value.c_str(), out, error)) {
+        return false;
+      }
+    } else if (key == "start_ms") {
+      out.motorStartMs = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+    } else if (key == "duration_s") {
+      out.durationMs = static_cast<uint32_t>(strtof(value.c_str(), nullptr) * 1000.0f);
+    } else if (key == "speed") {
+      out.speedPercent = static_cast<uint8_t>(atoi(value.c_str()));
+    } else {
+      setSetting(out, key.c_str(), atoi(value.c_str()));
+    }
+  }
+  if (!named) {
+    error = "missing scenario name";
+    return false;
+  }
+  return true;
+}
+
+bool simLoadScenarioFile(const char* path, std::vector<SimScenario>& out, std::string& error) {
+  std::ifstream f(path);
+  if (!f.good()) {
+    error = std::string("cannot open ") + path;
+    return false;
+  }
+  std::string line;
+  size_t lineNo = 0;
+  while (std::getline(f, line)) {
+    ++lineNo;
+    const size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') {
+      continue;
+    }
+    SimScenario s;
+    if (!simParseScenarioLine(line.c_str(), s, error)) {
+      error = std::string(path) + ":" + std::to_string(lineNo) + ": " + error;
+      return false;
+    }
+    out.push_back(s);
+  }
+  return true;
+}
+
+bool simLoadTraceCsv(const char* path, SimScenario& scenario, std::string& error) {
+  std::ifstream f(path);
+  if (!f.good()) {
+    error = std::string("cannot open trace ") + path;
+    return false;
+  }
+  scenario.tempC.points.clear();
+  scenario.packV.points.clear();
+  scenario.rpm.points.clear();
+  scenario.dieTempC.points.clear();
+  std::string line;
+  while (std::getline(f, line)) {
+    if (line.empty() || line[0] == '#' || (line[0] != '-' && (line[0] < '0' || line[0] > '9'))) {
+      continue;  // comments and the header row
+    }
+    float cols[5] = {0, NAN, NAN, NAN, NAN};
+    int n = sscanf(line.c_str(), "%f,%f,%f,%f,%f", &cols[0], &cols[1], &cols[2], &cols[3], &cols[4]);
+    if (n < 2) {
+      continue;
+    }
+    const uint32_t t = static_cast<uint32_t>(cols[0]);
+    if (!isnan(cols[1])) scenario.tempC.points.emplace_back(t, cols[1]);
+    if (!isnan(cols[2])) scenario.packV.points.emplace_back(t, cols[2]);
+    if (!isnan(cols[3])) scenario.rpm.points.emplace_back(t, cols[3]);
+    if (!isnan(cols[4])) scenario.dieTempC.points.emplace_back(t, cols[4]);
+  }
+  if (scenario.tempC.empty() && scenario.packV.empty() && scenario.rpm.empty()) {
+    error = std::string("no samples in trace ") + path;
+    return false;
+  }
+  const uint32_t last = std::max({scenario.tempC.empty() ? 0U : scenario.tempC.points.back().first,
+                                  scenario.packV.empty() ? 0U : scenario.packV.points.back().first,
+                                  scenario.rpm.empty() ? 0U : scenario.rpm.points.back().first});
+  if (last > scenario.durationMs) {
+    scenario.durationMs = last;
+  }
+  return true;
+}
+
+bool simBuildSweep(const char* kind, std::vector<SimScenario>& out) {
+  const bool all = strcmp(kind, "all") == 0;
+  bool matched = all;
+  char name[64];
+
+  if (all || strcmp(kind, "thermal") == 0) {
+    matched = true;
+    static const float kRatesCps[] = {0.25f, 0.5f, 1.0f, 1.5f, 2.0f, 3.0f, 5.0f, 7.5f, 10.0f, 15.0f, 20.0f, 40.0f};
+    for (int lim = 40; lim <= 80; lim += 5) {
+      for (float rate : kRatesCps) {
+        // Motor start phase against the 250 ms NTC sampling cycle.
+        for (uint32_t phase = 0; phase < 250; phase += 25) {
+          snprintf(name, sizeof(name), "thermal_lim%d_rate%.2f_ph%u", lim, static_cast<double>(rate),
+                   static_cast<unsigned>(phase));
+          SimScenario s = baseScenario(name, 1000 + phase);
+          setSetting(s, "temp_lim", lim);
+          const uint32_t rampMs = static_cast<uint32_t>((100.0f - kAmbientC) / rate * 1000.0f);
+          s.tempC.points = {{0, kAmbientC}, {s.motorStartMs, kAmbientC}, {s.motorStartMs + rampMs, 100.0f}};
+          const uint32_t onsetMs = s.motorStartMs + static_cast<uint32_t>((lim - kAmbientC) / rate * 1000.0f);
+          s.durationMs = onsetMs + 5000;
+          out.push_back(s);
+        }
+      }
+    }
+  }
+
+  if (all || strcmp(kind, "undervoltage") == 0) {
+    matched = true;
+    struct Profile {
+      const char* tag;
+      float cellV;      // level the pack sags to (per cell)
+      float rateVps;    // per-cell ramp rate; 0 = step
+      uint32_t dipMs;   // 0 = sustained
+    };
+    static const Profile kProfiles[] = {
+        {"step98", 2.94f, 0.0f, 0},   {"step90", 2.70f, 0.0f, 0},   {"step80", 2.40f, 0.0f, 0},
+        {"ramp0.05", 2.50f, 0.05f, 0}, {"ramp0.2", 2.50f, 0.2f, 0},  {"ramp1", 2.50f, 1.0f, 0},
+        {"dip300", 2.70f, 0.0f, 300}, {"dip500", 2.70f, 0.0f, 500}, {"dip1000", 2.70f, 0.0f, 1000},
+    };
+    for (int cells = 3; cells <= 8; ++cells) {
+      for (const Profile& p : kProfiles) {
+        // Sag phase against the 100 ms battery sampling interval.
+        for (uint32_t phase = 0; phase < 100; phase += 10) {
+          snprintf(name, sizeof(name), "uv_%dS_%s_ph%u", cells, p.tag, static_cast<unsigned>(phase));
+          SimScenario s = baseScenario(name, 1000);
+          setSetting(s, "bat_cells", cells);
+          const float v0 = kNominalCellV * cells;
+          const float vLow = p.cellV * cells;
+          const uint32_t sagAt = 3000 + phase;
+          if (p.rateVps > 0.0f) {
+            const uint32_t rampMs = static_cast<uint32_t>((kNominalCellV - p.cellV) / p.rateVps * 1000.0f);
+            s.packV.points = {{0, v0}, {sagAt, v0}, {sagAt + rampMs, vLow}};
+            s.durationMs = sagAt + rampMs + 3000;
+          } else if (p.dipMs > 0) {
+            s.packV.points = {{0, v0}, {sagAt, v0}, {sagAt + 1, vLow}, {sagAt + p.dipMs, vLow}, {sagAt + p.dipMs + 1, v0}};
+            s.durationMs = sagAt + p.dipMs + 3000;
+          } else {
+            s.packV.points = {{0, v0}, {sagAt, v0}, {sagAt + 1, vLow}};
+            s.durationMs = sagAt + 3000;
+          }
+          out.push_back(s);
+        }
+      }
+    }
+  }
+
+  if (all || strcmp(kind, "auto_off") == 0) {
+    matched = true;
+    static const int kMinutes[] = {1, 2, 3, 5};
+    for (int minutes : kMinutes) {
+      for (uint32_t phase = 0; phase < 1000; phase += 200) {
+        snprintf(name, sizeof(name), "auto_off_%dmin_ph%u", minutes, static_cast<unsigned>(phase));
+        SimScenario s = baseScenario(name, 1000 + phase);
+        setSetting(s, "auto_off", minutes);
+        s.durationMs = s.motorStartMs + static_cast<uint32_t>(minutes) * 60000U + 3000;
+        out.push_back(s);
+      }
+    }
+  }
+
+  return matched;
+}
+
+int simScenarioSetting(const SimScenario& scenario, const char* key, int firmwareValue) {
+  for (const auto& kv : scenario.settings) {
+    if (kv.first == key) {
+      return kv.second;
+    }
+  }
+  return firmwareValue;
+}
+
+SimExpectation simExpectedCutoff(const SimScenario& s, uint8_t tempLimitC, uint8_t cells, uint8_t autoOffMinutes,
+                                 float minCellV) {
+  SimExpectation best{"none", 0, false};
+  uint32_t bestMs = UINT32_MAX;
+
+  if (autoOffMinutes > 0) {
+    bestMs = s.motorStartMs + static_cast<uint32_t>(autoOffMinutes) * 60000U;
+    best.cause = "auto_off";
+  }
+  // The firmware checks cutoffs only while the motor runs; scan the traces at 1 ms resolution.
+  if (tempLimitC > 0 && !s.tempC.empty()) {
+    for (uint32_t t = s.motorStartMs; t < s.durationMs && t < bestMs; ++t) {
+      if (s.tempC.at(t, kAmbientC) > static_cast<float>(tempLimitC)) {
+        bestMs = t;
+        best.cause = "thermal_stop";
+        break;
+      }
+    }
+  }
+  if (cells > 0 && !s.packV.empty()) {
+    // Follow the pack through the ADC moving average, then apply the debounce: the stop needs the
+    // 100 ms published value to read low on every sample across 400 ms. A low stretch longer than the
+    // debounce but shorter than debounce + sampling interval fires or not depending on where the
+    // samples land, so either outcome counts as expected there.
+    float window[kUndervoltageFilterMs] = {};
+    float sum = 0.0f;
+    uint32_t belowSinceMs = 0;
+    bool below = false;
+    const uint32_t filterStartMs = s.motorStartMs >= kUndervoltageFilterMs ? s.motorStartMs - kUndervoltageFilterMs : 0;
+    for (uint32_t t = filterStartMs; t <= s.durationMs; ++t) {
+      const float packV = t < s.durationMs ? s.packV.at(t, 0.0f) : 0.0f;
+      float& slot = window[t % kUndervoltageFilterMs];
+      sum += packV - slot;
+      slot = packV;
+      if (t < s.motorStartMs) {
+        continue;
+      }
+      const float filteredV = sum / static_cast<float>(kUndervoltageFilterMs);
+      const bool low =
+          t < s.durationMs && filteredV > 0.05f && filteredV / static_cast<float>(cells) < minCellV;
+      if (low && !below) {
+        below = true;
+        belowSinceMs = t;
+      }
+      const uint32_t lowMs = t - belowSinceMs;
+      if (!below || (low && lowMs < kUndervoltageDebounceMs + kBatterySampleMs)) {
+        continue;
+      }
+      // Either sure to fire (still low a full sampling interval past the debounce) or the stretch ended.
+      const uint32_t onsetMs = belowSinceMs + kUndervoltageDebounceMs;
+      if (lowMs > kUndervoltageDebounceMs && onsetMs < bestMs) {
+        bestMs = onsetMs;
+        best.cause = "undervoltage_stop";
+        best.phaseDependent = !low;
+      }
+      if (low || onsetMs >= bestMs) {
+        break;
+      }
+      below = false;
+    }
+  }
+  if (bestMs >= s.durationMs) {
+    return SimExpectation{"none", 0, false};
+  }
+  best.onsetMs = bestMs;
+  return best;
+}
+
+#endif  // OSHVAC_SIM
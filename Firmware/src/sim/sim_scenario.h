@@ -0,0 +1,66 @@
+#ifndef SIM_SCENARIO_H
+#define SIM_SCENARIO_H
+
+#if defined(OSHVAC_SIM)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Piecewise-linear signal: (t_ms, value) points, held flat before the first and after the last. */
+struct SimChannel {
+  std::vector<std::pair<uint32_t, float>> points;
+
+  bool empty() const { return points.empty(); }
+  float at(uint32_t tMs, float fallback) const;
+};
+
+/**
+ * One cutoff-timing scenario. Times are ms from scenario start (the forked, booted firmware).
+ * Settings are applied through the real set_settings command before the motor is started.
+ */
+struct SimScenario {
+  std::string name;
+  std::vector<std::pair<std::string, int>> settings;  // e.g. {"temp_lim", 60}
+  uint8_t speedPercent = 100;
+  uint32_t motorStartMs = 1000;
+  uint32_t durationMs = 60000;
+  SimChannel tempC;       // motor NTC
+  SimChannel packV;       // battery pack at the divider input
+  SimChannel rpm;         // tach FG (tach_ppr pulses per revolution)
+  SimChannel dieTempC;    // MCU die
+};
+
+/** Which cutoff should fire first according to the traces, and when (ms from scenario start). */
+struct SimExpectation {
+  const char* cause;  // "auto_off", "thermal_stop", "undervoltage_stop" or "none"
+  uint32_t onsetMs;
+  bool phaseDependent;  // outcome hinges on where the 100 ms battery samples land: "none" is fine too
+};
+
+/**
+ * Scenario line format (whitespace separated, '#' starts a comment):
+ *   name key=value ...
+ * Keys: any set_settings key (temp_lim, bat_cells, auto_off, ...), speed, start_ms, duration_s,
+ * and the channels temp, pack_v, rpm, die_temp as value@ms lists, e.g. temp=25@0,95@20000.
+ * trace=path.csv loads recorded channels from CSV columns t_ms,temp_c,pack_v,rpm[,die_c].
+ */
+bool simParseScenarioLine(const char* line, SimScenario& out, std::string& error);
+bool simLoadScenarioFile(const char* path, std::vector<SimScenario>& out, std::string& error);
+bool simLoadTraceCsv(const char* path, SimScenario& scenario, std::string& error);
+
+/** Built-in synthetic grids: "thermal", "undervoltage", "auto_off" or "all". */
+bool simBuildSweep(const char* kind, std::vector<SimScenario>& out);
+
+/** Settings value the scenario applies, or the firmware default if it leaves the key alone. */
+int simScenarioSetting(const SimScenario& scenario, const char* key, int firmwareValue);
+
+SimExpectation simExpectedCutoff(const SimScenario& scenario, uint8_t tempLimitC, uint8_t cells,
+                                 uint8_t autoOffMinutes, float minCellV);
+
+#endif  // OSHVAC_SIM
+
+#endif  // SIM_SCENARIO_H
@@ -0,0 +1,215 @@
+#include "static_assets.h"
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <LittleFS.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+constexpr char kManifestPath[] = "/assets.idx";
+constexpr size_t kManifestMaxBytes = 4096;
+constexpr uint8_t kMaxAssets = 32;
+constexpr size_t kUrlMax = 64;
+constexpr size_t kEtagMax = 24;  // quoted, as sent
+// Files up to this size are kept in RAM after boot (index.html, the favicon), within the budget.
+constexpr size_t kHotAssetMaxBytes = 2048;
+constexpr size_t kHotCacheBudget = 8192;
+
+constexpr char kCacheImmutable[] = "public, max-age=31536000, immutable";
+constexpr char kCacheRevalidate[] = "no-cache";
+constexpr char kCacheDay[] = "public, max-age=86400";
+
+// Interned so entries only hold a pointer; anything else is served as octet-stream.
+constexpr const char* kMimeTypes[] = {
+    "text/html",  "text/css",  "application/javascript", "application/json", "image/svg+xml",
+    "image/png",  "image/jpeg", "image/gif",             "image/x-icon",     "image/webp",
+    "font/woff2", "text/plain",
+};
+constexpr char kMimeDefault[] = "application/octet-stream";
+
+struct StaticAsset {
+  char url[kUrlMax];
+  char etag[kEtagMax];
+  const char* mime;
+  const char* cacheControl;
+  uint32_t size;  // stored (possibly compressed) length
+  bool gzip;
+  uint8_t* hot;   // whole file in RAM, or nullptr
+};
+
+StaticAsset assets[kMaxAssets];
+uint8_t assetCount = 0;
+
+const char* internMime(const char* mime) {
+  for (const char* m : kMimeTypes) {
+    if (strcmp(m, mime) == 0) {
+      return m;
+    }
+  }
+  return kMimeDefault;
+}
+
+const char* cachePolicy(const char* url) {
+  if (strncmp(url, "/assets/", 8) == 0) {
+    return kCacheImmutable;  // file names carry the content hash
+  }
+  const size_t len = strlen(url);
+  if (len >= 5 && strcmp(url + len - 5, ".html") == 0) {
+    return kCacheRevalidate;
+  }
+  return kCacheDay;
+}
+
+void storedPath(const StaticAsset& asset, char* out, size_t outSize) {
+  snprintf(out, outSize, "%s%s", asset.url, asset.gzip ? ".gz" : "");
+}
+
+// One manifest line: url, mime, encoding, size, etag (tab separated); false if malformed.
+bool parseLine(char* line, StaticAsset& out) {
+  char* fields[5];
+  uint8_t n = 0;
+  char* p = line;
+  while (n < 5 && p != nullptr) {
+    fields[n++] = p;
+    p = strchr(p, '\t');
+    if (p != nullptr) {
+      *p++ = '\0';
+    }
+  }
+  if (n != 5 || fields[0][0] != '/' || strlen(fields[0]) >= kUrlMax || strlen(fields[4]) >= kEtagMax) {
+    return false;
+  }
+  strcpy(out.url, fields[0]);
+  strcpy(out.etag, fields[4]);
+  out.mime = internMime(fields[1]);
+  out.cacheControl = cachePolicy(out.url);
+  out.gzip = strcmp(fields[2], "gzip") == 0;
+  out.size = static_cast<uint32_t>(strtoul(fields[3], nullptr, 10));
+  out.hot = nullptr;
+  return true;
+}
+
+bool loadManifest() {
+  File f = LittleFS.open(kManifestPath, "r");
+  if (!f) {
+    return false;
+  }
+  const size_t size = f.size();
+  char* text = size < kManifestMaxBytes ? static_cast<char*>(malloc(size + 1)) : nullptr;
+  if (text == nullptr) {
+    Serial.printf("[WebServer] Manifest too large (%u bytes)\n", static_cast<unsigned>(size));
+    f.close();
+    return false;
+  }
+  text[f.read(reinterpret_cast<uint8_t*>(text), size)] = '\0';
+  f.close();
+
+  assetCount = 0;
+  char* line = text;
+  while (line != nullptr && *line != '\0' && assetCount < kMaxAssets) {
+    char* next = strchr(line, '\n');
+    if (next != nullptr) {
+      *next++ = '\0';
+    }
+    if (parseLine(line, assets[assetCount])) {
+      ++assetCount;
+    }
+    line = next;
+  }
+  free(text);
+  return assetCount > 0;
+}
+
+void loadHotCache(uint8_t& hotCount, size_t& hotBytes) {
+  hotCount = 0;
+  hotBytes = 0;
+  for (uint8_t i = 0; i < assetCount; ++i) {
+    StaticAsset& a = assets[i];
+    if (a.size == 0 || a.size > kHotAssetMaxBytes || hotBytes + a.size > kHotCacheBudget) {
+      continue;
+    }
+    char path[kUrlMax + 4];
+    storedPath(a, path, sizeof(path));
+    File f = LittleFS.open(path, "r");
+    uint8_t* buf = f ? static_cast<uint8_t*>(malloc(a.size)) : nullptr;
+    if (buf != nullptr && f.read(buf, a.size) == a.size) {
+      a.hot = buf;
+      hotBytes += a.size;
+      ++hotCount;
+    } else {
+      free(buf);
+    }
+    if (f) {
+      f.close();
+    }
+  }
+}
+
+const StaticAsset* findAsset(const char* url) {
+  for (uint8_t i = 0; i < assetCount; ++i) {
+    if (strcmp(assets[i].url, url) == 0) {
+      return &assets[i];
+    }
+  }
+  return nullptr;
+}
+
+void addCacheHeaders(AsyncWebServerResponse* response, const StaticAsset& asset) {
+  response->addHeader("ETag", asset.etag);
+  response->addHeader("Cache-Control", asset.cacheControl);
+}
+
+}  // namespace
+
+bool staticAssetsInit() {
+  for (uint8_t i = 0; i < assetCount; ++i) {
+    free(assets[i].hot);
+  }
+  assetCount = 0;
+  if (!loadManifest()) {
+    Serial.println("[WebServer] No asset manifest; serving files uncompressed");
+    return false;
+  }
+  uint8_t hotCount = 0;
+  size_t hotBytes = 0;
+  loadHotCache(hotCount, hotBytes);
+  Serial.printf("[WebServer] %u assets in manifest, %u cached in RAM (%u bytes)\n", assetCount, hotCount,
+                static_cast<unsigned>(hotBytes));
+  return true;
+}
+
+bool staticAssetsServe(AsyncWebServerRequest* request) {
+  const String& url = request->url();
+  const StaticAsset* asset = findAsset(url == "/" ? "/index.html" : url.c_str());
+  if (asset == nullptr) {
+    return false;
+  }
+
+  // The stored ETag is unique per content, so a substring match also covers lists and W/ prefixes.
+  const AsyncWebHeader* match = request->getHeader("If-None-Match");
+  if (match != nullptr && strstr(match->value().c_str(), asset->etag) != nullptr) {
+    AsyncWebServerResponse* response = request->beginResponse(304);
+    addCacheHeaders(response, *asset);
+    request->send(response);
+    return true;
+  }
+
+  AsyncWebServerResponse* response;
+  if (asset->hot != nullptr) {
+    response = request->beginResponse(200, asset->mime, asset->hot, asset->size);
+  } else {
+    // Open the stored name directly so the library does not probe for a .gz sibling.
+    char path[kUrlMax + 4];
+    storedPath(*asset, path, sizeof(path));
+    response = request->beginResponse(LittleFS, path, asset->mime);
+  }
+  // Only the .gz is on flash; every browser sends Accept-Encoding: gzip.
+  if (asset->gzip) {
+    response->addHeader("Content-Encoding", "gzip");
+  }
+  addCacheHeaders(response, *asset);
+  request->send(response);
+  return true;
+}
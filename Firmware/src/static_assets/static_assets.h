@@ -0,0 +1,19 @@
+#ifndef STATIC_ASSETS_H
+#define STATIC_ASSETS_H
+
+class AsyncWebServerRequest;
+
+/**
+ * Web UI files from LittleFS, looked up in the /assets.idx manifest written by tools/fs_pack.py at
+ * uploadfs time (url -> mime, encoding, size, ETag), so requests never probe the filesystem.
+ * Hashed files under /assets/ are immutable, everything else revalidates with If-None-Match; small files
+ * (index.html) are answered from RAM.
+ */
+
+/** Load the manifest and the hot cache; false if LittleFS has no manifest (old image). */
+bool staticAssetsInit();
+
+/** Answer a GET for the request's URL ("/" is index.html); false if it is not in the manifest. */
+bool staticAssetsServe(AsyncWebServerRequest* request);
+
+#endif  // STATIC_ASSETS_H
@@ -1,63 +1,269 @@
-#include <Arduino.h>
 #include "tachometer.h"
 
-#define FG_PIN 16
+#include <Arduino.h>
+#include <driver/mcpwm_cap.h>
+#include <driver/pulse_cnt.h>
+
+#include <atomic>
+
+#include "../settings/settings.h"
+
+namespace {
+
+constexpr uint8_t kFgPin = 16;
+
+// Period mode (capture interrupt per edge) below kFrequencyEnterHz edges/s, PCNT windows above it;
+// the gap keeps the mode from flapping at the threshold.
+constexpr float kFrequencyEnterHz = 1000.0f;
+constexpr float kFrequencyExitHz = 800.0f;
+// Frequency mode samples PCNT every kSampleUs; the window reaches back until it holds kWindowMinEdges
+// edges (0.5 % resolution) or spans kWindowMaxUs.
+constexpr uint32_t kSampleUs = 5000;
+constexpr uint32_t kWindowMinEdges = 200;
+constexpr uint32_t kWindowMaxUs = 250000;
+constexpr uint8_t kSampleSlots = kWindowMaxUs / kSampleUs + 2;
+// Reads 0 after kStallPeriods periods without an edge (at least kStallMinUs); edges further apart than
+// kStallMaxUs are not measured at all (120 RPM at one pulse per revolution).
+constexpr uint32_t kStallPeriods = 3;
+constexpr uint32_t kStallMinUs = 20000;
+constexpr uint32_t kStallMaxUs = 500000;
+constexpr int kPcntHighLimit = 32767;  // 16-bit counter; the driver accumulates across the limit
+constexpr uint32_t kGlitchFilterNs = 1000;
+constexpr uint32_t kCaptureSlots = 16;
+
+enum class TachMode : uint8_t { Period, Frequency };
+
+struct CountSample {
+  uint32_t atUs;
+  uint32_t count;
+};
+
+pcnt_unit_handle_t pcntUnit = nullptr;
+mcpwm_cap_channel_handle_t captureChannel = nullptr;
+bool hardware = false;
+uint32_t captureHz = 1000000;  // timestamp ticks per second (micros() with the GPIO interrupt)
+
+// Edge timestamps, written only by the capture (or GPIO) interrupt.
+uint32_t captureTicks[kCaptureSlots];
+std::atomic<uint32_t> captureHead{0};
+
+TachMode mode = TachMode::Period;
+uint32_t captureTail = 0;
+uint32_t lastCapture = 0;
+bool haveLastCapture = false;
+uint32_t periodUs = 0;  // last measured edge period, 0 when stopped
+uint32_t lastEdgeSeenUs = 0;
+
+CountSample samples[kSampleSlots];
+uint8_t sampleHead = 0;  // next slot to write
+uint8_t sampleFill = 0;
+
+float rpmCached = 0.0f;
+bool rpmReady = false;
+
+void IRAM_ATTR pushCapture(uint32_t ticks) {
+  const uint32_t head = captureHead.load(std::memory_order_relaxed);
+  captureTicks[head % kCaptureSlots] = ticks;
+  captureHead.store(head + 1, std::memory_order_release);
+}
+
+bool IRAM_ATTR onCapture(mcpwm_cap_channel_handle_t, const mcpwm_capture_event_data_t* edata, void*) {
+  pushCapture(edata->cap_value);
+  return false;
+}
+
+void IRAM_ATTR onFgEdge() {
+  pushCapture(micros());
+}
+
+bool initPulseCounter() {
+  pcnt_unit_config_t unitConfig = {};
+  unitConfig.low_limit = -1;
+  unitConfig.high_limit = kPcntHighLimit;
+  unitConfig.flags.accum_count = 1;
+  pcnt_glitch_filter_config_t filterConfig = {};
+  filterConfig.max_glitch_ns = kGlitchFilterNs;
+  pcnt_chan_config_t chanConfig = {};
+  chanConfig.edge_gpio_num = kFgPin;
+  chanConfig.level_gpio_num = -1;
+  pcnt_channel_handle_t chan = nullptr;
+  return pcnt_new_unit(&unitConfig, &pcntUnit) == ESP_OK &&
+         pcnt_unit_set_glitch_filter(pcntUnit, &filterConfig) == ESP_OK &&
+         pcnt_new_channel(pcntUnit, &chanConfig, &chan) == ESP_OK &&
+         pcnt_channel_set_edge_action(chan, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_HOLD) ==
+             ESP_OK &&
+         pcnt_unit_add_watch_point(pcntUnit, kPcntHighLimit) == ESP_OK && pcnt_unit_enable(pcntUnit) == ESP_OK &&
+         pcnt_unit_clear_count(pcntUnit) == ESP_OK && pcnt_unit_start(pcntUnit) == ESP_OK;
+}
+
+bool initCapture() {
+  mcpwm_capture_timer_config_t timerConfig = {};
+  timerConfig.group_id = 0;
+  timerConfig.clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT;
+  mcpwm_capture_channel_config_t chanConfig = {};
+  chanConfig.gpio_num = kFgPin;
+  chanConfig.prescale = 1;
+  chanConfig.flags.pos_edge = 1;
+  mcpwm_capture_event_callbacks_t callbacks = {};
+  callbacks.on_cap = onCapture;
+  mcpwm_cap_timer_handle_t timer = nullptr;
+  return mcpwm_new_capture_timer(&timerConfig, &timer) == ESP_OK &&
+         mcpwm_capture_timer_get_resolution(timer, &captureHz) == ESP_OK &&
+         mcpwm_new_capture_channel(timer, &chanConfig, &captureChannel) == ESP_OK &&
+         mcpwm_capture_channel_register_event_callbacks(captureChannel, &callbacks, nullptr) == ESP_OK &&
+         mcpwm_capture_channel_enable(captureChannel) == ESP_OK && mcpwm_capture_timer_enable(timer) == ESP_OK &&
+         mcpwm_capture_timer_start(timer) == ESP_OK;
+}
+
+void publishRpm(float edgeHz) {
+  const uint8_t ppr = getRuntimeSettings().tachPulsesPerRev;
+  rpmCached = edgeHz * 60.0f / static_cast<float>(ppr > 0 ? ppr : 1);
+  rpmReady = true;
+}
+
+const CountSample& sampleBack(uint8_t back) {
+  return samples[(sampleHead + kSampleSlots - 1 - back) % kSampleSlots];
+}
 
-// Tachometer parameters
-const uint8_t PULSES_PER_REV = 1;  // adjust to your motor/fan FG output
+// Reads PCNT once per kSampleUs (in both modes, so a full window is ready when frequency mode starts).
+bool samplePulseCount(uint32_t now) {
+  if (sampleFill > 0 && now - sampleBack(0).atUs < kSampleUs) {
+    return false;
+  }
+  int count = 0;
+  pcnt_unit_get_count(pcntUnit, &count);
+  samples[sampleHead] = CountSample{now, static_cast<uint32_t>(count)};
+  sampleHead = static_cast<uint8_t>((sampleHead + 1) % kSampleSlots);
+  if (sampleFill < kSampleSlots) {
+    ++sampleFill;
+  }
+  return true;
+}
 
-// Pulse counting (volatile for ISR access)
-volatile uint32_t fgPulseCount = 0;
+void enterFrequencyMode() {
+  mcpwm_capture_channel_disable(captureChannel);
+  mode = TachMode::Frequency;
+}
 
-// State variables
-static float rpm_cached = 0.0f;
-static bool rpmReady = false;
-static unsigned long lastUpdateTime = 0;
-const unsigned long UPDATE_INTERVAL = 200; // Update every 200ms
+void enterPeriodMode(uint32_t now, float recentHz) {
+  captureTail = captureHead.load(std::memory_order_acquire);
+  haveLastCapture = false;
+  lastEdgeSeenUs = now;
+  periodUs = recentHz > 0.0f ? static_cast<uint32_t>(1e6f / recentHz) : 0;
+  mcpwm_capture_channel_enable(captureChannel);
+  mode = TachMode::Period;
+}
 
-// Interrupt Service Routine for FG pulse
-void IRAM_ATTR onFgPulse() {
-  fgPulseCount = fgPulseCount + 1;
+void updatePeriodMode(uint32_t now) {
+  const uint32_t head = captureHead.load(std::memory_order_acquire);
+  if (head - captureTail > kCaptureSlots / 2) {
+    // Fell behind; keep the newest half, clear of the slot the interrupt writes next.
+    captureTail = head - kCaptureSlots / 2;
+    haveLastCapture = false;
+  }
+  const bool sawEdge = captureTail != head;
+  uint32_t periods = 0;
+  uint32_t spanTicks = 0;
+  for (; captureTail != head; ++captureTail) {
+    const uint32_t ticks = captureTicks[captureTail % kCaptureSlots];
+    if (haveLastCapture) {
+      spanTicks += ticks - lastCapture;
+      ++periods;
+    }
+    lastCapture = ticks;
+    haveLastCapture = true;
+  }
+
+  if (periods > 0 && spanTicks > 0) {
+    lastEdgeSeenUs = now;
+    const float edgeHz = static_cast<float>(periods) * static_cast<float>(captureHz) / static_cast<float>(spanTicks);
+    periodUs = static_cast<uint32_t>(1e6f / edgeHz);
+    publishRpm(edgeHz);
+    if (hardware && edgeHz >= kFrequencyEnterHz) {
+      enterFrequencyMode();
+    }
+    return;
+  }
+  if (sawEdge) {
+    lastEdgeSeenUs = now;  // first edge after a stop: a period needs the next one
+    return;
+  }
+
+  const uint32_t quietUs = now - lastEdgeSeenUs;
+  uint32_t stallUs = periodUs * kStallPeriods;
+  stallUs = stallUs < kStallMinUs ? kStallMinUs : (stallUs > kStallMaxUs ? kStallMaxUs : stallUs);
+  if (quietUs >= stallUs) {
+    publishRpm(0.0f);
+  }
+  if (quietUs >= kStallMaxUs) {
+    haveLastCapture = false;
+    periodUs = 0;
+  }
+}
+
+void updateFrequencyMode(uint32_t now) {
+  const CountSample& newest = sampleBack(0);
+  uint32_t edges = 0;
+  uint32_t spanUs = 0;
+  for (uint8_t back = 1; back < sampleFill; ++back) {
+    const CountSample& s = sampleBack(back);
+    if (newest.atUs - s.atUs > kWindowMaxUs) {
+      break;
+    }
+    edges = newest.count - s.count;
+    spanUs = newest.atUs - s.atUs;
+    if (edges >= kWindowMinEdges) {
+      break;
+    }
+  }
+  if (spanUs == 0) {
+    return;
+  }
+  const float edgeHz = static_cast<float>(edges) * 1e6f / static_cast<float>(spanUs);
+  // The newest sample step alone shows a stall or a sharp slow-down long before the window does.
+  const CountSample& previous = sampleBack(1);
+  const uint32_t recentUs = newest.atUs - previous.atUs;
+  const float recentHz =
+      recentUs > 0 ? static_cast<float>(newest.count - previous.count) * 1e6f / static_cast<float>(recentUs) : edgeHz;
+  if (edgeHz < kFrequencyExitHz || recentHz < kFrequencyExitHz / 2.0f) {
+    enterPeriodMode(now, recentHz);
+    return;
+  }
+  publishRpm(edgeHz);
 }
 
+}  // namespace
+
 void initTachometer() {
-  pinMode(FG_PIN, INPUT);
-  attachInterrupt(digitalPinToInterrupt(FG_PIN), onFgPulse, RISING);
-  lastUpdateTime = millis();
+  pinMode(kFgPin, INPUT);
+  hardware = initPulseCounter() && initCapture();
+  if (hardware) {
+    Serial.printf("[Tach] PCNT + MCPWM capture on GPIO%u (%lu Hz timestamps)\n", kFgPin,
+                  static_cast<unsigned long>(captureHz));
+  } else {
+    captureHz = 1000000;
+    attachInterrupt(digitalPinToInterrupt(kFgPin), onFgEdge, RISING);
+    Serial.println("[Tach] PCNT/capture unavailable, timing edges with a GPIO interrupt");
+  }
+  lastEdgeSeenUs = micros();
 }
 
 void updateTachometer() {
-  unsigned long currentTime = millis();
-  
-  // Only update every UPDATE_INTERVAL ms
-  if (currentTime - lastUpdateTime < UPDATE_INTERVAL) {
-    return;
+  const uint32_t now = micros();
+  const bool sampled = hardware && samplePulseCount(now);
+  if (mode == TachMode::Frequency) {
+    if (sampled) {
+      updateFrequencyMode(now);
+    }
+  } else {
+    updatePeriodMode(now);
   }
-  
-  unsigned long dt = currentTime - lastUpdateTime;
-  lastUpdateTime = currentTime;
-  
-  // Copy and reset pulse count with interrupts disabled
-  uint32_t count;
-  noInterrupts();
-  count = fgPulseCount;
-  fgPulseCount = 0;
-  interrupts();
-  
-  // Compute Hz
-  float hz = (float)count * 1000.0f / (float)dt;
-  
-  // Compute RPM
-  rpm_cached = hz * 60.0f / (float)PULSES_PER_REV;
-  
-  rpmReady = true;
 }
 
 float getRPM() {
-  return rpm_cached;
+  return rpmCached;
 }
 
 bool isRPMReady() {
   return rpmReady;
 }
-
@@ -1,17 +1,20 @@
 #ifndef TACHOMETER_H
 #define TACHOMETER_H
 
-// Initialize tachometer
+/**
+ * FG tachometer: PCNT counts every edge, MCPWM capture timestamps them. Below ~1 kHz of edges the RPM
+ * comes from the captured periods; above it the capture interrupt is switched off and PCNT counts over a
+ * sliding window of at least 200 edges (0.5 % resolution). Pulses per revolution is the tach_ppr setting.
+ */
 void initTachometer();
 
-// Update RPM reading (call this in loop())
+// Update RPM reading (control tick)
 void updateTachometer();
 
-// Get last read RPM
+// Get last read RPM (0 once the rotor has stopped or stalled)
 float getRPM();
 
 // Check if RPM is ready (has been read at least once)
 bool isRPMReady();
 
 #endif // TACHOMETER_H
-
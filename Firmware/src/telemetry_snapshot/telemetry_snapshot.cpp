@@ -0,0 +1,57 @@
+#include "telemetry_snapshot.h"
+
+#include <Arduino.h>
+
+#include <atomic>
+
+namespace {
+std::atomic<uint32_t> s_seq{0};  // odd while the writer is copying
+std::atomic<uint32_t> s_version{0};
+TelemetrySnapshot s_snapshot{};
+TelemetrySnapshot s_lastPublished{};  // writer-private copy for change detection
+
+bool sameValues(const TelemetrySnapshot& a, const TelemetrySnapshot& b) {
+  return a.speedPercent == b.speedPercent && a.batteryVoltage == b.batteryVoltage &&
+         a.temperatureC == b.temperatureC && a.temperatureReady == b.temperatureReady &&
+         a.mcuTemperatureC == b.mcuTemperatureC && a.rpm == b.rpm && a.rpmReady == b.rpmReady &&
+         a.triggerHeld == b.triggerHeld && a.batterySocPercent == b.batterySocPercent &&
+         a.motorActive == b.motorActive && a.displayInfoMode == b.displayInfoMode &&
+         a.displayInfoPage == b.displayInfoPage && a.maxStats.maxRpm == b.maxStats.maxRpm &&
+         a.maxStats.hasMaxRpm == b.maxStats.hasMaxRpm && a.maxStats.maxVoltageV == b.maxStats.maxVoltageV &&
+         a.maxStats.hasMaxVoltage == b.maxStats.hasMaxVoltage &&
+         a.maxStats.maxMotorTempC == b.maxStats.maxMotorTempC &&
+         a.maxStats.hasMaxMotorTemp == b.maxStats.hasMaxMotorTemp;
+}
+}  // namespace
+
+void telemetrySnapshotPublish(const TelemetrySnapshot& snapshot) {
+  const uint32_t version = s_version.load(std::memory_order_relaxed);
+  if (version != 0 && sameValues(snapshot, s_lastPublished)) {
+    return;
+  }
+  s_lastPublished = snapshot;
+  s_lastPublished.version = version + 1U;
+  s_lastPublished.publishedMs = millis();
+
+  const uint32_t seq = s_seq.load(std::memory_order_relaxed);
+  s_seq.store(seq + 1U, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  s_snapshot = s_lastPublished;
+  s_seq.store(seq + 2U, std::memory_order_release);
+  s_version.store(version + 1U, std::memory_order_release);
+}
+
+void telemetrySnapshotRead(TelemetrySnapshot& out) {
+  uint32_t before = 0;
+  uint32_t after = 0;
+  do {
+    before = s_seq.load(std::memory_order_acquire);
+    out = s_snapshot;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = s_seq.load(std::memory_order_relaxed);
+  } while ((before & 1U) != 0U || before != after);
+}
+
+uint32_t telemetrySnapshotVersion() {
+  return s_version.load(std::memory_order_acquire);
+}
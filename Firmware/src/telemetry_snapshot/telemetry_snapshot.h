@@ -0,0 +1,45 @@
+#ifndef TELEMETRY_SNAPSHOT_H
+#define TELEMETRY_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../maximum_stats/maximum_stats.h"
+
+/**
+ * Everything the control tick measured, published once per tick. Display, LED bar and device
+ * link read this instead of calling the sensor/motor getters again.
+ */
+struct TelemetrySnapshot {
+  /** Bumped only when a field below changed; 0 = nothing published yet. */
+  uint32_t version;
+  uint32_t publishedMs;
+
+  uint8_t speedPercent;
+  float batteryVoltage;
+  float temperatureC;
+  bool temperatureReady;
+  float mcuTemperatureC;
+  float rpm;
+  bool rpmReady;
+  bool triggerHeld;
+  int8_t batterySocPercent;  // 0-100, or -1 if unavailable
+  bool motorActive;
+  bool displayInfoMode;
+  uint8_t displayInfoPage;
+  MaximumStatsForDisplay maxStats;
+};
+
+/**
+ * Single writer (the control tick). Assigns version/publishedMs; when the values equal the last
+ * published ones nothing is written and the version stays, so readers can skip their work.
+ */
+void telemetrySnapshotPublish(const TelemetrySnapshot& snapshot);
+
+/** Lock-free for any number of readers (seqlock: retries while the writer is mid-copy). */
+void telemetrySnapshotRead(TelemetrySnapshot& out);
+
+/** Cheap check before a full read. */
+uint32_t telemetrySnapshotVersion();
+
+#endif  // TELEMETRY_SNAPSHOT_H
@@ -0,0 +1,260 @@
+#include "telemetry_stream.h"
+
+#include <Arduino.h>
+#include <math.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "../battery/battery.h"
+#include "../motor/motor.h"
+
+namespace {
+struct StreamSample {
+  uint32_t tMs;
+  uint32_t rpm;
+  uint16_t seq;
+  uint16_t packMv;
+  int16_t tempCc;
+  uint8_t duty;
+  uint8_t speed;
+};
+
+constexpr uint32_t kRingSize = 256;  // power of two; 1.28 s at 200 Hz
+constexpr uint32_t kFlushAgeMs = 250;
+constexpr size_t kMaxDeltaBytes = 5 + 3 + 3 + 2 + 2;  // worst-case varints for one sample
+
+// Single producer (control tick) / single consumer (I/O task) ring.
+StreamSample s_ring[kRingSize];
+std::atomic<uint32_t> s_head{0};
+std::atomic<uint32_t> s_tail{0};
+std::atomic<bool> s_active{false};
+std::atomic<uint16_t> s_periodMs{1000 / kStreamDefaultRateHz};
+std::atomic<uint8_t> s_fieldMask{kStreamFieldAll};
+std::atomic<uint32_t> s_dropped{0};
+
+// I/O side only.
+uint8_t s_subscribers = 0;
+uint8_t s_batch = kStreamDefaultBatch;
+
+// Control side only.
+bool s_samplerRunning = false;
+uint32_t s_nextSampleMs = 0;
+uint16_t s_nextSeq = 0;
+
+void putU16(uint8_t* p, uint16_t v) {
+  p[0] = static_cast<uint8_t>(v);
+  p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void putU32(uint8_t* p, uint32_t v) {
+  putU16(p, static_cast<uint16_t>(v));
+  putU16(p + 2, static_cast<uint16_t>(v >> 16));
+}
+
+size_t putVarint(uint8_t* p, int32_t delta) {
+  uint32_t z = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+  size_t n = 0;
+  while (z >= 0x80U) {
+    p[n++] = static_cast<uint8_t>(z | 0x80U);
+    z >>= 7;
+  }
+  p[n++] = static_cast<uint8_t>(z);
+  return n;
+}
+
+size_t putAbsolute(uint8_t* p, const StreamSample& s, uint8_t mask) {
+  size_t n = 0;
+  if (mask & kStreamFieldRpm) {
+    putU32(p + n, s.rpm);
+    n += 4;
+  }
+  if (mask & kStreamFieldPack) {
+    putU16(p + n, s.packMv);
+    n += 2;
+  }
+  if (mask & kStreamFieldTemp) {
+    putU16(p + n, static_cast<uint16_t>(s.tempCc));
+    n += 2;
+  }
+  if (mask & kStreamFieldDuty) {
+    p[n++] = s.duty;
+  }
+  if (mask & kStreamFieldSpeed) {
+    p[n++] = s.speed;
+  }
+  return n;
+}
+
+size_t putDelta(uint8_t* p, const StreamSample& s, const StreamSample& prev, uint8_t mask) {
+  size_t n = 0;
+  if (mask & kStreamFieldRpm) {
+    n += putVarint(p + n, static_cast<int32_t>(s.rpm - prev.rpm));
+  }
+  if (mask & kStreamFieldPack) {
+    n += putVarint(p + n, static_cast<int32_t>(s.packMv) - static_cast<int32_t>(prev.packMv));
+  }
+  if (mask & kStreamFieldTemp) {
+    n += putVarint(p + n, static_cast<int32_t>(s.tempCc) - static_cast<int32_t>(prev.tempCc));
+  }
+  if (mask & kStreamFieldDuty) {
+    n += putVarint(p + n, static_cast<int32_t>(s.duty) - static_cast<int32_t>(prev.duty));
+  }
+  if (mask & kStreamFieldSpeed) {
+    n += putVarint(p + n, static_cast<int32_t>(s.speed) - static_cast<int32_t>(prev.speed));
+  }
+  return n;
+}
+}  // namespace
+
+TelemetryStreamConfig telemetryStreamNormalize(uint16_t rateHz, uint8_t fieldMask, uint8_t batch) {
+  if (rateHz < kStreamMinRateHz) {
+    rateHz = kStreamMinRateHz;
+  }
+  if (rateHz > kStreamMaxRateHz) {
+    rateHz = kStreamMaxRateHz;
+  }
+  fieldMask &= kStreamFieldAll;
+  if (fieldMask == 0) {
+    fieldMask = kStreamFieldAll;
+  }
+  if (batch == 0) {
+    batch = 1;
+  }
+  if (batch > kStreamMaxBatch) {
+    batch = kStreamMaxBatch;
+  }
+  TelemetryStreamConfig config;
+  config.periodMs = static_cast<uint16_t>((1000U + rateHz / 2U) / rateHz);
+  config.fieldMask = fieldMask;
+  config.batch = batch;
+  return config;
+}
+
+void telemetryStreamSubscribe(uint8_t client, const TelemetryStreamConfig& config) {
+  s_subscribers = static_cast<uint8_t>(s_subscribers | (1U << client));
+  s_batch = config.batch;
+  s_periodMs.store(config.periodMs, std::memory_order_relaxed);
+  s_fieldMask.store(config.fieldMask, std::memory_order_relaxed);
+  if (!s_active.load(std::memory_order_relaxed)) {
+    // Whatever a previous session left behind is stale.
+    s_tail.store(s_head.load(std::memory_order_acquire), std::memory_order_release);
+    s_active.store(true, std::memory_order_release);
+    Serial.printf("[Stream] started: %u ms period, fields 0x%02X, batch %u\n", static_cast<unsigned>(config.periodMs),
+                  static_cast<unsigned>(config.fieldMask), static_cast<unsigned>(config.batch));
+  }
+}
+
+void telemetryStreamUnsubscribe(uint8_t client) {
+  if ((s_subscribers & (1U << client)) == 0) {
+    return;
+  }
+  s_subscribers = static_cast<uint8_t>(s_subscribers & ~(1U << client));
+  if (s_subscribers == 0) {
+    s_active.store(false, std::memory_order_release);
+    Serial.printf("[Stream] stopped (%lu samples dropped so far)\n",
+                  static_cast<unsigned long>(s_dropped.load(std::memory_order_relaxed)));
+  }
+}
+
+uint8_t telemetryStreamSubscribers() {
+  return s_subscribers;
+}
+
+void telemetryStreamSample(const TelemetrySnapshot& snapshot) {
+  if (!s_active.load(std::memory_order_acquire)) {
+    s_samplerRunning = false;
+    return;
+  }
+  const uint32_t now = millis();
+  const uint16_t period = s_periodMs.load(std::memory_order_relaxed);
+  if (!s_samplerRunning) {
+    s_samplerRunning = true;
+    s_nextSampleMs = now;
+  }
+  if (static_cast<int32_t>(now - s_nextSampleMs) < 0) {
+    return;
+  }
+  if (now - s_nextSampleMs >= period) {
+    // Missed whole periods (light sleep, a long tick): skip their sequence numbers so the
+    // consumer sees the gap, and restart the cadence from now.
+    s_nextSeq = static_cast<uint16_t>(s_nextSeq + (now - s_nextSampleMs) / period);
+    s_nextSampleMs = now;
+  }
+  s_nextSampleMs += period;
+
+  const uint8_t mask = s_fieldMask.load(std::memory_order_relaxed);
+  StreamSample sample;
+  sample.tMs = now;
+  sample.seq = s_nextSeq++;
+  sample.rpm = snapshot.rpmReady && snapshot.rpm > 0.0f ? static_cast<uint32_t>(lroundf(snapshot.rpm)) : 0U;
+  // The 100 ms averaged pack value is too slow for brownouts; read the ADC once per sample.
+  sample.packMv = (mask & kStreamFieldPack) ? static_cast<uint16_t>(lroundf(readBatteryVoltageNow() * 1000.0f)) : 0U;
+  sample.tempCc = snapshot.temperatureReady ? static_cast<int16_t>(lroundf(snapshot.temperatureC * 100.0f)) : 0;
+  const int duty = snapshot.motorActive ? getMotorDuty() : 0;
+  sample.duty = static_cast<uint8_t>(duty < 0 ? 0 : (duty > 255 ? 255 : duty));
+  sample.speed = snapshot.speedPercent;
+
+  const uint32_t head = s_head.load(std::memory_order_relaxed);
+  if (head - s_tail.load(std::memory_order_acquire) >= kRingSize) {
+    s_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  s_ring[head & (kRingSize - 1U)] = sample;
+  s_head.store(head + 1U, std::memory_order_release);
+}
+
+size_t telemetryStreamTakeBatch(uint8_t* out, size_t capacity) {
+  if (!s_active.load(std::memory_order_acquire)) {
+    return 0;
+  }
+  const uint8_t mask = s_fieldMask.load(std::memory_order_relaxed);
+  const uint32_t tail = s_tail.load(std::memory_order_relaxed);
+  const uint32_t pending = s_head.load(std::memory_order_acquire) - tail;
+  if (pending == 0) {
+    return 0;
+  }
+  const StreamSample first = s_ring[tail & (kRingSize - 1U)];
+  if (pending < s_batch && (millis() - first.tMs) < kFlushAgeMs) {
+    return 0;
+  }
+  uint8_t absolute[12];
+  const size_t absoluteLen = putAbsolute(absolute, first, mask);
+  if (capacity < kStreamBatchHeaderSize + absoluteLen) {
+    return 0;
+  }
+
+  out[0] = kStreamBatchMagic;
+  out[1] = kStreamBatchVersion;
+  out[2] = mask;
+  putU16(out + 4, s_periodMs.load(std::memory_order_relaxed));
+  putU16(out + 6, first.seq);
+  putU32(out + 8, first.tMs);
+  memcpy(out + kStreamBatchHeaderSize, absolute, absoluteLen);
+  size_t len = kStreamBatchHeaderSize + absoluteLen;
+
+  uint32_t count = 1;
+  StreamSample prev = first;
+  uint8_t delta[kMaxDeltaBytes];
+  while (count < s_batch && count < pending) {
+    const StreamSample next = s_ring[(tail + count) & (kRingSize - 1U)];
+    if (next.seq != static_cast<uint16_t>(prev.seq + 1U)) {
+      break;  // gap: the next batch restarts with an absolute sample
+    }
+    const size_t n = putDelta(delta, next, prev, mask);
+    if (len + n > capacity) {
+      break;
+    }
+    memcpy(out + len, delta, n);
+    len += n;
+    prev = next;
+    ++count;
+  }
+  out[3] = static_cast<uint8_t>(count);
+  s_tail.store(tail + count, std::memory_order_release);
+  return len;
+}
+
+uint32_t telemetryStreamDropped() {
+  return s_dropped.load(std::memory_order_relaxed);
+}
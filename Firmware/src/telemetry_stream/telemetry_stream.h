@@ -0,0 +1,71 @@
+#ifndef TELEMETRY_STREAM_H
+#define TELEMETRY_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../telemetry_snapshot/telemetry_snapshot.h"
+
+/**
+ * High-rate sample stream (stream_start / stream_stop). The control tick samples into a ring only
+ * while at least one client is subscribed; the I/O side drains it into batch messages.
+ *
+ * Batch message v1 (binary, little-endian):
+ *   0 u8 magic 0xA6   1 u8 version   2 u8 field mask   3 u8 sample count
+ *   4 u16 sample period [ms]   6 u16 seq of the first sample   8 u32 millis() of the first sample
+ *  12 first sample, present fields in mask-bit order with fixed widths:
+ *     rpm u32, pack u16 [mV], temp i16 [0.01 °C], duty u8 [0–255], speed u8 [%]
+ *  then every further sample as one zigzag LEB128 varint per field: the delta to the previous one.
+ * Samples in a batch are consecutive; a gap (ring overrun, light sleep) starts a new batch.
+ */
+constexpr uint8_t kStreamBatchMagic = 0xA6;
+constexpr uint8_t kStreamBatchVersion = 1;
+constexpr size_t kStreamBatchHeaderSize = 12;
+
+constexpr uint8_t kStreamFieldRpm = 1U << 0;
+constexpr uint8_t kStreamFieldPack = 1U << 1;
+constexpr uint8_t kStreamFieldTemp = 1U << 2;
+constexpr uint8_t kStreamFieldDuty = 1U << 3;
+constexpr uint8_t kStreamFieldSpeed = 1U << 4;
+constexpr uint8_t kStreamFieldAll = 0x1F;
+
+constexpr uint16_t kStreamMinRateHz = 10;
+constexpr uint16_t kStreamMaxRateHz = 200;
+constexpr uint16_t kStreamDefaultRateHz = 100;
+constexpr uint8_t kStreamDefaultBatch = 10;
+constexpr uint8_t kStreamMaxBatch = 64;
+
+/** Subscriber ids: WebSocket client n is n (0–6), the BLE client is kStreamClientBle. */
+constexpr uint8_t kStreamClientBle = 7;
+
+struct TelemetryStreamConfig {
+  uint16_t periodMs;
+  uint8_t fieldMask;
+  uint8_t batch;  // samples per message (upper bound; also capped by the transport payload)
+};
+
+/**
+ * Clamps rate/batch and drops unknown field bits. The rate is rounded to a whole-millisecond
+ * period (150 Hz runs at 7 ms), so the returned config is what the stream actually does.
+ */
+TelemetryStreamConfig telemetryStreamNormalize(uint16_t rateHz, uint8_t fieldMask, uint8_t batch);
+
+/** I/O side. The last start wins for the shared rate/mask/batch. */
+void telemetryStreamSubscribe(uint8_t client, const TelemetryStreamConfig& config);
+void telemetryStreamUnsubscribe(uint8_t client);
+/** Bit n set = subscriber n. */
+uint8_t telemetryStreamSubscribers();
+
+/** Control tick, after the snapshot is published. Returns at once while nobody is subscribed. */
+void telemetryStreamSample(const TelemetrySnapshot& snapshot);
+
+/**
+ * I/O side: encodes the next batch into `out` (at most `capacity` bytes). Returns 0 while fewer
+ * than `batch` samples are pending and the oldest is younger than the flush age.
+ */
+size_t telemetryStreamTakeBatch(uint8_t* out, size_t capacity);
+
+/** Samples lost because the ring was full (since boot). */
+uint32_t telemetryStreamDropped();
+
+#endif  // TELEMETRY_STREAM_H
@@ -0,0 +1,86 @@
+#ifndef NTC_TABLE_H
+#define NTC_TABLE_H
+
+#include <stdint.h>
+
+/**
+ * NTC in a divider with a fixed resistor, as Steinhart–Hart coefficients (1/T = A + B ln R + C ln³ R,
+ * T in kelvin). Beta datasheets map onto it with C = 0; see ntcFromBeta().
+ */
+struct NtcModel {
+  double a;
+  double b;
+  double c;
+  double seriesOhms;
+  bool ntcToGnd;  // false: NTC to 3V3, fixed resistor to GND (higher code = hotter)
+};
+
+constexpr uint16_t kNtcAdcMax = 4095;
+// Table values saturate here; beyond them the sensor is open or shorted anyway.
+constexpr int16_t kNtcTableMinCenti = -5500;
+constexpr int16_t kNtcTableMaxCenti = 30000;
+
+/** Natural log usable in constant expressions (std::log is not constexpr); x > 0. */
+constexpr double ntcLn(double x) {
+  constexpr double kLn2 = 0.693147180559945309417;
+  int exponent = 0;
+  while (x > 1.5) {
+    x /= 2.0;
+    ++exponent;
+  }
+  while (x < 0.75) {
+    x *= 2.0;
+    --exponent;
+  }
+  // ln x = 2 atanh((x - 1) / (x + 1)); |y| <= 0.2 here, so 12 odd terms are below double precision.
+  const double y = (x - 1.0) / (x + 1.0);
+  const double y2 = y * y;
+  double term = y;
+  double sum = 0.0;
+  for (int n = 1; n < 24; n += 2) {
+    sum += term / n;
+    term *= y2;
+  }
+  return 2.0 * sum + exponent * kLn2;
+}
+
+constexpr NtcModel ntcFromBeta(double r0Ohms, double t0Kelvin, double beta, double seriesOhms, bool ntcToGnd) {
+  return NtcModel{1.0 / t0Kelvin - ntcLn(r0Ohms) / beta, 1.0 / beta, 0.0, seriesOhms, ntcToGnd};
+}
+
+constexpr NtcModel ntcFromSteinhartHart(double a, double b, double c, double seriesOhms, bool ntcToGnd) {
+  return NtcModel{a, b, c, seriesOhms, ntcToGnd};
+}
+
+/** Thermistor resistance for a 12-bit code, clamped to 1..4094 like the conversion always was. */
+constexpr double ntcOhms(const NtcModel& m, uint16_t adc) {
+  const double code = adc < 1 ? 1.0 : (adc > kNtcAdcMax - 1 ? kNtcAdcMax - 1.0 : static_cast<double>(adc));
+  return m.ntcToGnd ? m.seriesOhms * code / (kNtcAdcMax - code) : m.seriesOhms * (kNtcAdcMax - code) / code;
+}
+
+/** Temperature in °C for a resistance, given ln R (the caller picks a constexpr or a libm log). */
+constexpr double ntcCelsiusFromLnOhms(const NtcModel& m, double lnR) {
+  return 1.0 / (m.a + m.b * lnR + m.c * lnR * lnR * lnR) - 273.15;
+}
+
+/** One centi-degree value per ADC code. */
+struct NtcTable {
+  int16_t centi[kNtcAdcMax + 1];
+};
+
+constexpr NtcTable buildNtcTable(const NtcModel& m) {
+  NtcTable table{};
+  for (uint32_t adc = 0; adc <= kNtcAdcMax; ++adc) {
+    const double c = ntcCelsiusFromLnOhms(m, ntcLn(ntcOhms(m, static_cast<uint16_t>(adc)))) * 100.0;
+    table.centi[adc] = c <= kNtcTableMinCenti   ? kNtcTableMinCenti
+                       : c >= kNtcTableMaxCenti ? kNtcTableMaxCenti
+                                                : static_cast<int16_t>(c + 0.5 - (c < 0.0 ? 1.0 : 0.0));
+  }
+  return table;
+}
+
+inline int16_t ntcLookupCenti(const NtcTable& table, uint16_t adc) {
+  return table.centi[adc > kNtcAdcMax ? kNtcAdcMax : adc];
+}
+
+#endif  // NTC_TABLE_H
@@ -1,89 +1,133 @@
 #include <Arduino.h>
 #include "temperature.h"
-#include <math.h>
+#include "../adc_sampler/adc_sampler.h"
 
-#define THERM_PIN 4
+namespace {
 
 // Hardware configuration
-const bool  THERMISTOR_TO_GND = false;   // NTC to 3V3, fixed to GND
-const float SERIES_R  = 10000.0f;        // 10k fixed resistor (to GND)
-
-// ADC configuration
-const uint16_t ADC12_MAX = 4095;         // 12-bit ADC (0..4095)
+constexpr bool   THERMISTOR_TO_GND = false;  // NTC to 3V3, fixed to GND
+constexpr double SERIES_R  = 10000.0;        // 10k fixed resistor (to GND)
 
 // Thermistor parameters
-const float R0        = 10000.0f;        // 10k at 25°C
-const float T0_K      = 298.15f;         // 25 °C in Kelvin
-const float BETA      = 3950.0f;         // Beta parameter
-
-// Sampling configuration
-const uint8_t N = 8;                     // Number of samples to average
-constexpr uint32_t SAMPLE_SPACING_US = 350;
+constexpr double R0        = 10000.0;        // 10k at 25°C
+constexpr double T0_K      = 298.15;         // 25 °C in Kelvin
+constexpr double BETA      = 3950.0;         // Beta parameter
+
+constexpr NtcModel kMotorModel = ntcFromBeta(R0, T0_K, BETA, SERIES_R, THERMISTOR_TO_GND);
+// Evaluated by the compiler into flash (8 KB): a conversion is one load instead of a divide and a logf.
+constexpr NtcTable kMotorTable = buildNtcTable(kMotorModel);
+
+static_assert(kMotorTable.centi[2048] > 2490 && kMotorTable.centi[2048] < 2510, "midscale is ~25 C for 10k/10k");
+static_assert(kMotorTable.centi[3000] > kMotorTable.centi[1000], "NTC to 3V3: higher code is hotter");
+
+#if defined(NTC2_ADC_PIN)
+// Second NTC: generic 10k part, Steinhart–Hart fit of its datasheet R/T table; same divider wiring.
+constexpr double NTC2_SH_A = 1.009249522e-3;
+constexpr double NTC2_SH_B = 2.378405444e-4;
+constexpr double NTC2_SH_C = 2.019202697e-7;
+constexpr double NTC2_SERIES_R = 10000.0;
+constexpr bool   NTC2_TO_GND = false;
+
+constexpr NtcModel kAuxModel = ntcFromSteinhartHart(NTC2_SH_A, NTC2_SH_B, NTC2_SH_C, NTC2_SERIES_R, NTC2_TO_GND);
+constexpr NtcTable kAuxTable = buildNtcTable(kAuxModel);
+#endif
+
+constexpr NtcModel kNoModel = {};
+
+struct NtcState {
+  float celsius;
+  bool ready;
+};
+
+NtcState states[kNtcChannelCount];
+unsigned long lastReadTime = 0;
+const unsigned long READ_INTERVAL = 250; // Convert the ADC moving average every 250ms
+
+const NtcTable* tableFor(NtcChannel channel) {
+  switch (channel) {
+    case NtcChannel::Motor:
+      return &kMotorTable;
+#if defined(NTC2_ADC_PIN)
+    case NtcChannel::Aux:
+      return &kAuxTable;
+#endif
+    default:
+      return nullptr;
+  }
+}
 
-// State variables
-static float lastTemperature = 0.0f;
-static bool temperatureReady = false;
-static unsigned long lastReadTime = 0;
-const unsigned long READ_INTERVAL = 250; // Start a new multi-sample cycle every 250ms
+bool adcChannelFor(NtcChannel channel, AdcChannel& out) {
+  switch (channel) {
+    case NtcChannel::Motor:
+      out = AdcChannel::Thermistor;
+      return true;
+#if defined(NTC2_ADC_PIN)
+    case NtcChannel::Aux:
+      out = AdcChannel::Thermistor2;
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
 
-static uint8_t tempSampleIdx = 0;
-static uint32_t tempAcc = 0;
-static uint32_t nextThermSampleAtUs = 0;
+}  // namespace
 
 void initTemperature() {
-  pinMode(THERM_PIN, INPUT);
   lastReadTime = millis();
-  tempSampleIdx = 0;
-  tempAcc = 0;
 }
 
 void updateTemperature() {
   const unsigned long currentTime = millis();
-
-  if (tempSampleIdx == 0) {
-    if (currentTime - lastReadTime < READ_INTERVAL) {
-      return;
-    }
-    lastReadTime = currentTime;
-    tempAcc = 0;
-  } else {
-    const uint32_t nowUs = micros();
-    // Signed delta so micros() wrap (~71 min) still yields correct wait vs scheduled sample time.
-    if (static_cast<int32_t>(nowUs - nextThermSampleAtUs) < 0) {
-      return;
-    }
+  if (currentTime - lastReadTime < READ_INTERVAL) {
+    return;
   }
+  lastReadTime = currentTime;
 
-  tempAcc += static_cast<uint32_t>(analogRead(THERM_PIN));
-  tempSampleIdx++;
-
-  if (tempSampleIdx < N) {
-    nextThermSampleAtUs = micros() + SAMPLE_SPACING_US;
-    return;
+  for (uint8_t i = 0; i < kNtcChannelCount; ++i) {
+    const NtcChannel channel = static_cast<NtcChannel>(i);
+    AdcChannel adcChannel;
+    if (!adcChannelFor(channel, adcChannel) || !adcSamplerReady(adcChannel)) {
+      continue;
+    }
+    const int16_t centi = ntcLookupCenti(*tableFor(channel), adcSamplerFiltered(adcChannel).raw);
+    states[i].celsius = static_cast<float>(centi) / 100.0f;
+    states[i].ready = true;
   }
+}
 
-  tempSampleIdx = 0;
-  uint16_t adc = static_cast<uint16_t>(tempAcc / N);
+float getTemperature() {
+  return getNtcTemperature(NtcChannel::Motor);
+}
 
-  if (adc < 1) {
-    adc = 1;
-  }
-  if (adc >= ADC12_MAX) {
-    adc = ADC12_MAX - 1;
-  }
+bool isTemperatureReady() {
+  return isNtcTemperatureReady(NtcChannel::Motor);
+}
 
-  float Rth = SERIES_R * ((float)(ADC12_MAX - adc) / (float)adc);
-  float T_K = 1.0f / (1.0f / T0_K + (1.0f / BETA) * log(Rth / R0));
-  float T_C = T_K - 273.15f;
+float getNtcTemperature(NtcChannel channel) {
+  const uint8_t i = static_cast<uint8_t>(channel);
+  return i < kNtcChannelCount ? states[i].celsius : 0.0f;
+}
 
-  lastTemperature = T_C;
-  temperatureReady = true;
+bool isNtcTemperatureReady(NtcChannel channel) {
+  const uint8_t i = static_cast<uint8_t>(channel);
+  return i < kNtcChannelCount && states[i].ready;
 }
 
-float getTemperature() {
-  return lastTemperature;
+int16_t ntcCentiFromAdc(NtcChannel channel, uint16_t adc) {
+  const NtcTable* table = tableFor(channel);
+  return table != nullptr ? ntcLookupCenti(*table, adc) : INT16_MIN;
 }
 
-bool isTemperatureReady() {
-  return temperatureReady;
+const NtcModel& ntcChannelModel(NtcChannel channel) {
+  switch (channel) {
+    case NtcChannel::Motor:
+      return kMotorModel;
+#if defined(NTC2_ADC_PIN)
+    case NtcChannel::Aux:
+      return kAuxModel;
+#endif
+    default:
+      return kNoModel;
+  }
 }
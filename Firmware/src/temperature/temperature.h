@@ -1,17 +1,38 @@
 #ifndef TEMPERATURE_H
 #define TEMPERATURE_H
 
+#include <stdint.h>
+
+#include "ntc_table.h"
+
+/**
+ * Thermistor inputs. Motor is the NTC on GPIO4; Aux is an optional second NTC (pack, driver), built
+ * in when NTC2_ADC_PIN is defined. Codes are converted through a constexpr table per channel.
+ */
+enum class NtcChannel : uint8_t { Motor = 0, Aux, Count };
+
+constexpr uint8_t kNtcChannelCount = static_cast<uint8_t>(NtcChannel::Count);
+
 // Initialize temperature sensor
 void initTemperature();
 
 // Update temperature reading (call this in loop())
 void updateTemperature();
 
-// Get last read temperature in Celsius
+// Get last read motor temperature in Celsius
 float getTemperature();
 
-// Check if temperature is ready (has been read at least once)
+// Check if the motor temperature is ready (has been read at least once)
 bool isTemperatureReady();
 
-#endif // TEMPERATURE_H
+// Per-channel variants; Aux is never ready without NTC2_ADC_PIN
+float getNtcTemperature(NtcChannel channel);
+bool isNtcTemperatureReady(NtcChannel channel);
+
+/** Table conversion of one 12-bit code to centi-degrees C (INT16_MIN for a channel not built in). */
+int16_t ntcCentiFromAdc(NtcChannel channel, uint16_t adc);
 
+/** The model a channel's table was built from (for the host accuracy check). */
+const NtcModel& ntcChannelModel(NtcChannel channel);
+
+#endif // TEMPERATURE_H
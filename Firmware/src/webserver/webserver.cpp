@@ -2,6 +2,7 @@
 #include "webserver.h"
 #include "wifi/wifi.h"
 #include "settings/settings_config.h"
+#include "static_assets/static_assets.h"
 
 #include <ESPAsyncWebServer.h>
 #include <AsyncTCP.h>
@@ -15,6 +16,36 @@ AsyncWebServer httpServer(HTTP_PORT);
 // State
 static bool httpServerRunning = false;
 
+// Fallback for filesystem images uploaded without tools/fs_pack.py (no /assets.idx).
+static const char* contentTypeFor(const String& path) {
+  if (path.endsWith(".html")) return "text/html";
+  if (path.endsWith(".css")) return "text/css";
+  if (path.endsWith(".js")) return "application/javascript";
+  if (path.endsWith(".png")) return "image/png";
+  if (path.endsWith(".jpg") || path.endsWith(".jpeg")) return "image/jpeg";
+  if (path.endsWith(".gif")) return "image/gif";
+  if (path.endsWith(".svg")) return "image/svg+xml";
+  return "text/plain";
+}
+
+static void serveUnpacked(AsyncWebServerRequest *request) {
+  const String path = request->url() == "/" ? String("/index.html") : request->url();
+  if (!LittleFS.exists(path)) {
+    Serial.printf("[WebServer] 404 - Not found: %s\n", path.c_str());
+    request->send(404, "text/plain", "Not found");
+    return;
+  }
+  AsyncWebServerResponse *response = request->beginResponse(LittleFS, path, contentTypeFor(path));
+  response->addHeader("Cache-Control", path.endsWith(".html") ? "no-cache" : "public, max-age=3600");
+  request->send(response);
+}
+
+static void serveStatic(AsyncWebServerRequest *request) {
+  if (!staticAssetsServe(request)) {
+    serveUnpacked(request);
+  }
+}
+
 void initWebServer() {
   // Initialize LittleFS
   if (!LittleFS.begin(true)) {
@@ -23,10 +54,7 @@ void initWebServer() {
   }
   Serial.println("[WebServer] LittleFS mounted successfully");
   
-  // Check if index.html exists
-  if (LittleFS.exists("/index.html")) {
-    Serial.println("[WebServer] /index.html found in filesystem");
-  } else {
+  if (!staticAssetsInit() && !LittleFS.exists("/index.html")) {
     Serial.println("[WebServer] WARNING: /index.html not found!");
     Serial.println("[WebServer] Make sure you ran: pio run --target uploadfs");
   }
@@ -38,62 +66,9 @@ void updateWebServer() {
   // Check if WiFi is ready and server is not running
   if (!httpServerRunning && isWiFiStackReady()) {
     Serial.println("[WebServer] WiFi is ready, starting server...");
-    // Serve index.html for root path - register with HTTP_GET explicitly
-    httpServer.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-      Serial.printf("[WebServer] Request: %s from %s\n", request->url().c_str(), request->host().c_str());
-      if (LittleFS.exists("/index.html")) {
-        AsyncWebServerResponse *response = request->beginResponse(LittleFS, "/index.html", "text/html");
-        response->addHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-        response->addHeader("Pragma", "no-cache");
-        response->addHeader("Expires", "0");
-        response->addHeader("Connection", "close");
-        request->send(response);
-        Serial.println("[WebServer] Served /index.html");
-      } else {
-        Serial.println("[WebServer] /index.html not found!");
-        request->send(404, "text/plain", "File not found. Please upload filesystem with: pio run --target uploadfs");
-      }
-    });
-    
-    // Serve other static files (CSS, JS, images, etc.) from LittleFS
-    // We'll handle these manually as needed, or add specific handlers
-    // For now, we'll use a catch-all that serves files if they exist
-    httpServer.onNotFound([](AsyncWebServerRequest *request) {
-      String path = request->url();
-      Serial.printf("[WebServer] Request for: %s\n", path.c_str());
-      
-      // If it's not root, try to serve as a static file
-      if (path != "/" && path.length() > 0) {
-        if (LittleFS.exists(path)) {
-          // Determine content type based on extension
-          String contentType = "text/plain";
-          if (path.endsWith(".html")) contentType = "text/html";
-          else if (path.endsWith(".css")) contentType = "text/css";
-          else if (path.endsWith(".js")) contentType = "application/javascript";
-          else if (path.endsWith(".png")) contentType = "image/png";
-          else if (path.endsWith(".jpg") || path.endsWith(".jpeg")) contentType = "image/jpeg";
-          else if (path.endsWith(".gif")) contentType = "image/gif";
-          else if (path.endsWith(".svg")) contentType = "image/svg+xml";
-          
-          AsyncWebServerResponse *response = request->beginResponse(LittleFS, path, contentType);
-          // Add cache control for static assets (but allow caching for images/CSS/JS)
-          if (path.endsWith(".html")) {
-            response->addHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-            response->addHeader("Pragma", "no-cache");
-            response->addHeader("Expires", "0");
-          } else {
-            response->addHeader("Cache-Control", "public, max-age=3600");
-          }
-          request->send(response);
-          Serial.printf("[WebServer] Served static file: %s\n", path.c_str());
-          return;
-        }
-      }
-      
-      // Not found
-      Serial.printf("[WebServer] 404 - Not found: %s\n", path.c_str());
-      request->send(404, "text/plain", "Not found");
-    });
+    // Manifest lookup per request (no filesystem probing); the unpacked fallback only runs for old images.
+    httpServer.on("/", HTTP_GET, serveStatic);
+    httpServer.onNotFound(serveStatic);
 
     httpServer.begin();
     httpServerRunning = true;
@@ -2,59 +2,236 @@
 #include <string.h>
 #include "websocket.h"
 #include "wifi/wifi.h"
-#include <WebSocketsServer.h>
+#include <ESPAsyncWebServer.h>
+#include "../device_link/device_link.h"
 #include "../device_protocol/device_protocol.h"
 
+#include <atomic>
+
 #define WEBSOCKET_PORT 81
 
-WebSocketsServer webSocket = WebSocketsServer(WEBSOCKET_PORT);
+// Own listener on :81 (the UI and the hosted proxy connect there); the HTTP server stays on :80.
+AsyncWebServer webSocketServer(WEBSOCKET_PORT);
+AsyncWebSocket webSocket("/");
 
 static bool serverRunning = false;
 static WebSocketCommandCallback commandCallback = nullptr;
 
-void webSocketEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
-  switch (type) {
-    case WStype_DISCONNECTED:
-      Serial.printf("[WebSocket] Client %u disconnected\n", num);
-      break;
+static_assert(kWebSocketMaxClients <= kLinkClientBle, "WebSocket client ids must stay below the BLE link id");
+
+namespace {
+
+// Per-client share of the AsyncWebSocket message queue (the library's own limit is larger): telemetry
+// only goes out while at most one frame is waiting, bulk payloads wait below half the queue.
+constexpr uint8_t kQueueDepth = 8;
+constexpr uint8_t kTelemetryQueueLimit = 2;
+constexpr uint8_t kBulkQueueLimit = 4;
+constexpr uint32_t kCleanupIntervalMs = 1000;
+
+// AsyncTCP task -> I/O task: connects, disconnects and whole text messages, in arrival order.
+constexpr uint8_t kInboundSlots = 8;
+static_assert((kInboundSlots & (kInboundSlots - 1)) == 0, "uint8_t head/tail wrap needs a power of two");
+constexpr size_t kInboundMaxLength = 768;
+
+enum class InboundType : uint8_t { Connected, Disconnected, Text };
+
+struct Inbound {
+  InboundType type;
+  uint8_t slot;
+  uint16_t length;
+  uint32_t ip;
+  char data[kInboundMaxLength + 1];
+};
+
+Inbound inbound[kInboundSlots];
+std::atomic<uint8_t> inboundHead{0};
+std::atomic<uint8_t> inboundTail{0};
 
-    case WStype_CONNECTED: {
-      IPAddress ip = webSocket.remoteIP(num);
-      Serial.printf("[WebSocket] Client %u connected from %d.%d.%d.%d\n", num, ip[0], ip[1], ip[2], ip[3]);
-      Serial.printf("[WebSocket] Total connected clients: %u\n", webSocket.connectedClients());
-      {
-        String payload;
-        deviceProtocolBuildSettingsPayload(payload);
-        if (payload.length() > 0) {
-          webSocket.sendTXT(num, payload);
+// AsyncWebSocket client id per link slot (0 = free); written by the AsyncTCP task only.
+std::atomic<uint32_t> slotClientIds[kWebSocketMaxClients];
+
+// I/O task only.
+WebSocketClientStats slotStats[kWebSocketMaxClients];
+uint32_t lastCleanupMs = 0;
+
+int8_t slotOfClient(uint32_t id) {
+  for (uint8_t i = 0; i < kWebSocketMaxClients; ++i) {
+    if (slotClientIds[i].load() == id) {
+      return static_cast<int8_t>(i);
+    }
+  }
+  return -1;
+}
+
+bool postInbound(InboundType type, uint8_t slot, const uint8_t* data, size_t length, uint32_t ip) {
+  const uint8_t tail = inboundTail.load(std::memory_order_relaxed);
+  if (static_cast<uint8_t>(tail - inboundHead.load(std::memory_order_acquire)) >= kInboundSlots) {
+    Serial.printf("[WebSocket] Inbound queue full, dropping event for client %u\n", slot);
+    return false;
+  }
+  Inbound& in = inbound[tail % kInboundSlots];
+  in.type = type;
+  in.slot = slot;
+  in.ip = ip;
+  in.length = static_cast<uint16_t>(length);
+  if (length > 0) {
+    memcpy(in.data, data, length);
+  }
+  in.data[length] = '\0';
+  inboundTail.store(static_cast<uint8_t>(tail + 1), std::memory_order_release);
+  return true;
+}
+
+// Runs on the AsyncTCP task: claim/release a slot and hand everything else to the I/O task.
+void onWebSocketEvent(AsyncWebSocket* server,
+                      AsyncWebSocketClient* client,
+                      AwsEventType type,
+                      void* arg,
+                      uint8_t* data,
+                      size_t length) {
+  (void)server;
+  switch (type) {
+    case WS_EVT_CONNECT: {
+      const int8_t slot = slotOfClient(0);
+      if (slot >= 0) {
+        // Claim first so the I/O task can send as soon as it sees the connect.
+        slotClientIds[slot].store(client->id());
+        const uint32_t ip = static_cast<uint32_t>(client->remoteIP());
+        if (postInbound(InboundType::Connected, static_cast<uint8_t>(slot), nullptr, 0, ip)) {
+          break;
         }
+        slotClientIds[slot].store(0);
+      }
+      Serial.printf("[WebSocket] Refusing client %lu (no free slot)\n", static_cast<unsigned long>(client->id()));
+      client->close();
+      break;
+    }
+    case WS_EVT_DISCONNECT: {
+      const int8_t slot = slotOfClient(client->id());
+      if (slot >= 0) {
+        slotClientIds[slot].store(0);
+        postInbound(InboundType::Disconnected, static_cast<uint8_t>(slot), nullptr, 0, 0);
+      }
+      break;
+    }
+    case WS_EVT_DATA: {
+      const AwsFrameInfo* info = static_cast<const AwsFrameInfo*>(arg);
+      const int8_t slot = slotOfClient(client->id());
+      // Commands are small single-frame text messages; anything else is ignored.
+      if (slot < 0 || info == nullptr || info->opcode != WS_TEXT || !info->final || info->index != 0 ||
+          info->len != length) {
+        break;
+      }
+      if (length > kInboundMaxLength) {
+        Serial.printf("[WebSocket] Dropping %u-byte message from client %d\n", static_cast<unsigned>(length), slot);
+        break;
       }
+      postInbound(InboundType::Text, static_cast<uint8_t>(slot), data, length, 0);
       break;
     }
+    default:
+      break;
+  }
+}
 
-    case WStype_TEXT: {
-      Serial.printf("[WebSocket] Received: %s\n", payload);
-      DeviceCommandResult result = deviceProtocolHandleJson(reinterpret_cast<const char*>(payload), length);
+void handleInbound(const Inbound& in) {
+  switch (in.type) {
+    case InboundType::Connected: {
+      const IPAddress ip(in.ip);
+      slotStats[in.slot] = {};
+      Serial.printf("[WebSocket] Client %u connected from %d.%d.%d.%d\n", in.slot, ip[0], ip[1], ip[2], ip[3]);
+      Serial.printf("[WebSocket] Total connected clients: %u\n", static_cast<unsigned>(webSocket.count()));
+      deviceLinkClientConnected(in.slot);
+      break;
+    }
+    case InboundType::Disconnected:
+      Serial.printf("[WebSocket] Client %u disconnected\n", in.slot);
+      deviceLinkClientDisconnected(in.slot);
+      break;
+    case InboundType::Text: {
+      Serial.printf("[WebSocket] Received: %s\n", in.data);
+      DeviceCommandResult result = deviceProtocolHandleJson(in.data, in.length);
       if (result.hasUnicast) {
-        webSocket.sendTXT(num, result.unicastJson);
+        webSocketSendText(in.slot, result.unicastData(), result.unicastLength(), LinkTxClass::Control);
       }
+      deviceLinkApplyCommandResult(in.slot, result);
       deviceProtocolAfterCommand(result);
       break;
     }
+  }
+}
+
+void processInbound() {
+  uint8_t head = inboundHead.load(std::memory_order_relaxed);
+  while (head != inboundTail.load(std::memory_order_acquire)) {
+    handleInbound(inbound[head % kInboundSlots]);
+    ++head;
+    inboundHead.store(head, std::memory_order_release);
+  }
+}
+
+AsyncWebSocketClient* clientForSlot(uint8_t slot) {
+  if (!serverRunning || slot >= kWebSocketMaxClients) {
+    return nullptr;
+  }
+  const uint32_t id = slotClientIds[slot].load();
+  return id != 0 ? webSocket.client(id) : nullptr;
+}
 
+uint8_t queueLimit(LinkTxClass cls) {
+  switch (cls) {
+    case LinkTxClass::Telemetry:
+      return kTelemetryQueueLimit;
+    case LinkTxClass::Bulk:
+      return kBulkQueueLimit;
     default:
-      break;
+      return kQueueDepth;
+  }
+}
+
+bool queueFrame(uint8_t slot, bool binary, const uint8_t* payload, size_t length, LinkTxClass cls) {
+  if (payload == nullptr || length == 0) {
+    return false;
+  }
+  AsyncWebSocketClient* client = clientForSlot(slot);
+  if (client == nullptr) {
+    return false;
+  }
+  WebSocketClientStats& stats = slotStats[slot];
+  const size_t depth = client->queueLen();
+  const bool queued = depth < queueLimit(cls) &&
+                      (binary ? client->binary(payload, length)
+                              : client->text(reinterpret_cast<const char*>(payload), length));
+  if (!queued) {
+    if (cls == LinkTxClass::Telemetry) {
+      stats.telemetryDropped++;
+    } else {
+      stats.dropped++;
+    }
+    return false;
+  }
+  stats.sent++;
+  stats.bytes += static_cast<uint32_t>(length);
+  if (depth + 1 > stats.peakQueueDepth) {
+    stats.peakQueueDepth = static_cast<uint8_t>(depth + 1);
   }
+  return true;
 }
 
+}  // namespace
+
 void initWebSocket() {
   serverRunning = false;
+  for (std::atomic<uint32_t>& id : slotClientIds) {
+    id.store(0);
+  }
 }
 
 void updateWebSocket() {
   if (!serverRunning && isWiFiStackReady()) {
-    webSocket.begin();
-    webSocket.onEvent(webSocketEvent);
+    webSocket.onEvent(onWebSocketEvent);
+    webSocketServer.addHandler(&webSocket);
+    webSocketServer.begin();
     serverRunning = true;
 
     IPAddress ip;
@@ -68,26 +245,60 @@ void updateWebSocket() {
   }
 
   if (serverRunning) {
-    webSocket.loop();
+    processInbound();
+    const uint32_t now = millis();
+    if (now - lastCleanupMs >= kCleanupIntervalMs) {
+      lastCleanupMs = now;
+      webSocket.cleanupClients();
+    }
   }
 }
 
 void broadcastWebSocket(const char* json) {
-  if (serverRunning && json != nullptr) {
-    webSocket.broadcastTXT(json);
+  if (json == nullptr) {
+    return;
+  }
+  for (uint8_t i = 0; i < kWebSocketMaxClients; ++i) {
+    webSocketSendText(i, json, strlen(json), LinkTxClass::Control);
   }
 }
 
 void sendWebSocketToClient(uint8_t client, const char* json) {
-  if (serverRunning && json != nullptr) {
-    webSocket.sendTXT(client, json);
+  if (json != nullptr) {
+    webSocketSendText(client, json, strlen(json), LinkTxClass::Control);
+  }
+}
+
+bool webSocketSendText(uint8_t client, const char* payload, size_t length, LinkTxClass cls) {
+  return queueFrame(client, false, reinterpret_cast<const uint8_t*>(payload), length, cls);
+}
+
+bool webSocketSendBinary(uint8_t client, const uint8_t* payload, size_t length, LinkTxClass cls) {
+  return queueFrame(client, true, payload, length, cls);
+}
+
+bool webSocketCanQueue(uint8_t client, LinkTxClass cls) {
+  AsyncWebSocketClient* c = clientForSlot(client);
+  return c != nullptr && c->queueLen() < queueLimit(cls);
+}
+
+bool webSocketClientStats(uint8_t client, WebSocketClientStats& out) {
+  AsyncWebSocketClient* c = clientForSlot(client);
+  if (c == nullptr) {
+    return false;
   }
+  out = slotStats[client];
+  const size_t depth = c->queueLen();
+  out.queueDepth = static_cast<uint8_t>(depth > 0xFF ? 0xFF : depth);
+  return true;
 }
 
 void broadcastSettingsToClients() {
   String payload;
   deviceProtocolBuildSettingsPayload(payload);
-  broadcastWebSocket(payload.c_str());
+  for (uint8_t i = 0; i < kWebSocketMaxClients; ++i) {
+    webSocketSendText(i, payload.c_str(), payload.length(), LinkTxClass::Bulk);
+  }
 }
 
 void requestSettingsBroadcast() {
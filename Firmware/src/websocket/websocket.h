@@ -3,6 +3,11 @@
 
 #include <WiFi.h>
 
+#include "../device_protocol/device_protocol.h"
+
+/** Link slots for WebSocket clients (ids 0..n-1 in device_link); later connections are refused. */
+constexpr uint8_t kWebSocketMaxClients = 5;
+
 // Initialize WebSocket server
 void initWebSocket();
 
@@ -13,8 +18,30 @@ void updateWebSocket();
 void broadcastWebSocket(const char* json);
 void sendWebSocketToClient(uint8_t client, const char* json);
 void broadcastSettingsToClients();
+
+/**
+ * Single-client TXT / BIN send (device_link decides who gets what). Frames are queued on the client
+ * and sent by the AsyncTCP task, so these never block. False when the class's queue share is full:
+ * telemetry is then dropped (the next one is newer anyway), control messages are counted as dropped.
+ */
+bool webSocketSendText(uint8_t client, const char* payload, size_t length, LinkTxClass cls);
+bool webSocketSendBinary(uint8_t client, const uint8_t* payload, size_t length, LinkTxClass cls);
+/** Room for one more message of `cls` on `client` (bulk payloads wait while this is false). */
+bool webSocketCanQueue(uint8_t client, LinkTxClass cls);
 void requestSettingsBroadcast();
 
+struct WebSocketClientStats {
+  uint8_t queueDepth;      // frames queued on the client right now
+  uint8_t peakQueueDepth;  // since connect
+  uint32_t sent;           // frames accepted into the queue
+  uint32_t bytes;
+  uint32_t dropped;        // control frames refused (queue full)
+  uint32_t telemetryDropped;
+};
+
+/** Queue depth and counters for a connected slot; false if the slot is free. */
+bool webSocketClientStats(uint8_t client, WebSocketClientStats& out);
+
 // Check if WebSocket server is running
 bool isWebSocketRunning();
 
@@ -25,4 +52,3 @@ typedef void (*WebSocketCommandCallback)(const char* key, int value);
 void setWebSocketCommandCallback(WebSocketCommandCallback callback);
 
 #endif // WEBSOCKET_H
-
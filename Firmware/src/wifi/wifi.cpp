@@ -1,8 +1,10 @@
 #include <Arduino.h>
 #include <stdio.h>
+
+#include <atomic>
+
 #include "wifi.h"
 #include "wifi_credentials.h"
-#include "led/led.h"
 #include "settings/settings_config.h"
 #include <ESPmDNS.h>
 
@@ -19,6 +21,29 @@ const char* ap_password = SettingsConfig::WIFI_AP_PASSWORD;
 
 namespace {
 
+// Set from the WiFi event task, consumed by updateWiFi() on the I/O task.
+std::atomic<bool> staGotIp{false};
+std::atomic<bool> apStarted{false};
+
+std::atomic<WiFiBringUpState> bringUpState{WiFiBringUpState::Idle};
+uint32_t bringUpStartMs = 0;
+uint32_t connectTimeoutMs = WIFI_STA_CONNECT_TIMEOUT_MS;
+bool probePending = false;
+WiFiReadyCallback readyCallback = nullptr;
+
+void onWiFiEvent(arduino_event_id_t event) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      staGotIp.store(true, std::memory_order_release);
+      break;
+    case ARDUINO_EVENT_WIFI_AP_START:
+      apStarted.store(true, std::memory_order_release);
+      break;
+    default:
+      break;
+  }
+}
+
 bool softApIsUp() {
   const wifi_mode_t mode = WiFi.getMode();
   if (mode != WIFI_AP && mode != WIFI_AP_STA) {
@@ -32,26 +57,6 @@ void loadStaCredentials() {
   wifiCredentialsLoad(g_sta_ssid, sizeof(g_sta_ssid), g_sta_password, sizeof(g_sta_password));
 }
 
-bool waitForStaConnection(uint32_t timeoutMs) {
-  unsigned long startTime = millis();
-  unsigned long lastDotTime = 0;
-
-  while (millis() - startTime < timeoutMs) {
-    yield();
-
-    if (WiFi.status() == WL_CONNECTED) {
-      return true;
-    }
-
-    if (millis() - lastDotTime >= 500) {
-      Serial.print(".");
-      lastDotTime = millis();
-    }
-  }
-  Serial.println();
-  return WiFi.status() == WL_CONNECTED;
-}
-
 void configureStaSuccess() {
   Serial.println("WiFi connected successfully!");
   Serial.print("IP address: ");
@@ -84,20 +89,27 @@ bool startAccessPoint() {
   return result;
 }
 
+void finishBringUp(WiFiLinkRole role) {
+  bringUpState.store(WiFiBringUpState::Ready, std::memory_order_release);
+  Serial.printf("[WiFi] Stack ready (%s)\n", role == WiFiLinkRole::Sta ? "STA" : "AP");
+  if (readyCallback != nullptr) {
+    readyCallback(role);
+  }
+}
+
 }  // namespace
 
 bool isWiFiStackReady() {
-  if (WiFi.status() == WL_CONNECTED) {
-    return true;
-  }
-  const wifi_mode_t mode = WiFi.getMode();
-  if (mode == WIFI_AP_STA) {
-    return softApIsUp();
-  }
-  if (mode == WIFI_AP) {
-    return softApIsUp();
-  }
-  return false;
+  return bringUpState.load(std::memory_order_acquire) == WiFiBringUpState::Ready &&
+         getWiFiLinkRole() != WiFiLinkRole::None;
+}
+
+WiFiBringUpState getWiFiBringUpState() {
+  return bringUpState.load(std::memory_order_acquire);
+}
+
+void setWiFiReadyCallback(WiFiReadyCallback callback) {
+  readyCallback = callback;
 }
 
 WiFiLinkRole getWiFiLinkRole() {
@@ -183,39 +195,61 @@ void printNetworkSummaryToSerial(const char* tag) {
 }
 
 void setupWiFi() {
-  setLEDColor(0, 0, 0);
-  setLEDPattern(LED_OFF);
-  updateLED();
-
   loadStaCredentials();
 
-  const bool probePending = wifiCredentialsIsProbePending();
-  const uint32_t connectTimeout =
-      probePending ? WIFI_PROVISION_CONNECT_TIMEOUT_MS : WIFI_STA_CONNECT_TIMEOUT_MS;
+  probePending = wifiCredentialsIsProbePending();
+  connectTimeoutMs = probePending ? WIFI_PROVISION_CONNECT_TIMEOUT_MS : WIFI_STA_CONNECT_TIMEOUT_MS;
 
   Serial.println("Attempting to connect to WiFi...");
   Serial.print("SSID: ");
   Serial.println(wifi_ssid);
 
+  staGotIp.store(false, std::memory_order_relaxed);
+  apStarted.store(false, std::memory_order_relaxed);
+  static bool eventsRegistered = false;
+  if (!eventsRegistered) {
+    WiFi.onEvent(onWiFiEvent);
+    eventsRegistered = true;
+  }
+
   WiFi.mode(WIFI_STA);
   WiFi.begin(wifi_ssid, wifi_password);
+  bringUpStartMs = millis();
+  bringUpState.store(WiFiBringUpState::Connecting, std::memory_order_release);
+}
 
-  const bool connected = waitForStaConnection(connectTimeout);
-
-  if (connected) {
-    wifiCredentialsClearProbePending();
-    configureStaSuccess();
-  } else {
-    if (probePending) {
-      wifiCredentialsClearProbePending();
-      Serial.println("Provisioned WiFi connection failed — returning to Access Point.");
-    } else {
-      Serial.println("WiFi connection failed.");
+void updateWiFi() {
+  switch (bringUpState.load(std::memory_order_acquire)) {
+    case WiFiBringUpState::Connecting: {
+      bool connected = staGotIp.load(std::memory_order_acquire);
+      if (!connected) {
+        if (millis() - bringUpStartMs < connectTimeoutMs) {
+          return;
+        }
+        connected = WiFi.status() == WL_CONNECTED;
+      }
+      if (connected) {
+        wifiCredentialsClearProbePending();
+        configureStaSuccess();
+        finishBringUp(WiFiLinkRole::Sta);
+        return;
+      }
+      if (probePending) {
+        wifiCredentialsClearProbePending();
+        Serial.println("Provisioned WiFi connection failed — returning to Access Point.");
+      } else {
+        Serial.println("WiFi connection failed.");
+      }
+      bringUpState.store(startAccessPoint() ? WiFiBringUpState::StartingAp : WiFiBringUpState::Offline,
+                         std::memory_order_release);
+      return;
     }
-    startAccessPoint();
+    case WiFiBringUpState::StartingAp:
+      if (apStarted.load(std::memory_order_acquire) || softApIsUp()) {
+        finishBringUp(WiFiLinkRole::AccessPoint);
+      }
+      return;
+    default:
+      return;
   }
-
-  setLEDColor(0, 0, 0);
-  setLEDPattern(LED_OFF);
-  updateLED();
 }
@@ -19,10 +19,23 @@ enum class WiFiLinkRole : uint8_t { None, Sta, AccessPoint };
 constexpr uint32_t WIFI_STA_CONNECT_TIMEOUT_MS = 10000;
 constexpr uint32_t WIFI_PROVISION_CONNECT_TIMEOUT_MS = 30000;
 
-// Setup WiFi - tries to connect first, falls back to AP mode
+/// Bring-up progress: STA association, then the soft-AP fallback, then Ready (or Offline if the AP failed).
+enum class WiFiBringUpState : uint8_t { Idle, Connecting, StartingAp, Ready, Offline };
+
+/// Called once from updateWiFi() when the stack is up.
+typedef void (*WiFiReadyCallback)(WiFiLinkRole role);
+
+// Starts STA association and returns at once; updateWiFi() falls back to AP mode on timeout.
 void setupWiFi();
 
-// True when the network stack can bind sockets (STA linked or AP started).
+// Advances the bring-up from the connect/AP events; call every I/O tick.
+void updateWiFi();
+
+WiFiBringUpState getWiFiBringUpState();
+
+void setWiFiReadyCallback(WiFiReadyCallback callback);
+
+// True once bring-up reached Ready and the stack can bind sockets (STA linked or AP started).
 bool isWiFiStackReady();
 
 // STA if connected; else AP if soft-AP is active; else None.
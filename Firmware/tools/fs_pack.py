@@ -0,0 +1,87 @@
+# Packs data/ into the LittleFS image source: text assets are stored gzip-only (<file>.gz), everything
+# else as-is, plus /assets.idx, the manifest the firmware serves from (src/static_assets):
+#
+#   <url> TAB <mime> TAB <identity|gzip> TAB <stored size> TAB "<etag>"
+#
+# PlatformIO runs this as a pre: script and points the buildfs/uploadfs image at the staged copy in
+# .pio/build/<env>/fsdata. Standalone (e.g. for env:native --fs-root):
+#
+#   python3 tools/fs_pack.py data /tmp/fsdata
+
+import gzip
+import hashlib
+import os
+import shutil
+import sys
+
+MANIFEST = "assets.idx"
+
+MIME_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".jpeg": "image/jpeg",
+    ".gif": "image/gif",
+    ".ico": "image/x-icon",
+    ".webp": "image/webp",
+    ".woff2": "font/woff2",
+    ".txt": "text/plain",
+}
+COMPRESSIBLE = {".html", ".css", ".js", ".json", ".svg", ".txt", ".ico"}
+
+
+def pack(src, dst):
+    if os.path.isdir(dst):
+        shutil.rmtree(dst)
+    os.makedirs(dst)
+    entries = []
+    for root, dirs, files in os.walk(src):
+        dirs.sort()
+        for name in sorted(files):
+            if name.startswith(".") or name.endswith(".gz") or name == MANIFEST:
+                continue
+            path = os.path.join(root, name)
+            rel = os.path.relpath(path, src).replace(os.sep, "/")
+            ext = os.path.splitext(name)[1].lower()
+            with open(path, "rb") as f:
+                body = f.read()
+            encoding = "identity"
+            if ext in COMPRESSIBLE:
+                packed = gzip.compress(body, compresslevel=9, mtime=0)
+                if len(packed) < len(body):
+                    body, encoding = packed, "gzip"
+            stored = os.path.join(dst, rel + (".gz" if encoding == "gzip" else ""))
+            os.makedirs(os.path.dirname(stored), exist_ok=True)
+            with open(stored, "wb") as f:
+                f.write(body)
+            etag = hashlib.sha1(body).hexdigest()[:16]
+            mime = MIME_TYPES.get(ext, "application/octet-stream")
+            entries.append("/%s\t%s\t%s\t%d\t\"%s\"\n" % (rel, mime, encoding, len(body), etag))
+    with open(os.path.join(dst, MANIFEST), "w", newline="\n") as f:
+        f.writelines(entries)
+    return len(entries)
+
+
+def main(argv):
+    if len(argv) != 3:
+        print("usage: fs_pack.py <data dir> <out dir>")
+        return 2
+    print("fs_pack: %d assets -> %s" % (pack(argv[1], argv[2]), argv[2]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
+else:
+    Import("env")  # noqa: F821 (SCons)
+    from SCons.Script import COMMAND_LINE_TARGETS  # noqa: E402
+
+    if any(t in ("buildfs", "uploadfs", "uploadfsota") for t in COMMAND_LINE_TARGETS):
+        staged = os.path.join(env.subst("$BUILD_DIR"), "fsdata")  # noqa: F821
+        count = pack(env.subst("$PROJECT_DATA_DIR"), staged)  # noqa: F821
+        print("fs_pack: %d assets staged in %s" % (count, staged))
+        env.Replace(PROJECT_DATA_DIR=staged)  # noqa: F821